@@ -0,0 +1,741 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: bench.cpp
+ * Description: Benchmark Suite Driver (make bench)
+ *
+ * Measures the compiler and the storage engine on synthetic data (see
+ * data_generator.h):
+ *   lexer, parser             generated statement scripts
+ *   generate_csv, csv_load,
+ *   csv_save                  employees table as CSV
+ *   csv_load_lazy             lazy CSV load, and the first query on one
+ *                             of its columns
+ *   point_lookup_scan/_hash   SELECT ... WHERE id = n, without / with a
+ *                             HASH index
+ *   range_scan, _btree        SELECT ... WHERE salary < v at several
+ *                             selectivities, without / with a BTREE index
+ *   range_scan_compiled,
+ *   filter_and, _compiled     the range scans, and an AND of three
+ *                             conditions, interpreted / run as a hot
+ *                             cached plan (compiled filter)
+ *   partitioned_group_by,
+ *   partitioned_lookup        the grouping and the point lookups on a
+ *                             copy hash partitioned by id into 4
+ *   update, delete            WHERE id < n at several selectivities
+ * for every requested table size. Statements go through all compiler
+ * phases, as in batch mode without the plan cache, except the _compiled
+ * cases, which go through a plan cache.
+ *
+ * Each case runs until its time budget is spent (at least once, at most
+ * 1000 times); the median iteration is reported. Results are written as
+ * JSON, one result object per line. Given a baseline (an earlier results
+ * file), cases whose median got slower by more than the threshold are
+ * listed and the exit status is 1.
+ *
+ * Usage:
+ *   ./sql_bench [--rows 10000,100000] [--output results.json]
+ *               [--baseline old.json] [--threshold 10] [--time 300]
+ *               [--statements 20000] [--threads n] [--dir tmpdir]
+ */
+
+#include "../include/data_store.h"
+#include "../include/executor.h"
+#include "../include/lexer.h"
+#include "../include/output.h"
+#include "../include/parser.h"
+#include "../include/partition.h"
+#include "../include/plan_cache.h"
+#include "../include/semantic.h"
+#include "../include/simd_scan.h"
+#include "../include/thread_pool.h"
+#include "data_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace MiniSQL;
+
+namespace {
+
+struct BenchOptions {
+  std::vector<uint64_t> rows = {10000, 100000, 1000000};
+  std::string output = "bench/results.json";
+  std::string baseline;   // Earlier results to compare with (empty = none)
+  double threshold = 10;  // Allowed slowdown in percent
+  double budgetMs = 300;  // Time per case
+  size_t statements = 20000;
+  unsigned threads = 0;   // Scan threads (0 = all cores)
+  std::string dir;        // Scratch directory for CSV files
+};
+
+struct BenchResult {
+  std::string name;
+  uint64_t rows;        // Table size (0 = no table)
+  double selectivity;   // Fraction of rows selected (< 0 = not applicable)
+  size_t iterations;
+  double medianNs;
+  double meanNs;
+  double minNs;
+  uint64_t items;       // Work of one iteration, in `unit`
+  std::string unit;
+
+  double perSecond() const {
+    return medianNs > 0 ? items * 1e9 / medianNs : 0;
+  }
+
+  // Identifies the case across runs
+  std::string key() const {
+    std::ostringstream text;
+    text << name << "/" << rows << "/" << selectivity;
+    return text.str();
+  }
+};
+
+// Discards everything written to it (std::cout during measurements)
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override { return c; }
+};
+
+[[noreturn]] void fail(const std::string &message) {
+  std::cerr << "sql_bench: " << message << "\n";
+  std::exit(1);
+}
+
+double elapsedNs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// ============================================================================
+// MEASUREMENT
+// ============================================================================
+class Bench {
+private:
+  const BenchOptions &options;
+  std::ostream &report;
+  std::vector<BenchResult> results;
+
+public:
+  Bench(const BenchOptions &opts, std::ostream &out)
+      : options(opts), report(out) {}
+
+  const std::vector<BenchResult> &getResults() const { return results; }
+
+  /**
+   * Time fn (which returns the work it did, in `unit`) until the budget is
+   * spent. setup runs before every iteration and is not timed.
+   */
+  void measure(const std::string &name, uint64_t rows, double selectivity,
+               const std::string &unit, const std::function<uint64_t()> &fn,
+               const std::function<void()> &setup = nullptr) {
+    const size_t maxIterations = 1000;
+    std::vector<double> times;
+    uint64_t items = 0;
+    double spent = 0;
+    auto begin = std::chrono::steady_clock::now();
+    while (times.size() < maxIterations &&
+           (times.empty() || spent < options.budgetMs * 1e6)) {
+      if (setup)
+        setup();
+      auto start = std::chrono::steady_clock::now();
+      items = fn();
+      times.push_back(elapsedNs(start));
+      spent = elapsedNs(begin);
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.rows = rows;
+    result.selectivity = selectivity;
+    result.iterations = times.size();
+    result.items = items;
+    result.unit = unit;
+    result.minNs = *std::min_element(times.begin(), times.end());
+    double total = 0;
+    for (double t : times)
+      total += t;
+    result.meanNs = total / times.size();
+    std::nth_element(times.begin(), times.begin() + times.size() / 2,
+                     times.end());
+    result.medianNs = times[times.size() / 2];
+    results.push_back(result);
+    print(result);
+  }
+
+  void print(const BenchResult &r) const {
+    std::ostringstream select;
+    if (r.selectivity >= 0)
+      select << r.selectivity * 100 << "%";
+    else
+      select << "-";
+    report << std::left << std::setw(20) << r.name << std::right
+           << std::setw(11) << (r.rows ? std::to_string(r.rows) : "-")
+           << std::setw(8) << select.str() << std::setw(7) << r.iterations
+           << std::fixed << std::setprecision(1) << std::setw(14)
+           << r.medianNs / 1000 << " us" << std::setw(12)
+           << r.perSecond() / 1e6 << " M " << r.unit << "/s\n";
+    report.unsetf(std::ios::floatfield);
+  }
+
+  void printHeader() const {
+    report << std::left << std::setw(20) << "Benchmark" << std::right
+           << std::setw(11) << "Rows" << std::setw(8) << "Select"
+           << std::setw(7) << "Iter" << std::setw(17) << "Median"
+           << std::setw(12) << "Throughput" << "\n";
+  }
+};
+
+// ============================================================================
+// STATEMENT EXECUTION - All compiler phases, or a plan from the plan cache
+// ============================================================================
+QueryPlan planSql(const Catalog &catalog, DataStore &store,
+                  const std::string &sql) {
+  ParseArena arena;
+  Lexer lexer(sql);
+  std::vector<Token> tokens = lexer.tokenize();
+  Parser parser(tokens, arena);
+  ParseTree tree = lexer.hasErrors() ? nullptr : parser.parse();
+  SemanticAnalyzer semantic(catalog);
+  if (!tree || parser.hasErrors() || !semantic.analyze(tree))
+    fail("invalid statement: " + sql);
+
+  Executor executor(store);
+  QueryPlan plan;
+  if (!executor.buildPlan(tree, plan))
+    fail("cannot plan statement: " + sql);
+  return plan;
+}
+
+uint64_t executePlan(DataStore &store, const QueryPlan &plan,
+                     const std::string &sql) {
+  Executor executor(store);
+  QueryResult result = executor.execute(plan);
+  if (!result.success)
+    fail(sql + ": " + result.message);
+  return result.rows ? result.rows->count()
+                     : static_cast<uint64_t>(result.affectedRows);
+}
+
+uint64_t runSql(const Catalog &catalog, DataStore &store,
+                const std::string &sql) {
+  return executePlan(store, planSql(catalog, store, sql), sql);
+}
+
+// As the console runs a repeated query shape: once hot, its plans are
+// compiled
+uint64_t runCachedSql(const Catalog &catalog, DataStore &store,
+                      PlanCache &cache, const std::string &sql) {
+  std::string key;
+  std::vector<std::string> params;
+  if (!PlanCache::normalize(sql, key, params))
+    fail("cannot normalize statement: " + sql);
+  QueryPlan plan;
+  if (!cache.lookup(key, params, catalog->getVersion(), plan)) {
+    plan = planSql(catalog, store, sql);
+    plan.catalogVersion = catalog->getVersion();
+    cache.insert(key, plan);
+  }
+  return executePlan(store, plan, sql);
+}
+
+// ============================================================================
+// BENCHMARK CASES
+// ============================================================================
+void benchCompiler(Bench &bench, const Catalog &catalog,
+                   const BenchOptions &options) {
+  DataGenerator generator(*catalog->getTable("employees"));
+  std::vector<std::string> script =
+      generator.script(options.statements, 100000);
+  std::string text;
+  for (const auto &sql : script)
+    text += sql + "\n";
+
+  bench.measure("lexer", 0, -1, "bytes", [&]() {
+    Lexer lexer(text);
+    std::vector<Token> tokens = lexer.tokenize();
+    if (lexer.hasErrors())
+      fail("generated script does not tokenize");
+    return static_cast<uint64_t>(text.size());
+  });
+
+  bench.measure("parser", 0, -1, "statements", [&]() {
+    ParseArena arena;
+    for (const auto &sql : script) {
+      Lexer lexer(sql);
+      std::vector<Token> tokens = lexer.tokenize();
+      Parser parser(tokens, arena);
+      if (!parser.parse() || parser.hasErrors())
+        fail("generated statement does not parse: " + sql);
+      arena.reset();
+    }
+    return static_cast<uint64_t>(script.size());
+  });
+}
+
+void benchTable(Bench &bench, const Catalog &catalog, ThreadPool &pool,
+                uint64_t rows, const BenchOptions &options) {
+  namespace fs = std::filesystem;
+  const TableInfo &info = *catalog->getTable("employees");
+  DataGenerator generator(info);
+  std::string loadDir = options.dir + "/load";
+  std::string saveDir = options.dir + "/save";
+  fs::create_directories(loadDir);
+  fs::create_directories(saveDir);
+  std::string csvPath = loadDir + "/employees.csv";
+
+  // CSV generation, load and save
+  bench.measure("generate_csv", rows, -1, "rows", [&]() {
+    std::string error;
+    if (!generator.writeCsv(csvPath, rows, error))
+      fail(error);
+    return rows;
+  });
+  uint64_t bytes = fs::file_size(csvPath);
+
+  DataStore store(*catalog);
+  store.setThreadPool(&pool);
+  bench.measure("csv_load", rows, -1, "bytes", [&]() {
+    store.loadFromFiles(loadDir);
+    return bytes;
+  });
+  if (static_cast<uint64_t>(store.getRowCount("employees")) != rows)
+    fail("csv_load loaded " + std::to_string(store.getRowCount("employees")) +
+         " of " + std::to_string(rows) + " rows");
+
+  // Lazy loading: index the file, then parse the one column a query reads
+  std::string firstId = "SELECT COUNT(*) FROM employees WHERE id = " +
+                        generator.literal(0, generator.columnIndex("id")) +
+                        ";";
+  store.setLazyLoading(true);
+  bench.measure("csv_load_lazy", rows, -1, "bytes", [&]() {
+    store.loadFromFiles(loadDir);
+    runSql(catalog, store, firstId);
+    return bytes;
+  });
+  store.setLazyLoading(false);
+  store.loadFromFiles(loadDir);
+
+  bench.measure("csv_save", rows, -1, "bytes", [&]() {
+    store.saveToFiles(saveDir);
+    return bytes;
+  });
+
+  // Point lookups on random ids
+  int id = generator.columnIndex("id");
+  int salary = generator.columnIndex("salary");
+  std::vector<std::string> lookups;
+  for (uint64_t i = 0; i < 256; i++) {
+    lookups.push_back("SELECT * FROM employees WHERE id = " +
+                      generator.literal((i * 2654435761ULL) % rows, id) +
+                      ";");
+  }
+  size_t next = 0;
+  auto lookup = [&]() {
+    if (runSql(catalog, store, lookups[next++ % lookups.size()]) != 1)
+      fail("point lookup did not find its row");
+    return uint64_t(1);
+  };
+
+  // Range scans at fixed selectivities
+  const std::vector<double> ranges = {0.01, 0.1, 0.5};
+  PlanCache cache;
+  auto rangeScans = [&](const std::string &name, bool cached = false) {
+    for (double fraction : ranges) {
+      std::string sql = "SELECT id FROM employees WHERE salary < " +
+                        generator.cutoff(salary, fraction, rows) + ";";
+      bench.measure(name, rows, fraction, "rows", [&]() {
+        if (cached)
+          runCachedSql(catalog, store, cache, sql);
+        else
+          runSql(catalog, store, sql);
+        return rows;
+      });
+    }
+  };
+
+  bench.measure("point_lookup_scan", rows, -1, "queries", lookup);
+  rangeScans("range_scan");
+
+  // The same scans as hot cached plans, and an AND of three conditions
+  // interpreted and compiled
+  rangeScans("range_scan_compiled", true);
+  std::string conjunction =
+      "SELECT id FROM employees WHERE salary < " +
+      generator.cutoff(salary, 0.5, rows) +
+      " AND age >= 30 AND department != 'Sales';";
+  bench.measure("filter_and", rows, -1, "rows", [&]() {
+    runSql(catalog, store, conjunction);
+    return rows;
+  });
+  bench.measure("filter_and_compiled", rows, -1, "rows", [&]() {
+    runCachedSql(catalog, store, cache, conjunction);
+    return rows;
+  });
+
+  // Aggregation: grouped, and the COUNT(*) row-count fast path
+  bench.measure("group_by", rows, -1, "rows", [&]() {
+    runSql(catalog, store,
+           "SELECT department, COUNT(*), AVG(salary) FROM employees "
+           "GROUP BY department;");
+    return rows;
+  });
+  bench.measure("count_star", rows, -1, "queries", [&]() {
+    if (runSql(catalog, store, "SELECT COUNT(*) FROM employees;") != 1)
+      fail("COUNT(*) did not return one row");
+    return uint64_t(1);
+  });
+
+  // The same grouping and lookups on a copy hash partitioned by id:
+  // partial aggregates merged, and lookups pruned to one partition
+  {
+    DataStore partitioned(*catalog);
+    partitioned.setThreadPool(&pool);
+    PartitionScheme scheme;
+    std::string error;
+    if (!parsePartitionScheme(info, "hash:id:4", scheme, error) ||
+        !partitioned.partitionTable("employees", scheme, error))
+      fail(error);
+    partitioned.loadFromFiles(loadDir);
+    bench.measure("partitioned_group_by", rows, -1, "rows", [&]() {
+      runSql(catalog, partitioned,
+             "SELECT department, COUNT(*), AVG(salary) FROM employees "
+             "GROUP BY department;");
+      return rows;
+    });
+    bench.measure("partitioned_lookup", rows, -1, "queries", [&]() {
+      if (runSql(catalog, partitioned, lookups[next++ % lookups.size()]) != 1)
+        fail("partitioned lookup did not find its row");
+      return uint64_t(1);
+    });
+  }
+
+  // ORDER BY: a top-K heap for a small LIMIT, a full sort otherwise
+  bench.measure("order_by_limit", rows, -1, "rows", [&]() {
+    runSql(catalog, store,
+           "SELECT id, salary FROM employees ORDER BY salary DESC LIMIT 10;");
+    return rows;
+  });
+  bench.measure("order_by", rows, -1, "rows", [&]() {
+    if (runSql(catalog, store,
+               "SELECT id, salary FROM employees ORDER BY salary, id;") !=
+        rows)
+      fail("ORDER BY did not return every row");
+    return rows;
+  });
+
+  runSql(catalog, store, "CREATE INDEX ON employees USING HASH (id);");
+  runSql(catalog, store, "CREATE INDEX ON employees USING BTREE (salary);");
+  bench.measure("point_lookup_hash", rows, -1, "queries", lookup);
+  rangeScans("range_scan_btree");
+
+  // Statistics, then the same ranges with the access path chosen by cost
+  bench.measure("analyze", rows, -1, "rows", [&]() {
+    runSql(catalog, store, "ANALYZE employees;");
+    return rows;
+  });
+  rangeScans("range_scan_costed");
+
+  // UPDATE and DELETE of the first rows by id
+  const std::vector<double> changes = {0.001, 0.01, 0.1, 1.0};
+  for (double fraction : changes) {
+    std::string sql = "UPDATE employees SET age = 30 WHERE id < " +
+                      generator.cutoff(id, fraction, rows) + ";";
+    bench.measure("update", rows, fraction, "rows",
+                  [&]() { return runSql(catalog, store, sql); });
+  }
+  for (double fraction : changes) {
+    std::string sql = "UPDATE employees SET age = 31, salary = 50000, "
+                      "department = 'QA' WHERE id < " +
+                      generator.cutoff(id, fraction, rows) + ";";
+    bench.measure("update_multi", rows, fraction, "rows",
+                  [&]() { return runSql(catalog, store, sql); });
+  }
+  for (double fraction : changes) {
+    std::string sql = "DELETE FROM employees WHERE id < " +
+                      generator.cutoff(id, fraction, rows) + ";";
+    bench.measure(
+        "delete", rows, fraction, "rows",
+        [&]() { return runSql(catalog, store, sql); },
+        [&]() { store.loadFromFiles(loadDir); });
+  }
+
+  // Many single-row DELETEs (cleanup jobs), each found by the id index
+  std::vector<std::string> deletes;
+  for (const auto &sql : lookups)
+    deletes.push_back("DELETE FROM employees" +
+                      sql.substr(sql.find(" WHERE")));
+  bench.measure(
+      "delete_point", rows, -1, "queries",
+      [&]() {
+        for (const auto &sql : deletes)
+          runSql(catalog, store, sql);
+        return static_cast<uint64_t>(deletes.size());
+      },
+      [&]() { store.loadFromFiles(loadDir); });
+}
+
+// ============================================================================
+// JSON OUTPUT AND BASELINE COMPARISON
+// ============================================================================
+std::string jsonString(const std::string &text) {
+  std::string out = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+bool writeResults(const std::string &path,
+                  const std::vector<BenchResult> &results, unsigned threads) {
+  std::ofstream file(path);
+  if (!file.is_open())
+    return false;
+
+  char created[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(created, sizeof(created), "%Y-%m-%dT%H:%M:%SZ",
+                std::gmtime(&now));
+
+  file << "{\n";
+  file << "  \"format\": 1,\n";
+  file << "  \"created\": " << jsonString(created) << ",\n";
+  file << "  \"compiler\": " << jsonString(__VERSION__) << ",\n";
+  file << "  \"threads\": " << threads << ",\n";
+  file << "  \"simd\": " << jsonString(scanKernels().name) << ",\n";
+  file << "  \"results\": [\n";
+  file << std::fixed << std::setprecision(1);
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult &r = results[i];
+    file << "    {\"name\": " << jsonString(r.name) << ", \"rows\": " << r.rows;
+    if (r.selectivity >= 0)
+      file << ", \"selectivity\": " << std::setprecision(3) << r.selectivity
+           << std::setprecision(1);
+    file << ", \"iterations\": " << r.iterations
+         << ", \"median_ns\": " << r.medianNs << ", \"mean_ns\": " << r.meanNs
+         << ", \"min_ns\": " << r.minNs << ", \"items\": " << r.items
+         << ", \"unit\": " << jsonString(r.unit)
+         << ", \"per_second\": " << r.perSecond() << "}"
+         << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  file << "  ]\n}\n";
+  return static_cast<bool>(file);
+}
+
+// Value of "key": in a one-line result object
+bool jsonField(const std::string &line, const std::string &key,
+               std::string &value) {
+  size_t pos = line.find("\"" + key + "\":");
+  if (pos == std::string::npos)
+    return false;
+  pos = line.find_first_not_of(' ', pos + key.size() + 3);
+  if (pos == std::string::npos)
+    return false;
+  if (line[pos] == '"') {
+    size_t end = line.find('"', pos + 1);
+    value = line.substr(pos + 1, end - pos - 1);
+  } else {
+    size_t end = line.find_first_of(",}", pos);
+    value = line.substr(pos, end - pos);
+  }
+  return true;
+}
+
+// Results of an earlier run, by case key
+bool readBaseline(const std::string &path,
+                  std::map<std::string, BenchResult> &baseline) {
+  std::ifstream file(path);
+  if (!file.is_open())
+    return false;
+
+  std::string line;
+  while (std::getline(file, line)) {
+    BenchResult r;
+    std::string rows, selectivity, median;
+    if (!jsonField(line, "name", r.name) || !jsonField(line, "rows", rows) ||
+        !jsonField(line, "median_ns", median))
+      continue;
+    r.rows = std::stoull(rows);
+    r.selectivity =
+        jsonField(line, "selectivity", selectivity) ? std::stod(selectivity)
+                                                    : -1;
+    r.medianNs = std::stod(median);
+    baseline[r.key()] = r;
+  }
+  return true;
+}
+
+// @return number of regressions
+size_t compareBaseline(const std::vector<BenchResult> &results,
+                       const std::map<std::string, BenchResult> &baseline,
+                       double threshold, std::ostream &report) {
+  size_t regressions = 0;
+  size_t compared = 0;
+  report << "\n--- Comparison with baseline (threshold " << threshold
+         << "%) ---\n";
+  for (const auto &r : results) {
+    auto it = baseline.find(r.key());
+    if (it == baseline.end() || it->second.medianNs <= 0)
+      continue;
+    compared++;
+    double change = (r.medianNs / it->second.medianNs - 1) * 100;
+    if (change <= threshold)
+      continue;
+    regressions++;
+    report << "REGRESSION " << r.name << " rows=" << r.rows;
+    if (r.selectivity >= 0)
+      report << " selectivity=" << r.selectivity;
+    report << std::fixed << std::setprecision(1) << ": "
+           << it->second.medianNs / 1000 << " us -> " << r.medianNs / 1000
+           << " us (+" << change << "%)\n";
+    report.unsetf(std::ios::floatfield);
+  }
+  report << compared << " case(s) compared, " << regressions
+         << " regression(s)\n";
+  return regressions;
+}
+
+// ============================================================================
+// COMMAND LINE
+// ============================================================================
+void printUsage() {
+  std::cout << "Usage: ./sql_bench [options]\n"
+            << "  --rows <n,n,...>   Table sizes (default "
+               "10000,100000,1000000)\n"
+            << "  --output <path>    Results file (default "
+               "bench/results.json)\n"
+            << "  --baseline <path>  Report cases slower than in this file\n"
+            << "  --threshold <pct>  Allowed slowdown (default 10)\n"
+            << "  --time <ms>        Time budget per case (default 300)\n"
+            << "  --statements <n>   Statements in the lexer/parser script "
+               "(default 20000)\n"
+            << "  --threads <n>      Scan threads (default: all cores)\n"
+            << "  --dir <path>       Scratch directory for CSV files\n";
+}
+
+bool parseOptions(int argc, char *argv[], BenchOptions &options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      printUsage();
+      std::exit(0);
+    }
+    if (i + 1 >= argc) {
+      std::cerr << "Missing value for " << arg << "\n";
+      return false;
+    }
+    std::string value = argv[++i];
+    try {
+      if (arg == "--rows") {
+        options.rows.clear();
+        std::stringstream list(value);
+        std::string item;
+        while (std::getline(list, item, ','))
+          options.rows.push_back(static_cast<uint64_t>(std::stod(item)));
+      } else if (arg == "--output") {
+        options.output = value;
+      } else if (arg == "--baseline") {
+        options.baseline = value;
+      } else if (arg == "--threshold") {
+        options.threshold = std::stod(value);
+      } else if (arg == "--time") {
+        options.budgetMs = std::stod(value);
+      } else if (arg == "--statements") {
+        options.statements = std::stoul(value);
+      } else if (arg == "--threads") {
+        options.threads = static_cast<unsigned>(std::stoul(value));
+      } else if (arg == "--dir") {
+        options.dir = value;
+      } else {
+        std::cerr << "Unknown option: " << arg << "\n";
+        return false;
+      }
+    } catch (const std::exception &) {
+      std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+      return false;
+    }
+  }
+  for (uint64_t rows : options.rows) {
+    if (rows == 0) {
+      std::cerr << "Table sizes must be positive\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main(int argc, char *argv[]) {
+  BenchOptions options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage();
+    return 1;
+  }
+  bool scratch = options.dir.empty();
+  if (scratch) {
+    options.dir =
+        (std::filesystem::temp_directory_path() / "minisql-bench").string();
+  }
+
+  // Progress goes to the real stdout; the engine's own messages (load and
+  // save reports) are dropped
+  std::ostream report(std::cout.rdbuf());
+  NullBuffer discard;
+  std::cout.rdbuf(&discard);
+  setDiagnostics(false);
+
+  Catalog catalog = std::make_shared<const SymbolTable>();
+  ThreadPool pool(options.threads);
+
+  report << "Scan threads: " << pool.size() << ", kernels: "
+         << scanKernels().name << "\n\n";
+  Bench bench(options, report);
+  bench.printHeader();
+  benchCompiler(bench, catalog, options);
+  for (uint64_t rows : options.rows)
+    benchTable(bench, catalog, pool, rows, options);
+
+  if (scratch)
+    std::filesystem::remove_all(options.dir);
+
+  if (!writeResults(options.output, bench.getResults(),
+                    static_cast<unsigned>(pool.size()))) {
+    report << "Cannot write " << options.output << "\n";
+    return 1;
+  }
+  report << "\nResults written to " << options.output << "\n";
+
+  int status = 0;
+  if (!options.baseline.empty()) {
+    std::map<std::string, BenchResult> baseline;
+    if (!readBaseline(options.baseline, baseline)) {
+      report << "Cannot read baseline " << options.baseline << "\n";
+      status = 1;
+    } else if (compareBaseline(bench.getResults(), baseline,
+                               options.threshold, report) > 0) {
+      status = 1;
+    }
+  }
+
+  std::cout.rdbuf(report.rdbuf());
+  return status;
+}
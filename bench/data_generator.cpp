@@ -0,0 +1,261 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: data_generator.cpp
+ * Description: Schema-Aware Synthetic Data Implementation
+ */
+
+#include "data_generator.h"
+#include "../include/csv_loader.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace MiniSQL {
+
+namespace {
+
+const std::vector<std::string> FIRST_NAMES = {
+    "Aarav", "Priya",  "Rahul", "Sneha", "Vikram", "Ananya", "Rohan",
+    "Kavya", "Arjun",  "Meera", "Karan", "Divya",  "Nikhil", "Pooja",
+    "Sanjay", "Neha"};
+
+const std::vector<std::string> LAST_NAMES = {
+    "Sharma", "Verma", "Patel", "Reddy", "Nair", "Iyer", "Gupta", "Singh",
+    "Kumar",  "Das",   "Joshi", "Mehta", "Rao", "Shah", "Bose", "Menon"};
+
+const std::vector<std::string> DEPARTMENTS = {
+    "Engineering", "Sales", "Marketing", "HR", "Finance", "Support",
+    "Legal",       "Operations"};
+
+const std::vector<std::string> STATUSES = {"active", "inactive", "pending",
+                                           "banned"};
+
+// SplitMix64 finalizer: a well-mixed 64-bit value per input
+uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+std::string formatCents(int64_t cents) {
+  std::string text = std::to_string(cents / 100) + ".";
+  int64_t fraction = cents % 100;
+  if (fraction < 10)
+    text += '0';
+  return text + std::to_string(fraction);
+}
+
+std::string quote(const std::string &text) { return "'" + text + "'"; }
+
+// Value in [low, high] for a random number
+int64_t uniform(int64_t low, int64_t high, uint64_t random) {
+  return low +
+         static_cast<int64_t>(random % static_cast<uint64_t>(high - low + 1));
+}
+
+} // namespace
+
+DataGenerator::DataGenerator(const TableInfo &info, uint64_t s)
+    : table(info), seed(s) {
+  for (const auto &col : table.columns) {
+    ColumnSpec spec;
+    spec.name = col.name;
+    spec.low = 0;
+    spec.high = 0;
+    if (col.dataType == "INT") {
+      if (col.name == "id") {
+        spec.domain = Domain::SEQUENCE;
+      } else {
+        spec.domain = Domain::INT_RANGE;
+        spec.low = col.name == "age" ? 18 : 0;
+        spec.high = col.name == "age" ? 65 : 9999;
+      }
+    } else if (col.dataType == "FLOAT") {
+      spec.domain = Domain::FLOAT_RANGE;
+      spec.low = 100000;
+      spec.high = 10000000;
+    } else if (col.name == "department") {
+      spec.domain = Domain::CATEGORY;
+      spec.categories = DEPARTMENTS;
+    } else if (col.name == "status") {
+      spec.domain = Domain::CATEGORY;
+      spec.categories = STATUSES;
+    } else if (col.name == "email") {
+      spec.domain = Domain::UNIQUE_TEXT;
+      spec.prefix = "user";
+      spec.suffix = "@example.com";
+    } else if (col.name == "username") {
+      spec.domain = Domain::UNIQUE_TEXT;
+      spec.prefix = "user";
+    } else {
+      spec.domain = Domain::NAME;
+    }
+    specs.push_back(spec);
+  }
+}
+
+uint64_t DataGenerator::draw(uint64_t row, size_t column) const {
+  return mix(mix(seed ^ (row * 0x100000001b3ULL)) + column);
+}
+
+std::string DataGenerator::value(uint64_t row, size_t column) const {
+  const ColumnSpec &spec = specs[column];
+  uint64_t random = draw(row, column);
+  switch (spec.domain) {
+  case Domain::SEQUENCE:
+    return std::to_string(row + 1);
+  case Domain::INT_RANGE:
+    return std::to_string(uniform(spec.low, spec.high, random));
+  case Domain::FLOAT_RANGE:
+    return formatCents(uniform(spec.low, spec.high, random));
+  case Domain::CATEGORY:
+    return spec.categories[random % spec.categories.size()];
+  case Domain::UNIQUE_TEXT:
+    return spec.prefix + std::to_string(row + 1) + spec.suffix;
+  case Domain::NAME:
+    return FIRST_NAMES[random % FIRST_NAMES.size()] + " " +
+           LAST_NAMES[(random >> 32) % LAST_NAMES.size()];
+  }
+  return "";
+}
+
+std::string DataGenerator::literal(uint64_t row, size_t column) const {
+  std::string text = value(row, column);
+  return table.columns[column].dataType == "VARCHAR" ? quote(text) : text;
+}
+
+std::string DataGenerator::cutoff(size_t column, double fraction,
+                                  uint64_t rows) const {
+  const ColumnSpec &spec = specs[column];
+  fraction = std::min(1.0, std::max(0.0, fraction));
+  switch (spec.domain) {
+  case Domain::SEQUENCE:
+    return std::to_string(
+        static_cast<uint64_t>(std::llround(fraction * rows)) + 1);
+  case Domain::INT_RANGE:
+  case Domain::FLOAT_RANGE: {
+    int64_t value =
+        spec.low + std::llround(fraction * (spec.high - spec.low + 1));
+    return spec.domain == Domain::INT_RANGE ? std::to_string(value)
+                                            : formatCents(value);
+  }
+  default:
+    return "0";
+  }
+}
+
+// ============================================================================
+// CSV OUTPUT
+// ============================================================================
+bool DataGenerator::writeCsv(const std::string &path, uint64_t rows,
+                             std::string &error) const {
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    error = "cannot write " + path;
+    return false;
+  }
+
+  std::string buffer;
+  for (size_t c = 0; c < table.columns.size(); c++) {
+    if (c > 0)
+      buffer += ',';
+    appendCsvField(buffer, table.columns[c].name);
+  }
+  buffer += '\n';
+
+  for (uint64_t row = 0; row < rows; row++) {
+    for (size_t c = 0; c < specs.size(); c++) {
+      if (c > 0)
+        buffer += ',';
+      appendCsvField(buffer, value(row, c));
+    }
+    buffer += '\n';
+    if (buffer.size() >= (size_t(1) << 20)) {
+      file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      buffer.clear();
+    }
+  }
+  file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+  if (!file) {
+    error = "write to " + path + " failed";
+    return false;
+  }
+  return true;
+}
+
+// ============================================================================
+// STATEMENT SCRIPTS
+// ============================================================================
+std::vector<std::string> DataGenerator::script(size_t statements,
+                                               uint64_t rows) const {
+  std::vector<size_t> numeric, text;
+  for (size_t c = 0; c < specs.size(); c++) {
+    if (specs[c].domain == Domain::INT_RANGE ||
+        specs[c].domain == Domain::FLOAT_RANGE)
+      numeric.push_back(c);
+    else if (specs[c].domain == Domain::CATEGORY ||
+             specs[c].domain == Domain::NAME)
+      text.push_back(c);
+  }
+  int idCol = columnIndex("id");
+  if (numeric.empty() || text.empty() || idCol < 0 || rows == 0)
+    return {};
+
+  const std::string &name = table.name;
+  const std::string &id = specs[idCol].name;
+  std::vector<std::string> script;
+  script.reserve(statements);
+
+  for (size_t i = 0; i < statements; i++) {
+    uint64_t random = mix(seed + i);
+    uint64_t row = random % rows;
+    size_t numCol = numeric[(random >> 8) % numeric.size()];
+    const std::string &num = specs[numCol].name;
+    size_t textCol = text[(random >> 16) % text.size()];
+    std::string sql;
+
+    switch ((random >> 24) % 6) {
+    case 0:
+      sql = "SELECT * FROM " + name + " WHERE " + id + " = " +
+            literal(row, idCol) + ";";
+      break;
+    case 1:
+      sql = "SELECT " + id + ", " + num + " FROM " + name + " WHERE " + num +
+            " > " + literal(row, numCol) + " AND " + specs[textCol].name +
+            " != " + literal(row + 1, textCol) + ";";
+      break;
+    case 2:
+      sql = "SELECT " + specs[textCol].name + " FROM " + name + " WHERE (" +
+            num + " < " + literal(row, numCol) + " OR " +
+            specs[textCol].name + " = " + literal(row, textCol) + ") AND " +
+            id + " >= " + literal(row / 2, idCol) + ";";
+      break;
+    case 3: {
+      std::string columns, values;
+      for (size_t c = 0; c < specs.size(); c++) {
+        columns += (c ? ", " : "") + specs[c].name;
+        values += (c ? ", " : "") + literal(rows + i, c);
+      }
+      sql = "INSERT INTO " + name + " (" + columns + ") VALUES (" + values +
+            ");";
+      break;
+    }
+    case 4:
+      sql = "UPDATE " + name + " SET " + num + " = " +
+            literal(row + 7, numCol) + " WHERE " + id + " = " +
+            literal(row, idCol) + ";";
+      break;
+    default:
+      sql = "DELETE FROM " + name + " WHERE " + id + " = " +
+            literal(row, idCol) + ";";
+      break;
+    }
+    script.push_back(std::move(sql));
+  }
+  return script;
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,114 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: data_generator.h
+ * Description: Schema-Aware Synthetic Data for the Benchmark Suite
+ *
+ * Generates rows for any table of the SymbolTable from its column
+ * definitions. Every column gets a value domain chosen from its type and
+ * name:
+ *   INT "id"             1, 2, 3, ... (unique, in row order)
+ *   INT "age"            uniform 18 .. 65
+ *   other INT            uniform 0 .. 9999
+ *   FLOAT                uniform 1000.00 .. 100000.00
+ *   VARCHAR department,
+ *           status       a few categories (low cardinality)
+ *   VARCHAR email        user<id>@example.com (unique)
+ *   VARCHAR username     user<id> (unique)
+ *   other VARCHAR        first and last name from a fixed list
+ *
+ * A value is a hash of (seed, row, column), so any row can be produced on
+ * its own and the same seed always yields the same table. Because numeric
+ * domains are uniform, a comparison literal that selects a given fraction
+ * of the rows can be computed (see cutoff), which lets the benchmarks fix
+ * the selectivity of scans, UPDATEs and DELETEs.
+ */
+
+#ifndef DATA_GENERATOR_H
+#define DATA_GENERATOR_H
+
+#include "../include/symbol_table.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+class DataGenerator {
+public:
+  // How the values of a column are drawn
+  enum class Domain {
+    SEQUENCE,    // Row number + 1
+    INT_RANGE,   // Uniform integer in [low, high]
+    FLOAT_RANGE, // Uniform value in [low, high] cents
+    CATEGORY,    // One of a few categories
+    UNIQUE_TEXT, // prefix + id + suffix
+    NAME         // First and last name
+  };
+
+private:
+  struct ColumnSpec {
+    std::string name;
+    Domain domain;
+    int64_t low;  // INT_RANGE / FLOAT_RANGE (FLOAT in cents)
+    int64_t high; // Inclusive
+    std::vector<std::string> categories; // CATEGORY
+    std::string prefix;                  // UNIQUE_TEXT: prefix + id
+    std::string suffix;
+  };
+
+  TableInfo table;
+  std::vector<ColumnSpec> specs;
+  uint64_t seed;
+
+  uint64_t draw(uint64_t row, size_t column) const;
+
+public:
+  explicit DataGenerator(const TableInfo &table, uint64_t seed = 42);
+
+  const TableInfo &getTable() const { return table; }
+
+  /**
+   * Text of a column in a row (rows are numbered from 0), as it would
+   * appear in a query: VARCHAR values quoted
+   */
+  std::string literal(uint64_t row, size_t column) const;
+
+  /**
+   * Text of a column in a row, unquoted
+   */
+  std::string value(uint64_t row, size_t column) const;
+
+  /**
+   * Position of a column, or -1
+   */
+  int columnIndex(const std::string &name) const {
+    return table.columnIndex(name);
+  }
+
+  /**
+   * Literal v such that "column < v" holds for about `fraction` of the
+   * rows (exactly, for SEQUENCE columns); only for numeric domains
+   */
+  std::string cutoff(size_t column, double fraction, uint64_t rows) const;
+
+  /**
+   * Write `rows` rows as a CSV file with a header line, in the format
+   * DataStore::loadFromFiles reads
+   * @return false if the file cannot be written
+   */
+  bool writeCsv(const std::string &path, uint64_t rows,
+                std::string &error) const;
+
+  /**
+   * A script of valid statements against the table: SELECTs (with and
+   * without compound WHERE clauses), INSERTs, UPDATEs and DELETEs, one per
+   * element, each ending in ';'
+   */
+  std::vector<std::string> script(size_t statements, uint64_t rows) const;
+};
+
+} // namespace MiniSQL
+
+#endif // DATA_GENERATOR_H
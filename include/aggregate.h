@@ -0,0 +1,117 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: aggregate.h
+ * Description: Hash Aggregation for GROUP BY and Aggregate Functions
+ *
+ * SELECT department, COUNT(*), AVG(salary) FROM employees
+ *   GROUP BY department;
+ *
+ * The rows to aggregate (those passing the WHERE filter, or the tuples of
+ * a join) are split into one contiguous range per thread of the pool.
+ * Each thread builds a partial aggregate of its range: an open-addressing
+ * hash table from group key to one accumulator per aggregate. The
+ * partials are then merged, in range order, into the first one, so groups
+ * come out in the order their first row appears in the input whatever the
+ * number of threads.
+ *
+ * The growth of every partial is reserved from the statement's memory
+ * account (memory_tracker.h) as it is built; once the memory limits are
+ * reached the aggregation stops and the statement fails.
+ *
+ * NULL keys form a group of their own; NULL values are skipped by every
+ * aggregate but COUNT(*). Without GROUP BY there is exactly one group,
+ * also for an empty input (COUNT = 0, the others NULL).
+ *
+ * The result is a small table of its own (one row per group: the key
+ * columns, then the aggregates), so it is output like any other SELECT.
+ *
+ * A partitioned table (partition.h) is aggregated in two steps: every
+ * partition aggregates its own rows (partialSpecs), and the partial
+ * results are merged by group key (mergePartials).
+ */
+
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include "data_store.h"
+#include "query_plan.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+// A column the aggregation reads: input position i is row rows[i] of
+// `column` (rows == nullptr: row i)
+struct AggregateInput {
+  const Column *column;
+  const RowId *rows;
+  std::string name; // Output column name
+
+  AggregateInput() : column(nullptr), rows(nullptr) {}
+};
+
+// One aggregate function of the SELECT list
+struct AggregateSpec {
+  AggregateFn fn;
+  AggregateInput input; // input.column == nullptr for COUNT(*)
+
+  AggregateSpec() : fn(AggregateFn::COUNT) {}
+};
+
+/**
+ * Type of an aggregate's result column: COUNT is INT, AVG is FLOAT, and
+ * SUM / MIN / MAX keep the type of their column
+ */
+ColumnType aggregateType(const AggregateSpec &spec);
+
+/**
+ * Group input positions 0 .. rows - 1 by their keys and aggregate each
+ * group
+ * @param keys  GROUP BY columns (empty = a single group)
+ * @param specs Aggregates to compute per group
+ * @param pool  Builds the partial aggregates in parallel (nullptr = on
+ *              the calling thread)
+ * @param error Set when the hash tables outgrow the memory limits
+ * @return one row per group: the key columns, then one column per spec
+ *         (nullptr on failure)
+ */
+TableSnapshot aggregateRows(size_t rows,
+                            const std::vector<AggregateInput> &keys,
+                            const std::vector<AggregateSpec> &specs,
+                            ThreadPool *pool, std::string &error);
+
+/**
+ * The aggregates a partition computes so that partials can be merged
+ * (mergePartials): AVG becomes the SUM and COUNT of its column, the
+ * others stay as they are
+ */
+std::vector<AggregateSpec>
+partialSpecs(const std::vector<AggregateSpec> &specs);
+
+/**
+ * Merge the partial aggregates of partitions (aggregateRows with
+ * partialSpecs) into the final one: groups are combined by key, COUNTs
+ * and SUMs summed, MINs and MAXes compared, and AVG divided out of its
+ * summed SUM and COUNT
+ * @param partials At least one, each with keyCount key columns first
+ * @param specs    The aggregates asked for (only fn and input.name are
+ *                 read)
+ * @return one row per group, as aggregateRows returns it (nullptr on
+ *         failure)
+ */
+TableSnapshot mergePartials(const std::vector<TableSnapshot> &partials,
+                            size_t keyCount,
+                            const std::vector<AggregateSpec> &specs,
+                            ThreadPool *pool, std::string &error);
+
+/**
+ * A one-row result of COUNT(*) columns, for a count already known (e.g.
+ * a table's row count)
+ */
+TableSnapshot countResult(size_t count, const std::vector<std::string> &names);
+
+} // namespace MiniSQL
+
+#endif // AGGREGATE_H
@@ -0,0 +1,98 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: binary_io.h
+ * Description: Little-Endian Encoding Helpers for Binary Files
+ *
+ * Shared by the snapshot and write-ahead log formats. Values are written
+ * in host byte order; both formats record a byte-order mark or assume a
+ * little-endian host.
+ */
+
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+template <typename T> void putValue(std::vector<uint8_t> &out, const T &value) {
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(&value);
+  out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+void putArray(std::vector<uint8_t> &out, const std::vector<T> &values) {
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(values.data());
+  out.insert(out.end(), p, p + values.size() * sizeof(T));
+}
+
+// u32 length + bytes
+inline void putString(std::vector<uint8_t> &out, const std::string &text) {
+  putValue(out, static_cast<uint32_t>(text.size()));
+  out.insert(out.end(), text.begin(), text.end());
+}
+
+// ============================================================================
+// BYTE READER - Bounds-checked reads from a byte range
+// ============================================================================
+class ByteReader {
+private:
+  const uint8_t *pos;
+  const uint8_t *end;
+
+public:
+  ByteReader(const uint8_t *begin, const uint8_t *finish)
+      : pos(begin), end(finish) {}
+
+  bool has(size_t bytes) const {
+    return static_cast<size_t>(end - pos) >= bytes;
+  }
+  size_t remaining() const { return static_cast<size_t>(end - pos); }
+  bool atEnd() const { return pos == end; }
+
+  template <typename T> bool get(T &value) {
+    if (!has(sizeof(T)))
+      return false;
+    std::memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+  }
+
+  template <typename T> bool getArray(std::vector<T> &values, size_t count) {
+    if (count > remaining() / sizeof(T))
+      return false;
+    values.resize(count);
+    if (count == 0)
+      return true; // values.data() may be null
+    std::memcpy(values.data(), pos, count * sizeof(T));
+    pos += count * sizeof(T);
+    return true;
+  }
+
+  bool getString(std::string &text) {
+    uint32_t length = 0;
+    if (!get(length) || !has(length))
+      return false;
+    text.assign(reinterpret_cast<const char *>(pos), length);
+    pos += length;
+    return true;
+  }
+
+  // Skip bytes, returning where they start (nullptr if out of range)
+  const uint8_t *take(size_t bytes) {
+    if (!has(bytes))
+      return nullptr;
+    const uint8_t *start = pos;
+    pos += bytes;
+    return start;
+  }
+};
+
+} // namespace MiniSQL
+
+#endif // BINARY_IO_H
@@ -0,0 +1,319 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: column_store.h
+ * Description: Columnar, Typed Storage for Table Data
+ *
+ * Each table column is stored as its own typed vector instead of one
+ * hash map per row:
+ * - INT     -> int64_t values
+ * - FLOAT   -> double values
+ * - VARCHAR -> dictionary codes into an arena-backed string dictionary
+ *
+ * Columns are split into fixed-size chunks of COLUMN_CHUNK_ROWS rows so
+ * that growing a table never moves existing data, and so that scans can
+ * work on one cache-friendly chunk at a time. Every chunk of a VARCHAR
+ * column owns its own dictionary; repeated values such as department
+ * names are stored once per chunk.
+ *
+ * Chunks are copy-on-write: copying a Column shares its chunks, and a
+ * chunk is only duplicated when it is about to be modified while another
+ * copy (e.g. a table version held by a reader, see data_store.h) still
+ * refers to it. Unmodified chunks are shared by every version of a table.
+ */
+
+#ifndef COLUMN_STORE_H
+#define COLUMN_STORE_H
+
+#include "memory_tracker.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MiniSQL {
+
+// Number of rows held by one column chunk (power of two)
+constexpr size_t COLUMN_CHUNK_SHIFT = 13;
+constexpr size_t COLUMN_CHUNK_ROWS = size_t(1) << COLUMN_CHUNK_SHIFT;
+
+// Position of a row within a table
+using RowId = uint32_t;
+
+// Positions of the rows selected from a table, in table order
+using SelectionVector = std::vector<RowId>;
+
+// Physical type of a column, derived from ColumnInfo::dataType
+enum class ColumnType { INT, FLOAT, VARCHAR };
+
+/**
+ * Map a schema data type ("INT", "FLOAT", "VARCHAR") to a ColumnType.
+ * Unknown types are stored as VARCHAR.
+ */
+ColumnType columnTypeFromString(const std::string &dataType);
+
+// A single typed cell value, used when writing into a column
+struct CellValue {
+  bool isNull;
+  int64_t intValue;
+  double floatValue;
+  std::string stringValue;
+
+  CellValue() : isNull(true), intValue(0), floatValue(0.0) {}
+};
+
+/**
+ * Convert the textual form of a value into a typed cell.
+ * @return false if the text is not a valid value of the given type
+ */
+bool parseCellValue(ColumnType type, const std::string &text, CellValue &out);
+
+/**
+ * Format a FLOAT value with the shortest text that reads back exactly
+ */
+std::string formatFloat(double value);
+
+/**
+ * Format a FLOAT value of a query result: 15 significant digits, so the
+ * last-bit error of arithmetic (0.1 + 0.2, an AVG) does not print as 17
+ */
+std::string formatResultFloat(double value);
+
+/**
+ * SplitMix64 finalizer: spreads the bits of a key over all 64 bits of its
+ * hash, so the low bits can pick a hash table slot and the high bits a
+ * radix partition
+ */
+inline uint64_t mixHash(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// ============================================================================
+// STRING DICTIONARY - Arena-backed, deduplicated strings for one chunk
+// ============================================================================
+class StringDictionary {
+private:
+  std::vector<char> bytes;       // All string bytes, back to back
+  std::vector<uint32_t> offsets; // Start of each code in bytes (+ end)
+  std::vector<uint32_t> slots;   // Open-addressing table: code + 1, 0 = empty
+
+  size_t findSlot(std::string_view text) const;
+  void rehash(size_t newCapacity);
+
+public:
+  StringDictionary() : offsets(1, 0) {}
+
+  /**
+   * Return the code for a string, adding it if not yet present
+   */
+  uint32_t intern(std::string_view text);
+
+  /**
+   * Look up a string without inserting it
+   * @return true and set code if the string is in the dictionary
+   */
+  bool find(std::string_view text, uint32_t &code) const;
+
+  /**
+   * Get the string for a code
+   */
+  std::string_view get(uint32_t code) const {
+    return std::string_view(bytes.data() + offsets[code],
+                            offsets[code + 1] - offsets[code]);
+  }
+
+  size_t size() const { return offsets.size() - 1; }
+
+  // Raw storage, for serialization
+  const std::vector<char> &getBytes() const { return bytes; }
+  const std::vector<uint32_t> &getOffsets() const { return offsets; }
+
+  /**
+   * Replace the contents with serialized storage and rebuild the slots
+   * @return false (dictionary unchanged) if the offsets do not describe
+   *         the bytes
+   */
+  bool assign(std::vector<char> &&rawBytes, std::vector<uint32_t> &&rawOffsets);
+
+  /**
+   * Add the heap bytes of this dictionary: its string bytes as strings,
+   * its offsets and slots as maps, spare capacity as reserved
+   */
+  void memoryUsage(MemoryUsage &usage) const;
+};
+
+// ============================================================================
+// COLUMN CHUNK - Up to COLUMN_CHUNK_ROWS values of one column
+// ============================================================================
+struct ColumnChunk {
+  std::vector<int64_t> ints;    // INT values
+  std::vector<double> floats;   // FLOAT values
+  std::vector<uint32_t> codes;  // VARCHAR dictionary codes
+  StringDictionary dict;        // VARCHAR dictionary
+  std::vector<uint8_t> nulls;   // 1 if the row is NULL
+};
+
+// ============================================================================
+// COLUMN - All values of one table column, stored chunk by chunk
+// ============================================================================
+class Column {
+private:
+  ColumnType type;
+  std::vector<std::shared_ptr<ColumnChunk>> chunks; // Shared with copies
+  size_t rowCount;
+
+  // Chunk to modify: duplicated first if another copy still shares it
+  ColumnChunk &writableChunk(size_t index);
+
+  ColumnChunk &chunkFor(size_t row) {
+    return writableChunk(row >> COLUMN_CHUNK_SHIFT);
+  }
+  const ColumnChunk &chunkFor(size_t row) const {
+    return *chunks[row >> COLUMN_CHUNK_SHIFT];
+  }
+  static size_t offsetOf(size_t row) {
+    return row & (COLUMN_CHUNK_ROWS - 1);
+  }
+
+public:
+  explicit Column(ColumnType t = ColumnType::VARCHAR)
+      : type(t), rowCount(0) {}
+
+  ColumnType getType() const { return type; }
+  size_t size() const { return rowCount; }
+
+  // Chunk access for scan kernels; chunk i holds rows
+  // [i * COLUMN_CHUNK_ROWS, i * COLUMN_CHUNK_ROWS + chunk.nulls.size())
+  size_t chunkCount() const { return chunks.size(); }
+  const ColumnChunk &getChunk(size_t index) const { return *chunks[index]; }
+
+  /**
+   * Append a value (must already match the column type)
+   */
+  void append(const CellValue &value);
+
+  /**
+   * Append a chunk built elsewhere (e.g. by a parallel loader). When the
+   * column ends on a chunk boundary the chunk is moved in as is;
+   * otherwise its values are appended one by one.
+   */
+  void appendChunk(ColumnChunk &&chunk);
+
+  /**
+   * Append all rows of another column of the same type, which is left
+   * empty. While this column ends on a chunk boundary, the other's chunks
+   * are taken over without copying.
+   */
+  void appendColumn(Column &&other);
+
+  /**
+   * Overwrite the value of an existing row
+   */
+  void set(size_t row, const CellValue &value);
+
+  /**
+   * Keep only the rows whose keep[row] is non-zero, preserving order
+   */
+  void compact(const std::vector<uint8_t> &keep);
+
+  /**
+   * Remove all rows
+   */
+  void clear();
+
+  // Typed accessors (row must be in range)
+  bool isNull(size_t row) const { return chunkFor(row).nulls[offsetOf(row)]; }
+  int64_t getInt(size_t row) const { return chunkFor(row).ints[offsetOf(row)]; }
+  double getFloat(size_t row) const {
+    return chunkFor(row).floats[offsetOf(row)];
+  }
+  std::string_view getString(size_t row) const {
+    const ColumnChunk &chunk = chunkFor(row);
+    return chunk.dict.get(chunk.codes[offsetOf(row)]);
+  }
+
+  /**
+   * Get the value of a row as display text ("NULL" for NULL cells)
+   */
+  std::string getText(size_t row) const;
+
+  /**
+   * Get the value of a row as a typed cell, e.g. to append it elsewhere
+   */
+  CellValue getCell(size_t row) const;
+
+  /**
+   * Add the approximate heap bytes of this column (shared chunks
+   * included): values, codes and NULL flags as values, dictionaries as
+   * strings and maps, the unfilled rest of its chunks as reserved
+   */
+  void memoryUsage(MemoryUsage &usage) const;
+};
+
+// ============================================================================
+// DELETE BITMAP - Tombstones of deleted rows, one bit per row
+// ============================================================================
+// A deleted row keeps its position until the table is compacted, so a
+// DELETE touches only the rows it removes. Bits are kept per chunk of
+// COLUMN_CHUNK_ROWS rows, allocated on the first deletion in the chunk
+// and, like column chunks, shared with copies until modified.
+class DeleteBitmap {
+private:
+  static constexpr size_t WORDS_PER_CHUNK = COLUMN_CHUNK_ROWS / 64;
+
+  std::vector<std::shared_ptr<std::vector<uint64_t>>> chunks; // nullptr =
+                                                              // none deleted
+  size_t count;
+
+public:
+  DeleteBitmap() : count(0) {}
+
+  // Number of deleted rows
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  bool contains(size_t row) const {
+    size_t chunk = row >> COLUMN_CHUNK_SHIFT;
+    if (chunk >= chunks.size() || !chunks[chunk])
+      return false;
+    size_t bit = row & (COLUMN_CHUNK_ROWS - 1);
+    return ((*chunks[chunk])[bit >> 6] >> (bit & 63)) & 1;
+  }
+
+  /**
+   * Mark a row deleted
+   * @return false if it already was
+   */
+  bool insert(size_t row);
+
+  /**
+   * Clear the flags of the deleted rows among the `count` rows of a chunk
+   */
+  void mask(size_t chunk, size_t count, uint8_t *flags) const;
+
+  /**
+   * Whether any row of a chunk is deleted
+   */
+  bool anyIn(size_t chunk) const {
+    return chunk < chunks.size() && chunks[chunk];
+  }
+
+  void clear() {
+    chunks.clear();
+    count = 0;
+  }
+
+  /**
+   * Add the heap bytes of the bits (as values)
+   */
+  void memoryUsage(MemoryUsage &usage) const;
+};
+
+} // namespace MiniSQL
+
+#endif // COLUMN_STORE_H
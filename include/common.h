@@ -13,6 +13,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace MiniSQL {
@@ -35,9 +36,19 @@ enum class TokenType {
   KEYWORD_DELETE,
   KEYWORD_CREATE,
   KEYWORD_TABLE,
+  KEYWORD_INDEX,
+  KEYWORD_ON,
+  KEYWORD_USING,
+  KEYWORD_EXPLAIN,
+  KEYWORD_COPY,
+  KEYWORD_JOIN,
+  KEYWORD_GROUP,
+  KEYWORD_BY,
+  KEYWORD_ORDER,
+  KEYWORD_LIMIT,
 
   // Identifiers and Literals
-  IDENTIFIER,     // Table names, column names
+  IDENTIFIER,     // Table names, column names (optionally table.column)
   NUMBER,         // Numeric constants (e.g., 25, 100.5)
   STRING_LITERAL, // String constants (e.g., 'John')
 
@@ -88,6 +99,26 @@ inline std::string tokenTypeToString(TokenType type) {
     return "KEYWORD_CREATE";
   case TokenType::KEYWORD_TABLE:
     return "KEYWORD_TABLE";
+  case TokenType::KEYWORD_INDEX:
+    return "KEYWORD_INDEX";
+  case TokenType::KEYWORD_ON:
+    return "KEYWORD_ON";
+  case TokenType::KEYWORD_USING:
+    return "KEYWORD_USING";
+  case TokenType::KEYWORD_EXPLAIN:
+    return "KEYWORD_EXPLAIN";
+  case TokenType::KEYWORD_COPY:
+    return "KEYWORD_COPY";
+  case TokenType::KEYWORD_JOIN:
+    return "KEYWORD_JOIN";
+  case TokenType::KEYWORD_GROUP:
+    return "KEYWORD_GROUP";
+  case TokenType::KEYWORD_BY:
+    return "KEYWORD_BY";
+  case TokenType::KEYWORD_ORDER:
+    return "KEYWORD_ORDER";
+  case TokenType::KEYWORD_LIMIT:
+    return "KEYWORD_LIMIT";
   case TokenType::IDENTIFIER:
     return "IDENTIFIER";
   case TokenType::NUMBER:
@@ -128,18 +159,22 @@ inline std::string tokenTypeToString(TokenType type) {
 // ============================================================================
 // TOKEN STRUCTURE - Represents a single token
 // ============================================================================
+// The value is a view: into the query text (identifiers, numbers, string
+// contents without the quotes, operators) or into the lexer's static
+// keyword table (keywords, in upper case). Tokens must not outlive the
+// query string they were scanned from.
 struct Token {
   TokenType type;
-  std::string value; // The actual text of the token
-  int line;          // Line number (1-indexed)
-  int column;        // Column number (1-indexed)
+  std::string_view value; // The actual text of the token
+  int line;               // Line number (1-indexed)
+  int column;             // Column number (1-indexed)
 
-  Token(TokenType t, const std::string &v, int l, int c)
+  Token(TokenType t, std::string_view v, int l, int c)
       : type(t), value(v), line(l), column(c) {}
 
   // Display token information
   std::string toString() const {
-    return "<" + tokenTypeToString(type) + ", \"" + value +
+    return "<" + tokenTypeToString(type) + ", \"" + std::string(value) +
            "\", Line:" + std::to_string(line) +
            ", Col:" + std::to_string(column) + ">";
   }
@@ -197,6 +232,8 @@ enum class NodeType {
   TABLE_NAME,
   WHERE_CLAUSE,
   CONDITION,
+  AND_EXPR, // Conjunction of conditions / nested expressions
+  OR_EXPR,  // Disjunction of conditions / nested expressions
   OPERATOR,
   VALUE,
   INSERT_QUERY,
@@ -204,7 +241,22 @@ enum class NodeType {
   DELETE_QUERY,
   VALUE_LIST,
   ASSIGNMENT,
-  SET_CLAUSE
+  SET_CLAUSE,
+  CREATE_INDEX_QUERY,
+  INDEX_NAME,
+  INDEX_METHOD,
+  EXPLAIN_QUERY, // EXPLAIN [ANALYZE] <statement>; value "ANALYZE" or empty
+  COPY_QUERY,    // COPY <table> FROM '<path>'
+  JOIN_CLAUSE,   // JOIN <table> ON <condition>, inside FROM_CLAUSE
+  AGGREGATE,     // COUNT/SUM/AVG/MIN/MAX; child is its COLUMN ("*" = rows)
+  GROUP_BY_CLAUSE, // GROUP BY <column> {, <column>}
+  ORDER_BY_CLAUSE, // ORDER BY <sort_key> {, <sort_key>}
+  SORT_KEY,        // Value "ASC" or "DESC"; child is a COLUMN or AGGREGATE
+  LIMIT_CLAUSE,    // LIMIT <number>; child is its VALUE
+  ANALYZE_QUERY,   // ANALYZE <table>
+  SHOW_QUERY,      // SHOW MEMORY; value "MEMORY"
+  PARTITION_QUERY  // ALTER TABLE <table> PARTITION BY ...; value "HASH" or
+                   // "RANGE"
 };
 
 inline std::string nodeTypeToString(NodeType type) {
@@ -225,6 +277,10 @@ inline std::string nodeTypeToString(NodeType type) {
     return "WHERE_CLAUSE";
   case NodeType::CONDITION:
     return "CONDITION";
+  case NodeType::AND_EXPR:
+    return "AND_EXPR";
+  case NodeType::OR_EXPR:
+    return "OR_EXPR";
   case NodeType::OPERATOR:
     return "OPERATOR";
   case NodeType::VALUE:
@@ -241,24 +297,93 @@ inline std::string nodeTypeToString(NodeType type) {
     return "ASSIGNMENT";
   case NodeType::SET_CLAUSE:
     return "SET_CLAUSE";
+  case NodeType::CREATE_INDEX_QUERY:
+    return "CREATE_INDEX_QUERY";
+  case NodeType::INDEX_NAME:
+    return "INDEX_NAME";
+  case NodeType::INDEX_METHOD:
+    return "INDEX_METHOD";
+  case NodeType::EXPLAIN_QUERY:
+    return "EXPLAIN_QUERY";
+  case NodeType::COPY_QUERY:
+    return "COPY_QUERY";
+  case NodeType::JOIN_CLAUSE:
+    return "JOIN_CLAUSE";
+  case NodeType::AGGREGATE:
+    return "AGGREGATE";
+  case NodeType::GROUP_BY_CLAUSE:
+    return "GROUP_BY_CLAUSE";
+  case NodeType::ORDER_BY_CLAUSE:
+    return "ORDER_BY_CLAUSE";
+  case NodeType::SORT_KEY:
+    return "SORT_KEY";
+  case NodeType::LIMIT_CLAUSE:
+    return "LIMIT_CLAUSE";
+  case NodeType::ANALYZE_QUERY:
+    return "ANALYZE_QUERY";
+  case NodeType::SHOW_QUERY:
+    return "SHOW_QUERY";
+  case NodeType::PARTITION_QUERY:
+    return "PARTITION_QUERY";
   default:
     return "UNKNOWN_NODE";
   }
 }
 
+// ============================================================================
+// PARSE TREE NODE - Allocated in the query's ParseArena (parse_arena.h)
+// ============================================================================
+struct ParseTreeNode;
+
+// Children of a node, linked through ParseTreeNode::nextSibling
+struct ParseTreeChildren {
+  ParseTreeNode *first;
+  ParseTreeNode *last;
+
+  class iterator {
+  private:
+    ParseTreeNode *node;
+
+  public:
+    explicit iterator(ParseTreeNode *n) : node(n) {}
+    ParseTreeNode *operator*() const { return node; }
+    iterator &operator++();
+    bool operator!=(const iterator &other) const { return node != other.node; }
+  };
+
+  iterator begin() const { return iterator(first); }
+  iterator end() const { return iterator(nullptr); }
+  bool empty() const { return first == nullptr; }
+};
+
 struct ParseTreeNode {
   NodeType type;
-  std::string value;
-  std::vector<std::shared_ptr<ParseTreeNode>> children;
+  int literalIndex;       // For VALUE nodes from a literal: its position
+                          // among the query's literals (0-based), else -1
+  std::string_view value; // Token text, owned by the arena
+  ParseTreeChildren children;
+  ParseTreeNode *nextSibling;
 
-  ParseTreeNode(NodeType t, const std::string &v = "") : type(t), value(v) {}
+  ParseTreeNode(NodeType t, std::string_view v = {})
+      : type(t), literalIndex(-1), value(v), children{nullptr, nullptr},
+        nextSibling(nullptr) {}
 
-  void addChild(std::shared_ptr<ParseTreeNode> child) {
-    children.push_back(child);
+  void addChild(ParseTreeNode *child) {
+    if (children.last)
+      children.last->nextSibling = child;
+    else
+      children.first = child;
+    children.last = child;
   }
 };
 
-using ParseTree = std::shared_ptr<ParseTreeNode>;
+inline ParseTreeChildren::iterator &ParseTreeChildren::iterator::operator++() {
+  node = node->nextSibling;
+  return *this;
+}
+
+// A parse tree is owned by its arena; nodes are never freed one by one
+using ParseTree = ParseTreeNode *;
 
 } // namespace MiniSQL
 
@@ -0,0 +1,90 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: compiled_filter.h
+ * Description: Compiled WHERE Filters for Hot Cached Plans
+ *
+ * The interpreter (filter.h) evaluates a filter one operand at a time:
+ * every operand writes a match flag per row of the chunk, the flags are
+ * combined, deleted rows are masked out, and a last pass collects the
+ * positions of the rows left, with a branch per row.
+ *
+ * A plan executed often from the plan cache (plan_cache.h) has its
+ * filter compiled instead, when it is one comparison or an AND of
+ * comparisons. Each comparison becomes a stage: a loop template
+ * instantiated for its (comparison mode x operator), picked when the
+ * plan is bound, so nothing is dispatched per row:
+ * - The first stage scans the chunk and writes the positions of the rows
+ *   it keeps directly: every position is written, and the output length
+ *   advances by the result of the comparison, so there is no branch
+ * - Every further stage tests only the positions kept so far and
+ *   compacts them in place the same way
+ * - Positions of deleted rows are dropped last, in chunks that have any
+ *
+ * Stages run in the interpreter's evaluation order (cheapest per
+ * rejected row first). Filters with an OR, or comparing a numeric column
+ * with text, are not compiled; they keep running in the interpreter.
+ */
+
+#ifndef COMPILED_FILTER_H
+#define COMPILED_FILTER_H
+
+#include "column_store.h"
+#include "predicate.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+struct BoundFilter;
+
+class CompiledFilter {
+public:
+  // First stage: write the positions of the rows among the first `count`
+  // rows of a chunk (the first of them at position `base`) that satisfy
+  // the predicate to out
+  // @return number of positions written
+  using SelectFn = size_t (*)(const BoundPredicate &pred,
+                              const ColumnChunk &chunk, size_t count,
+                              RowId base, RowId *out);
+
+  // Later stage: keep, in order, the positions among rows[0 .. n - 1]
+  // whose row satisfies the predicate
+  // @return number of positions kept
+  using RefineFn = size_t (*)(const BoundPredicate &pred,
+                              const ColumnChunk &chunk, RowId base,
+                              RowId *rows, size_t n);
+
+private:
+  struct Stage {
+    BoundPredicate predicate;
+    SelectFn select;
+    RefineFn refine;
+  };
+
+  std::vector<Stage> stages; // In evaluation order
+
+public:
+  /**
+   * Compile a bound filter
+   * @return nullptr if the filter cannot be compiled (it is interpreted)
+   */
+  static std::shared_ptr<const CompiledFilter>
+  compile(const BoundFilter &filter);
+
+  /**
+   * Append the positions of the rows among the first `count` rows of one
+   * chunk that satisfy the filter and are not deleted, in table order
+   */
+  void selectChunk(const std::vector<Column> &columns,
+                   const DeleteBitmap &deleted, size_t chunkIndex,
+                   size_t count, SelectionVector &out) const;
+
+  size_t stageCount() const { return stages.size(); }
+};
+
+} // namespace MiniSQL
+
+#endif // COMPILED_FILTER_H
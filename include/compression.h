@@ -0,0 +1,48 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: compression.h
+ * Description: LZ77 Block Compression and Checksums for Snapshots
+ *
+ * A small, dependency-free byte-oriented LZ77 codec in the style of LZ4:
+ * a block is a sequence of (literal run, back-reference) pairs, found
+ * with a hash table of 4-byte prefixes. It trades ratio for speed, which
+ * suits column data with repeated values and small integers.
+ *
+ * Sequence layout:
+ *   token        high nibble: literal length, low nibble: match length - 4
+ *                (15 = more length bytes follow, each adding 0-255)
+ *   literals     literal length bytes
+ *   offset       2 bytes, little-endian, distance back to the match
+ *                (absent in the final sequence, which has only literals)
+ */
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MiniSQL {
+
+/**
+ * Compress a block; out is replaced with the compressed bytes
+ */
+void lzCompress(const uint8_t *in, size_t size, std::vector<uint8_t> &out);
+
+/**
+ * Decompress a block into exactly outSize bytes
+ * @return false if the input is corrupt or does not fill outSize bytes
+ */
+bool lzDecompress(const uint8_t *in, size_t size, uint8_t *out,
+                  size_t outSize);
+
+/**
+ * 64-bit checksum of a byte range (processes 8 bytes per step)
+ */
+uint64_t checksum64(const uint8_t *data, size_t size);
+
+} // namespace MiniSQL
+
+#endif // COMPRESSION_H
@@ -0,0 +1,136 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: csv_loader.h
+ * Description: Parallel CSV Loader for Table Storage
+ *
+ * Loads a CSV file (header line + one record per line) straight into
+ * the typed columns of a table:
+ *
+ * 1. The file is memory-mapped; no per-line strings are read.
+ * 2. The body is cut into one byte range per thread. A parallel count of
+ *    '"' characters tells every range whether it starts inside a quoted
+ *    field, so each range can find its first record boundary on its own.
+ * 3. Records are counted per range and cut into segments of exactly
+ *    COLUMN_CHUNK_ROWS records, so every segment becomes one column chunk.
+ * 4. Threads parse segments in place (fields are string_views into the
+ *    mapping) into private chunks, which are then moved into the table
+ *    in file order.
+ *
+ * Fields follow RFC 4180: a field may be enclosed in double quotes, and
+ * a quoted field may contain commas, line breaks and "" (a literal
+ * quote). Unquoted fields are trimmed of spaces and tabs. An empty
+ * unquoted field is NULL; a quoted empty field ("") is an empty string.
+ * Records with the wrong number of fields, or with a value that does not
+ * match its column type, are skipped. Header columns that are not part
+ * of the schema are ignored (and listed in CsvLoadStats, for COPY to
+ * reject the file); schema columns missing from the header are NULL.
+ *
+ * Lazy loading (CsvColumnSource) runs steps 1-3 only, checks every record
+ * without storing it, and keeps the file mapped: one column is parsed
+ * later, segment by segment in parallel, when a query first needs it.
+ */
+
+#ifndef CSV_LOADER_H
+#define CSV_LOADER_H
+
+#include "data_store.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+struct CsvLoadStats {
+  size_t rows;      // Records loaded
+  size_t skipped;   // Malformed records skipped
+  unsigned threads; // Threads used
+  std::vector<std::string> ignoredColumns; // Header fields the table does
+                                           // not have
+
+  CsvLoadStats() : rows(0), skipped(0), threads(1) {}
+};
+
+/**
+ * Replace the rows of a table with the contents of a CSV file.
+ * Indexes are not touched; the caller rebuilds them.
+ * @param threads Number of threads (0 = one per hardware thread)
+ * @return false (table unchanged) if the file cannot be opened or has no
+ *         header line
+ */
+bool loadCsvFile(const std::string &path, TableData &table,
+                 CsvLoadStats &stats, std::string &error,
+                 unsigned threads = 0);
+
+// How the header fields of a CSV file map onto a table's columns
+struct CsvLayout {
+  std::vector<ColumnType> types; // Per table column
+  std::vector<int> headerColumn; // Per header field: column or -1
+};
+
+class MappedFile;
+
+/**
+ * A CSV file indexed for lazy loading (DataStore::setLazyLoading). Only
+ * the byte range of every segment of COLUMN_CHUNK_ROWS records is kept,
+ * with the malformed records in it, and the file stays mapped until the
+ * source is released. A loaded column holds the same rows loadCsvFile
+ * would have loaded. The file must not be modified in place meanwhile
+ * (DataStore::saveToFiles replaces it instead).
+ */
+class CsvColumnSource {
+private:
+  struct SourceSegment {
+    const char *begin;
+    const char *end;
+    size_t rows = 0;
+    std::vector<uint32_t> skipped; // Malformed records, by their number
+                                   // in the segment (blank lines aside)
+  };
+
+  std::string path;
+  std::unique_ptr<MappedFile> file;
+  CsvLayout layout;
+  std::vector<SourceSegment> segments;
+  size_t rowCount;
+
+  explicit CsvColumnSource(const std::string &path);
+
+public:
+  ~CsvColumnSource();
+
+  CsvColumnSource(const CsvColumnSource &) = delete;
+  CsvColumnSource &operator=(const CsvColumnSource &) = delete;
+
+  /**
+   * Map and index a CSV file for the columns of a table
+   * @param stats   Set to the rows the table will have, and the
+   *                malformed records skipped
+   * @param threads Number of threads (0 = one per hardware thread)
+   * @return nullptr if the file cannot be opened or has no header line
+   */
+  static std::shared_ptr<const CsvColumnSource>
+  open(const std::string &path, const TableData &table, CsvLoadStats &stats,
+       std::string &error, unsigned threads = 0);
+
+  /**
+   * Parse one column of the table (by schema position) from the file
+   * @param out Replaced by the column's rows
+   */
+  void loadColumn(size_t column, Column &out, unsigned threads = 0) const;
+
+  size_t rows() const { return rowCount; }
+  const std::string &getPath() const { return path; }
+};
+
+/**
+ * Append a field to a CSV line, quoting it when needed so that
+ * loadCsvFile reads back the same text
+ */
+void appendCsvField(std::string &line, const std::string &text);
+
+} // namespace MiniSQL
+
+#endif // CSV_LOADER_H
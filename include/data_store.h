@@ -5,35 +5,244 @@
  * Description: In-Memory Data Storage with CSV Persistence
  *
  * Provides actual data storage for the SQL engine.
- * Tables are stored as vectors of row maps, with CSV file I/O.
+ * Tables are stored column by column in typed vectors (see column_store.h),
+ * with CSV file I/O.
+ *
+ * Concurrency (multi-version): every table is an immutable version that
+ * readers take hold of with snapshot(). Writers never modify a version a
+ * reader holds; they copy it, sharing all column chunks, and modify the
+ * copy, whose touched chunks are then duplicated on write. The copy is
+ * published as the newest version, so:
+ * - A reader sees one consistent state of the table for as long as it
+ *   keeps its snapshot, and reads it without any lock
+ * - Writers are serialized among themselves and never wait for readers
+ * - When no reader holds the newest version, it is modified in place
+ * A superseded version, and every chunk only it referred to, is freed as
+ * soon as the last snapshot of it is released.
+ *
+ * Secondary indexes always describe the newest version. They are shared
+ * by all versions and only used through the DataStore, which probes them
+ * while taking the snapshot the result is read from.
+ *
+ * DELETE marks the matching rows in the table's tombstone bitmap, so it
+ * costs time in proportion to the rows it removes, and rows keep their
+ * positions. Every reader skips marked rows. Once the marked rows reach
+ * a share of the table (setCompactRatio), a background thread compacts
+ * the table into a new version without them.
+ *
+ * Next to its schema, every table keeps the statistics of its last
+ * ANALYZE (statistics.h). The access path of a WHERE filter is chosen by
+ * estimated cost (chooseAccess): with statistics, an index lookup is used
+ * only when it reads fewer rows than a scan would cost, and a large scan
+ * runs in parallel on the thread pool.
+ *
+ * Lazy loading (setLazyLoading): loadFromFiles only indexes each CSV file
+ * (csv_loader.h), and a table's columns stay empty until a statement
+ * reads them. loadColumns parses the missing ones into a new version and
+ * keeps them resident while the statement runs; once the resident
+ * columns of lazy tables exceed their budget (setColumnCacheMemory), the
+ * least recently used ones are dropped again, to be parsed anew when
+ * next needed. Indexed columns always stay resident. The first change to
+ * a lazy table loads all its columns, and it is an ordinary table from
+ * then on.
+ *
+ * Partitioning (partitionTable, partition.h): a partitioned table holds
+ * no rows itself. They live in its partitions, which are tables of their
+ * own and are versioned, indexed, analyzed, logged and checkpointed one
+ * by one. Writes to the table route every row to its partition, or apply
+ * to each partition the filter may match; all partitions a statement
+ * changes are published together, and readers take every partition of
+ * one state together (partitionSnapshots, openPartitionCursors). A
+ * snapshot of the table as a whole gathers the rows of its partitions
+ * into a copy, e.g. for a join.
  */
 
 #ifndef DATA_STORE_H
 #define DATA_STORE_H
 
+#include "column_store.h"
+#include "filter.h"
+#include "index.h"
+#include "partition.h"
+#include "predicate.h"
+#include "statistics.h"
 #include "symbol_table.h"
+#include "thread_pool.h"
+#include "wal.h"
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace MiniSQL {
 
-// A single row: column_name -> value (all stored as strings)
-using Row = std::unordered_map<std::string, std::string>;
+class CsvColumnSource;
 
-// A table's data: schema info + rows
+// A table's data: schema info + one typed column per schema column
 struct TableData {
   TableInfo schema;
-  std::vector<Row> rows;
+  std::vector<Column> columns; // Same order as schema.columns
+  size_t rowCount;             // Rows stored, deleted ones included
+  DeleteBitmap deleted;        // Rows deleted but not yet compacted away
+  std::vector<std::shared_ptr<TableIndex>> indexes; // Secondary indexes
+  uint64_t logSequence; // LSN of the last log record applied (wal.h)
+
+  // Lazily loaded table: the file its columns are parsed from, and which
+  // of them are resident (the others are empty); nullptr once every
+  // column is
+  std::shared_ptr<const CsvColumnSource> source;
+  std::vector<uint8_t> resident; // Per column, while source is set
+
+  TableData() : rowCount(0), logSequence(0) {}
+  TableData(const TableInfo &info)
+      : schema(info), rowCount(0), logSequence(0) {
+    for (const auto &col : info.columns) {
+      columns.emplace_back(columnTypeFromString(col.dataType));
+    }
+  }
+
+  // Rows not deleted
+  size_t liveRows() const { return rowCount - deleted.size(); }
+
+  // Whether a column holds its rows (not left to lazy loading)
+  bool isResident(size_t column) const {
+    return !source || resident[column];
+  }
+
+  /**
+   * Get the position of a column in the schema
+   * @return column index, or -1 if the column does not exist
+   */
+  int columnIndex(const std::string &name) const {
+    return schema.columnIndex(name);
+  }
+};
+
+// A read-only version of a table, valid for as long as it is held
+using TableSnapshot = std::shared_ptr<const TableData>;
+
+// Memory held by a table's newest version (SHOW MEMORY)
+struct TableMemory {
+  std::string table;
+  MemoryUsage data; // Columns and deleted-row bitmap
+  std::vector<std::pair<std::string, MemoryUsage>> indexes; // By name
+};
+
+class RowCursor;
+class DataStore;
+
+// Columns of lazily loaded tables that a statement keeps resident while
+// it runs (DataStore::loadColumns); released on destruction
+class ColumnLease {
+private:
+  friend class DataStore;
+  DataStore *store;
+  std::vector<uint64_t> columns; // Cache entries pinned
+
+public:
+  ColumnLease() : store(nullptr) {}
+  ~ColumnLease();
+
+  ColumnLease(const ColumnLease &) = delete;
+  ColumnLease &operator=(const ColumnLease &) = delete;
+};
+
+// Default memory budget of a sort (DataStore::setSortMemory)
+const size_t DEFAULT_SORT_MEMORY = size_t(256) << 20;
+
+// Default share of deleted rows at which a table is compacted
+// (DataStore::setCompactRatio)
+const double DEFAULT_COMPACT_RATIO = 0.25;
+
+// Fewest deleted rows that are worth compacting a table for
+const size_t COMPACT_MIN_ROWS = 1024;
+
+// Access path costs, in rows read by a sequential scan: an index lookup
+// pays INDEX_PROBE_COST, then INDEX_ROW_COST per candidate row (a random
+// read, the remaining conditions, the sort into table order), against
+// chunk kernels that test a row in about a nanosecond; a parallel scan
+// pays PARALLEL_SCAN_COST to hand its morsels to the pool
+const double INDEX_PROBE_COST = 16.0;
+const double INDEX_ROW_COST = 64.0;
+const double PARALLEL_SCAN_COST = double(COLUMN_CHUNK_ROWS);
 
-  TableData() = default;
-  TableData(const TableInfo &info) : schema(info) {}
+// How the rows matching a WHERE filter are found (DataStore::chooseAccess)
+struct AccessPlan {
+  const TableIndex *index; // Supplies candidate rows (nullptr = scan)
+  bool parallel;           // Scan: morsels run on the thread pool
+  bool costBased; // Index chosen by estimated cost (table analyzed), not
+                  // by rule (an index whenever one applies)
+  double rows;    // Estimated matching rows
+  double cost;    // Estimated cost, in rows scanned
+
+  AccessPlan()
+      : index(nullptr), parallel(false), costBased(false), rows(0.0),
+        cost(0.0) {}
 };
 
 class DataStore {
 private:
-  std::unordered_map<std::string, TableData> tables;
+  friend class ColumnLease;
+
+  // A table's schema and newest version
+  struct TableSlot {
+    TableInfo schema;
+    std::shared_ptr<TableData> current;
+    std::shared_ptr<const TableStats> stats; // Last ANALYZE (nullptr =
+                                             // never analyzed)
+
+    // Partitioned table: how its rows are split, and its partitions in
+    // order (current stays empty)
+    std::shared_ptr<const PartitionScheme> partitioning;
+    std::vector<TableSlot *> partitions;
+    bool isPartition = false; // A partition of another table
+  };
+
+  std::unordered_map<std::string, TableSlot> tables; // Tables (and
+                                                     // partitions)
+  bool tablesFixed; // Set by fixTables: partitionTable fails from then on
+  mutable std::shared_mutex versionMutex; // Guards TableSlot::current,
+                                          // TableSlot::stats and the
+                                          // indexes
+  mutable std::mutex writeMutex;          // Serializes writers
   std::string dataDir; // Directory for CSV persistence
+  WriteAheadLog *log;  // Receives every change (nullptr = not logged)
+  ThreadPool *pool;    // Runs scans in parallel (nullptr = serial)
+  size_t sortMemory;   // Bytes an ORDER BY sorts in memory (sort.h)
+  double compactRatio; // Share of deleted rows that triggers compaction
+
+  // Background compaction: tables queued by DELETE, compacted by a thread
+  // started on the first request
+  std::thread compactor;
+  std::mutex compactMutex; // Guards the queue and compactStopping
+  std::mutex compactingMutex; // Held while the compactor compacts a table,
+                              // and while partitionTable adds tables
+  std::condition_variable compactRequested;
+  std::vector<std::string> compactQueue;
+  bool compactStopping;
+
+  // Lazy loading: the resident columns of lazily loaded tables, least
+  // recently used first
+  struct CachedColumn {
+    uint64_t id;
+    std::string table;
+    size_t column;
+    size_t bytes;
+    size_t pins; // Leases holding the column
+  };
+  bool lazyLoading;         // loadFromFiles indexes files only
+  size_t columnCacheMemory; // Budget of the resident columns (0 = none)
+  std::mutex cacheMutex;    // Guards the three below
+  std::list<CachedColumn> cachedColumns;
+  size_t cachedBytes;
+  uint64_t nextCachedId;
 
 public:
   /**
@@ -41,6 +250,14 @@ public:
    */
   DataStore(const SymbolTable &symbolTable);
 
+  /**
+   * Stops the background compactor; queued compactions are dropped
+   */
+  ~DataStore();
+
+  DataStore(const DataStore &) = delete;
+  DataStore &operator=(const DataStore &) = delete;
+
   /**
    * Insert a row into a table
    * @return true on success
@@ -50,32 +267,146 @@ public:
                  const std::vector<std::string> &values);
 
   /**
-   * Get all rows from a table
+   * Insert rows into a table. `values` holds the rows one after another,
+   * one value per listed column each; unlisted columns are NULL. The
+   * column mapping is resolved once and every value is checked before the
+   * table is touched, so a bad value inserts nothing.
+   * @param error Set to a description of the problem on failure
+   * @return number of rows inserted, or -1
    */
-  std::vector<Row> getRows(const std::string &tableName) const;
+  int insertRows(const std::string &tableName,
+                 const std::vector<std::string> &columns,
+                 const std::vector<std::string> &values, std::string &error);
 
   /**
-   * Get rows matching a WHERE condition
+   * Append the records of a CSV file (header line naming the columns, as
+   * saveToFiles writes them) to a table. The file is parsed in parallel
+   * into whole column chunks before the table is locked (see
+   * csv_loader.h); malformed records are skipped. A header column the
+   * table does not have fails the COPY, as its values would be dropped.
+   * @param skipped Set to the number of records skipped
+   * @param error   Set to a description of the problem on failure
+   * @return number of rows appended, or -1 if the file cannot be read or
+   *         names a column the table does not have
    */
-  std::vector<Row> getFilteredRows(const std::string &tableName,
-                                   const std::string &column,
-                                   const std::string &op,
-                                   const std::string &value) const;
+  int copyFromFile(const std::string &tableName, const std::string &path,
+                   size_t &skipped, std::string &error);
 
   /**
-   * Update rows matching a condition
-   * @return number of rows updated
+   * Take a consistent, read-only view of a table's newest version (of a
+   * partitioned table: its partitions' rows gathered into a copy)
+   * @return nullptr if the table does not exist
+   */
+  TableSnapshot snapshot(const std::string &tableName) const;
+
+  /**
+   * Make columns of a lazily loaded table resident (no-op for others):
+   * missing ones are parsed from its file into a new version, and all of
+   * them are kept until the lease is released. Take snapshots to read
+   * them from afterwards. May drop the least recently used unleased
+   * columns of lazy tables to stay within the column cache budget.
+   * @param columns Column names ("*" = all); unknown names are ignored
+   */
+  void loadColumns(const std::string &tableName,
+                   const std::vector<std::string> &columns,
+                   ColumnLease &lease);
+
+  /**
+   * Open a cursor over the rows matching a bound WHERE filter. No row data
+   * is copied, and nothing is scanned until rows are pulled from the
+   * cursor (see row_cursor.h); read values through its snapshot.
+   * @param access Index to find candidate rows with, or how to scan
+   * @return nullptr if the table does not exist
+   */
+  std::shared_ptr<RowCursor> openCursor(const std::string &tableName,
+                                        const BoundFilter &where,
+                                        const AccessPlan &access) const;
+
+  /**
+   * Update rows matching a bound WHERE filter: every assignment is applied
+   * to a row before the next row, in one pass over the matching rows,
+   * which keep their positions
+   * @param columns Assigned columns, each at most once (not the partition
+   *                key of a partitioned table)
+   * @param values  New value per assigned column
+   * @param access  Index to find the rows with, or how to scan (each
+   *                partition of a partitioned table chooses its own)
+   * @param error   Set to a description of the problem on failure
+   * @return number of rows updated, or -1 if a column does not exist or a
+   *         new value does not match its type (nothing is updated)
    */
-  int updateRows(const std::string &tableName, const std::string &setColumn,
-                 const std::string &setValue, const std::string &whereColumn,
-                 const std::string &whereOp, const std::string &whereValue);
+  int updateRows(const std::string &tableName,
+                 const std::vector<std::string> &columns,
+                 const std::vector<std::string> &values,
+                 const BoundFilter &where, const AccessPlan &access,
+                 std::string &error);
 
   /**
-   * Delete rows matching a condition
+   * Delete rows matching a bound WHERE filter: they are marked in the
+   * tombstone bitmap, and the table is queued for compaction once enough
+   * of its rows are marked
+   * @param access Index to find the rows with, or how to scan
    * @return number of rows deleted
    */
-  int deleteRows(const std::string &tableName, const std::string &whereColumn,
-                 const std::string &whereOp, const std::string &whereValue);
+  int deleteRows(const std::string &tableName, const BoundFilter &where,
+                 const AccessPlan &access = AccessPlan());
+
+  /**
+   * Remove the deleted rows of a table now, renumbering the rest: the
+   * compacted columns are built while readers and the indexes keep using
+   * the current version, which is then replaced
+   * @return number of deleted rows removed
+   */
+  int compactTable(const std::string &tableName);
+
+  /**
+   * Build a secondary index on a column from the current table contents
+   * (on every partition of a partitioned table)
+   * @param name  Index name; a default name is generated when empty
+   * @param error Set to a description of the problem on failure
+   * @return true on success
+   */
+  bool createIndex(const std::string &tableName, const std::string &column,
+                   IndexKind kind, std::string &name, std::string &error);
+
+  /**
+   * Choose how to find the rows of a bound WHERE filter. An index can
+   * answer a predicate every match must satisfy (see
+   * BoundFilter::conjuncts); a hash index is preferred for equality.
+   * - Analyzed table: the cheapest of a lookup on each such index and a
+   *   scan, by the estimated matches of the predicate it answers
+   * - Otherwise: always an index, if any applies: one answering an
+   *   equality before a range (by the default estimates), and a hash
+   *   index before an ordered one; ties go to the earlier predicate
+   * A scan runs in parallel when that is estimated to be cheaper. A
+   * partitioned table is estimated as a scan of all its partitions; each
+   * chooses its own path (call this on partitionName).
+   */
+  AccessPlan chooseAccess(const std::string &tableName,
+                          const BoundFilter &where) const;
+
+  /**
+   * Collect the statistics of a table's current version (ANALYZE) and
+   * keep them for the planner, replacing any earlier ones. Readers and
+   * writers are not blocked while the rows are read. The columns of a
+   * lazy table are parsed for the occasion, without becoming resident.
+   * Each partition of a partitioned table is analyzed too.
+   * @return nullptr if the table does not exist
+   */
+  std::shared_ptr<const TableStats> analyze(const std::string &tableName);
+
+  /**
+   * Statistics of a table's last ANALYZE
+   * @return nullptr if the table has not been analyzed (or does not exist)
+   */
+  std::shared_ptr<const TableStats> getStats(const std::string &tableName) const;
+
+  /**
+   * Memory held by the newest version of every table and its indexes,
+   * by table name. Chunks a version shares with older ones still held by
+   * readers are counted once, with the newest.
+   */
+  std::vector<TableMemory> memoryReport() const;
 
   /**
    * Delete all rows from a table
@@ -84,7 +415,7 @@ public:
   int deleteAllRows(const std::string &tableName);
 
   /**
-   * Get row count for a table
+   * Get row count for a table (deleted rows not included)
    */
   int getRowCount(const std::string &tableName) const;
 
@@ -94,31 +425,396 @@ public:
   std::vector<std::string> getColumnNames(const std::string &tableName) const;
 
   /**
-   * Load data from CSV files in the data directory
+   * Load data from CSV files in the data directory (with lazy loading,
+   * only index them). A partitioned table is loaded whole, its rows
+   * routed to their partitions.
    */
   void loadFromFiles(const std::string &dir);
 
   /**
-   * Save data to CSV files in the data directory
+   * Save data to CSV files in the data directory. Each file is written
+   * under a temporary name and then renamed over the old one, which lazy
+   * tables may still be reading.
    */
   void saveToFiles(const std::string &dir) const;
 
+  /**
+   * Load tables from binary snapshots (<table>.snap) in a directory.
+   * A table whose snapshot is missing or invalid keeps its rows.
+   */
+  void loadSnapshots(const std::string &dir);
+
+  /**
+   * Save every table as a binary snapshot (<table>.snap) in a directory
+   * @param compress Store column blocks LZ-compressed when that is smaller
+   */
+  void saveSnapshots(const std::string &dir, bool compress) const;
+
   /**
    * Check if a table exists
    */
   bool tableExists(const std::string &tableName) const;
 
+  /**
+   * Get the schema a table was created from
+   * @return nullptr if the table does not exist
+   */
+  const TableInfo *getSchema(const std::string &tableName) const;
+
+  /**
+   * Split a table into partitions (partition.h), moving its rows into
+   * them. The set of tables changes, so only while one session uses the
+   * store (before fixTables), and not under an attached log: a log
+   * directory must be reopened with the same partitioning, given at
+   * startup.
+   * @param error Set to a description of the problem on failure
+   * @return false if the table does not exist, is partitioned already or
+   *         has indexes, or the tables are fixed or logged
+   */
+  bool partitionTable(const std::string &tableName,
+                      const PartitionScheme &scheme, std::string &error);
+
+  /**
+   * How a table is partitioned
+   * @return nullptr if it is not
+   */
+  std::shared_ptr<const PartitionScheme>
+  getPartitioning(const std::string &tableName) const;
+
+  /**
+   * The newest version of every partition of a table, all of one state
+   * (empty if the table is not partitioned)
+   */
+  std::vector<TableSnapshot>
+  partitionSnapshots(const std::string &tableName) const;
+
+  /**
+   * Open a cursor over the rows of each listed partition of a table that
+   * match a bound WHERE filter, all on one state of the table (see
+   * openCursor)
+   * @param where  Filter (nullptr = every row)
+   * @param access How to find the rows, per listed partition (chosen
+   *               with chooseAccess on partitionName)
+   */
+  std::vector<std::shared_ptr<RowCursor>>
+  openPartitionCursors(const std::string &tableName, const BoundFilter *where,
+                       const std::vector<size_t> &partitions,
+                       const std::vector<AccessPlan> &access) const;
+
+  /**
+   * Log every later INSERT, UPDATE and DELETE to a write-ahead log
+   * (nullptr detaches the log). Waits for the change in progress, if any,
+   * e.g. a background compaction.
+   */
+  void attachLog(WriteAheadLog *wal);
+
+  /**
+   * Fix the set of tables before sessions use the store concurrently
+   * (server mode): tables are looked up without a lock
+   */
+  void fixTables() { tablesFixed = true; }
+
+  /**
+   * Scan tables and load CSV files on a thread pool
+   * (nullptr = scan on the calling thread)
+   */
+  void setThreadPool(ThreadPool *threads) { pool = threads; }
+
+  ThreadPool *getThreadPool() const { return pool; }
+
+  /**
+   * Memory budget of a sort: an ORDER BY whose rows need more spills
+   * sorted runs to temporary files and merges them (sort.h)
+   */
+  void setSortMemory(size_t bytes) { sortMemory = bytes; }
+
+  size_t getSortMemory() const { return sortMemory; }
+
+  /**
+   * Share of a table's rows that must be deleted (and at least
+   * COMPACT_MIN_ROWS) before it is compacted in the background
+   * (0 = never)
+   */
+  void setCompactRatio(double ratio) { compactRatio = ratio; }
+
+  double getCompactRatio() const { return compactRatio; }
+
+  /**
+   * Make loadFromFiles index CSV files and load each column on first use
+   * (see above); tables loaded already are not affected
+   */
+  void setLazyLoading(bool lazy) { lazyLoading = lazy; }
+
+  bool getLazyLoading() const { return lazyLoading; }
+
+  /**
+   * Bytes the resident columns of lazy tables may take before the least
+   * recently used ones are dropped (0 = no limit)
+   */
+  void setColumnCacheMemory(size_t bytes) { columnCacheMemory = bytes; }
+
+  size_t getColumnCacheMemory() const { return columnCacheMemory; }
+
+  /**
+   * Redo a logged change (recovery); the change is not logged again
+   * @return false if the record does not fit the table
+   */
+  bool applyLogRecord(const LogRecord &record);
+
+  /**
+   * Copy every table (without indexes, with its deleted rows), e.g. to
+   * write a checkpoint while
+   * the originals keep changing. Lazy tables are copied with all their
+   * columns. Copies share their chunks with the
+   * tables, so this costs no row data. No change is in progress while
+   * the tables are copied, so together they reflect a prefix of the log.
+   */
+  std::vector<TableData> captureTables() const;
+
 private:
+  /**
+   * Write access to a table's newest version. A version some reader still
+   * holds is first replaced by a copy. Requires writeMutex and the
+   * exclusive versionMutex while the result is modified.
+   */
+  static TableData &writableTable(TableSlot &slot);
+
+  /**
+   * Make columns of a lazy table resident in its newest version, pinned
+   * by the lease if there is one, then drop least recently used columns
+   * over the cache budget (requires writeMutex)
+   */
+  void residentColumns(const std::string &tableName, TableSlot &slot,
+                       std::vector<size_t> columns, ColumnLease *lease);
+
+  /**
+   * Make a lazy table an ordinary one before it is changed: its missing
+   * columns are loaded into its newest version (requires writeMutex)
+   */
+  void materialize(const std::string &tableName, TableSlot &slot);
+
+  /**
+   * Fill the missing columns of a private copy of a lazy table
+   */
+  void fillColumns(TableData &table) const;
+
+  /**
+   * Snapshot of a table with all its columns: those a lazy table lacks
+   * are parsed into a private copy
+   */
+  TableSnapshot fullSnapshot(const std::string &tableName) const;
+
+  /**
+   * Add cache entries for the resident columns of a lazy table just
+   * loaded
+   */
+  void cacheColumns(const std::string &tableName, const TableData &table);
+
+  /**
+   * Drop the cache entries of a table's columns
+   */
+  void forgetColumns(const std::string &tableName);
+
+  /**
+   * Unpin the columns of a lease
+   */
+  void releaseColumns(ColumnLease &lease);
+
+  /**
+   * Take the newest versions of tables together, probing the index of
+   * each access plan in its own, then open a cursor over each
+   * @param where Filter (nullptr = every row)
+   */
+  std::vector<std::shared_ptr<RowCursor>>
+  openCursors(const std::vector<const TableSlot *> &slots,
+              const BoundFilter *where,
+              const std::vector<AccessPlan> &access) const;
+
+  /**
+   * Copy of the live rows of partitions of a table, one partition after
+   * the other
+   */
+  static TableSnapshot gatherPartitions(const TableSlot &slot,
+                                        const std::vector<TableSnapshot> &parts);
+
+  /**
+   * Split the live rows of a table into one table per partition
+   */
+  static std::vector<TableData> splitRows(const TableData &table,
+                                          const PartitionScheme &scheme);
+
+  /**
+   * Update the matching rows of every partition a filter may match
+   * (requires writeMutex); the partition key may not be assigned
+   */
+  int updatePartitions(const std::string &tableName, TableSlot &slot,
+                       const std::vector<std::string> &columns,
+                       const std::vector<std::string> &values,
+                       const BoundFilter &where, std::string &error);
+
+  /**
+   * Delete the matching rows of every partition a filter may match
+   * (requires writeMutex)
+   * @param compact Receives the partitions to compact afterwards
+   */
+  int deletePartitions(const std::string &tableName, TableSlot &slot,
+                       const BoundFilter &where,
+                       std::vector<std::string> &compact);
+
+  /**
+   * Log the rows of a staged table (COPY, partitioned inserts) as
+   * INSERT_ROWS records
+   * @return the LSN of the last record
+   */
+  uint64_t logTable(const std::string &tableName, const TableData &staged);
+
+  /**
+   * Append the rows of a staged table, chunk by chunk, and add them to
+   * the indexes in one batch per index
+   */
+  static void appendTable(TableData &table, TableData &&staged);
+
+  /**
+   * Log and append the rows split per partition (splitRows) of a
+   * partitioned table, publishing all partitions together (requires
+   * writeMutex)
+   */
+  void appendPartitions(const std::string &tableName, TableSlot &slot,
+                        std::vector<TableData> &&parts);
+
+  /**
+   * Threads to parse CSV files with (0 = one per hardware thread)
+   */
+  unsigned loadThreads() const {
+    return pool ? static_cast<unsigned>(pool->size()) : 0;
+  }
+
+  /**
+   * Convert the listed values of a row to their column types; unlisted
+   * columns are NULL
+   * @return false if a column does not exist or a value does not fit
+   */
+  static bool convertRow(const TableData &table,
+                         const std::vector<std::string> &columns,
+                         const std::vector<std::string> &values,
+                         std::vector<CellValue> &cells);
+
+  /**
+   * Append a converted row and add it to the indexes
+   */
+  static void appendCells(TableData &table,
+                          const std::vector<CellValue> &cells);
+
+  /**
+   * Convert rows of values for insertRows to typed columns, parsing every
+   * value once (NULL where nulls, if not empty, flags it); unlisted
+   * columns are NULL
+   * @param staged Empty table of the schema; receives the rows, to be
+   *               appended with appendTable
+   * @return false if a column does not exist or is listed twice, or a
+   *         value does not fit
+   */
+  static bool stageRows(const std::vector<std::string> &columns,
+                        const std::vector<std::string> &values,
+                        const std::vector<uint8_t> &nulls, TableData &staged,
+                        std::string &error);
+
+  /**
+   * Log rows of values as INSERT_ROWS records of up to COLUMN_CHUNK_ROWS
+   * rows each
+   * @return the LSN of the last record
+   */
+  uint64_t logRows(const std::string &tableName,
+                   const std::vector<std::string> &columns,
+                   const std::vector<std::string> &values,
+                   const std::vector<uint8_t> &nulls);
+
   /**
    * Load sample data into tables
    */
   void loadSampleData();
 
   /**
-   * Compare two values based on operator
+   * Rebuild every index of a table from its columns (requires the
+   * exclusive versionMutex, as the indexes are shared by all versions)
+   */
+  void rebuildIndexes(TableData &table);
+
+  /**
+   * Resolve assigned columns and convert their new values
+   * @param targets Set to the table column of each assigned column
+   * @return false if a column does not exist or a value does not fit
    */
-  bool compareValues(const std::string &left, const std::string &op,
-                     const std::string &right) const;
+  static bool convertAssignments(const TableData &table,
+                                 const std::vector<std::string> &columns,
+                                 const std::vector<std::string> &values,
+                                 std::vector<int> &targets,
+                                 std::vector<CellValue> &cells,
+                                 std::string &error);
+
+  /**
+   * Assign cells[i] to column targets[i] of each row, one row at a time
+   * @return number of rows updated
+   */
+  static int updateMatching(TableData &table, const std::vector<int> &targets,
+                            const std::vector<CellValue> &cells,
+                            const SelectionVector &rows);
+
+  /**
+   * Mark rows deleted and remove them from the indexes
+   * @return number of rows deleted
+   */
+  static int markDeleted(TableData &table, const SelectionVector &rows);
+
+  /**
+   * Drop the deleted rows from the columns of a table, renumbering the
+   * rest; the indexes are not touched
+   * @return newIds[old position] = new position, or DELETED_ROW
+   */
+  static std::vector<RowId> compactColumns(TableData &table);
+
+  /**
+   * Whether enough of a table's rows are deleted to compact it
+   */
+  bool needsCompaction(const TableData &table) const;
+
+  /**
+   * Queue a table for the background compactor, starting it if needed
+   */
+  void requestCompaction(const std::string &tableName);
+
+  /**
+   * Background compactor: compact queued tables until stopped
+   */
+  void compactorLoop();
+
+  /**
+   * Remove all rows of a table
+   */
+  void clearTable(TableData &table);
+
+  /**
+   * Append a record describing a change to the attached log
+   * @return the record's LSN
+   */
+  uint64_t logChange(LogRecord &record);
+
+  /**
+   * Find the rows of a table that satisfy a bound filter and are not
+   * deleted
+   * @return their positions, in table order
+   */
+  SelectionVector matchRows(const TableData &table, const BoundFilter &where,
+                            const AccessPlan &access) const;
+
+  /**
+   * Call fn(morsel, count) for every morsel of a table: morsel i is chunk
+   * i, holding `count` rows. With `parallel`, morsels run on the thread
+   * pool.
+   */
+  void forEachMorsel(const TableData &table, bool parallel,
+                     const std::function<void(size_t, size_t)> &fn) const;
+
 };
 
 } // namespace MiniSQL
@@ -5,8 +5,23 @@
  * Description: Query Execution Engine Header
  *
  * The Executor is the fourth phase of compilation.
- * After validation, it traverses the parse tree and executes
- * the query against the DataStore.
+ * After validation, it flattens the parse tree into a QueryPlan and
+ * executes the plan against the DataStore. Plans can be cached and
+ * executed again without re-parsing (see plan_cache.h).
+ *
+ * EXPLAIN returns the plan as a one-column result ("QUERY PLAN"): the
+ * access path, the WHERE filter in evaluation order with estimated
+ * selectivities, and the output columns. EXPLAIN ANALYZE also runs the
+ * statement (changes included) and adds what was measured (metrics.h).
+ *
+ * ANALYZE <table> collects the table's statistics (statistics.h) and
+ * returns them, one row per column. Plans bind their WHERE filters to
+ * the statistics current when they execute, so a cached plan picks up a
+ * later ANALYZE.
+ *
+ * SHOW MEMORY reports the memory held per table and index (split into
+ * values, strings and maps) and per running statement, with the limits
+ * of memory_tracker.h.
  */
 
 #ifndef EXECUTOR_H
@@ -14,35 +29,120 @@
 
 #include "common.h"
 #include "data_store.h"
+#include "join.h"
+#include "query_plan.h"
+#include "row_cursor.h"
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace MiniSQL {
 
+// Rows a SELECT reads ahead before returning: the console table sizes its
+// columns from them, and a result that fits reports its row count at once
+const size_t RESULT_SAMPLE_ROWS = 1000;
+
 // Result of query execution
+//
+// SELECT results are a cursor, not a copy: the rows are found as they
+// are pulled from it (see row_cursor.h), and cell values are read from
+// the cursor's snapshot of the table on demand. The snapshot keeps the
+// result valid, and unchanged, while the table is modified. A result's
+// rows can be read once.
+//
+// The rows of a multi-table SELECT are the tuples of its join (join.h),
+// read from the snapshots the join holds. A SELECT with aggregates reads
+// its rows, one per group, from a table of its own (aggregate.h). With
+// ORDER BY the cursor returns the same positions, sorted (sort.h).
 struct QueryResult {
   bool success;
   std::string message;
   std::vector<std::string> columnNames;
-  std::vector<Row> rows;
   int affectedRows; // For INSERT/UPDATE/DELETE
 
-  QueryResult() : success(false), affectedRows(0) {}
+  TableSnapshot table;             // Table version the rows are read from
+  std::vector<int> projection;     // Table column index per output column
+  std::shared_ptr<RowCursor> rows; // SELECT: positions of the result rows
+
+  // Multi-table SELECT: result row i is tuple i of the join, and output
+  // column col comes from its table sources[col]
+  std::shared_ptr<const JoinRows> join;
+  std::vector<size_t> sources;
+
+  QueryResult() : success(false), affectedRows(0), table(nullptr) {}
+
+  // Column output column col is read from
+  const Column &getColumn(size_t col) const {
+    const TableData &data = join ? *join->tables[sources[col]] : *table;
+    return data.columns[projection[col]];
+  }
+
+  // Row of getColumn(col) that holds output column col of result row
+  // `row`
+  RowId sourceRow(RowId row, size_t col) const {
+    return join ? join->rows[sources[col]][row] : row;
+  }
+
+  // Text of output column col in result row `row`
+  std::string getValue(RowId row, size_t col) const {
+    const Column &column = getColumn(col);
+    RowId id = sourceRow(row, col);
+    if (column.getType() == ColumnType::FLOAT && !column.isNull(id))
+      return formatResultFloat(column.getFloat(id));
+    return column.getText(id);
+  }
 };
 
 class Executor {
 private:
   DataStore &dataStore;
 
+  // Execute a plan's statement (without its EXPLAIN)
+  QueryResult executeStatement(const QueryPlan &plan);
+
   // Execute specific query types
-  QueryResult executeSelect(const ParseTree &tree);
-  QueryResult executeInsert(const ParseTree &tree);
-  QueryResult executeUpdate(const ParseTree &tree);
-  QueryResult executeDelete(const ParseTree &tree);
+  QueryResult executeSelect(const QueryPlan &plan);
+  QueryResult executeJoin(const QueryPlan &plan);
+  QueryResult executeAggregate(const QueryPlan &plan);
+  // SELECT on a partitioned table: a fragment per partition that may
+  // match, pushing down the filter, the projection and partial
+  // aggregates; the fragments' results are merged here
+  QueryResult executePartitioned(const QueryPlan &plan);
+  QueryResult executeInsert(const QueryPlan &plan);
+  QueryResult executeUpdate(const QueryPlan &plan);
+  QueryResult executeDelete(const QueryPlan &plan);
+  QueryResult executeCreateIndex(const QueryPlan &plan);
+  QueryResult executeCopy(const QueryPlan &plan);
+  QueryResult executeAnalyze(const QueryPlan &plan);
+  QueryResult executeShowMemory(const QueryPlan &plan);
+  QueryResult executePartition(const QueryPlan &plan);
+  QueryResult executeExplain(const QueryPlan &plan);
 
-  // Extract information from parse tree
-  std::string extractTableName(const ParseTree &tree) const;
-  std::vector<std::string> extractColumns(const ParseTree &tree) const;
+  // Describe a plan as EXPLAIN prints it, one line per entry; on failure,
+  // fill result
+  bool describePlan(const QueryPlan &plan, std::vector<std::string> &lines,
+                    QueryResult &result) const;
+  bool describeJoin(const QueryPlan &plan, std::vector<std::string> &lines,
+                    QueryResult &result) const;
+
+  // Bind a plan's WHERE expression to the table schema; on failure, fill
+  // result
+  bool bindWhere(const QueryPlan &plan, BoundFilter &out,
+                 QueryResult &result) const;
+
+  // The partitioning ALTER TABLE ... PARTITION BY asks for, checked
+  // against the table's schema
+  bool planPartitioning(const QueryPlan &plan, PartitionScheme &scheme,
+                        std::string &error) const;
+
+  // Make the columns a SELECT reads resident in lazily loaded tables, for
+  // as long as the lease is held
+  void loadColumns(const QueryPlan &plan, ColumnLease &lease);
+
+  // Choose how to find the rows of a WHERE filter (an index lookup, or a
+  // serial or parallel scan) and record the choice
+  AccessPlan chooseAccess(const std::string &tableName,
+                          const BoundFilter &where) const;
 
   // Print results in tabular format
   void printResultTable(const QueryResult &result) const;
@@ -61,6 +161,17 @@ public:
    */
   QueryResult execute(const ParseTree &tree);
 
+  /**
+   * Execute a plan (built by buildPlan, possibly from the plan cache)
+   */
+  QueryResult execute(const QueryPlan &plan);
+
+  /**
+   * Flatten a validated parse tree into an executable plan
+   * @return false if the tree is not an executable statement
+   */
+  bool buildPlan(const ParseTree &tree, QueryPlan &plan) const;
+
   /**
    * Print execution results
    */
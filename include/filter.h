@@ -0,0 +1,114 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: filter.h
+ * Description: Compound WHERE Filters over Column Chunks
+ *
+ * A WHERE expression is compiled into a tree of bound predicates joined by
+ * AND / OR. The tree is evaluated one column chunk at a time, producing a
+ * match flag per row (the selection bitmap of that chunk):
+ * - AND starts from its first operand's matches and lets every further
+ *   operand only clear flags; once no row is left the rest is skipped
+ * - OR starts from its first operand and lets every further operand only
+ *   set flags of rows not yet selected; once all rows match it stops
+ *
+ * While many rows are still undecided an operand runs its full chunk scan
+ * kernel; once only a few remain it tests just those rows.
+ *
+ * Operands are reordered so the short-circuits fire early for the least
+ * work: AND evaluates first the operand with the lowest cost per row it
+ * rejects (cost / (1 - selectivity)), OR the one with the lowest cost per
+ * row it accepts (cost / selectivity). Between operands of equal cost that
+ * is the most selective one first for AND, the least selective for OR.
+ * Selectivities come from the table's statistics when it has been
+ * analyzed (statistics.h), and from defaults per operator otherwise.
+ *
+ * A filter can also be compiled into a fused scan (compiled_filter.h);
+ * selectChunk() then runs the compiled stages instead of the tree.
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "compiled_filter.h"
+#include "predicate.h"
+#include "statistics.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace MiniSQL {
+
+struct BoundFilter {
+  enum class Kind { PREDICATE, AND, OR };
+
+  Kind kind;
+  BoundPredicate predicate;          // PREDICATE
+  std::vector<BoundFilter> children; // AND / OR, in evaluation order
+  double selectivity;                // Estimated fraction of rows matching
+  std::shared_ptr<const CompiledFilter> compiled; // Set by compile()
+
+  BoundFilter() : kind(Kind::PREDICATE), selectivity(1.0) {}
+
+  /**
+   * A filter testing one predicate
+   * @param stats Statistics of the predicate's table, if analyzed
+   */
+  static BoundFilter leaf(const BoundPredicate &predicate,
+                          const TableStats *stats = nullptr);
+
+  /**
+   * Combine operands with AND / OR. Nested operands of the same kind are
+   * flattened, and operands are put into evaluation order.
+   */
+  static BoundFilter combine(Kind kind, std::vector<BoundFilter> operands);
+
+  /**
+   * Evaluate the filter over every row of a table
+   * @param columns  The table's columns (indexed by BoundPredicate)
+   * @param rowCount Number of rows in the table
+   * @param out      One flag per row, resized to rowCount
+   */
+  void evaluate(const std::vector<Column> &columns, size_t rowCount,
+                std::vector<uint8_t> &out) const;
+
+  /**
+   * Evaluate the filter on a single row
+   */
+  bool matches(const std::vector<Column> &columns, size_t row) const;
+
+  /**
+   * Predicates every matching row must satisfy: the filter itself, or the
+   * predicate operands of a top-level AND. An index on any of them can
+   * supply candidate rows.
+   */
+  std::vector<const BoundPredicate *> conjuncts() const;
+
+  /**
+   * Evaluate the filter over the first `count` rows of one chunk
+   * @param out One flag per row of the chunk
+   */
+  void evaluateChunk(const std::vector<Column> &columns, size_t chunkIndex,
+                     size_t count, uint8_t *out) const;
+
+  /**
+   * Compile the filter into a fused scan used by selectChunk()
+   * @return false if it cannot be compiled; it stays interpreted
+   */
+  bool compile();
+
+  /**
+   * Append the positions of the rows among the first `count` rows of one
+   * chunk that match and are not deleted, in table order: with the
+   * compiled stages if the filter is compiled, from evaluateChunk()
+   * otherwise
+   */
+  void selectChunk(const std::vector<Column> &columns,
+                   const DeleteBitmap &deleted, size_t chunkIndex,
+                   size_t count, SelectionVector &out) const;
+};
+
+} // namespace MiniSQL
+
+#endif // FILTER_H
@@ -0,0 +1,114 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: index.h
+ * Description: Secondary Indexes on Table Columns
+ *
+ * Indexes are created with:
+ *   CREATE INDEX [name] ON table [USING HASH | BTREE] (column);
+ *
+ * - HASH indexes answer equality (=) lookups
+ * - BTREE (ordered) indexes answer =, <, <=, > and >= lookups
+ *
+ * An index maps column values to row positions. The DataStore keeps
+ * every index of a table up to date on insert, update and delete, and
+ * the Executor picks an index when the WHERE column has one.
+ * NULL cells are not indexed (they never satisfy a condition).
+ */
+
+#ifndef INDEX_H
+#define INDEX_H
+
+#include "column_store.h"
+#include "memory_tracker.h"
+#include "predicate.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+// Marks a deleted row in a row-position remapping
+constexpr RowId DELETED_ROW = UINT32_MAX;
+
+enum class IndexKind { HASH, ORDERED };
+
+inline std::string indexKindToString(IndexKind kind) {
+  return kind == IndexKind::HASH ? "HASH" : "BTREE";
+}
+
+class TableIndex {
+protected:
+  std::string name;
+  int columnIndex; // Indexed column's position in the table schema
+  IndexKind kind;
+
+public:
+  TableIndex(const std::string &n, int column, IndexKind k)
+      : name(n), columnIndex(column), kind(k) {}
+  virtual ~TableIndex() = default;
+
+  const std::string &getName() const { return name; }
+  int getColumnIndex() const { return columnIndex; }
+  IndexKind getKind() const { return kind; }
+
+  /**
+   * Check if this index can answer a bound condition
+   */
+  bool supports(const BoundPredicate &where) const;
+
+  /**
+   * Add the value of one row (read from the indexed column)
+   */
+  virtual void insert(const Column &values, RowId row) = 0;
+
+  /**
+   * Add the values of rows [first, end), e.g. a batch just appended
+   */
+  virtual void insertRows(const Column &values, RowId first, RowId end) = 0;
+
+  /**
+   * Remove one row; must be called before the row's value changes
+   */
+  virtual void erase(const Column &values, RowId row) = 0;
+
+  /**
+   * Remove all entries
+   */
+  virtual void clear() = 0;
+
+  /**
+   * Renumber rows after the table was compacted
+   * @param newIds newIds[old] = new position, or DELETED_ROW
+   */
+  virtual void remap(const std::vector<RowId> &newIds) = 0;
+
+  /**
+   * Collect the rows satisfying a supported condition, in table order
+   */
+  virtual void lookup(const BoundPredicate &where,
+                      SelectionVector &out) const = 0;
+
+  /**
+   * Number of indexed rows
+   */
+  virtual size_t size() const = 0;
+
+  /**
+   * Add the approximate heap bytes of the index: row lists as values, key
+   * characters as strings, buckets and nodes as maps, spare capacity of
+   * row lists as reserved
+   */
+  virtual void memoryUsage(MemoryUsage &usage) const = 0;
+};
+
+/**
+ * Create an empty index for a column of the given type
+ */
+std::unique_ptr<TableIndex> createIndex(const std::string &name,
+                                        int columnIndex, ColumnType type,
+                                        IndexKind kind);
+
+} // namespace MiniSQL
+
+#endif // INDEX_H
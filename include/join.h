@@ -0,0 +1,119 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: join.h
+ * Description: Join Operators for Multi-Table SELECT
+ *
+ * A multi-table SELECT joins its tables left to right, in FROM order.
+ * Each table's own WHERE conditions are applied first, by the ordinary
+ * scan or index lookup (row_cursor.h); joining then pairs the rows that
+ * are left over:
+ * - Hash join, when a condition is an equality between a column of the
+ *   table being joined and one of a table joined before. The smaller
+ *   input is loaded into an open-addressing hash table (16-byte slots,
+ *   linear probing) and the larger one probes it, a morsel at a time on
+ *   the thread pool.
+ * - Radix hash join, when the smaller input has RADIX_JOIN_MIN_ROWS rows
+ *   or more and its hash table would not stay in cache: both inputs are
+ *   first split into partitions by the high bits of their key hashes,
+ *   sized so each partition's table fits in cache, and the partition
+ *   pairs are joined in parallel.
+ * - Nested-loop join for any other condition (or none: every pair).
+ * The remaining conditions between the tables are checked on every pair.
+ *
+ * A join result is a list of row tuples, one row position per table. No
+ * value is copied: the output reads the values from the tables' snapshots
+ * as the tuples are written.
+ */
+
+#ifndef JOIN_H
+#define JOIN_H
+
+#include "data_store.h"
+#include "predicate.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+// Build inputs of at least this many rows are radix-partitioned
+const size_t RADIX_JOIN_MIN_ROWS = size_t(1) << 16;
+
+// Rows of a join: tuple i pairs row rows[t][i] of every table t
+struct JoinRows {
+  std::vector<TableSnapshot> tables; // In FROM order
+  std::vector<SelectionVector> rows; // One position per table and tuple
+
+  size_t size() const { return rows.empty() ? 0 : rows[0].size(); }
+};
+
+// A column of one of the joined tables
+struct JoinColumn {
+  size_t table; // Position of the table in the FROM list
+  int column;   // Position of the column in the table
+  std::string name; // As written in the query (for messages)
+
+  JoinColumn() : table(0), column(-1) {}
+};
+
+// "left op right" on two columns. When the condition is applied, right
+// is a column of the table being joined and left one of it or of a table
+// joined before.
+struct JoinCondition {
+  JoinColumn left;
+  CompareOp op;
+  JoinColumn right;
+
+  JoinCondition() : op(CompareOp::EQ) {}
+};
+
+enum class JoinMethod { HASH, RADIX_HASH, NESTED_LOOP };
+
+std::string joinMethodToString(JoinMethod method);
+
+/**
+ * Whether two column types can be compared: numeric with numeric,
+ * VARCHAR with VARCHAR
+ */
+bool comparableTypes(ColumnType a, ColumnType b);
+
+/**
+ * Compare a cell of one column with a cell of another (of comparable
+ * types); a NULL cell never matches
+ */
+bool compareCells(const Column &a, size_t rowA, CompareOp op,
+                  const Column &b, size_t rowB);
+
+/**
+ * The method joinTable uses for inputs of the given sizes
+ * @param joinedRows Tuples joined so far
+ * @param tableRows  Rows of the table being joined
+ * @param key        Set to the condition used as the hash key (-1 = none)
+ */
+JoinMethod chooseJoinMethod(const std::vector<JoinCondition> &conditions,
+                            size_t joinedRows, size_t tableRows, int &key);
+
+/**
+ * Join one more table to the tuples of a join
+ * @param joined     Tuples of the tables joined so far, extended in place
+ *                   by the new table (table joined.tables.size())
+ * @param rows       Rows of the new table to join, e.g. those passing
+ *                   its own WHERE conditions
+ * @param conditions Every condition to apply (oriented as described at
+ *                   JoinCondition)
+ * @param pool       Runs partitions and morsels in parallel (nullptr =
+ *                   on the calling thread)
+ * @param method     Set to the method used
+ * @param error      Set when the result would have too many tuples, or
+ *                   the join more memory than the limits leave
+ * @return false on failure
+ */
+bool joinTable(JoinRows &joined, TableSnapshot table,
+               const SelectionVector &rows,
+               const std::vector<JoinCondition> &conditions,
+               ThreadPool *pool, JoinMethod &method, std::string &error);
+
+} // namespace MiniSQL
+
+#endif // JOIN_H
@@ -16,21 +16,25 @@
  * - Handle numeric and string literals
  * - Track line and column positions for error reporting
  * - Skip whitespace and comments
+ *
+ * The lexer does not allocate per token: token values are views into the
+ * source text (see Token), and keywords are recognized case-insensitively
+ * with a compile-time perfect hash instead of an upper-cased copy and a
+ * map lookup. The source must outlive the lexer and its tokens.
  */
 
 #ifndef LEXER_H
 #define LEXER_H
 
 #include "common.h"
-#include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 namespace MiniSQL {
 
 class Lexer {
 private:
-  std::string source;                // Input SQL query
+  std::string_view source;           // Input SQL query (not copied)
   std::vector<Token> tokens;         // Output token stream
   std::vector<CompilerError> errors; // Lexical errors encountered
 
@@ -40,9 +44,6 @@ private:
   int column;      // Current column number
   int startColumn; // Column at start of current token
 
-  // Keyword lookup table
-  static std::unordered_map<std::string, TokenType> keywords;
-
   // Helper methods
   bool isAtEnd() const;
   char advance();
@@ -59,7 +60,7 @@ private:
 
   // Token creation
   void addToken(TokenType type);
-  void addToken(TokenType type, const std::string &value);
+  void addToken(TokenType type, std::string_view value);
 
   // Error reporting
   void reportError(const std::string &message);
@@ -67,9 +68,10 @@ private:
 public:
   /**
    * Constructor
-   * @param source The SQL query string to tokenize
+   * @param source The SQL query string to tokenize (must outlive the
+   *               tokens, which point into it)
    */
-  explicit Lexer(const std::string &source);
+  explicit Lexer(std::string_view source);
 
   /**
    * Perform lexical analysis and generate token stream
@@ -93,6 +95,12 @@ public:
    * Print token stream to console (for demonstration)
    */
   void printTokens() const;
+
+  /**
+   * Keyword an identifier spells, in any case
+   * @return its upper-case spelling, or empty if it is no keyword
+   */
+  static std::string_view keywordSpelling(std::string_view text);
 };
 
 } // namespace MiniSQL
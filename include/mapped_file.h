@@ -0,0 +1,44 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: mapped_file.h
+ * Description: Read-Only Memory-Mapped File
+ *
+ * Maps a whole file into memory so loaders can parse or copy it in place
+ * without reading it through a stream. The mapping lives as long as the
+ * MappedFile object.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace MiniSQL {
+
+class MappedFile {
+private:
+  int fd;
+  const char *bytes;
+  size_t length;
+
+public:
+  /**
+   * Open and map a file; check isOpen() for success.
+   * An empty file is open but has data() == nullptr.
+   */
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool isOpen() const { return fd >= 0; }
+  const char *data() const { return bytes; }
+  size_t size() const { return length; }
+};
+
+} // namespace MiniSQL
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,238 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: memory_tracker.h
+ * Description: Per-Query Memory Accounting and Limits (SHOW MEMORY)
+ *
+ * Every statement has a memory account for as long as it runs
+ * (MemoryScope, bound to its thread like the metrics of metrics.h). What
+ * a statement holds in proportion to its input is reserved from the
+ * account before it is built, and released when it is freed:
+ * - the row positions collected as the input of a join or aggregation
+ * - join keys, hash tables and tuples; aggregation hash tables
+ * - the entries an ORDER BY sorts in memory, and its sorted result
+ * The parse tree and the rows an UPDATE or DELETE finds are counted too.
+ *
+ * Two limits apply, both off unless configured:
+ * - per query (--query-memory-mb): what one statement may hold at once
+ * - global (--memory-limit-mb): what all running statements together
+ *   may hold, e.g. the sessions of a server
+ * A reservation that would exceed either fails, and the operator adapts
+ * or stops before allocating: a sort spills its run to disk early and
+ * goes on; joins and aggregations fail the statement with a "memory
+ * limit exceeded" error. Table data belongs to no query and is not
+ * limited; SHOW MEMORY reports it per table.
+ *
+ * The counters are atomic, so operators running on the thread pool
+ * reserve through a MemoryReservation made on the statement's thread.
+ */
+
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+// Heap bytes of a structure, by what they hold
+struct MemoryUsage {
+  size_t values;   // Fixed-width arrays: numbers, dictionary codes, NULL
+                   // flags, row positions
+  size_t strings;  // String bytes (dictionaries, index keys)
+  size_t maps;     // Lookup structures: dictionary slots and offsets, hash
+                   // buckets, tree and list nodes
+  size_t reserved; // Allocated for growth, not holding anything yet (e.g.
+                   // the rest of a column chunk being filled)
+
+  MemoryUsage() : values(0), strings(0), maps(0), reserved(0) {}
+
+  // Bytes in use
+  size_t total() const { return values + strings + maps; }
+
+  // Bytes allocated: in use or reserved
+  size_t allocated() const { return total() + reserved; }
+
+  MemoryUsage &operator+=(const MemoryUsage &other) {
+    values += other.values;
+    strings += other.strings;
+    maps += other.maps;
+    reserved += other.reserved;
+    return *this;
+  }
+};
+
+/**
+ * Heap bytes of a string's characters (0 if they are stored inline)
+ */
+size_t stringHeapBytes(const std::string &text);
+
+/**
+ * Set the limits (bytes, 0 = none)
+ */
+void setMemoryLimits(size_t perQuery, size_t global);
+
+size_t getQueryMemoryLimit();
+size_t getGlobalMemoryLimit();
+
+// The memory account of one running statement
+class QueryMemory {
+private:
+  uint64_t id;
+  std::string query;
+  std::atomic<size_t> used;
+  std::atomic<size_t> peak;
+
+public:
+  QueryMemory(uint64_t id, std::string query);
+
+  QueryMemory(const QueryMemory &) = delete;
+  QueryMemory &operator=(const QueryMemory &) = delete;
+
+  /**
+   * Reserve bytes before allocating them
+   * @return false (nothing reserved) if the per-query or global limit
+   *         would be exceeded
+   */
+  bool reserve(size_t bytes);
+
+  /**
+   * Count bytes already allocated, without checking the limits
+   */
+  void charge(size_t bytes);
+
+  void release(size_t bytes);
+
+  /**
+   * Bytes that can still be reserved (SIZE_MAX without limits)
+   */
+  size_t available() const;
+
+  uint64_t getId() const { return id; }
+  const std::string &getQuery() const { return query; }
+  size_t getUsed() const { return used.load(std::memory_order_relaxed); }
+  size_t getPeak() const { return peak.load(std::memory_order_relaxed); }
+};
+
+/**
+ * Account of the statement running on this thread (nullptr outside one)
+ */
+QueryMemory *currentMemory();
+
+/**
+ * Gives a statement its account for the scope's lifetime and lists it
+ * among the live queries. Whatever it still holds is released at the end.
+ */
+class MemoryScope {
+private:
+  QueryMemory account;
+  QueryMemory *previous;
+
+public:
+  explicit MemoryScope(const std::string &query);
+  ~MemoryScope();
+
+  MemoryScope(const MemoryScope &) = delete;
+  MemoryScope &operator=(const MemoryScope &) = delete;
+
+  QueryMemory &get() { return account; }
+};
+
+/**
+ * Charges what the calling thread reserves to another thread's statement
+ * for the scope's lifetime, e.g. while it runs a fragment of that
+ * statement on the thread pool (nullptr = to no statement)
+ */
+class MemoryAccountScope {
+private:
+  QueryMemory *previous;
+
+public:
+  explicit MemoryAccountScope(QueryMemory *account);
+  ~MemoryAccountScope();
+
+  MemoryAccountScope(const MemoryAccountScope &) = delete;
+  MemoryAccountScope &operator=(const MemoryAccountScope &) = delete;
+};
+
+/**
+ * Memory an operator reserves while it works, released when the
+ * reservation is destroyed. It charges the account of the statement
+ * that created it, from any thread.
+ */
+class MemoryReservation {
+private:
+  QueryMemory *account; // nullptr outside a statement: nothing is counted
+  size_t bytes;
+
+public:
+  MemoryReservation() : account(currentMemory()), bytes(0) {}
+  ~MemoryReservation() { resize(0); }
+
+  MemoryReservation(const MemoryReservation &) = delete;
+  MemoryReservation &operator=(const MemoryReservation &) = delete;
+
+  /**
+   * Grow or shrink the reservation to `total` bytes
+   * @return false (reservation unchanged) if growing would exceed a limit
+   */
+  bool resize(size_t total);
+
+  size_t size() const { return bytes; }
+};
+
+/**
+ * Reserve bytes for the current statement until it ends, e.g. for rows
+ * its result keeps (always succeeds outside a statement)
+ * @param what  What needs the memory, for the error message
+ * @param error Set to a description of the limit on failure
+ */
+bool reserveMemory(size_t bytes, const std::string &what, std::string &error);
+
+/**
+ * Count bytes the current statement has allocated until it ends (no-op
+ * outside one)
+ */
+void chargeMemory(size_t bytes);
+
+/**
+ * Bytes the current statement can still reserve (SIZE_MAX outside one
+ * or without limits)
+ */
+size_t availableMemory();
+
+/**
+ * Error message for `what` needing `bytes` in all, which a reservation
+ * could not get
+ */
+std::string memoryLimitError(const std::string &what, size_t bytes);
+
+// A running statement, as SHOW MEMORY lists it
+struct LiveQuery {
+  uint64_t id;
+  std::string query;
+  size_t used;
+  size_t peak;
+};
+
+/**
+ * The statements running now, oldest first
+ */
+std::vector<LiveQuery> liveQueries();
+
+/**
+ * Bytes all running statements hold together
+ */
+size_t globalQueryMemory();
+
+/**
+ * "512 B", "12.0 KiB", "1.5 MiB", ...
+ */
+std::string formatBytes(size_t bytes);
+
+} // namespace MiniSQL
+
+#endif // MEMORY_TRACKER_H
@@ -0,0 +1,167 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: metrics.h
+ * Description: Per-Statement Instrumentation and Process-Wide Totals
+ *
+ * Every statement is measured, whether or not anyone asks: the time spent
+ * in each compiler phase, the rows the WHERE filter examined and kept,
+ * the rows returned or affected, the bytes the statement allocated for
+ * its parse tree and row selections, and the access path the executor
+ * chose. EXPLAIN ANALYZE prints the numbers of one statement; the
+ * interactive "metrics" command prints the totals of all statements.
+ *
+ * The cost is a few clock reads and counter additions per statement. The
+ * statement being measured is bound to its thread (MetricsScope), so the
+ * layers that count do not pass anything around, and concurrent sessions
+ * of a server (see server.h) each count their own statement. When a
+ * statement ends its numbers are added to the totals with relaxed
+ * atomics.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MiniSQL {
+
+// Timed phases of a statement
+enum class Phase { LEX, PARSE, SEMANTIC, EXECUTE };
+const size_t PHASE_COUNT = 4;
+
+std::string phaseToString(Phase phase);
+
+// How the rows of a statement were found
+enum class AccessPath {
+  NONE,          // No table was read (INSERT, CREATE INDEX)
+  ALL_ROWS,      // No WHERE clause: every row, nothing evaluated
+  FULL_SCAN,     // WHERE evaluated over every row
+  PARALLEL_SCAN, // FULL_SCAN, its morsels run on the thread pool
+  INDEX          // Index lookup, remaining conditions checked per candidate
+};
+
+struct QueryMetrics {
+  uint64_t phaseNanos[PHASE_COUNT];
+  bool planCached;         // Phases LEX..SEMANTIC were skipped
+  uint64_t rowsScanned;    // Rows the WHERE filter examined
+  uint64_t rowsMatched;    // Rows that satisfied it
+  uint64_t rowsEmitted;    // Rows returned (SELECT, as they are read from
+                           // its cursor) or affected
+  uint64_t bytesAllocated; // Parse tree, row selections and match flags
+  AccessPath access;
+  std::string indexName;   // When access == INDEX
+
+  QueryMetrics() { clear(); }
+
+  void clear();
+
+  uint64_t totalNanos() const;
+
+  // "full table scan", "index lookup using 'idx_age'", ...
+  std::string accessDescription() const;
+
+  // Add another statement's counters (phases included) to this one
+  void add(const QueryMetrics &other);
+};
+
+/**
+ * Metrics of the statement running on this thread (nullptr outside one)
+ */
+QueryMetrics *currentMetrics();
+
+/**
+ * Measures one statement on the calling thread for the scope's lifetime.
+ * When it ends, its counters are added to the enclosing scope if one is
+ * active, and to the process-wide totals otherwise, so a statement run
+ * inside another (EXPLAIN ANALYZE) is counted once.
+ */
+class MetricsScope {
+private:
+  QueryMetrics metrics;
+  QueryMetrics *previous;
+
+public:
+  MetricsScope();
+  ~MetricsScope();
+
+  MetricsScope(const MetricsScope &) = delete;
+  MetricsScope &operator=(const MetricsScope &) = delete;
+
+  QueryMetrics &get() { return metrics; }
+};
+
+/**
+ * Measures part of a statement that runs on another thread (e.g. a
+ * fragment on the thread pool) into `into` for the scope's lifetime. The
+ * counters are not published: the statement adds them to its own.
+ */
+class MetricsCapture {
+private:
+  QueryMetrics *previous;
+
+public:
+  explicit MetricsCapture(QueryMetrics &into);
+  ~MetricsCapture();
+
+  MetricsCapture(const MetricsCapture &) = delete;
+  MetricsCapture &operator=(const MetricsCapture &) = delete;
+};
+
+/**
+ * Adds the time until its end of scope to a phase of the current
+ * statement
+ */
+class PhaseTimer {
+private:
+  Phase phase;
+  std::chrono::steady_clock::time_point start;
+
+public:
+  explicit PhaseTimer(Phase p)
+      : phase(p), start(std::chrono::steady_clock::now()) {}
+  ~PhaseTimer();
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+};
+
+/**
+ * Record a WHERE evaluation of the current statement (no-op outside one)
+ * @param scanned Rows examined (index candidates, or the whole table)
+ * @param matched Rows kept
+ * @param bytes   Bytes allocated for selections and match flags
+ */
+void recordScan(uint64_t scanned, uint64_t matched, uint64_t bytes);
+
+/**
+ * Record the access path the current statement chose (no-op outside one)
+ */
+void recordAccess(AccessPath access, const std::string &indexName = "");
+
+/**
+ * Record rows returned by the current statement (no-op outside one)
+ */
+void recordEmitted(uint64_t rows);
+
+/**
+ * Record bytes allocated by the current statement (no-op outside one)
+ */
+void recordBytes(uint64_t bytes);
+
+/**
+ * Print the totals of all finished statements
+ */
+void printMetrics();
+
+/**
+ * Set all totals back to zero
+ */
+void resetMetrics();
+
+} // namespace MiniSQL
+
+#endif // METRICS_H
@@ -0,0 +1,34 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: output.h
+ * Description: Diagnostic Output Stream
+ *
+ * Every compiler phase reports its progress (phase banners, validation
+ * messages, execution status) through diag() instead of std::cout. In
+ * quiet batch mode diagnostics are disabled and diag() returns a stream
+ * that discards everything, so only query results are written.
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <ostream>
+
+namespace MiniSQL {
+
+/**
+ * Stream for phase diagnostics (std::cout, or a discarding stream)
+ */
+std::ostream &diag();
+
+/**
+ * Enable or disable phase diagnostics (enabled by default)
+ */
+void setDiagnostics(bool enabled);
+
+bool diagnosticsEnabled();
+
+} // namespace MiniSQL
+
+#endif // OUTPUT_H
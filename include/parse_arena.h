@@ -0,0 +1,93 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: parse_arena.h
+ * Description: Per-Query Bump Allocator for Parse Trees
+ *
+ * All parse tree nodes of a query, and the token texts they hold, are
+ * carved out of one arena by bumping a pointer. Nothing is freed
+ * individually: destroying (or resetting) the arena releases the whole
+ * tree in one step. The first few KiB live inside the arena object
+ * itself, so a typical statement parses without touching the heap.
+ *
+ * Only trivially destructible objects may be placed in an arena, since
+ * their destructors never run.
+ */
+
+#ifndef PARSE_ARENA_H
+#define PARSE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MiniSQL {
+
+class ParseArena {
+private:
+  static constexpr size_t INLINE_BYTES = 4096;
+  static constexpr size_t MIN_BLOCK_BYTES = 16384;
+
+  alignas(std::max_align_t) char inlineBlock[INLINE_BYTES];
+  std::vector<std::unique_ptr<char[]>> blocks; // Overflow blocks
+  char *cursor;
+  char *limit;
+  size_t nextBlockBytes;
+  size_t bytesUsed;
+
+  void *allocateSlow(size_t size, size_t align);
+
+public:
+  ParseArena();
+
+  ParseArena(const ParseArena &) = delete;
+  ParseArena &operator=(const ParseArena &) = delete;
+
+  /**
+   * Allocate uninitialized memory (align must be a power of two)
+   */
+  void *allocate(size_t size, size_t align) {
+    uintptr_t at = (reinterpret_cast<uintptr_t>(cursor) + align - 1) &
+                   ~static_cast<uintptr_t>(align - 1);
+    if (at + size > reinterpret_cast<uintptr_t>(limit))
+      return allocateSlow(size, align);
+    cursor = reinterpret_cast<char *>(at + size);
+    bytesUsed += size;
+    return reinterpret_cast<void *>(at);
+  }
+
+  /**
+   * Construct an object in the arena
+   */
+  template <typename T, typename... Args> T *make(Args &&...args) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "arena objects are never destroyed");
+    return new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Copy text into the arena
+   * @return a view of the copy, valid as long as the arena
+   */
+  std::string_view copy(std::string_view text);
+
+  /**
+   * Release everything allocated so far (the inline block is reused)
+   */
+  void reset();
+
+  /**
+   * Bytes handed out since construction or the last reset
+   */
+  size_t used() const { return bytesUsed; }
+};
+
+} // namespace MiniSQL
+
+#endif // PARSE_ARENA_H
@@ -17,14 +17,33 @@
  *
  * Our SQL Grammar:
  * ----------------
- * <query>        ::= SELECT <column_list> FROM <table_name> [<where_clause>] ;
- * <column_list>  ::= * | <column_name> { , <column_name> }*
- * <column_name>  ::= IDENTIFIER
+ * <query>        ::= SELECT <column_list> FROM <from_list> [<where_clause>]
+ *                    [<group_by>] [<order_by>] [LIMIT NUMBER] ;
+ * <from_list>    ::= <table_name> { , <table_name>
+ *                                 | JOIN <table_name> ON <or_expr> }*
+ * <column_list>  ::= * | <select_item> { , <select_item> }*
+ * <select_item>  ::= <column_name> | <function> ( <column_name> | * )
+ * <function>     ::= COUNT | SUM | AVG | MIN | MAX
+ * <group_by>     ::= GROUP BY <column_name> { , <column_name> }*
+ * <order_by>     ::= ORDER BY <sort_key> { , <sort_key> }*
+ * <sort_key>     ::= <select_item> [ASC | DESC]
+ * <column_name>  ::= IDENTIFIER | <table_name>.IDENTIFIER
  * <table_name>   ::= IDENTIFIER
  * <where_clause> ::= WHERE <condition>
  * <condition>    ::= <column_name> <rel_op> <value>
  * <rel_op>       ::= = | < | >
  * <value>        ::= IDENTIFIER | NUMBER | STRING_LITERAL
+ * <create_index> ::= CREATE INDEX [<index_name>] ON <table_name>
+ *                    [USING HASH | BTREE] ( <column_name> ) ;
+ * <insert>       ::= INSERT INTO <table_name> ( <column_list> )
+ *                    VALUES ( <values> ) { , ( <values> ) }* ;
+ * <copy>         ::= COPY <table_name> FROM STRING_LITERAL ;
+ * <analyze>      ::= ANALYZE <table_name> ;
+ * <show>         ::= SHOW MEMORY ;
+ * <partition>    ::= ALTER TABLE <table_name> PARTITION BY
+ *                    ( HASH ( <column_name> ) PARTITIONS NUMBER
+ *                    | RANGE ( <column_name> ) VALUES ( <values> ) ) ;
+ * <explain>      ::= EXPLAIN [ANALYZE] <statement>
  *
  * Responsibilities:
  * - Validate token sequence against SQL grammar
@@ -36,6 +55,7 @@
 #define PARSER_H
 
 #include "common.h"
+#include "parse_arena.h"
 #include <string>
 #include <vector>
 
@@ -43,14 +63,16 @@ namespace MiniSQL {
 
 class Parser {
 private:
-  std::vector<Token> tokens;         // Input token stream
+  const std::vector<Token> &tokens;  // Input token stream
+  ParseArena &arena;                 // Owns the parse tree
   std::vector<CompilerError> errors; // Syntax errors
   size_t current;                    // Current token index
+  int literalCount;                  // Literal values seen so far
 
   // Token navigation
-  Token peek() const;
-  Token previous() const;
-  Token advance();
+  const Token &peek() const;
+  const Token &previous() const;
+  const Token &advance();
   bool isAtEnd() const;
   bool check(TokenType type) const;
   bool match(TokenType type);
@@ -63,27 +85,44 @@ private:
   ParseTree parseQuery();
   ParseTree parseSelectClause();
   ParseTree parseColumnList();
+  ParseTree parseSelectItem();
   ParseTree parseFromClause();
   ParseTree parseWhereClause();
+  ParseTree parseGroupBy();
+  ParseTree parseOrderBy();
+  ParseTree parseLimit();
+  ParseTree parseOrExpr();
+  ParseTree parseAndExpr();
+  ParseTree parsePrimaryCondition();
   ParseTree parseCondition();
   ParseTree parseInsert();
   ParseTree parseUpdate();
   ParseTree parseDelete();
+  ParseTree parseCreateIndex();
+  ParseTree parseExplain();
+  ParseTree parseCopy();
+  ParseTree parseAnalyze();
+  ParseTree parseShow();
+  ParseTree parsePartition();
   ParseTree parseValueList();
 
   // Utility
-  Token consume(TokenType type, const std::string &message);
+  bool consume(TokenType type, const std::string &message);
+  ParseTree makeNode(NodeType type, std::string_view value = {});
+  ParseTree makeValueNode(const Token &token);
 
 public:
   /**
    * Constructor
-   * @param tokens Token stream from lexer
+   * @param tokens Token stream from lexer (must outlive the parser)
+   * @param arena  Arena that receives the parse tree's nodes and texts
    */
-  explicit Parser(const std::vector<Token> &tokens);
+  Parser(const std::vector<Token> &tokens, ParseArena &arena);
 
   /**
    * Parse the token stream and build parse tree
-   * @return Parse tree (nullptr if parsing failed)
+   * @return Parse tree, valid until the arena is reset or destroyed
+   *         (nullptr if parsing failed)
    */
   ParseTree parse();
 
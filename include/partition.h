@@ -0,0 +1,112 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: partition.h
+ * Description: Hash and Range Partitioning of Tables
+ *
+ *   ./sql_compiler --partition employees:hash:id:4
+ *   ./sql_compiler --partition employees:range:salary:50000,80000
+ *   ALTER TABLE employees PARTITION BY HASH (id) PARTITIONS 4;
+ *   ALTER TABLE employees PARTITION BY RANGE (salary) VALUES (50000, 80000);
+ *
+ * A partitioned table keeps its rows in partitions, each of them a table
+ * of its own inside the DataStore (named "<table>#<n>", see
+ * partitionName) with its own versions, indexes, statistics and log
+ * records. The partition of a row is decided by one column, the
+ * partition key:
+ * - HASH:  a hash of the key value, modulo the number of partitions
+ * - RANGE: ascending bounds; partition i holds the keys from bound i - 1
+ *          (inclusive) up to bound i (exclusive), the first partition
+ *          everything below the first bound, the last one everything
+ *          from the last bound on
+ * NULL keys go to the first partition. A row never changes partition:
+ * UPDATE may not assign the key.
+ *
+ * A SELECT on a partitioned table runs as one fragment per partition,
+ * each on a partition worker (partition_worker.h), and a coordinator
+ * merges what the fragments send (see executor.h). The WHERE filter
+ * decides which partitions need a fragment at all (prune): a comparison
+ * of the key with a literal selects the partitions that can hold a
+ * matching key, AND intersects the partitions of its operands and OR
+ * unites them.
+ */
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include "column_store.h"
+#include "filter.h"
+#include "symbol_table.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+// Most partitions a table may be split into
+const size_t MAX_PARTITIONS = 256;
+
+enum class PartitionMethod { HASH, RANGE };
+
+// How the rows of a table are split into partitions
+struct PartitionScheme {
+  PartitionMethod method;
+  std::string column;            // Partition key
+  int columnIndex;               // Its position in the table schema
+  ColumnType type;               // Its type
+  size_t count;                  // Number of partitions
+  std::vector<CellValue> bounds; // RANGE: count - 1 ascending bounds
+
+  PartitionScheme()
+      : method(PartitionMethod::HASH), columnIndex(-1),
+        type(ColumnType::INT), count(1) {}
+
+  /**
+   * Partition of a row by its key value
+   */
+  size_t partitionOf(const CellValue &key) const;
+
+  /**
+   * Partitions that may hold rows matching a bound WHERE filter, in
+   * ascending order (nullptr = no filter: all of them)
+   */
+  std::vector<size_t> prune(const BoundFilter *where) const;
+
+  /**
+   * "HASH (id) into 4 partitions", "RANGE (salary) at 50000, 80000
+   * into 3 partitions"
+   */
+  std::string describe() const;
+};
+
+/**
+ * Build a partitioning from its parts, as ALTER TABLE ... PARTITION BY
+ * gives them
+ * @param method "hash" or "range" (in any case)
+ * @param args   HASH: the number of partitions; RANGE: the bounds,
+ *               ascending
+ * @param error  Set to a description of the problem on failure
+ * @return false if the method, column, count or bounds are invalid
+ */
+bool makePartitionScheme(const TableInfo &schema, const std::string &method,
+                         const std::string &column,
+                         const std::vector<std::string> &args,
+                         PartitionScheme &out, std::string &error);
+
+/**
+ * Parse a partitioning as --partition gives it after the table name:
+ * "hash:<column>:<partitions>" or "range:<column>:<bound>,<bound>,..."
+ * @param error Set to a description of the problem on failure
+ * @return false if the method, column, count or bounds are invalid
+ */
+bool parsePartitionScheme(const TableInfo &schema, const std::string &text,
+                          PartitionScheme &out, std::string &error);
+
+/**
+ * Name of partition n of a table in the DataStore, e.g. "employees#2"
+ */
+std::string partitionName(const std::string &table, size_t partition);
+
+} // namespace MiniSQL
+
+#endif // PARTITION_H
@@ -0,0 +1,151 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: partition_worker.h
+ * Description: Workers Running the Fragments of Partitioned SELECTs
+ *
+ * A SELECT on a partitioned table (partition.h) runs as one fragment per
+ * partition its filter may match. The coordinator
+ * (Executor::executePartitioned) describes what every fragment computes
+ * in a FragmentTask, has a PartitionWorker run it on each partition, and
+ * merges the FragmentResults in partition order:
+ * - an aggregate SELECT: each fragment aggregates its own rows into
+ *   partial groups (aggregateRows with partialSpecs), merged by group key
+ *   (mergePartials)
+ * - otherwise: each fragment ships the output and ORDER BY columns of its
+ *   rows; with ORDER BY and LIMIT only its first LIMIT rows in that order
+ *
+ * The coordinator only talks to the worker, never to the partitions
+ * themselves. A task names columns instead of pointing at them, and a
+ * result is a table with the positions of its rows, so both could be sent
+ * to a worker in another process, holding the partitions there (its
+ * result a table of just the rows shipped). No such remote or
+ * out-of-process worker exists yet: the one worker in this tree,
+ * LocalPartitionWorker, runs fragments on the partitions of the
+ * DataStore in this process, so partitioning spreads a table over the
+ * cores of one machine, not over several. The coordinator runs the
+ * fragments of a statement on the thread pool, one per thread, so they
+ * run in parallel. A fragment scans, aggregates and sorts serially then:
+ * its own use of the pool finds it busy (thread_pool.h). Only a single
+ * fragment, e.g. after pruning, still scans in parallel.
+ */
+
+#ifndef PARTITION_WORKER_H
+#define PARTITION_WORKER_H
+
+#include "data_store.h"
+#include "memory_tracker.h"
+#include "metrics.h"
+#include "query_plan.h"
+#include "row_cursor.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+// One aggregate a fragment computes, by column name
+struct FragmentAggregate {
+  AggregateFn fn;
+  std::string column; // "*" for COUNT(*)
+  std::string name;   // Output column name, e.g. "SUM(salary)"
+
+  FragmentAggregate() : fn(AggregateFn::COUNT) {}
+};
+
+// What a fragment computes from the rows of its partition that match the
+// statement's filter
+struct FragmentTask {
+  // Partial aggregation: one row per group, the groupBy columns and then
+  // the partialSpecs of `aggregates`
+  bool aggregate;
+  std::vector<std::string> groupBy;
+  std::vector<FragmentAggregate> aggregates;
+
+  // Otherwise the rows, `columns` only: with orderBy the first `limit` of
+  // them in its order, else any `limit` of them
+  std::vector<std::string> columns;
+  std::vector<OrderKey> orderBy;
+  size_t limit;
+
+  FragmentTask() : aggregate(false), limit(SIZE_MAX) {}
+};
+
+// What a fragment sends back to the coordinator
+struct FragmentResult {
+  // Partial groups: all rows of `table`. Rows: those of `table` at
+  // `positions`, the task's columns at `columns` of it. A local worker
+  // points into its partition, so the coordinator copies each cell once.
+  // (table is nullptr on failure)
+  TableSnapshot table;
+  std::vector<int> columns;
+  SelectionVector positions;
+  size_t inputRows;     // Rows aggregated (all that matched the filter)
+                        // or shipped
+  QueryMetrics metrics; // Its scans and allocations, added to the
+                        // statement's by the coordinator
+  std::string error;
+
+  FragmentResult() : inputRows(0) {}
+};
+
+/**
+ * Runs the fragments of one SELECT. A worker is created for a statement
+ * with its table, filter and the partitions it reads, and runs one
+ * fragment on each of them.
+ */
+class PartitionWorker {
+public:
+  virtual ~PartitionWorker() = default;
+
+  /**
+   * Run a fragment on one of the statement's partitions. Fragments on
+   * different partitions may run concurrently.
+   * @return false (with out.error set) on failure: aggregation errors as
+   *         aggregateRows reports them, others with what failed first
+   *         ("ORDER BY failed: ...")
+   */
+  virtual bool runFragment(size_t partition, const FragmentTask &task,
+                           FragmentResult &out) = 0;
+};
+
+/**
+ * A worker over the partitions of a DataStore in this process. It opens
+ * the statement's partitions when created, all of one state, so every
+ * fragment reads the same state of the table. Fragments charge their
+ * memory to the statement that created the worker, from any thread.
+ */
+class LocalPartitionWorker : public PartitionWorker {
+private:
+  std::vector<size_t> partitions;
+  std::vector<std::shared_ptr<RowCursor>> cursors; // One per partition
+  size_t sortMemory;
+  ThreadPool *pool;
+  QueryMemory *account;
+
+  bool aggregate(RowCursor &cursor, const FragmentTask &task,
+                 FragmentResult &out) const;
+  bool shipRows(std::shared_ptr<RowCursor> cursor, const FragmentTask &task,
+                FragmentResult &out) const;
+
+public:
+  /**
+   * @param where      The statement's filter (nullptr = all rows)
+   * @param partitions Partitions the statement reads
+   * @param access     How to find the rows, per listed partition (chosen
+   *                   with chooseAccess on partitionName)
+   */
+  LocalPartitionWorker(const DataStore &store, const std::string &tableName,
+                       const BoundFilter *where,
+                       const std::vector<size_t> &partitions,
+                       const std::vector<AccessPlan> &access);
+
+  bool runFragment(size_t partition, const FragmentTask &task,
+                   FragmentResult &out) override;
+};
+
+} // namespace MiniSQL
+
+#endif // PARTITION_WORKER_H
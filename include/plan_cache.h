@@ -0,0 +1,145 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: plan_cache.h
+ * Description: Compiled-Plan Cache Keyed by Normalized Query Text
+ *
+ * Most workloads repeat a few query shapes with different literals:
+ *   SELECT name FROM employees WHERE age > 30;
+ *   SELECT name FROM employees WHERE age > 41;
+ * Both normalize to the same key:
+ *   SELECT name FROM employees WHERE age > ?i;
+ *
+ * The first query of a shape goes through all compiler phases and its
+ * validated plan is stored under the key. Later queries of the same shape
+ * skip lexical, syntax and semantic analysis: the cached plan is copied
+ * and the new literals are bound into its parameter slots.
+ *
+ * Normalization is a single character scan that splits the query into
+ * tokens exactly like the Lexer does, so the n-th '?' in the key is the
+ * n-th literal token of the query. The character after each '?' records
+ * the kind of literal: 's' for a string, 'i' for a whole number and 'f'
+ * for a decimal one. Syntax and semantic analysis accept or reject a
+ * literal by its kind (LIMIT 'abc', a string into an INT column), so a
+ * plan is only reused for literals of the kinds it was validated with.
+ *
+ * The key is that token stream with one space between tokens: keywords
+ * are upper-cased and operators read the same however the query spaced
+ * them, so "select * from t where age>32" and
+ * "SELECT * FROM t WHERE age > 32" share a plan. Identifiers keep their
+ * case, contextual words such as ANALYZE or COUNT included, and so do
+ * identifier values such as "WHERE status = active".
+ *
+ * A shape that keeps coming back is worth compiling: from its
+ * COMPILE_THRESHOLD-th execution on, lookups return its plan marked hot,
+ * and the executor runs its WHERE filter as a compiled fused scan
+ * (compiled_filter.h) instead of interpreting it. A plain EXPLAIN runs
+ * nothing, so it never counts as an execution; its plan is hot when the
+ * statement it describes is, and shows how that statement runs now.
+ *
+ * The cache is shared by all sessions of a server (see server.h), so
+ * every member locks it.
+ */
+
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include "query_plan.h"
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MiniSQL {
+
+// Executions of a query shape (the one that cached it included) from
+// which its plans are hot
+const size_t COMPILE_THRESHOLD = 3;
+
+class PlanCache {
+private:
+  using LruList = std::list<std::string>; // Most recently used first
+
+  struct Entry {
+    QueryPlan plan;
+    LruList::iterator lruPos;
+    size_t executions; // Of the shape: its insert and every hit since,
+                       // unless they only EXPLAIN it
+  };
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, Entry> entries;
+  LruList lru;
+  size_t capacity;
+  size_t hits;
+  size_t misses;
+
+  // statementHot, with the mutex held
+  bool isStatementHot(const std::string &key, uint64_t catalogVersion) const;
+
+public:
+  explicit PlanCache(size_t capacity = 256);
+
+  /**
+   * Normalize a query: literals become '?s', '?i' or '?f', keywords are
+   * upper-cased and tokens separated by one space
+   * @param key    Normalized query text
+   * @param params Literal values in query order (strings without quotes)
+   * @return false if the query cannot be normalized (e.g. unterminated
+   *         string, or a '?' of its own that would read as a literal);
+   *         such queries are never cached
+   */
+  static bool normalize(const std::string &query, std::string &key,
+                        std::vector<std::string> &params);
+
+  /**
+   * Look up a plan and bind the given literals into a copy of it.
+   * A plan validated against another schema version is dropped. The
+   * plan is marked hot once its shape has run COMPILE_THRESHOLD times.
+   * @return true on a hit (out holds the bound plan)
+   */
+  bool lookup(const std::string &key, const std::vector<std::string> &params,
+              uint64_t catalogVersion, QueryPlan &out);
+
+  /**
+   * Store a validated plan under a normalized key
+   */
+  void insert(const std::string &key, const QueryPlan &plan);
+
+  /**
+   * Whether the statement a plain EXPLAIN describes is hot
+   * @param key Normalized text of the EXPLAIN ("EXPLAIN SELECT ...")
+   * @return false if the key is not a plain EXPLAIN, or the statement
+   *         has no plan of this schema version
+   */
+  bool statementHot(const std::string &key, uint64_t catalogVersion) const;
+
+  /**
+   * Remove all cached plans (e.g. after the schema changed)
+   */
+  void clear();
+
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+  }
+  size_t getHits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+  }
+  size_t getMisses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+  }
+
+  /**
+   * Print cache statistics
+   */
+  void printStats() const;
+};
+
+} // namespace MiniSQL
+
+#endif // PLAN_CACHE_H
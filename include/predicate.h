@@ -0,0 +1,93 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: predicate.h
+ * Description: Type-Bound WHERE Predicates
+ *
+ * A WHERE condition "column op literal" is bound once, before the scan:
+ * - The literal is converted to the column's declared type
+ *   (ColumnInfo::dataType), so rows are never parsed or re-converted
+ * - A scan kernel specialized for (column type x operator) is selected,
+ *   so the inner loop has no string parsing, no operator dispatch and no
+ *   exceptions
+ *
+ * Kernels work one column chunk at a time and write one match flag per
+ * row (1 = row satisfies the condition). NULL cells never match.
+ */
+
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include "column_store.h"
+#include "symbol_table.h"
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+// Relational operator of a condition
+enum class CompareOp { EQ, NE, LT, LE, GT, GE };
+
+/**
+ * Convert an operator token ("=", "!=", "<", "<=", ">", ">=")
+ * @return false if the text is not a relational operator
+ */
+bool compareOpFromString(const std::string &op, CompareOp &out);
+
+// Operator token of a CompareOp
+std::string compareOpToString(CompareOp op);
+
+// How the bound literal is compared against the stored values
+enum class CompareMode {
+  INT,          // INT column, integer literal
+  FLOAT,        // FLOAT column, numeric literal
+  INT_AS_FLOAT, // INT column, fractional literal (e.g. age < 30.5)
+  VARCHAR,      // VARCHAR column, string literal
+  TEXT          // Numeric column, non-numeric literal: compare as text
+};
+
+struct BoundPredicate;
+
+// Scan kernel: evaluate the predicate over the first `count` rows of a chunk
+using ChunkScanFn = void (*)(const BoundPredicate &pred,
+                             const ColumnChunk &chunk, size_t count,
+                             uint8_t *out);
+
+// A WHERE condition bound to one column of one table
+struct BoundPredicate {
+  int columnIndex;     // Position of the column in the table schema
+  std::string column;  // Column name (for messages)
+  CompareOp op;
+  CompareMode mode;
+  CellValue literal;   // Literal converted to the comparison type
+  std::string text;    // Literal as written in the query
+  ChunkScanFn scan;    // Kernel selected for (mode, op)
+
+  BoundPredicate()
+      : columnIndex(-1), op(CompareOp::EQ), mode(CompareMode::TEXT),
+        scan(nullptr) {}
+
+  /**
+   * Evaluate the predicate over every row of a column
+   * @param out One flag per row, resized to the column size
+   */
+  void evaluate(const Column &values, std::vector<uint8_t> &out) const;
+
+  /**
+   * Evaluate the predicate on a single row
+   */
+  bool matches(const Column &values, size_t row) const;
+};
+
+/**
+ * Bind "column op value" against a table schema
+ * @param error Set to a description of the problem when binding fails
+ * @return false if the column or operator is unknown
+ */
+bool bindPredicate(const TableInfo &schema, const std::string &column,
+                   const std::string &op, const std::string &value,
+                   BoundPredicate &out, std::string &error);
+
+} // namespace MiniSQL
+
+#endif // PREDICATE_H
@@ -0,0 +1,231 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: query_plan.h
+ * Description: Execution Plan Extracted from a Validated Parse Tree
+ *
+ * After semantic analysis, the Executor flattens the parse tree into a
+ * QueryPlan: the tables, columns, WHERE condition, assignments and values
+ * the statement needs. A plan does not depend on the parse tree, so it
+ * can be cached and executed again.
+ *
+ * Every literal (NUMBER or STRING_LITERAL token) in the query becomes a
+ * parameter slot, numbered in the order the literals appear in the query
+ * text. Re-running the plan with different literals only requires
+ * binding new parameter values (see plan_cache.h).
+ */
+
+#ifndef QUERY_PLAN_H
+#define QUERY_PLAN_H
+
+#include "index.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MiniSQL {
+
+enum class PlanType {
+  SELECT,
+  INSERT,
+  UPDATE,
+  DELETE,
+  CREATE_INDEX,
+  COPY,
+  ANALYZE,
+  SHOW_MEMORY,
+  PARTITION
+};
+
+inline std::string planTypeToString(PlanType type) {
+  switch (type) {
+  case PlanType::SELECT:
+    return "SELECT";
+  case PlanType::INSERT:
+    return "INSERT";
+  case PlanType::UPDATE:
+    return "UPDATE";
+  case PlanType::DELETE:
+    return "DELETE";
+  case PlanType::CREATE_INDEX:
+    return "CREATE INDEX";
+  case PlanType::COPY:
+    return "COPY";
+  case PlanType::ANALYZE:
+    return "ANALYZE";
+  case PlanType::SHOW_MEMORY:
+    return "SHOW MEMORY";
+  case PlanType::PARTITION:
+    return "ALTER TABLE";
+  }
+  return "UNKNOWN";
+}
+
+// EXPLAIN prefix of a statement: describe the plan instead of running
+// it, or run it and describe what happened
+enum class ExplainMode { NONE, PLAN, ANALYZE };
+
+// A value in a plan: its text, and the literal slot it came from
+struct PlanValue {
+  std::string text;
+  int param; // Literal slot (0-based), or -1 for an identifier value
+
+  PlanValue() : param(-1) {}
+  PlanValue(std::string_view t, int p) : text(t), param(p) {}
+};
+
+// Aggregate function of a SELECT list entry (NONE = plain column)
+enum class AggregateFn { NONE, COUNT, SUM, AVG, MIN, MAX };
+
+inline std::string aggregateFnToString(AggregateFn fn) {
+  switch (fn) {
+  case AggregateFn::NONE:
+    return "";
+  case AggregateFn::COUNT:
+    return "COUNT";
+  case AggregateFn::SUM:
+    return "SUM";
+  case AggregateFn::AVG:
+    return "AVG";
+  case AggregateFn::MIN:
+    return "MIN";
+  case AggregateFn::MAX:
+    return "MAX";
+  }
+  return "";
+}
+
+// Function of an upper-case name (NONE if it is not an aggregate)
+inline AggregateFn aggregateFnFromString(std::string_view name) {
+  for (AggregateFn fn : {AggregateFn::COUNT, AggregateFn::SUM,
+                         AggregateFn::AVG, AggregateFn::MIN,
+                         AggregateFn::MAX}) {
+    if (aggregateFnToString(fn) == name)
+      return fn;
+  }
+  return AggregateFn::NONE;
+}
+
+// ORDER BY key: a column, or an aggregate (fn != NONE; column "*" is the
+// argument of COUNT(*))
+struct OrderKey {
+  std::string column;
+  AggregateFn fn;
+  bool descending;
+
+  OrderKey() : fn(AggregateFn::NONE), descending(false) {}
+
+  // Display name, e.g. "salary" or "COUNT(*)"
+  std::string name() const {
+    if (fn == AggregateFn::NONE)
+      return column;
+    return aggregateFnToString(fn) + "(" + column + ")";
+  }
+};
+
+// WHERE expression: a "column op value" comparison, or an AND / OR of
+// nested expressions
+enum class PlanExprKind { CONDITION, AND, OR };
+
+struct PlanExpr {
+  PlanExprKind kind;
+
+  // CONDITION
+  std::string column;
+  std::string op;
+  PlanValue value;
+
+  // AND / OR operands, in query order
+  std::vector<PlanExpr> children;
+
+  PlanExpr() : kind(PlanExprKind::CONDITION) {}
+};
+
+struct QueryPlan {
+  PlanType type;
+  ExplainMode explain;
+  std::string table; // Lower-cased table name (the first one of a join)
+
+  // Multi-table SELECT: the other tables of the FROM clause, in order.
+  // Their ON conditions are part of `where`, ANDed with the WHERE clause;
+  // column names may be qualified (table.column), and an identifier
+  // value naming a column of the tables compares two columns.
+  std::vector<std::string> joins;
+
+  // SELECT projection / INSERT column list
+  std::vector<std::string> columns;
+  bool selectAll;
+
+  // SELECT with aggregates: the function of each entry of `columns`
+  // ("*" is the argument of COUNT(*)), or empty if there is none
+  std::vector<AggregateFn> aggregates;
+
+  // SELECT ... GROUP BY columns
+  std::vector<std::string> groupBy;
+
+  // SELECT ... ORDER BY keys, most significant first
+  std::vector<OrderKey> orderBy;
+
+  // SELECT ... LIMIT: the number of rows to return at most
+  bool hasLimit;
+  PlanValue limit;
+
+  // WHERE expression (SELECT, UPDATE, DELETE)
+  bool hasWhere;
+  PlanExpr where;
+
+  // UPDATE ... SET column = value, ...: one value per assigned column
+  std::vector<std::string> setColumns;
+  std::vector<PlanValue> setValues;
+
+  // INSERT ... VALUES (...), ...: the rows one after another, one value
+  // per column of `columns` each
+  std::vector<PlanValue> values;
+
+  // COPY ... FROM 'path'
+  PlanValue source;
+
+  // CREATE INDEX
+  std::string indexName;
+  IndexKind indexKind;
+
+  // ALTER TABLE ... PARTITION BY: "HASH" or "RANGE", the key in `columns`
+  // and the number of partitions or the bounds in `values`
+  std::string partitionMethod;
+
+  int paramCount; // Number of literal slots
+
+  uint64_t catalogVersion; // Schema version the plan was validated against
+
+  // Set by the plan cache once the plan's shape has run COMPILE_THRESHOLD
+  // times: its WHERE filter is compiled (compiled_filter.h)
+  bool hot;
+
+  QueryPlan()
+      : type(PlanType::SELECT), explain(ExplainMode::NONE), selectAll(false),
+        hasLimit(false), hasWhere(false), indexKind(IndexKind::ORDERED), paramCount(0),
+        catalogVersion(0), hot(false) {}
+
+  // Whether the SELECT computes aggregates (one row per group)
+  bool isAggregate() const { return !aggregates.empty() || !groupBy.empty(); }
+
+  /**
+   * Display name of output column i, e.g. "SUM(salary)"
+   */
+  std::string outputName(size_t i) const {
+    if (aggregates.empty() || aggregates[i] == AggregateFn::NONE)
+      return columns[i];
+    return aggregateFnToString(aggregates[i]) + "(" + columns[i] + ")";
+  }
+
+  /**
+   * Replace every literal slot with the matching parameter value
+   * @return false if the number of parameters does not match
+   */
+  bool bindParameters(const std::vector<std::string> &params);
+};
+
+} // namespace MiniSQL
+
+#endif // QUERY_PLAN_H
@@ -0,0 +1,79 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: result_writer.h
+ * Description: Buffered Machine-Readable Result Output
+ *
+ * In quiet batch mode, SELECT results are written by a ResultWriter
+ * instead of the boxed console table:
+ * - CSV:   header line, then one line per row (RFC 4180 quoting)
+ * - TSV:   header line, then one line per row (\t, \n, \\ escaped)
+ * - JSONL: one JSON object per row, keyed by column name
+ *
+ * CSV and TSV result sets are separated by an empty line. NULL cells
+ * are written as an empty field (CSV), \N (TSV) or null (JSONL).
+ *
+ * Rows are pulled from the result's cursor and written as they arrive,
+ * so a result of any size is exported in bounded memory. Output is
+ * collected in a memory buffer and written with one fwrite whenever the
+ * buffer fills, so a large batch makes few system calls.
+ */
+
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include "executor.h"
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace MiniSQL {
+
+enum class OutputFormat { CSV, TSV, JSONL };
+
+/**
+ * Parse a format name ("csv", "tsv", "jsonl")
+ * @return false if the name is unknown
+ */
+bool outputFormatFromString(const std::string &name, OutputFormat &out);
+
+class ResultWriter {
+private:
+  FILE *out;
+  OutputFormat format;
+  std::string buffer;
+  size_t bufferLimit;
+  size_t resultSets; // Result sets written so far
+
+  void appendField(std::string_view text);
+  void appendJsonString(std::string_view text);
+  void appendCell(const QueryResult &result, RowId row, size_t col);
+
+public:
+  /**
+   * @param out         Destination (not closed by the writer)
+   * @param bufferLimit Bytes collected before the buffer is written out
+   */
+  ResultWriter(FILE *out, OutputFormat format,
+               size_t bufferLimit = size_t(1) << 16);
+  ~ResultWriter();
+
+  ResultWriter(const ResultWriter &) = delete;
+  ResultWriter &operator=(const ResultWriter &) = delete;
+
+  /**
+   * Write the rows of a SELECT result (other results write nothing),
+   * reading its cursor to the end
+   * @return number of rows written
+   */
+  size_t write(const QueryResult &result);
+
+  /**
+   * Write out everything buffered so far
+   */
+  void flush();
+};
+
+} // namespace MiniSQL
+
+#endif // RESULT_WRITER_H
@@ -0,0 +1,176 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: row_cursor.h
+ * Description: Pull-Based Iteration over the Rows of a Result
+ *
+ * A SELECT does not collect its rows up front. It returns a RowCursor,
+ * and whoever outputs the result (console table, result writer, server
+ * reply) pulls the row positions from it batch by batch: in table order,
+ * or in index order when an index supplied them.
+ * The WHERE filter is evaluated one window of morsels at a time as the
+ * rows are pulled, so:
+ * - Memory stays bounded by one window, whatever the size of the result
+ * - The first rows can be written as soon as the first window is done
+ *
+ * A window holds a few morsels per thread of the pool and is evaluated
+ * in parallel. When an index supplies the candidate rows they are looked
+ * up when the cursor is opened, and the rest of the filter is checked
+ * per batch of candidates.
+ *
+ * Rows deleted but not yet compacted away (data_store.h) are skipped;
+ * index candidates never include them.
+ *
+ * A sorted result (sort.h) supplies its rows from a RowSource of its own,
+ * in sort order. LIMIT caps the rows a cursor returns: once they have
+ * been returned nothing more is read, so the rest of the table is never
+ * scanned.
+ *
+ * The cursor holds the snapshot the rows are read from, so the result
+ * stays consistent while the table is modified. A cursor is read once,
+ * by one thread; scan counts and returned rows are added to the metrics
+ * of the statement on that thread (metrics.h).
+ */
+
+#ifndef ROW_CURSOR_H
+#define ROW_CURSOR_H
+
+#include "data_store.h"
+#include <cstddef>
+#include <memory>
+
+namespace MiniSQL {
+
+// Rows supplied in an order of their own, e.g. sorted (sort.h)
+class RowSource {
+public:
+  virtual ~RowSource() = default;
+
+  /**
+   * Append the next rows, at most `max` of them, to out
+   * @return false once every row has been supplied
+   */
+  virtual bool read(SelectionVector &out, size_t max) = 0;
+};
+
+class RowCursor {
+private:
+  enum class Source {
+    ALL,        // Every row, nothing evaluated
+    SCAN,       // Rows matching `where`, evaluated window by window
+    CANDIDATES, // Index candidates, checked against `where` if residual
+    ORDERED     // Rows from `ordered`, in its order
+  };
+
+  TableSnapshot table;
+  Source source;
+  BoundFilter where;
+  bool residual;              // CANDIDATES: check `where` per candidate
+  ThreadPool *pool;           // SCAN: evaluates windows (nullptr = serial)
+  SelectionVector candidates; // CANDIDATES
+  std::unique_ptr<RowSource> ordered; // ORDERED
+  size_t position;            // Next row, morsel or candidate to read
+  bool exhausted;             // Every row of the source has been read
+  SelectionVector ahead;      // Read by prefetch(), not yet returned
+  size_t returnedRows;
+  size_t limit; // Rows next() returns at most
+
+  // Rows next() may still return
+  size_t remaining() const { return limit - returnedRows; }
+
+  // Append the rows of the next window to out
+  void readWindow(SelectionVector &out);
+
+public:
+  /**
+   * Every row of a table
+   */
+  explicit RowCursor(TableSnapshot table);
+
+  /**
+   * Positions 0 .. rows - 1 of a result that is not a table, e.g. the
+   * tuples of a join (join.h); getTable() has no columns
+   */
+  explicit RowCursor(size_t rows);
+
+  /**
+   * The rows of a table matching a filter
+   * @param pool Evaluates the morsels of a window (nullptr = serial)
+   */
+  RowCursor(TableSnapshot table, BoundFilter where, ThreadPool *pool);
+
+  /**
+   * Candidate rows, e.g. from an index lookup, returned in their order
+   * @param residual Check `where` on every candidate (false = all match)
+   */
+  RowCursor(TableSnapshot table, SelectionVector candidates,
+            BoundFilter where, bool residual);
+
+  /**
+   * Rows of a table in the order a source supplies them, e.g. sorted
+   */
+  RowCursor(TableSnapshot table, std::unique_ptr<RowSource> source);
+
+  RowCursor(const RowCursor &) = delete;
+  RowCursor &operator=(const RowCursor &) = delete;
+
+  const TableSnapshot &getTable() const { return table; }
+
+  /**
+   * Return at most `rows` rows (LIMIT): reading stops at the window in
+   * which they are found
+   */
+  void setLimit(size_t rows) { limit = rows; }
+
+  /**
+   * Get the next batch of row positions (replacing the contents of rows)
+   * @return false, with rows empty, once every row has been returned
+   */
+  bool next(SelectionVector &rows);
+
+  /**
+   * Read ahead until `rows` rows are buffered or the result ends. The
+   * buffered rows are still returned by next(); until then they can be
+   * inspected with buffered(), e.g. to size the columns of a table.
+   * @return true if the whole rest of the result is buffered
+   */
+  bool prefetch(size_t rows);
+
+  const SelectionVector &buffered() const { return ahead; }
+
+  /**
+   * True once every row has been read from the table: the rows not yet
+   * returned are exactly the buffered ones
+   */
+  bool complete() const {
+    return exhausted || ahead.size() >= remaining();
+  }
+
+  /**
+   * Rows returned by next() so far
+   */
+  size_t returned() const { return returnedRows; }
+
+  /**
+   * Read the rest of the result without returning it
+   * @return total number of rows in the result
+   */
+  size_t count();
+
+  /**
+   * Read the rest of the rows into `rows`, e.g. as the input of a join.
+   * They are not counted as returned by the statement, nor limited.
+   */
+  void readAll(SelectionVector &rows);
+
+  /**
+   * Read the next batch of rows like readAll(), e.g. as the input of a
+   * sort, which keeps only one batch at a time
+   * @return false, with rows empty, once every row has been read
+   */
+  bool readNext(SelectionVector &rows);
+};
+
+} // namespace MiniSQL
+
+#endif // ROW_CURSOR_H
@@ -20,9 +20,17 @@
  *
  * For our mini SQL compiler, we validate:
  * - Table names exist in the schema
- * - Column names exist in the specified table
+ * - Column names exist in the specified table; in a multi-table SELECT,
+ *   in exactly one of its tables unless qualified (table.column)
+ * - Columns compared with each other (join conditions) have comparable
+ *   types
  * - WHERE clause columns are valid
  * - Basic type compatibility in conditions
+ * - INSERT values: one per column in every row, each of its column's type
+ * - Aggregates: known functions, SUM/AVG of numeric columns only, and
+ *   every plain SELECT column listed in GROUP BY
+ * - ORDER BY: columns of the tables (of GROUP BY when grouping) or
+ *   aggregates of a grouped SELECT; LIMIT: a whole number of rows
  */
 
 #ifndef SEMANTIC_H
@@ -37,22 +45,48 @@ namespace MiniSQL {
 
 class SemanticAnalyzer {
 private:
-  SymbolTable symbolTable;
+  Catalog symbolTable; // Shared, read-only schema
   std::vector<CompilerError> errors;
 
   std::string currentTable;                 // Table being queried
+  std::vector<std::string> fromTables;      // Every table of the FROM
+                                            // clause, in order
   std::vector<std::string> selectedColumns; // Columns in SELECT
+  bool selectAll;                           // SELECT *
+  bool hasAggregates;                       // SELECT has an aggregate
 
   // Validation methods
   void validateQuery(const ParseTree &node);
   void validateSelectClause(const ParseTree &node);
+  void validateAggregate(const ParseTree &node);
+  void validateGroupBy(const ParseTree &node);
+  void validateOrderBy(const ParseTree &node, const ParseTree &groupBy);
+  void validateLimit(const ParseTree &node);
   void validateFromClause(const ParseTree &node);
   void validateWhereClause(const ParseTree &node);
   void validateCondition(const ParseTree &node);
   void validateColumn(const std::string &columnName, int line, int col);
+
+  // Schema entry of a column reference ("column" or "table.column") among
+  // the tables of the statement; nullptr if it names no column, or an
+  // unqualified column of several tables
+  const ColumnInfo *findColumn(const std::string &name) const;
+
+  // Whether a name is a column reference: qualified, or a column of one of
+  // the tables (even if ambiguous)
+  bool namesColumn(const std::string &name) const;
+
+  // Tables a column reference is looked up in (the one it is qualified
+  // with, or all of them); sets column to the unqualified name
+  std::vector<std::string> lookupTables(const std::string &name,
+                                        std::string &column) const;
   void validateInsert(const ParseTree &node);
   void validateUpdate(const ParseTree &node);
   void validateDelete(const ParseTree &node);
+  void validateCreateIndex(const ParseTree &node);
+  void validateCopy(const ParseTree &node);
+  void validateAnalyze(const ParseTree &node);
+  void validatePartition(const ParseTree &node);
 
   // Error reporting
   void reportError(const std::string &message, int line = 1, int col = 1);
@@ -60,8 +94,9 @@ private:
 public:
   /**
    * Constructor
+   * @param catalog Schema to validate against (shared, not copied)
    */
-  SemanticAnalyzer();
+  explicit SemanticAnalyzer(Catalog catalog);
 
   /**
    * Perform semantic analysis on the parse tree
@@ -0,0 +1,180 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: server.h
+ * Description: TCP Server with Pipelined Statements
+ *
+ * With --serve <port>, one process keeps the schema, data store and plan
+ * cache alive and answers statements from any number of connections.
+ * An epoll event loop owns all sockets; statements run on a pool of
+ * worker threads. Statements of one connection run one after another
+ * and are answered in order; different connections run in parallel
+ * (readers on MVCC snapshots, see data_store.h).
+ *
+ * Clients may pipeline: send many requests without waiting, then read
+ * the responses. All integers are little-endian.
+ *
+ * Request:  u32 length, then that many bytes of SQL text (one statement)
+ *
+ * Response: a sequence of frames, each u32 length (of the kind byte and
+ * the payload), u8 kind, payload:
+ *   'H' columns: u16 count; per column u8 type (0 INT, 1 FLOAT,
+ *       2 VARCHAR), u16 name length, name
+ *   'D' rows:    u32 count; per row a NULL bitmap of (columns + 7) / 8
+ *       bytes (bit c set = column c is NULL), then every non-NULL value:
+ *       INT i64, FLOAT f64 (IEEE 754), VARCHAR u32 length + bytes
+ *   'K' done:    u8 success, u64 rows (returned or affected),
+ *       u32 message length, message (the error when success = 0)
+ * A SELECT is answered by H, zero or more D, then K; every other
+ * statement (including one that fails to compile) by K alone.
+ *
+ * Rows are sent in batches as they are read from the result's cursor,
+ * so the first rows of a large result arrive before the scan has found
+ * the last ones, and a reply never holds more than a batch. A
+ * connection whose client stops reading holds its worker once its
+ * unsent output exceeds SERVER_OUTPUT_LIMIT.
+ *
+ * Input is bounded the same way: once a connection has
+ * SERVER_MAX_PENDING requests, or SERVER_INPUT_LIMIT bytes of them,
+ * waiting to run, the server stops reading from it until its worker has
+ * worked the queue down, and the client's sends block in TCP.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "executor.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace MiniSQL {
+
+const size_t SERVER_MAX_REQUEST = size_t(16) << 20; // Longest statement
+const size_t SERVER_OUTPUT_LIMIT = size_t(4) << 20; // Unsent bytes/client
+const size_t SERVER_MAX_PENDING = 1024; // Queued requests/client
+const size_t SERVER_INPUT_LIMIT = size_t(32) << 20; // Queued bytes/client
+
+/**
+ * Encodes the response frames of one statement (see above). Frames are
+ * collected in a buffer that is handed to the connection whenever it
+ * grows past a batch, and by finish().
+ */
+class ReplyWriter {
+private:
+  std::string buffer;
+  std::function<void(std::string &)> send; // Takes the buffered bytes
+
+  size_t beginFrame(char kind);
+  void endFrame(size_t start);
+
+public:
+  explicit ReplyWriter(std::function<void(std::string &)> send);
+
+  /**
+   * Write the column and row frames of a SELECT result (other results
+   * write nothing)
+   */
+  void writeRows(const QueryResult &result);
+
+  /**
+   * Write the final frame of the statement and send everything buffered
+   */
+  void finish(bool success, uint64_t rows, const std::string &message);
+};
+
+class Server {
+public:
+  // Runs one statement and writes its response
+  using Handler = std::function<void(const std::string &sql,
+                                     ReplyWriter &reply)>;
+
+private:
+  struct Connection {
+    int fd;
+    std::string input; // Received bytes of incomplete requests (loop only)
+
+    std::mutex mutex; // Guards the members below
+    std::condition_variable drained;
+    std::deque<std::string> pending; // Statements not yet run
+    size_t pendingBytes;             // Their total length
+    std::string output;              // Response bytes not yet sent
+    bool running;    // A worker runs its statements
+    bool waiting;    // Output waits for the socket to become writable
+    bool peerClosed; // No more requests will arrive
+    bool broken;     // Socket failed: drop all statements and output
+
+    uint32_t events; // Events registered with epoll (loop only)
+
+    explicit Connection(int fd)
+        : fd(fd), pendingBytes(0), running(false), waiting(false),
+          peerClosed(false), broken(false), events(0) {}
+
+    // Enough requests are queued: stop reading more (mutex held)
+    bool inputFull() const {
+      return pending.size() >= SERVER_MAX_PENDING ||
+             pendingBytes >= SERVER_INPUT_LIMIT;
+    }
+  };
+  using ConnectionPtr = std::shared_ptr<Connection>;
+
+  std::string host;
+  int port;
+  size_t workerCount;
+  Handler handler;
+
+  int listenFd;
+  int epollFd;
+  int wakeFd; // eventfd: workers ask the loop to look at connections
+  std::unordered_map<int, ConnectionPtr> connections; // Loop thread only
+
+  std::mutex queueMutex;
+  std::condition_variable queueReady;
+  std::deque<ConnectionPtr> runQueue;     // Connections with statements
+  std::vector<ConnectionPtr> wakeQueue;   // Connections for the loop
+  bool stopping;
+  std::vector<std::thread> workers;
+
+  bool listenOn(std::string &error);
+  void acceptClients();
+  void readClient(const ConnectionPtr &conn);
+  void writeClient(const ConnectionPtr &conn);
+  void serviceWoken();
+  void updateConnection(const ConnectionPtr &conn);
+  void closeConnection(const ConnectionPtr &conn);
+  void workerLoop();
+  void runStatements(const ConnectionPtr &conn);
+  void queueOutput(const ConnectionPtr &conn, std::string &bytes);
+  bool flushLocked(Connection &conn);
+  void wakeLoop(const ConnectionPtr &conn);
+
+public:
+  /**
+   * @param host    Address to listen on ("127.0.0.1", "0.0.0.0", ...)
+   * @param port    TCP port (0 = any free port, printed on startup)
+   * @param workers Threads that run statements
+   */
+  Server(const std::string &host, int port, size_t workers, Handler handler);
+  ~Server();
+
+  Server(const Server &) = delete;
+  Server &operator=(const Server &) = delete;
+
+  /**
+   * Serve until SIGINT or SIGTERM
+   * @return false if the port cannot be opened
+   */
+  bool run(std::string &error);
+};
+
+} // namespace MiniSQL
+
+#endif // SERVER_H
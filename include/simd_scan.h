@@ -0,0 +1,56 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: simd_scan.h
+ * Description: Vectorized Comparison Kernels with Runtime Dispatch
+ *
+ * The hot loops of a WHERE scan compare a contiguous array of typed
+ * values against one literal. This module provides those loops for
+ * several instruction sets:
+ * - AVX-512 (F + BW): 64 rows per step, compare results as mask registers
+ * - AVX2:             32 rows per step
+ * - NEON (AArch64):   16 rows per step
+ * - Scalar:           portable fallback, also used for the tail rows
+ *
+ * The best set the CPU supports is picked once, on first use, from the
+ * CPUID feature bits. Setting the environment variable MINISQL_SIMD to
+ * "scalar", "avx2" or "avx512" selects a lower level instead (e.g. to
+ * compare results or timings); levels the CPU lacks are ignored.
+ *
+ * Every kernel writes one flag per row, the format the filter pipeline
+ * consumes: out[i] = 1 if row i is not NULL and satisfies the comparison.
+ */
+
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MiniSQL {
+
+// out[i] = nulls[i] == 0 && values[i] OP literal, for i < count
+using IntCompareFn = void (*)(const int64_t *values, const uint8_t *nulls,
+                              size_t count, int64_t literal, uint8_t *out);
+using FloatCompareFn = void (*)(const double *values, const uint8_t *nulls,
+                                size_t count, double literal, uint8_t *out);
+using CodeCompareFn = void (*)(const uint32_t *codes, const uint8_t *nulls,
+                               size_t count, uint32_t code, uint8_t *out);
+
+// Kernels of one instruction set; arrays are indexed by CompareOp
+struct ScanKernels {
+  const char *name;
+  IntCompareFn ints[6];
+  FloatCompareFn floats[6];
+  CodeCompareFn codesEqual;    // Dictionary code == code
+  CodeCompareFn codesNotEqual; // Dictionary code != code
+};
+
+/**
+ * Kernels for the best instruction set of this CPU (selected once)
+ */
+const ScanKernels &scanKernels();
+
+} // namespace MiniSQL
+
+#endif // SIMD_SCAN_H
@@ -0,0 +1,72 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: snapshot.h
+ * Description: Binary Columnar Table Snapshots
+ *
+ * A snapshot stores a table exactly as it is laid out in memory, so
+ * loading is a bounds-checked copy of each column chunk rather than a
+ * parse. One file per table (<dir>/<table>.snap, little-endian):
+ *
+ *   header   "MSQLSNAP", format version, flags, byte-order mark,
+ *            row count, log sequence number (version 2+),
+ *            COLUMN_CHUNK_ROWS, and each column's name and type
+ *   blocks   every chunk of column 0, then every chunk of column 1, ...
+ *            Each block: codec, row count, raw size, stored size,
+ *            checksum of the raw bytes, then the payload:
+ *              null flags (1 byte per row)
+ *              INT/FLOAT: 8 bytes per row
+ *              VARCHAR:   dictionary codes (4 bytes per row), entry
+ *                         count, entry offsets and string bytes
+ *   deleted  (version 3+) count and positions of the rows deleted but
+ *            not yet compacted away, which keep their positions
+ *   trailer  "MSQLEND!"
+ *
+ * With compression enabled, each block is LZ-compressed (compression.h)
+ * and stored compressed only if that makes it smaller. Snapshots are
+ * written to a temporary file and renamed into place, so a failed save
+ * never damages the previous snapshot. A snapshot is rejected on load if
+ * its version, schema or any checksum does not match.
+ *
+ * The log sequence number is the table's TableData::logSequence: the last
+ * write-ahead log record (wal.h) whose effect the snapshot contains.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "data_store.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MiniSQL {
+
+constexpr uint32_t SNAPSHOT_VERSION = 3;
+
+struct SnapshotStats {
+  size_t rows;        // Rows not deleted
+  size_t rawBytes;    // Column data before compression
+  size_t storedBytes; // Column data as stored in the file
+
+  SnapshotStats() : rows(0), rawBytes(0), storedBytes(0) {}
+};
+
+/**
+ * Write a table snapshot
+ * @param compress LZ-compress blocks that get smaller
+ */
+bool saveSnapshot(const std::string &path, const TableData &table,
+                  bool compress, SnapshotStats &stats, std::string &error);
+
+/**
+ * Replace the rows of a table with a snapshot's contents.
+ * Indexes are not touched; the caller rebuilds them.
+ * @return false (table unchanged) if the file is missing or invalid
+ */
+bool loadSnapshot(const std::string &path, TableData &table,
+                  SnapshotStats &stats, std::string &error);
+
+} // namespace MiniSQL
+
+#endif // SNAPSHOT_H
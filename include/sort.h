@@ -0,0 +1,105 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: sort.h
+ * Description: ORDER BY - Top-K Heap, Parallel and External Merge Sort
+ *
+ * SELECT name, salary FROM employees ORDER BY salary DESC LIMIT 10;
+ *
+ * A sort reads the positions of the rows to order from a cursor and
+ * returns a cursor over the same table that supplies them sorted. Each
+ * row becomes a 16-byte entry: its position and an order-preserving
+ * 64-bit prefix of its first key (an integer with the sign bit flipped,
+ * a float's bits made monotonic, the first 8 bytes of a string), so most
+ * comparisons are a single integer comparison; only equal prefixes read
+ * the key columns. Rows with equal keys keep the order of their
+ * positions, so the result does not depend on the number of threads.
+ *
+ * Three methods, by LIMIT and by the size of the input:
+ * - TOP_K: a small LIMIT keeps a bounded max-heap of the best LIMIT rows
+ *   while the input is read; memory is LIMIT entries, whatever the input
+ * - PARALLEL: the entries are sorted in memory, one range per thread of
+ *   the pool, and the sorted ranges are merged pairwise in parallel
+ * - EXTERNAL: when the entries exceed the memory budget, each
+ *   budget-sized run is sorted (in parallel) and spilled to a temporary
+ *   file. The runs are merged with a heap as the result is pulled, so
+ *   the sorted rows are never all in memory at once; with more runs than
+ *   the budget has merge buffers for, groups of runs are merged into
+ *   longer runs first.
+ *
+ * In-memory entries are reserved from the statement's memory account
+ * (memory_tracker.h) as a run grows; when the memory limits leave no
+ * more, the run is spilled early, so a limited sort goes external
+ * instead of failing.
+ *
+ * NULLs sort after every value (first with DESC).
+ */
+
+#ifndef SORT_H
+#define SORT_H
+
+#include "row_cursor.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MiniSQL {
+
+// A column the rows are sorted by: input position p is row rows[p] of
+// `column` (rows == nullptr: row p)
+struct SortKey {
+  const Column *column;
+  const RowId *rows;
+  bool descending;
+
+  SortKey() : column(nullptr), rows(nullptr), descending(false) {}
+};
+
+enum class SortMethod { TOP_K, PARALLEL, EXTERNAL };
+
+std::string sortMethodToString(SortMethod method);
+
+// Largest LIMIT sorted with a top-K heap
+const size_t TOP_K_MAX_ROWS = 65536;
+
+// What a sort did
+struct SortStats {
+  SortMethod method;
+  size_t rows;         // Rows read from the input
+  size_t runs;         // EXTERNAL: sorted runs spilled
+  size_t spilledBytes; // EXTERNAL: bytes written to temporary files
+  bool memoryLimited;  // EXTERNAL: runs were spilled early to stay within
+                       // the memory limits
+
+  SortStats() : method(SortMethod::PARALLEL), rows(0), runs(0),
+                spilledBytes(0), memoryLimited(false) {}
+};
+
+/**
+ * Method a sort starts with; a PARALLEL sort becomes EXTERNAL when its
+ * input turns out not to fit in memory
+ * @param limit Rows wanted (SIZE_MAX = all of them)
+ */
+SortMethod chooseSortMethod(size_t limit);
+
+/**
+ * Sort the rows an input cursor has not read yet
+ * @param keys   Sort keys, most significant first (at least one)
+ * @param limit  Rows wanted (SIZE_MAX = all of them)
+ * @param memory Bytes of entries sorted in memory before spilling
+ * @param pool   Sorts ranges and runs in parallel (nullptr = serial)
+ * @param out    Receives a cursor over the input's table, returning at
+ *               most `limit` of its rows, sorted
+ * @return false (with error set) if a temporary file failed, or a
+ *         top-K heap or the sorted result exceeds the memory limits
+ */
+bool sortRows(RowCursor &input, const std::vector<SortKey> &keys,
+              size_t limit, size_t memory, ThreadPool *pool,
+              std::shared_ptr<RowCursor> &out, SortStats &stats,
+              std::string &error);
+
+} // namespace MiniSQL
+
+#endif // SORT_H
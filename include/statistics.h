@@ -0,0 +1,129 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: statistics.h
+ * Description: Table Statistics for the Cost-Based Planner (ANALYZE)
+ *
+ * ANALYZE employees;
+ *
+ * reads every live row of a table once (one morsel per chunk, in parallel)
+ * and keeps, per column:
+ * - the number of NULLs and the exact minimum and maximum
+ * - the number of distinct values, estimated with a HyperLogLog sketch
+ *   (4096 one-byte registers, about 1.6% standard error, whatever the
+ *   table size)
+ * - an equi-depth histogram: bucket bounds such that about the same
+ *   number of values falls between each pair, taken from a systematic
+ *   sample of at most HISTOGRAM_SAMPLE values
+ * - the most common values of the sample with their frequencies
+ *
+ * The planner estimates from them what share of the rows a predicate
+ * keeps: equality from the frequent values or the distinct count, ranges
+ * by interpolating within a histogram bucket. Statistics are not updated
+ * as the table changes; estimates apply their fractions to the current
+ * row count until the table is analyzed again.
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include "column_store.h"
+#include "predicate.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MiniSQL {
+
+struct TableData;
+class ThreadPool;
+
+// Buckets of an equi-depth histogram
+const size_t HISTOGRAM_BUCKETS = 32;
+
+// Most values sampled for the histogram and the frequent values
+const size_t HISTOGRAM_SAMPLE = 32768;
+
+// Most frequent values kept per column
+const size_t FREQUENT_VALUES = 8;
+
+// ============================================================================
+// HYPERLOGLOG - Distinct-value estimate in fixed memory
+// ============================================================================
+class HyperLogLog {
+private:
+  static constexpr unsigned PRECISION = 12; // 2^12 registers
+  std::vector<uint8_t> registers;
+
+public:
+  HyperLogLog() : registers(size_t(1) << PRECISION, 0) {}
+
+  /**
+   * Add a value by its 64-bit hash (the bits must be well mixed)
+   */
+  void add(uint64_t hash) {
+    size_t index = hash >> (64 - PRECISION);
+    uint64_t rest = (hash << PRECISION) | (uint64_t(1) << (PRECISION - 1));
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > registers[index])
+      registers[index] = rank;
+  }
+
+  /**
+   * Add every value another sketch has seen
+   */
+  void merge(const HyperLogLog &other);
+
+  /**
+   * Estimated number of distinct values added
+   */
+  uint64_t estimate() const;
+};
+
+// A value that is frequent in a column, and its share of the non-NULL
+// values
+struct FrequentValue {
+  CellValue value;
+  double fraction;
+
+  FrequentValue() : fraction(0.0) {}
+};
+
+struct ColumnStats {
+  ColumnType type;
+  uint64_t nulls;    // NULL rows
+  uint64_t distinct; // Estimated distinct non-NULL values
+  CellValue min;     // NULL when the column has no value
+  CellValue max;
+  std::vector<CellValue> bounds; // Histogram bucket bounds, min first and
+                                 // max last (empty: no values)
+  std::vector<FrequentValue> frequent; // Most frequent first
+
+  ColumnStats() : type(ColumnType::VARCHAR), nulls(0), distinct(0) {}
+};
+
+struct TableStats {
+  uint64_t rows;                    // Live rows when analyzed
+  std::vector<ColumnStats> columns; // Same order as the schema
+
+  TableStats() : rows(0) {}
+};
+
+/**
+ * Collect the statistics of a table's live rows
+ * @param pool Analyzes the chunks in parallel (nullptr = serial)
+ */
+TableStats analyzeTable(const TableData &table, ThreadPool *pool);
+
+/**
+ * Estimated fraction of the rows of a table that satisfy a predicate
+ * bound to it
+ * @return false if the statistics cannot tell (e.g. a text comparison),
+ *         leaving fraction unchanged
+ */
+bool estimateSelectivity(const TableStats &stats, const BoundPredicate &pred,
+                         double &fraction);
+
+} // namespace MiniSQL
+
+#endif // STATISTICS_H
@@ -23,11 +23,19 @@
  * This allows us to validate:
  * - Whether a referenced table exists
  * - Whether columns exist in the specified table
+ *
+ * The schema is built once per session and shared read-only (as a
+ * std::shared_ptr<const SymbolTable>) by the SemanticAnalyzer and the
+ * DataStore. Every change to a SymbolTable bumps its version, so cached
+ * query plans can tell whether they were validated against the current
+ * schema.
  */
 
 #ifndef SYMBOL_TABLE_H
 #define SYMBOL_TABLE_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -48,26 +56,31 @@ struct ColumnInfo {
 struct TableInfo {
   std::string name;
   std::vector<ColumnInfo> columns;
+  std::unordered_map<std::string, int> columnPositions; // name -> position
 
   TableInfo() = default;
   TableInfo(const std::string &n) : name(n) {}
 
   void addColumn(const std::string &colName, const std::string &type) {
+    columnPositions.emplace(colName, static_cast<int>(columns.size()));
     columns.push_back(ColumnInfo(colName, type));
   }
 
   bool hasColumn(const std::string &colName) const {
-    for (const auto &col : columns) {
-      if (col.name == colName)
-        return true;
-    }
-    return false;
+    return columnPositions.count(colName) != 0;
+  }
+
+  // Position of a column in the schema, or -1 if it does not exist
+  int columnIndex(const std::string &colName) const {
+    auto it = columnPositions.find(colName);
+    return it == columnPositions.end() ? -1 : it->second;
   }
 };
 
 class SymbolTable {
 private:
   std::unordered_map<std::string, TableInfo> tables;
+  uint64_t version; // Incremented on every schema change
 
 public:
   /**
@@ -101,12 +114,20 @@ public:
    */
   std::vector<std::string> getTableNames() const;
 
+  /**
+   * Schema version; plans validated against another version are stale
+   */
+  uint64_t getVersion() const { return version; }
+
   /**
    * Print the symbol table (for debugging/demonstration)
    */
   void print() const;
 };
 
+// Shared, read-only schema used by all compiler phases
+using Catalog = std::shared_ptr<const SymbolTable>;
+
 } // namespace MiniSQL
 
 #endif // SYMBOL_TABLE_H
@@ -0,0 +1,87 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: thread_pool.h
+ * Description: Work-Stealing Thread Pool for Morsel-Driven Scans
+ *
+ * Scans split a table into morsels (one column chunk of COLUMN_CHUNK_ROWS
+ * rows each) and hand the morsel numbers to run(). Every thread starts on
+ * its own contiguous block of morsels, taking them from the front; a
+ * thread that runs out steals from the back of another thread's block, so
+ * a skewed filter does not leave threads idle. The calling thread works
+ * too, and run() returns only when every morsel is done.
+ *
+ * Results are kept per morsel by the caller and merged in morsel order,
+ * so parallel scans produce rows in the same order as serial ones.
+ *
+ * The pool runs one scan at a time. When several sessions scan at once
+ * (see server.h), a scan that finds the pool busy runs its morsels on its
+ * own thread instead of waiting; the sessions are parallel already.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MiniSQL {
+
+class ThreadPool {
+private:
+  // Morsels [begin, end) not yet taken from one thread's block
+  struct WorkQueue {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues; // [0] = calling thread
+  std::vector<std::thread> workers;
+
+  std::mutex runMutex; // Held by the caller of the current run
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+  const std::function<void(size_t)> *task; // Task of the current run
+  uint64_t generation;                     // Incremented by every run
+  size_t busy;                             // Workers inside the current run
+  std::atomic<size_t> pending;             // Morsels not yet finished
+  bool stopping;
+
+  void workerLoop(size_t self);
+  void drain(size_t self, const std::function<void(size_t)> &fn);
+  bool take(size_t self, size_t &morsel);
+
+public:
+  /**
+   * @param threads Total threads, including the one calling run()
+   *                (0 = one per hardware thread)
+   */
+  explicit ThreadPool(size_t threads);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return queues.size(); }
+
+  /**
+   * Run fn(0) .. fn(count - 1) across the pool and wait for all of them.
+   * Calls for different morsels may run concurrently. While another
+   * thread's run is in progress, the calls run serially on this thread.
+   */
+  void run(size_t count, const std::function<void(size_t)> &fn);
+};
+
+} // namespace MiniSQL
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,181 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: wal.h
+ * Description: Write-Ahead Log with Group Commit and Checkpoints
+ *
+ * Every successful INSERT, UPDATE and DELETE appends one record to an
+ * append-only log, so a session's changes survive a crash without
+ * rewriting any table. All files live in one log directory:
+ *
+ *   wal-<segment>.log   log segments, replayed in segment order
+ *   <table>.snap        checkpoint snapshots (snapshot.h)
+ *
+ * Records are written as they are appended, and a flusher thread makes
+ * them durable with fdatasync. A statement that waits for its commit is
+ * durable when commit() returns; all commits that arrive while a sync is
+ * in progress share the next one (group commit). Batch mode does not wait
+ * per statement: the log is synced in groups as the batch runs and once
+ * more before the batch completes.
+ *
+ * Each record carries a log sequence number (LSN). INSERT records hold
+ * the inserted values (a multi-row INSERT or COPY writes one record per
+ * COLUMN_CHUNK_ROWS rows); UPDATE and DELETE records hold the positions of
+ * the affected rows, so replay repeats exactly what the original
+ * statement did without re-evaluating its WHERE condition. Deleted rows
+ * keep their positions until a compaction, which renumbers the rows and
+ * is therefore logged as well.
+ *
+ * Checkpoints: once the log grows past a threshold, the tables are copied,
+ * the log switches to a new segment, and a background thread writes the
+ * copies as snapshots stamped with the current LSN. When every snapshot is
+ * in place, the older segments are deleted. Recovery loads the snapshots
+ * and replays, table by table, only the records newer than the table's
+ * snapshot, so a crash at any point of a checkpoint is safe.
+ *
+ * Torn records at the end of a segment (a crash during a write) fail
+ * their checksum and end that segment's replay. The DataStore appends
+ * and applies each change under its writer lock, so records are logged
+ * in the order the changes are applied, whichever session makes them.
+ */
+
+#ifndef WAL_H
+#define WAL_H
+
+#include "column_store.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MiniSQL {
+
+class DataStore;
+struct TableData;
+
+enum class LogRecordType : uint8_t {
+  INSERT = 1,      // columns + values
+  UPDATE = 2,      // Older logs: columns[0] = SET column, values[0] = new
+                   // value, rows
+  DELETE = 3,      // Older logs: rows, removed at once (positions before
+                   // the delete)
+  TRUNCATE = 4,    // all rows of the table
+  INSERT_ROWS = 5, // columns + values of several rows, one after another,
+                   // and nulls (one flag per value, or none)
+  UPDATE_SET = 6,  // columns + values (one per SET assignment), rows
+  DELETE_MARK = 7, // rows marked deleted (positions do not change)
+  COMPACT = 8      // deleted rows removed, the others renumbered in order
+};
+
+struct LogRecord {
+  uint64_t lsn;
+  LogRecordType type;
+  std::string table;
+  std::vector<std::string> columns;
+  std::vector<std::string> values;
+  std::vector<RowId> rows;
+  std::vector<uint8_t> nulls;
+
+  LogRecord() : lsn(0), type(LogRecordType::INSERT) {}
+};
+
+class WriteAheadLog {
+private:
+  std::string dir;
+  size_t checkpointBytes; // Log size that triggers a checkpoint
+  DataStore *attached;    // Store the log is attached to (open())
+
+  // Active segment (guarded by mutex)
+  int fd;
+  uint64_t segment;
+  uint64_t nextLsn;
+  uint64_t writtenLsn;         // Last LSN written to the segment
+  uint64_t durableLsn;         // Last LSN known to be on disk
+  size_t bytesSinceCheckpoint;
+  std::vector<uint8_t> encodeBuffer;
+
+  // Group commit
+  std::mutex mutex;
+  std::condition_variable syncRequested;
+  std::condition_variable syncDone;
+  std::thread flusher;
+  bool stopping;
+  bool failed;
+  size_t syncCount;
+  size_t recordCount;
+
+  // Background checkpoint
+  std::thread checkpointer;
+  std::atomic<bool> checkpointRunning;
+  size_t checkpointCount;
+
+  void flusherLoop();
+  bool openSegment(uint64_t number, std::string &error);
+  std::string segmentPath(uint64_t number) const;
+  std::vector<uint64_t> listSegments() const;
+  void writeCheckpoint(std::vector<TableData> tables, uint64_t lastSegment);
+
+public:
+  /**
+   * @param checkpointBytes Log bytes after which maybeCheckpoint() starts
+   *                        a checkpoint (0 = only explicit checkpoints)
+   */
+  WriteAheadLog(const std::string &dir, size_t checkpointBytes);
+
+  /**
+   * Detaches the log from its store, waits for a running checkpoint,
+   * syncs the log and stops the flusher
+   */
+  ~WriteAheadLog();
+
+  WriteAheadLog(const WriteAheadLog &) = delete;
+  WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+  /**
+   * Recover a data store from the directory (checkpoint snapshots, then
+   * every log record newer than them) and start a new segment for
+   * appending. The store must not have a log attached yet.
+   * @return false if the directory or the new segment cannot be created
+   */
+  bool open(DataStore &store, std::string &error);
+
+  /**
+   * Append a record and assign its LSN. The record is written to the
+   * segment but not yet durable; see commit().
+   */
+  uint64_t append(LogRecord &record);
+
+  /**
+   * Make all appended records durable
+   * @param wait Block until they are on disk (otherwise just wake the
+   *             flusher)
+   * @return false if a write or sync has failed
+   */
+  bool commit(bool wait);
+
+  /**
+   * Write a checkpoint of the store
+   * @param background Return once the tables are copied and let a thread
+   *                   write the snapshots
+   * @return false if a checkpoint is already running or it failed
+   */
+  bool checkpoint(const DataStore &store, bool background);
+
+  /**
+   * Start a background checkpoint when the log has outgrown the threshold
+   */
+  void maybeCheckpoint(const DataStore &store);
+
+  /**
+   * Print log statistics
+   */
+  void printStats();
+};
+
+} // namespace MiniSQL
+
+#endif // WAL_H
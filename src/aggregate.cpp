@@ -0,0 +1,490 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: aggregate.cpp
+ * Description: Hash Aggregation Implementation
+ */
+
+#include "../include/aggregate.h"
+#include "../include/memory_tracker.h"
+#include "../include/metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+
+namespace MiniSQL {
+
+namespace {
+
+// One value of a group key. INT and FLOAT values are kept as their bits;
+// a VARCHAR value is a view into its column chunk (valid while the input
+// snapshot is held) and its string hash.
+struct KeyCell {
+  uint64_t bits;
+  std::string_view text;
+  bool null;
+
+  bool operator==(const KeyCell &other) const {
+    return null == other.null && bits == other.bits && text == other.text;
+  }
+};
+
+KeyCell readKey(const Column &column, RowId row) {
+  KeyCell cell{0, std::string_view(), column.isNull(row)};
+  if (cell.null)
+    return cell;
+  switch (column.getType()) {
+  case ColumnType::INT:
+    cell.bits = static_cast<uint64_t>(column.getInt(row));
+    break;
+  case ColumnType::FLOAT: {
+    double value = column.getFloat(row);
+    if (value == 0.0)
+      value = 0.0; // -0.0 and 0.0 are one group
+    std::memcpy(&cell.bits, &value, sizeof(cell.bits));
+    break;
+  }
+  case ColumnType::VARCHAR:
+    cell.text = column.getString(row);
+    cell.bits = std::hash<std::string_view>()(cell.text);
+    break;
+  }
+  return cell;
+}
+
+// Running state of one aggregate in one group
+struct Accumulator {
+  int64_t count;        // Values seen (rows, for COUNT(*))
+  int64_t intValue;     // INT column: SUM, or MIN / MAX so far
+  double floatValue;    // FLOAT column: SUM, or MIN / MAX so far
+  std::string_view text; // VARCHAR column: MIN / MAX so far
+
+  Accumulator() : count(0), intValue(0), floatValue(0.0) {}
+};
+
+// Fold one value into an accumulator
+void accumulate(Accumulator &acc, AggregateFn fn, const Column *column,
+                RowId row) {
+  if (!column) {
+    acc.count++; // COUNT(*)
+    return;
+  }
+  if (column->isNull(row))
+    return;
+
+  bool first = acc.count++ == 0;
+  if (fn == AggregateFn::COUNT)
+    return;
+  bool less = fn == AggregateFn::MIN;
+  switch (column->getType()) {
+  case ColumnType::INT: {
+    int64_t value = column->getInt(row);
+    if (fn == AggregateFn::SUM || fn == AggregateFn::AVG)
+      acc.intValue += value;
+    else if (first || (less ? value < acc.intValue : value > acc.intValue))
+      acc.intValue = value;
+    break;
+  }
+  case ColumnType::FLOAT: {
+    double value = column->getFloat(row);
+    if (fn == AggregateFn::SUM || fn == AggregateFn::AVG)
+      acc.floatValue += value;
+    else if (first ||
+             (less ? value < acc.floatValue : value > acc.floatValue))
+      acc.floatValue = value;
+    break;
+  }
+  case ColumnType::VARCHAR: {
+    std::string_view value = column->getString(row);
+    if (first || (less ? value < acc.text : value > acc.text))
+      acc.text = value;
+    break;
+  }
+  }
+}
+
+// Fold the accumulator of a partial aggregate into another
+void mergeInto(Accumulator &acc, AggregateFn fn, const Column *column,
+               const Accumulator &other) {
+  if (other.count == 0)
+    return;
+  bool first = acc.count == 0;
+  acc.count += other.count;
+  if (!column || fn == AggregateFn::COUNT)
+    return;
+  bool less = fn == AggregateFn::MIN;
+  bool sum = fn == AggregateFn::SUM || fn == AggregateFn::AVG;
+  switch (column->getType()) {
+  case ColumnType::INT:
+    if (sum)
+      acc.intValue += other.intValue;
+    else if (first || (less ? other.intValue < acc.intValue
+                            : other.intValue > acc.intValue))
+      acc.intValue = other.intValue;
+    break;
+  case ColumnType::FLOAT:
+    if (sum)
+      acc.floatValue += other.floatValue;
+    else if (first || (less ? other.floatValue < acc.floatValue
+                            : other.floatValue > acc.floatValue))
+      acc.floatValue = other.floatValue;
+    break;
+  case ColumnType::VARCHAR:
+    if (first || (less ? other.text < acc.text : other.text > acc.text))
+      acc.text = other.text;
+    break;
+  }
+}
+
+// ============================================================================
+// GROUP TABLE - Open addressing from group key to group number
+// ============================================================================
+// Groups are numbered in the order they are first seen; their keys and
+// accumulators are stored in flat arrays, `width` key cells and
+// `aggregates` accumulators per group.
+class GroupTable {
+private:
+  size_t width;
+  size_t aggregates;
+  std::vector<uint32_t> slots; // Group + 1, 0 = empty
+  size_t mask;
+
+  void grow() {
+    std::vector<uint32_t> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, 0);
+    mask = slots.size() - 1;
+    for (uint32_t entry : old) {
+      if (entry == 0)
+        continue;
+      size_t slot = hashes[entry - 1] & mask;
+      while (slots[slot] != 0)
+        slot = (slot + 1) & mask;
+      slots[slot] = entry;
+    }
+  }
+
+public:
+  std::vector<KeyCell> keys;
+  std::vector<uint64_t> hashes;
+  std::vector<Accumulator> accumulators;
+
+  GroupTable(size_t keyWidth, size_t aggregateCount)
+      : width(keyWidth), aggregates(aggregateCount), slots(16, 0), mask(15) {}
+
+  size_t size() const { return hashes.size(); }
+
+  // Accumulators of the group with the given key, added if new
+  Accumulator *find(uint64_t hash, const KeyCell *key) {
+    size_t slot = hash & mask;
+    for (; slots[slot] != 0; slot = (slot + 1) & mask) {
+      size_t group = slots[slot] - 1;
+      if (hashes[group] == hash &&
+          std::equal(key, key + width, keys.begin() + group * width))
+        return &accumulators[group * aggregates];
+    }
+
+    size_t group = hashes.size();
+    slots[slot] = static_cast<uint32_t>(group + 1);
+    hashes.push_back(hash);
+    keys.insert(keys.end(), key, key + width);
+    accumulators.resize(accumulators.size() + aggregates);
+    if (2 * hashes.size() > slots.size())
+      grow();
+    return &accumulators[group * aggregates];
+  }
+
+  size_t memoryUsage() const {
+    return slots.capacity() * sizeof(uint32_t) +
+           keys.capacity() * sizeof(KeyCell) +
+           hashes.capacity() * sizeof(uint64_t) +
+           accumulators.capacity() * sizeof(Accumulator);
+  }
+};
+
+RowId inputRow(const AggregateInput &input, size_t position) {
+  return input.rows ? input.rows[position] : static_cast<RowId>(position);
+}
+
+// Aggregate input positions [begin, end) into a partial, whose growth is
+// reserved once per chunk of positions
+// @return false (partial incomplete) once the memory limits are reached
+//         here or in another range
+bool aggregateRange(size_t begin, size_t end,
+                    const std::vector<AggregateInput> &keys,
+                    const std::vector<AggregateSpec> &specs,
+                    GroupTable &groups, MemoryReservation &reserved,
+                    std::atomic<bool> &exceeded) {
+  std::vector<KeyCell> key(keys.size());
+  for (size_t i = begin; i < end; i++) {
+    if ((i - begin) % COLUMN_CHUNK_ROWS == 0 &&
+        (exceeded.load(std::memory_order_relaxed) ||
+         !reserved.resize(groups.memoryUsage()))) {
+      exceeded.store(true, std::memory_order_relaxed);
+      return false;
+    }
+    uint64_t hash = 0;
+    for (size_t k = 0; k < keys.size(); k++) {
+      key[k] = readKey(*keys[k].column, inputRow(keys[k], i));
+      hash = mixHash(hash ^ (key[k].null ? ~uint64_t(0) : key[k].bits));
+    }
+    Accumulator *accs = groups.find(hash, key.data());
+    for (size_t a = 0; a < specs.size(); a++) {
+      const AggregateSpec &spec = specs[a];
+      accumulate(accs[a], spec.fn, spec.input.column,
+                 spec.input.column ? inputRow(spec.input, i) : 0);
+    }
+  }
+  return true;
+}
+
+// Result cell of a finished accumulator
+CellValue finalValue(const AggregateSpec &spec, const Accumulator &acc) {
+  CellValue cell;
+  if (spec.fn == AggregateFn::COUNT) {
+    cell.isNull = false;
+    cell.intValue = acc.count;
+    return cell;
+  }
+  if (acc.count == 0)
+    return cell; // NULL: no value to aggregate
+
+  cell.isNull = false;
+  ColumnType type = spec.input.column->getType();
+  if (spec.fn == AggregateFn::AVG) {
+    double sum = type == ColumnType::INT ? static_cast<double>(acc.intValue)
+                                         : acc.floatValue;
+    cell.floatValue = sum / static_cast<double>(acc.count);
+  } else if (type == ColumnType::INT) {
+    cell.intValue = acc.intValue;
+  } else if (type == ColumnType::FLOAT) {
+    cell.floatValue = acc.floatValue;
+  } else {
+    cell.stringValue = std::string(acc.text);
+  }
+  return cell;
+}
+
+std::string typeName(ColumnType type) {
+  switch (type) {
+  case ColumnType::INT:
+    return "INT";
+  case ColumnType::FLOAT:
+    return "FLOAT";
+  case ColumnType::VARCHAR:
+    return "VARCHAR";
+  }
+  return "VARCHAR";
+}
+
+} // namespace
+
+ColumnType aggregateType(const AggregateSpec &spec) {
+  if (spec.fn == AggregateFn::COUNT || !spec.input.column)
+    return ColumnType::INT;
+  if (spec.fn == AggregateFn::AVG)
+    return ColumnType::FLOAT;
+  return spec.input.column->getType();
+}
+
+// ============================================================================
+// AGGREGATION
+// ============================================================================
+TableSnapshot aggregateRows(size_t rows,
+                            const std::vector<AggregateInput> &keys,
+                            const std::vector<AggregateSpec> &specs,
+                            ThreadPool *pool, std::string &error) {
+  // One partial per thread, each over a contiguous range of at least a
+  // chunk of positions
+  size_t ranges = std::max<size_t>(
+      1, std::min(pool ? pool->size() : 1,
+                  (rows + COLUMN_CHUNK_ROWS - 1) / COLUMN_CHUNK_ROWS));
+  std::vector<GroupTable> partials(ranges,
+                                   GroupTable(keys.size(), specs.size()));
+  std::vector<MemoryReservation> reserved(ranges);
+  std::atomic<bool> exceeded(false);
+  auto runRange = [&](size_t r) {
+    aggregateRange(r * rows / ranges, (r + 1) * rows / ranges, keys, specs,
+                   partials[r], reserved[r], exceeded);
+  };
+  if (pool && ranges > 1) {
+    pool->run(ranges, runRange);
+  } else {
+    for (size_t r = 0; r < ranges; r++)
+      runRange(r);
+  }
+  auto overLimit = [&]() {
+    size_t bytes = 0;
+    for (const auto &partial : partials)
+      bytes += partial.memoryUsage();
+    error = memoryLimitError("the aggregation", bytes);
+    return nullptr;
+  };
+  if (exceeded)
+    return overLimit();
+
+  // Merge in range order, so groups keep their first-seen order
+  GroupTable &groups = partials[0];
+  size_t bytes = 0;
+  for (size_t r = 1; r < ranges; r++) {
+    const GroupTable &partial = partials[r];
+    bytes += partial.memoryUsage();
+    for (size_t g = 0; g < partial.size(); g++) {
+      Accumulator *accs = groups.find(partial.hashes[g],
+                                      partial.keys.data() + g * keys.size());
+      for (size_t a = 0; a < specs.size(); a++)
+        mergeInto(accs[a], specs[a].fn, specs[a].input.column,
+                  partial.accumulators[g * specs.size() + a]);
+    }
+    if (!reserved[0].resize(groups.memoryUsage()))
+      return overLimit();
+  }
+  // Without GROUP BY an empty input still has its one group
+  if (keys.empty() && groups.size() == 0)
+    groups.find(0, nullptr);
+  bytes += groups.memoryUsage();
+  recordBytes(bytes);
+
+  TableInfo schema("result");
+  for (const auto &key : keys)
+    schema.addColumn(key.name, typeName(key.column->getType()));
+  for (const auto &spec : specs)
+    schema.addColumn(spec.input.name, typeName(aggregateType(spec)));
+  auto result = std::make_shared<TableData>(schema);
+
+  for (size_t g = 0; g < groups.size(); g++) {
+    for (size_t k = 0; k < keys.size(); k++) {
+      const KeyCell &key = groups.keys[g * keys.size() + k];
+      CellValue cell;
+      cell.isNull = key.null;
+      if (!key.null) {
+        switch (keys[k].column->getType()) {
+        case ColumnType::INT:
+          cell.intValue = static_cast<int64_t>(key.bits);
+          break;
+        case ColumnType::FLOAT:
+          std::memcpy(&cell.floatValue, &key.bits, sizeof(key.bits));
+          break;
+        case ColumnType::VARCHAR:
+          cell.stringValue = std::string(key.text);
+          break;
+        }
+      }
+      result->columns[k].append(cell);
+    }
+    for (size_t a = 0; a < specs.size(); a++)
+      result->columns[keys.size() + a].append(
+          finalValue(specs[a], groups.accumulators[g * specs.size() + a]));
+  }
+  result->rowCount = groups.size();
+  return result;
+}
+
+std::vector<AggregateSpec>
+partialSpecs(const std::vector<AggregateSpec> &specs) {
+  std::vector<AggregateSpec> partial;
+  for (const auto &spec : specs) {
+    partial.push_back(spec);
+    if (spec.fn != AggregateFn::AVG)
+      continue;
+    partial.back().fn = AggregateFn::SUM;
+    partial.push_back(spec);
+    partial.back().fn = AggregateFn::COUNT;
+  }
+  return partial;
+}
+
+TableSnapshot mergePartials(const std::vector<TableSnapshot> &partials,
+                            size_t keyCount,
+                            const std::vector<AggregateSpec> &specs,
+                            ThreadPool *pool, std::string &error) {
+  // The partials one after another, sharing their chunks
+  auto rows = std::make_shared<TableData>(partials[0]->schema);
+  for (const auto &partial : partials) {
+    for (size_t c = 0; c < rows->columns.size(); c++)
+      rows->columns[c].appendColumn(Column(partial->columns[c]));
+    rows->rowCount += partial->rowCount;
+  }
+
+  // Aggregate them again: counts and sums add up, extremes stay extremes
+  std::vector<AggregateInput> keys(keyCount);
+  for (size_t k = 0; k < keyCount; k++) {
+    keys[k].column = &rows->columns[k];
+    keys[k].name = rows->schema.columns[k].name;
+  }
+  std::vector<AggregateSpec> merged;
+  for (size_t c = keyCount; c < rows->columns.size(); c++) {
+    merged.emplace_back();
+    merged.back().input.column = &rows->columns[c];
+    merged.back().input.name = rows->schema.columns[c].name;
+  }
+  size_t column = 0;
+  for (const auto &spec : specs) {
+    bool minMax = spec.fn == AggregateFn::MIN || spec.fn == AggregateFn::MAX;
+    merged[column++].fn = minMax ? spec.fn : AggregateFn::SUM;
+    if (spec.fn == AggregateFn::AVG)
+      merged[column++].fn = AggregateFn::SUM;
+  }
+  TableSnapshot combined =
+      aggregateRows(rows->rowCount, keys, merged, pool, error);
+  if (!combined || partialSpecs(specs).size() == specs.size())
+    return combined;
+
+  // Divide each AVG out of its summed SUM and COUNT
+  TableInfo schema("result");
+  for (size_t k = 0; k < keyCount; k++)
+    schema.addColumn(keys[k].name, combined->schema.columns[k].dataType);
+  column = keyCount;
+  for (const auto &spec : specs) {
+    schema.addColumn(spec.input.name,
+                     spec.fn == AggregateFn::AVG
+                         ? typeName(ColumnType::FLOAT)
+                         : combined->schema.columns[column].dataType);
+    column += spec.fn == AggregateFn::AVG ? 2 : 1;
+  }
+  auto result = std::make_shared<TableData>(schema);
+  for (size_t k = 0; k < keyCount; k++)
+    result->columns[k] = combined->columns[k];
+  column = keyCount;
+  for (size_t a = 0; a < specs.size(); a++) {
+    Column &out = result->columns[keyCount + a];
+    if (specs[a].fn != AggregateFn::AVG) {
+      out = combined->columns[column++];
+      continue;
+    }
+    const Column &sums = combined->columns[column++];
+    const Column &counts = combined->columns[column++];
+    for (size_t row = 0; row < combined->rowCount; row++) {
+      CellValue cell;
+      if (!sums.isNull(row) && counts.getInt(row) > 0) {
+        double sum = sums.getType() == ColumnType::INT
+                         ? static_cast<double>(sums.getInt(row))
+                         : sums.getFloat(row);
+        cell.isNull = false;
+        cell.floatValue = sum / static_cast<double>(counts.getInt(row));
+      }
+      out.append(cell);
+    }
+  }
+  result->rowCount = combined->rowCount;
+  return result;
+}
+
+TableSnapshot countResult(size_t count,
+                          const std::vector<std::string> &names) {
+  TableInfo schema("result");
+  for (const auto &name : names)
+    schema.addColumn(name, "INT");
+  auto result = std::make_shared<TableData>(schema);
+
+  CellValue cell;
+  cell.isNull = false;
+  cell.intValue = static_cast<int64_t>(count);
+  for (auto &column : result->columns)
+    column.append(cell);
+  result->rowCount = 1;
+  return result;
+}
+
+} // namespace MiniSQL
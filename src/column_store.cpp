@@ -0,0 +1,394 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: column_store.cpp
+ * Description: Columnar, Typed Storage Implementation
+ *
+ * Implements typed column chunks and the per-chunk string dictionary.
+ * Text values are converted to their column type once, when they are
+ * written, so scans never have to parse strings.
+ */
+
+#include "../include/column_store.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+namespace MiniSQL {
+
+// ============================================================================
+// TYPE HELPERS
+// ============================================================================
+ColumnType columnTypeFromString(const std::string &dataType) {
+  if (dataType == "INT")
+    return ColumnType::INT;
+  if (dataType == "FLOAT")
+    return ColumnType::FLOAT;
+  return ColumnType::VARCHAR;
+}
+
+bool parseCellValue(ColumnType type, const std::string &text, CellValue &out) {
+  out.isNull = false;
+
+  switch (type) {
+  case ColumnType::INT: {
+    if (text.empty())
+      return false;
+    char *end = nullptr;
+    errno = 0;
+    long long v = std::strtoll(text.c_str(), &end, 10);
+    if (errno != 0 || *end != '\0')
+      return false;
+    out.intValue = v;
+    return true;
+  }
+  case ColumnType::FLOAT: {
+    if (text.empty())
+      return false;
+    char *end = nullptr;
+    errno = 0;
+    double v = std::strtod(text.c_str(), &end);
+    if (errno != 0 || *end != '\0')
+      return false;
+    out.floatValue = v;
+    return true;
+  }
+  case ColumnType::VARCHAR:
+    out.stringValue = text;
+    return true;
+  }
+  return false;
+}
+
+std::string formatFloat(double value) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.15g", value);
+  if (std::strtod(buf, nullptr) != value) {
+    std::snprintf(buf, sizeof(buf), "%.17g", value);
+  }
+  return buf;
+}
+
+std::string formatResultFloat(double value) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.15g", value);
+  return buf;
+}
+
+// ============================================================================
+// STRING DICTIONARY
+// ============================================================================
+size_t StringDictionary::findSlot(std::string_view text) const {
+  size_t mask = slots.size() - 1;
+  size_t pos = std::hash<std::string_view>()(text) & mask;
+  while (slots[pos] != 0 && get(slots[pos] - 1) != text) {
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+void StringDictionary::rehash(size_t newCapacity) {
+  slots.assign(newCapacity, 0);
+  for (uint32_t code = 0; code < size(); code++) {
+    slots[findSlot(get(code))] = code + 1;
+  }
+}
+
+uint32_t StringDictionary::intern(std::string_view text) {
+  // Keep the load factor at or below 1/2
+  if ((size() + 1) * 2 > slots.size()) {
+    rehash(slots.empty() ? 16 : slots.size() * 2);
+  }
+
+  size_t pos = findSlot(text);
+  if (slots[pos] != 0)
+    return slots[pos] - 1;
+
+  uint32_t code = static_cast<uint32_t>(size());
+  bytes.insert(bytes.end(), text.begin(), text.end());
+  offsets.push_back(static_cast<uint32_t>(bytes.size()));
+  slots[pos] = code + 1;
+  return code;
+}
+
+bool StringDictionary::find(std::string_view text, uint32_t &code) const {
+  if (slots.empty())
+    return false;
+  size_t pos = findSlot(text);
+  if (slots[pos] == 0)
+    return false;
+  code = slots[pos] - 1;
+  return true;
+}
+
+bool StringDictionary::assign(std::vector<char> &&rawBytes,
+                              std::vector<uint32_t> &&rawOffsets) {
+  if (rawOffsets.empty() || rawOffsets.front() != 0 ||
+      rawOffsets.back() != rawBytes.size())
+    return false;
+  for (size_t i = 1; i < rawOffsets.size(); i++) {
+    if (rawOffsets[i] < rawOffsets[i - 1])
+      return false;
+  }
+
+  bytes = std::move(rawBytes);
+  offsets = std::move(rawOffsets);
+  size_t capacity = 16;
+  while (capacity < size() * 2)
+    capacity *= 2;
+  rehash(capacity);
+  return true;
+}
+
+void StringDictionary::memoryUsage(MemoryUsage &usage) const {
+  usage.strings += bytes.size();
+  usage.maps += (offsets.size() + slots.size()) * sizeof(uint32_t);
+  usage.reserved += bytes.capacity() - bytes.size() +
+                    (offsets.capacity() - offsets.size() + slots.capacity() -
+                     slots.size()) *
+                        sizeof(uint32_t);
+}
+
+// ============================================================================
+// COLUMN
+// ============================================================================
+ColumnChunk &Column::writableChunk(size_t index) {
+  std::shared_ptr<ColumnChunk> &chunk = chunks[index];
+  if (chunk.use_count() > 1) {
+    chunk = std::make_shared<ColumnChunk>(*chunk);
+  } else {
+    // Pairs with the release of the last other owner, so its reads of the
+    // chunk happen before our writes
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return *chunk;
+}
+
+void Column::append(const CellValue &value) {
+  if (offsetOf(rowCount) == 0) {
+    chunks.push_back(std::make_shared<ColumnChunk>());
+    ColumnChunk &fresh = *chunks.back();
+    fresh.nulls.reserve(COLUMN_CHUNK_ROWS);
+    switch (type) {
+    case ColumnType::INT:
+      fresh.ints.reserve(COLUMN_CHUNK_ROWS);
+      break;
+    case ColumnType::FLOAT:
+      fresh.floats.reserve(COLUMN_CHUNK_ROWS);
+      break;
+    case ColumnType::VARCHAR:
+      fresh.codes.reserve(COLUMN_CHUNK_ROWS);
+      break;
+    }
+  }
+
+  ColumnChunk &chunk = writableChunk(chunks.size() - 1);
+  chunk.nulls.push_back(value.isNull ? 1 : 0);
+  switch (type) {
+  case ColumnType::INT:
+    chunk.ints.push_back(value.isNull ? 0 : value.intValue);
+    break;
+  case ColumnType::FLOAT:
+    chunk.floats.push_back(value.isNull ? 0.0 : value.floatValue);
+    break;
+  case ColumnType::VARCHAR:
+    chunk.codes.push_back(
+        chunk.dict.intern(value.isNull ? std::string_view()
+                                       : std::string_view(value.stringValue)));
+    break;
+  }
+  rowCount++;
+}
+
+void Column::appendChunk(ColumnChunk &&chunk) {
+  size_t rows = chunk.nulls.size();
+  if (rows == 0)
+    return;
+
+  if (offsetOf(rowCount) == 0 && rows <= COLUMN_CHUNK_ROWS) {
+    chunks.push_back(std::make_shared<ColumnChunk>(std::move(chunk)));
+    rowCount += rows;
+    return;
+  }
+
+  CellValue value;
+  for (size_t i = 0; i < rows; i++) {
+    value.isNull = chunk.nulls[i] != 0;
+    switch (type) {
+    case ColumnType::INT:
+      value.intValue = chunk.ints[i];
+      break;
+    case ColumnType::FLOAT:
+      value.floatValue = chunk.floats[i];
+      break;
+    case ColumnType::VARCHAR:
+      value.stringValue.assign(chunk.dict.get(chunk.codes[i]));
+      break;
+    }
+    append(value);
+  }
+}
+
+void Column::appendColumn(Column &&other) {
+  for (auto &chunk : other.chunks) {
+    if (offsetOf(rowCount) == 0) {
+      // Only the other's last chunk can be partial, so it stays last here
+      rowCount += chunk->nulls.size();
+      chunks.push_back(std::move(chunk));
+    } else if (chunk.use_count() == 1) {
+      appendChunk(std::move(*chunk));
+    } else {
+      appendChunk(ColumnChunk(*chunk));
+    }
+  }
+  other.chunks.clear();
+  other.rowCount = 0;
+}
+
+void Column::set(size_t row, const CellValue &value) {
+  ColumnChunk &chunk = chunkFor(row);
+  size_t off = offsetOf(row);
+  chunk.nulls[off] = value.isNull ? 1 : 0;
+  if (value.isNull)
+    return;
+
+  switch (type) {
+  case ColumnType::INT:
+    chunk.ints[off] = value.intValue;
+    break;
+  case ColumnType::FLOAT:
+    chunk.floats[off] = value.floatValue;
+    break;
+  case ColumnType::VARCHAR:
+    // Replaced strings stay in the dictionary until the next compaction
+    chunk.codes[off] = chunk.dict.intern(value.stringValue);
+    break;
+  }
+}
+
+void Column::compact(const std::vector<uint8_t> &keep) {
+  Column packed(type);
+  CellValue value;
+  for (size_t row = 0; row < rowCount; row++) {
+    if (!keep[row])
+      continue;
+    value.isNull = isNull(row);
+    switch (type) {
+    case ColumnType::INT:
+      value.intValue = getInt(row);
+      break;
+    case ColumnType::FLOAT:
+      value.floatValue = getFloat(row);
+      break;
+    case ColumnType::VARCHAR:
+      value.stringValue.assign(getString(row));
+      break;
+    }
+    packed.append(value);
+  }
+  *this = std::move(packed);
+}
+
+void Column::clear() {
+  chunks.clear();
+  rowCount = 0;
+}
+
+std::string Column::getText(size_t row) const {
+  if (isNull(row))
+    return "NULL";
+  switch (type) {
+  case ColumnType::INT:
+    return std::to_string(getInt(row));
+  case ColumnType::FLOAT:
+    return formatFloat(getFloat(row));
+  case ColumnType::VARCHAR:
+    return std::string(getString(row));
+  }
+  return "";
+}
+
+CellValue Column::getCell(size_t row) const {
+  CellValue cell;
+  cell.isNull = isNull(row);
+  if (cell.isNull)
+    return cell;
+  switch (type) {
+  case ColumnType::INT:
+    cell.intValue = getInt(row);
+    break;
+  case ColumnType::FLOAT:
+    cell.floatValue = getFloat(row);
+    break;
+  case ColumnType::VARCHAR:
+    cell.stringValue = std::string(getString(row));
+    break;
+  }
+  return cell;
+}
+
+void Column::memoryUsage(MemoryUsage &usage) const {
+  const size_t pointer = sizeof(std::shared_ptr<ColumnChunk>);
+  usage.values += chunks.size() * pointer;
+  usage.reserved += (chunks.capacity() - chunks.size()) * pointer;
+  for (const auto &chunk : chunks) {
+    // A chunk is allocated for COLUMN_CHUNK_ROWS rows when it is started
+    usage.values += sizeof(ColumnChunk) +
+                    chunk->ints.size() * sizeof(int64_t) +
+                    chunk->floats.size() * sizeof(double) +
+                    chunk->codes.size() * sizeof(uint32_t) +
+                    chunk->nulls.size();
+    usage.reserved +=
+        (chunk->ints.capacity() - chunk->ints.size()) * sizeof(int64_t) +
+        (chunk->floats.capacity() - chunk->floats.size()) * sizeof(double) +
+        (chunk->codes.capacity() - chunk->codes.size()) * sizeof(uint32_t) +
+        (chunk->nulls.capacity() - chunk->nulls.size());
+    chunk->dict.memoryUsage(usage);
+  }
+}
+
+// ============================================================================
+// DELETE BITMAP
+// ============================================================================
+bool DeleteBitmap::insert(size_t row) {
+  size_t chunk = row >> COLUMN_CHUNK_SHIFT;
+  if (chunk >= chunks.size())
+    chunks.resize(chunk + 1);
+  auto &words = chunks[chunk];
+  if (!words)
+    words = std::make_shared<std::vector<uint64_t>>(WORDS_PER_CHUNK, 0);
+  else if (words.use_count() > 1)
+    words = std::make_shared<std::vector<uint64_t>>(*words);
+
+  size_t bit = row & (COLUMN_CHUNK_ROWS - 1);
+  uint64_t &word = (*words)[bit >> 6];
+  uint64_t mask = uint64_t(1) << (bit & 63);
+  if (word & mask)
+    return false;
+  word |= mask;
+  count++;
+  return true;
+}
+
+void DeleteBitmap::mask(size_t chunk, size_t count, uint8_t *flags) const {
+  if (!anyIn(chunk))
+    return;
+  const std::vector<uint64_t> &words = *chunks[chunk];
+  for (size_t r = 0; r < count; r++) {
+    if ((words[r >> 6] >> (r & 63)) & 1)
+      flags[r] = 0;
+  }
+}
+
+void DeleteBitmap::memoryUsage(MemoryUsage &usage) const {
+  usage.values += chunks.size() * sizeof(chunks[0]);
+  usage.reserved += (chunks.capacity() - chunks.size()) * sizeof(chunks[0]);
+  for (const auto &words : chunks) {
+    if (words)
+      usage.values += words->capacity() * sizeof(uint64_t);
+  }
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,247 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: compiled_filter.cpp
+ * Description: Compiled WHERE Filter Implementation
+ *
+ * A stage is FusedStage<Term>, where the term is the comparison of one
+ * (mode x operator): it is set up once per chunk (pointers to the
+ * values, the literal, a dictionary lookup) and tests row i of the chunk
+ * inline. NULL rows are excluded by the stage.
+ */
+
+#include "../include/compiled_filter.h"
+#include "../include/filter.h"
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace MiniSQL {
+
+namespace {
+
+// ============================================================================
+// TERMS - The comparison of one (mode x operator) on one chunk
+// ============================================================================
+template <typename Cmp> struct IntTerm {
+  const int64_t *values;
+  int64_t literal;
+
+  IntTerm(const BoundPredicate &pred, const ColumnChunk &chunk)
+      : values(chunk.ints.data()), literal(pred.literal.intValue) {}
+
+  bool operator()(size_t i) const { return Cmp()(values[i], literal); }
+};
+
+template <typename Cmp> struct FloatTerm {
+  const double *values;
+  double literal;
+
+  FloatTerm(const BoundPredicate &pred, const ColumnChunk &chunk)
+      : values(chunk.floats.data()), literal(pred.literal.floatValue) {}
+
+  bool operator()(size_t i) const { return Cmp()(values[i], literal); }
+};
+
+template <typename Cmp> struct IntAsFloatTerm {
+  const int64_t *values;
+  double literal;
+
+  IntAsFloatTerm(const BoundPredicate &pred, const ColumnChunk &chunk)
+      : values(chunk.ints.data()), literal(pred.literal.floatValue) {}
+
+  bool operator()(size_t i) const {
+    return Cmp()(static_cast<double>(values[i]), literal);
+  }
+};
+
+// String (in)equality: the literal's code in this chunk's dictionary. A
+// literal absent from the chunk gets a code no row has.
+template <typename Cmp> struct VarcharCodeTerm {
+  const uint32_t *codes;
+  uint32_t target;
+
+  VarcharCodeTerm(const BoundPredicate &pred, const ColumnChunk &chunk)
+      : codes(chunk.codes.data()), target(UINT32_MAX) {
+    uint32_t code;
+    if (chunk.dict.find(pred.literal.stringValue, code))
+      target = code;
+  }
+
+  bool operator()(size_t i) const { return Cmp()(codes[i], target); }
+};
+
+// String range: every distinct string of the chunk is compared once
+template <typename Cmp> struct VarcharRangeTerm {
+  const uint32_t *codes;
+  std::vector<uint8_t> codeMatches;
+
+  VarcharRangeTerm(const BoundPredicate &pred, const ColumnChunk &chunk)
+      : codes(chunk.codes.data()), codeMatches(chunk.dict.size()) {
+    std::string_view literal(pred.literal.stringValue);
+    Cmp cmp;
+    for (uint32_t code = 0; code < codeMatches.size(); code++)
+      codeMatches[code] = cmp(chunk.dict.get(code), literal) ? 1 : 0;
+  }
+
+  bool operator()(size_t i) const { return codeMatches[codes[i]] != 0; }
+};
+
+// ============================================================================
+// STAGES - Branch-free position loops around a term
+// ============================================================================
+template <typename Term> struct FusedStage {
+  static size_t select(const BoundPredicate &pred, const ColumnChunk &chunk,
+                       size_t count, RowId base, RowId *out) {
+    const Term term(pred, chunk);
+    const uint8_t *nulls = chunk.nulls.data();
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+      out[kept] = static_cast<RowId>(base + i);
+      kept += (nulls[i] == 0) & term(i);
+    }
+    return kept;
+  }
+
+  static size_t refine(const BoundPredicate &pred, const ColumnChunk &chunk,
+                       RowId base, RowId *rows, size_t n) {
+    const Term term(pred, chunk);
+    const uint8_t *nulls = chunk.nulls.data();
+    size_t kept = 0;
+    for (size_t j = 0; j < n; j++) {
+      size_t i = rows[j] - base;
+      rows[kept] = rows[j];
+      kept += (nulls[i] == 0) & term(i);
+    }
+    return kept;
+  }
+};
+
+struct StageFns {
+  CompiledFilter::SelectFn select;
+  CompiledFilter::RefineFn refine;
+};
+
+template <typename Term> StageFns stage() {
+  return {&FusedStage<Term>::select, &FusedStage<Term>::refine};
+}
+
+// Select the stage instantiation for an operator
+template <template <typename> class Term> StageFns stageFor(CompareOp op) {
+  switch (op) {
+  case CompareOp::EQ:
+    return stage<Term<std::equal_to<>>>();
+  case CompareOp::NE:
+    return stage<Term<std::not_equal_to<>>>();
+  case CompareOp::LT:
+    return stage<Term<std::less<>>>();
+  case CompareOp::LE:
+    return stage<Term<std::less_equal<>>>();
+  case CompareOp::GT:
+    return stage<Term<std::greater<>>>();
+  case CompareOp::GE:
+    return stage<Term<std::greater_equal<>>>();
+  }
+  return {nullptr, nullptr};
+}
+
+// @return false if the predicate has no compiled stage
+bool selectStage(const BoundPredicate &pred, StageFns &out) {
+  switch (pred.mode) {
+  case CompareMode::INT:
+    out = stageFor<IntTerm>(pred.op);
+    break;
+  case CompareMode::FLOAT:
+    out = stageFor<FloatTerm>(pred.op);
+    break;
+  case CompareMode::INT_AS_FLOAT:
+    out = stageFor<IntAsFloatTerm>(pred.op);
+    break;
+  case CompareMode::VARCHAR:
+    if (pred.op == CompareOp::EQ)
+      out = stage<VarcharCodeTerm<std::equal_to<>>>();
+    else if (pred.op == CompareOp::NE)
+      out = stage<VarcharCodeTerm<std::not_equal_to<>>>();
+    else
+      out = stageFor<VarcharRangeTerm>(pred.op);
+    break;
+  case CompareMode::TEXT:
+    return false;
+  }
+  return out.select != nullptr;
+}
+
+} // namespace
+
+// ============================================================================
+// COMPILATION
+// ============================================================================
+std::shared_ptr<const CompiledFilter>
+CompiledFilter::compile(const BoundFilter &filter) {
+  std::vector<const BoundPredicate *> predicates;
+  if (filter.kind == BoundFilter::Kind::PREDICATE) {
+    predicates.push_back(&filter.predicate);
+  } else if (filter.kind == BoundFilter::Kind::AND) {
+    for (const auto &child : filter.children) {
+      if (child.kind != BoundFilter::Kind::PREDICATE)
+        return nullptr;
+      predicates.push_back(&child.predicate);
+    }
+  } else {
+    return nullptr;
+  }
+
+  auto compiled = std::make_shared<CompiledFilter>();
+  for (const BoundPredicate *pred : predicates) {
+    StageFns fns{nullptr, nullptr};
+    if (pred->columnIndex < 0 || !selectStage(*pred, fns))
+      return nullptr;
+    compiled->stages.push_back(Stage{*pred, fns.select, fns.refine});
+  }
+  return compiled;
+}
+
+// ============================================================================
+// EXECUTION
+// ============================================================================
+void CompiledFilter::selectChunk(const std::vector<Column> &columns,
+                                 const DeleteBitmap &deleted,
+                                 size_t chunkIndex, size_t count,
+                                 SelectionVector &out) const {
+  for (const auto &stage : stages) {
+    if (static_cast<size_t>(stage.predicate.columnIndex) >= columns.size())
+      return;
+  }
+
+  // The positions are written straight into out, which is cut back to
+  // the rows kept
+  RowId base = static_cast<RowId>(chunkIndex * COLUMN_CHUNK_ROWS);
+  size_t start = out.size();
+  out.resize(start + count);
+  RowId *rows = out.data() + start;
+
+  const Stage &first = stages[0];
+  size_t kept = first.select(
+      first.predicate,
+      columns[first.predicate.columnIndex].getChunk(chunkIndex), count, base,
+      rows);
+  for (size_t s = 1; s < stages.size() && kept > 0; s++) {
+    const Stage &next = stages[s];
+    kept = next.refine(next.predicate,
+                       columns[next.predicate.columnIndex].getChunk(chunkIndex),
+                       base, rows, kept);
+  }
+
+  if (kept > 0 && deleted.anyIn(chunkIndex)) {
+    size_t live = 0;
+    for (size_t j = 0; j < kept; j++) {
+      rows[live] = rows[j];
+      live += !deleted.contains(rows[j]);
+    }
+    kept = live;
+  }
+  out.resize(start + kept);
+}
+
+} // namespace MiniSQL
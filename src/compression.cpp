@@ -0,0 +1,173 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: compression.cpp
+ * Description: LZ77 Block Compression and Checksums Implementation
+ */
+
+#include "../include/compression.h"
+#include <cstring>
+
+namespace MiniSQL {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr unsigned HASH_BITS = 14;
+
+uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t hash4(uint32_t v) { return (v * 2654435761u) >> (32 - HASH_BITS); }
+
+void writeLength(std::vector<uint8_t> &out, size_t length) {
+  while (length >= 255) {
+    out.push_back(255);
+    length -= 255;
+  }
+  out.push_back(static_cast<uint8_t>(length));
+}
+
+void emitSequence(std::vector<uint8_t> &out, const uint8_t *literals,
+                  size_t literalLength, size_t offset, size_t matchLength) {
+  size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+  uint8_t token =
+      static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4 |
+                           (matchCode < 15 ? matchCode : 15));
+  out.push_back(token);
+  if (literalLength >= 15)
+    writeLength(out, literalLength - 15);
+  out.insert(out.end(), literals, literals + literalLength);
+
+  if (matchLength == 0)
+    return; // Final sequence
+  out.push_back(static_cast<uint8_t>(offset & 0xFF));
+  out.push_back(static_cast<uint8_t>(offset >> 8));
+  if (matchCode >= 15)
+    writeLength(out, matchCode - 15);
+}
+
+// Read a length continuation; false if the input ends first
+bool readLength(const uint8_t *&ip, const uint8_t *end, size_t &length) {
+  uint8_t b;
+  do {
+    if (ip >= end)
+      return false;
+    b = *ip++;
+    length += b;
+  } while (b == 255);
+  return true;
+}
+
+} // namespace
+
+// ============================================================================
+// COMPRESSION
+// ============================================================================
+void lzCompress(const uint8_t *in, size_t size, std::vector<uint8_t> &out) {
+  out.clear();
+  out.reserve(size / 2 + 16);
+
+  std::vector<uint32_t> table(size_t(1) << HASH_BITS, UINT32_MAX);
+  size_t anchor = 0;
+  size_t pos = 0;
+
+  while (pos + MIN_MATCH <= size) {
+    uint32_t seq = read32(in + pos);
+    uint32_t &slot = table[hash4(seq)];
+    size_t candidate = slot;
+    slot = static_cast<uint32_t>(pos);
+
+    if (candidate == UINT32_MAX || pos - candidate > MAX_OFFSET ||
+        read32(in + candidate) != seq) {
+      pos++;
+      continue;
+    }
+
+    size_t length = MIN_MATCH;
+    while (pos + length < size && in[candidate + length] == in[pos + length])
+      length++;
+
+    emitSequence(out, in + anchor, pos - anchor, pos - candidate, length);
+    pos += length;
+    anchor = pos;
+  }
+
+  emitSequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+// ============================================================================
+// DECOMPRESSION - Every length and offset is bounds-checked
+// ============================================================================
+bool lzDecompress(const uint8_t *in, size_t size, uint8_t *out,
+                  size_t outSize) {
+  const uint8_t *ip = in;
+  const uint8_t *ipEnd = in + size;
+  uint8_t *op = out;
+  uint8_t *opEnd = out + outSize;
+
+  while (ip < ipEnd) {
+    uint8_t token = *ip++;
+
+    size_t literalLength = token >> 4;
+    if (literalLength == 15 && !readLength(ip, ipEnd, literalLength))
+      return false;
+    if (literalLength > static_cast<size_t>(ipEnd - ip) ||
+        literalLength > static_cast<size_t>(opEnd - op))
+      return false;
+    std::memcpy(op, ip, literalLength);
+    ip += literalLength;
+    op += literalLength;
+
+    if (ip == ipEnd)
+      break; // Final sequence has no match
+
+    if (ipEnd - ip < 2)
+      return false;
+    size_t offset = ip[0] | (size_t(ip[1]) << 8);
+    ip += 2;
+    size_t matchLength = token & 0x0F;
+    if (matchLength == 15 && !readLength(ip, ipEnd, matchLength))
+      return false;
+    matchLength += MIN_MATCH;
+
+    if (offset == 0 || offset > static_cast<size_t>(op - out) ||
+        matchLength > static_cast<size_t>(opEnd - op))
+      return false;
+    // Byte by byte: the match may overlap the bytes it produces
+    const uint8_t *match = op - offset;
+    for (size_t i = 0; i < matchLength; i++)
+      op[i] = match[i];
+    op += matchLength;
+  }
+
+  return op == opEnd;
+}
+
+// ============================================================================
+// CHECKSUM
+// ============================================================================
+uint64_t checksum64(const uint8_t *data, size_t size) {
+  const uint64_t prime = 0x9E3779B97F4A7C15ull;
+  uint64_t h = 0xCBF29CE484222325ull ^ (size * prime);
+
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    h = (h ^ word) * prime;
+    h ^= h >> 29;
+  }
+  uint64_t tail = 0;
+  if (i < size)
+    std::memcpy(&tail, data + i, size - i);
+  h = (h ^ tail) * prime;
+  h ^= h >> 32;
+  return h;
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,644 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: csv_loader.cpp
+ * Description: Parallel CSV Loader Implementation
+ *
+ * A record ends at a newline that is not inside a quoted field. Since
+ * every '"' toggles the quoted state (an escaped "" toggles it twice),
+ * whether a byte is inside quotes only depends on the parity of the
+ * quotes before it. That is what lets each thread start in the middle of
+ * the file.
+ */
+
+#include "../include/csv_loader.h"
+#include "../include/mapped_file.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace MiniSQL {
+
+namespace {
+
+// Files smaller than this are loaded by a single thread
+constexpr size_t PARALLEL_LOAD_MIN_BYTES = size_t(1) << 20;
+
+// Run fn(0) .. fn(count - 1) on up to `threads` threads
+template <typename Fn> void parallelFor(size_t count, unsigned threads, Fn fn) {
+  if (threads <= 1 || count <= 1) {
+    for (size_t i = 0; i < count; i++)
+      fn(i);
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  size_t spawn = std::min<size_t>(threads, count);
+  for (size_t t = 0; t < spawn; t++) {
+    workers.emplace_back([&]() {
+      for (size_t i = next++; i < count; i = next++)
+        fn(i);
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+}
+
+// ============================================================================
+// RECORD BOUNDARIES
+// ============================================================================
+
+// Start of the record after the one starting at p
+const char *skipRecord(const char *p, const char *end) {
+  // Most records have no quotes: their end is the next newline
+  const char *newline =
+      static_cast<const char *>(std::memchr(p, '\n', end - p));
+  const char *last = newline ? newline : end;
+  if (!std::memchr(p, '"', last - p))
+    return newline ? newline + 1 : end;
+
+  bool quoted = false;
+  for (; p < end; p++) {
+    if (*p == '"')
+      quoted = !quoted;
+    else if (*p == '\n' && !quoted)
+      return p + 1;
+  }
+  return end;
+}
+
+// Blank lines (only whitespace) are not records
+bool isBlank(const char *p, const char *end) {
+  for (; p < end; p++) {
+    if (*p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+      return false;
+  }
+  return true;
+}
+
+// First record start at or after pos, given the quote state at pos
+const char *firstRecordAt(const char *base, const char *pos, const char *end,
+                          bool quoted) {
+  if (pos > base && pos[-1] == '\n' && !quoted)
+    return pos;
+  for (; pos < end; pos++) {
+    if (*pos == '"')
+      quoted = !quoted;
+    else if (*pos == '\n' && !quoted)
+      return pos + 1;
+  }
+  return end;
+}
+
+// ============================================================================
+// FIELD SPLITTING
+// ============================================================================
+struct Field {
+  std::string_view text;
+  bool quoted;
+  long scratchPos; // Unescaped text lives in scratch from here (-1 = none)
+};
+
+// Split the record [p, end) into fields, stopping after the first
+// `limit` ones
+// @return false if the record is malformed (text after a closing quote)
+bool splitRecord(const char *p, const char *end, std::vector<Field> &fields,
+                 std::string &scratch, size_t limit = SIZE_MAX) {
+  fields.clear();
+  scratch.clear();
+
+  while (true) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+      p++;
+
+    Field field{std::string_view(), false, -1};
+    if (p < end && *p == '"') {
+      field.quoted = true;
+      const char *start = ++p;
+      bool escaped = false;
+      while (p < end) {
+        if (*p == '"') {
+          if (p + 1 < end && p[1] == '"') {
+            escaped = true;
+            p += 2;
+            continue;
+          }
+          break;
+        }
+        p++;
+      }
+      field.text = std::string_view(start, p - start);
+      if (p < end)
+        p++; // Closing quote
+
+      if (escaped) {
+        field.scratchPos = static_cast<long>(scratch.size());
+        for (size_t i = 0; i < field.text.size(); i++) {
+          scratch += field.text[i];
+          if (field.text[i] == '"')
+            i++; // Second quote of ""
+        }
+        field.text = std::string_view(
+            nullptr, scratch.size() - static_cast<size_t>(field.scratchPos));
+      }
+
+      while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+      if (p < end && *p != ',')
+        return false;
+    } else {
+      const char *start = p;
+      while (p < end && *p != ',')
+        p++;
+      const char *last = p;
+      while (last > start &&
+             (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r'))
+        last--;
+      field.text = std::string_view(start, last - start);
+    }
+
+    fields.push_back(field);
+    if (p >= end || fields.size() == limit)
+      break;
+    p++; // ','
+  }
+
+  // Scratch no longer grows: point unescaped fields into it
+  for (auto &field : fields) {
+    if (field.scratchPos >= 0)
+      field.text = std::string_view(scratch.data() + field.scratchPos,
+                                    field.text.size());
+  }
+  return true;
+}
+
+// ============================================================================
+// VALUE PARSING - In place, without allocating
+// ============================================================================
+bool parseInt(std::string_view text, int64_t &out) {
+  const char *first = text.data();
+  const char *last = first + text.size();
+  if (first < last && *first == '+')
+    first++;
+  if (first == last)
+    return false;
+  auto res = std::from_chars(first, last, out);
+  return res.ec == std::errc() && res.ptr == last;
+}
+
+bool parseFloat(std::string_view text, double &out) {
+  const char *first = text.data();
+  const char *last = first + text.size();
+  if (first < last && *first == '+')
+    first++;
+  if (first == last)
+    return false;
+  auto res = std::from_chars(first, last, out);
+  return res.ec == std::errc() && res.ptr == last;
+}
+
+struct ParsedCell {
+  bool isNull;
+  int64_t intValue;
+  double floatValue;
+  std::string_view text;
+};
+
+// Split a record and convert the fields of the table's columns into cells
+// @return false if the record is malformed: wrong number of fields, or a
+//         value that does not match its column type
+bool readRecord(const CsvLayout &layout, const char *p, const char *end,
+                std::vector<Field> &fields, std::string &scratch,
+                std::vector<ParsedCell> &cells) {
+  if (!splitRecord(p, end, fields, scratch) ||
+      fields.size() != layout.headerColumn.size())
+    return false;
+
+  for (auto &cell : cells)
+    cell.isNull = true;
+  for (size_t i = 0; i < fields.size(); i++) {
+    int c = layout.headerColumn[i];
+    if (c < 0 || (fields[i].text.empty() && !fields[i].quoted))
+      continue;
+    ParsedCell &cell = cells[c];
+    cell.isNull = false;
+    switch (layout.types[c]) {
+    case ColumnType::INT:
+      if (!parseInt(fields[i].text, cell.intValue))
+        return false;
+      break;
+    case ColumnType::FLOAT:
+      if (!parseFloat(fields[i].text, cell.floatValue))
+        return false;
+      break;
+    case ColumnType::VARCHAR:
+      cell.text = fields[i].text;
+      break;
+    }
+  }
+  return true;
+}
+
+// Record [begin, end) of the record starting at p, and the start of the
+// next one
+const char *recordAt(const char *p, const char *limit, const char *&end) {
+  const char *next = skipRecord(p, limit);
+  end = next;
+  if (end > p && end[-1] == '\n')
+    end--;
+  return next;
+}
+
+// One segment of up to COLUMN_CHUNK_ROWS records, parsed into chunks
+struct Segment {
+  const char *begin;
+  const char *end;
+  std::vector<ColumnChunk> chunks; // One per table column
+  size_t rows = 0;
+  size_t skipped = 0;
+};
+
+void parseSegment(const CsvLayout &layout, Segment &segment) {
+  size_t columnCount = layout.types.size();
+  segment.chunks.assign(columnCount, ColumnChunk());
+  for (size_t c = 0; c < columnCount; c++) {
+    ColumnChunk &chunk = segment.chunks[c];
+    chunk.nulls.reserve(COLUMN_CHUNK_ROWS);
+    switch (layout.types[c]) {
+    case ColumnType::INT:
+      chunk.ints.reserve(COLUMN_CHUNK_ROWS);
+      break;
+    case ColumnType::FLOAT:
+      chunk.floats.reserve(COLUMN_CHUNK_ROWS);
+      break;
+    case ColumnType::VARCHAR:
+      chunk.codes.reserve(COLUMN_CHUNK_ROWS);
+      break;
+    }
+  }
+
+  std::vector<Field> fields;
+  std::string scratch;
+  std::vector<ParsedCell> cells(columnCount);
+
+  const char *p = segment.begin;
+  while (p < segment.end) {
+    const char *recordEnd;
+    const char *next = recordAt(p, segment.end, recordEnd);
+    if (isBlank(p, recordEnd)) {
+      p = next;
+      continue;
+    }
+
+    bool ok = readRecord(layout, p, recordEnd, fields, scratch, cells);
+    p = next;
+
+    if (!ok) {
+      segment.skipped++;
+      continue;
+    }
+
+    for (size_t c = 0; c < columnCount; c++) {
+      ColumnChunk &chunk = segment.chunks[c];
+      const ParsedCell &cell = cells[c];
+      chunk.nulls.push_back(cell.isNull ? 1 : 0);
+      switch (layout.types[c]) {
+      case ColumnType::INT:
+        chunk.ints.push_back(cell.isNull ? 0 : cell.intValue);
+        break;
+      case ColumnType::FLOAT:
+        chunk.floats.push_back(cell.isNull ? 0.0 : cell.floatValue);
+        break;
+      case ColumnType::VARCHAR:
+        chunk.codes.push_back(
+            chunk.dict.intern(cell.isNull ? std::string_view() : cell.text));
+        break;
+      }
+    }
+    segment.rows++;
+  }
+}
+
+// ============================================================================
+// FILE LAYOUT
+// ============================================================================
+
+// Map the header line of a file onto the table's columns
+// @param body Set to the first byte after the header line
+bool readHeader(const MappedFile &file, const std::string &path,
+                const TableData &table, CsvLayout &layout, const char *&body,
+                CsvLoadStats &stats, std::string &error) {
+  if (!file.isOpen()) {
+    error = "could not open '" + path + "'";
+    return false;
+  }
+
+  const char *base = file.data();
+  const char *end = base + file.size();
+  if (!base) {
+    error = "'" + path + "' has no header line";
+    return false;
+  }
+
+  const char *headerEnd;
+  body = recordAt(base, end, headerEnd);
+  std::vector<Field> fields;
+  std::string scratch;
+  if (isBlank(base, headerEnd) ||
+      !splitRecord(base, headerEnd, fields, scratch)) {
+    error = "'" + path + "' has no header line";
+    return false;
+  }
+
+  layout.types.clear();
+  layout.headerColumn.clear();
+  for (const auto &column : table.columns)
+    layout.types.push_back(column.getType());
+  for (const auto &field : fields) {
+    layout.headerColumn.push_back(table.columnIndex(std::string(field.text)));
+    if (layout.headerColumn.back() < 0)
+      stats.ignoredColumns.emplace_back(field.text);
+  }
+  return true;
+}
+
+unsigned loadThreads(const MappedFile &file, unsigned threads) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if (file.size() < PARALLEL_LOAD_MIN_BYTES)
+    threads = 1;
+  return threads;
+}
+
+// Cut the body [body, end) into segments of exactly COLUMN_CHUNK_ROWS
+// records (the last one may hold fewer)
+std::vector<Segment> findSegments(const char *base, const char *body,
+                                  const char *end, unsigned threads) {
+  // Step 1: byte ranges, and the quote parity at the start of each
+  size_t bodySize = static_cast<size_t>(end - body);
+  size_t rangeCount = threads;
+  std::vector<const char *> rangeStart(rangeCount + 1);
+  for (size_t i = 0; i <= rangeCount; i++)
+    rangeStart[i] = body + bodySize * i / rangeCount;
+
+  std::vector<size_t> quotes(rangeCount, 0);
+  parallelFor(rangeCount, threads, [&](size_t i) {
+    quotes[i] = std::count(rangeStart[i], rangeStart[i + 1], '"');
+  });
+
+  // Step 2: first record of each range, and its record count
+  std::vector<const char *> recordStart(rangeCount + 1, end);
+  bool quoted = false;
+  for (size_t i = 0; i < rangeCount; i++) {
+    recordStart[i] =
+        i == 0 ? body : firstRecordAt(base, rangeStart[i], end, quoted);
+    quoted ^= (quotes[i] & 1) != 0;
+  }
+
+  std::vector<size_t> records(rangeCount, 0);
+  parallelFor(rangeCount, threads, [&](size_t i) {
+    for (const char *p = recordStart[i]; p < recordStart[i + 1];) {
+      const char *next = skipRecord(p, recordStart[i + 1]);
+      if (!isBlank(p, next))
+        records[i]++;
+      p = next;
+    }
+  });
+
+  // Step 3: segments of exactly COLUMN_CHUNK_ROWS records
+  std::vector<size_t> firstRecord(rangeCount, 0);
+  for (size_t i = 1; i < rangeCount; i++)
+    firstRecord[i] = firstRecord[i - 1] + records[i - 1];
+
+  std::vector<std::vector<const char *>> cuts(rangeCount);
+  parallelFor(rangeCount, threads, [&](size_t i) {
+    size_t record = firstRecord[i];
+    for (const char *p = recordStart[i]; p < recordStart[i + 1];) {
+      const char *next = skipRecord(p, recordStart[i + 1]);
+      if (!isBlank(p, next)) {
+        if (record % COLUMN_CHUNK_ROWS == 0)
+          cuts[i].push_back(p);
+        record++;
+      }
+      p = next;
+    }
+  });
+
+  std::vector<Segment> segments;
+  for (const auto &rangeCuts : cuts) {
+    for (const char *cut : rangeCuts) {
+      if (!segments.empty())
+        segments.back().end = cut;
+      segments.push_back(Segment());
+      segments.back().begin = cut;
+    }
+  }
+  if (!segments.empty())
+    segments.back().end = end;
+  return segments;
+}
+
+} // namespace
+
+// ============================================================================
+// LOADING
+// ============================================================================
+bool loadCsvFile(const std::string &path, TableData &table,
+                 CsvLoadStats &stats, std::string &error, unsigned threads) {
+  stats = CsvLoadStats();
+
+  MappedFile file(path);
+  CsvLayout layout;
+  const char *body;
+  if (!readHeader(file, path, table, layout, body, stats, error))
+    return false;
+
+  threads = loadThreads(file, threads);
+  stats.threads = threads;
+
+  // Steps 1-3: segments of COLUMN_CHUNK_ROWS records
+  std::vector<Segment> segments =
+      findSegments(file.data(), body, file.data() + file.size(), threads);
+
+  // Step 4: parse the segments in parallel
+  parallelFor(segments.size(), threads,
+              [&](size_t i) { parseSegment(layout, segments[i]); });
+
+  // Step 5: move the chunks into the table, in file order
+  for (auto &column : table.columns)
+    column.clear();
+  table.rowCount = 0;
+  table.deleted.clear();
+  for (auto &segment : segments) {
+    for (size_t c = 0; c < table.columns.size(); c++)
+      table.columns[c].appendChunk(std::move(segment.chunks[c]));
+    table.rowCount += segment.rows;
+    stats.rows += segment.rows;
+    stats.skipped += segment.skipped;
+  }
+  return true;
+}
+
+// ============================================================================
+// LAZY LOADING
+// ============================================================================
+CsvColumnSource::CsvColumnSource(const std::string &filePath)
+    : path(filePath), file(std::make_unique<MappedFile>(filePath)),
+      rowCount(0) {}
+
+CsvColumnSource::~CsvColumnSource() = default;
+
+std::shared_ptr<const CsvColumnSource>
+CsvColumnSource::open(const std::string &path, const TableData &table,
+                      CsvLoadStats &stats, std::string &error,
+                      unsigned threads) {
+  stats = CsvLoadStats();
+
+  std::shared_ptr<CsvColumnSource> source(new CsvColumnSource(path));
+  const char *body;
+  if (!readHeader(*source->file, path, table, source->layout, body, stats,
+                  error))
+    return nullptr;
+
+  threads = loadThreads(*source->file, threads);
+  stats.threads = threads;
+  const char *base = source->file->data();
+  std::vector<Segment> segments =
+      findSegments(base, body, base + source->file->size(), threads);
+
+  // Every record is checked once, so the row count and the rows of each
+  // column match what loadCsvFile keeps; nothing is stored but the
+  // positions of the malformed records
+  source->segments.resize(segments.size());
+  parallelFor(segments.size(), threads, [&](size_t i) {
+    SourceSegment &segment = source->segments[i];
+    segment.begin = segments[i].begin;
+    segment.end = segments[i].end;
+
+    std::vector<Field> fields;
+    std::string scratch;
+    std::vector<ParsedCell> cells(source->layout.types.size());
+    uint32_t record = 0;
+    for (const char *p = segment.begin; p < segment.end;) {
+      const char *recordEnd;
+      const char *next = recordAt(p, segment.end, recordEnd);
+      if (!isBlank(p, recordEnd)) {
+        if (readRecord(source->layout, p, recordEnd, fields, scratch, cells))
+          segment.rows++;
+        else
+          segment.skipped.push_back(record);
+        record++;
+      }
+      p = next;
+    }
+  });
+
+  for (const auto &segment : source->segments) {
+    source->rowCount += segment.rows;
+    stats.skipped += segment.skipped.size();
+  }
+  stats.rows = source->rowCount;
+  return source;
+}
+
+void CsvColumnSource::loadColumn(size_t column, Column &out,
+                                 unsigned threads) const {
+  // The header field of the column (the last one, as for loadCsvFile),
+  // or -1 if it is missing and the column is NULL
+  int field = -1;
+  for (size_t i = 0; i < layout.headerColumn.size(); i++) {
+    if (layout.headerColumn[i] == static_cast<int>(column))
+      field = static_cast<int>(i);
+  }
+  ColumnType type = layout.types[column];
+
+  std::vector<ColumnChunk> chunks(segments.size());
+  parallelFor(segments.size(), loadThreads(*file, threads), [&](size_t i) {
+    const SourceSegment &segment = segments[i];
+    ColumnChunk &chunk = chunks[i];
+    chunk.nulls.reserve(segment.rows);
+
+    std::vector<Field> fields;
+    std::string scratch;
+    auto skipped = segment.skipped.begin();
+    uint32_t record = 0;
+    for (const char *p = segment.begin; p < segment.end;) {
+      const char *recordEnd;
+      const char *next = recordAt(p, segment.end, recordEnd);
+      const char *start = p;
+      p = next;
+      if (isBlank(start, recordEnd))
+        continue;
+      if (skipped != segment.skipped.end() && *skipped == record) {
+        ++skipped;
+        record++;
+        continue;
+      }
+      record++;
+
+      // The record was checked when the file was indexed
+      Field value{std::string_view(), false, -1};
+      if (field >= 0) {
+        splitRecord(start, recordEnd, fields, scratch,
+                    static_cast<size_t>(field) + 1);
+        value = fields[field];
+      }
+      bool isNull = field < 0 || (value.text.empty() && !value.quoted);
+      chunk.nulls.push_back(isNull ? 1 : 0);
+      switch (type) {
+      case ColumnType::INT: {
+        int64_t number = 0;
+        if (!isNull)
+          parseInt(value.text, number);
+        chunk.ints.push_back(number);
+        break;
+      }
+      case ColumnType::FLOAT: {
+        double number = 0.0;
+        if (!isNull)
+          parseFloat(value.text, number);
+        chunk.floats.push_back(number);
+        break;
+      }
+      case ColumnType::VARCHAR:
+        chunk.codes.push_back(
+            chunk.dict.intern(isNull ? std::string_view() : value.text));
+        break;
+      }
+    }
+  });
+
+  out = Column(type);
+  for (auto &chunk : chunks)
+    out.appendChunk(std::move(chunk));
+}
+
+// ============================================================================
+// WRITING
+// ============================================================================
+void appendCsvField(std::string &line, const std::string &text) {
+  bool quote = text.empty() ||
+               text.find_first_of(",\"\r\n") != std::string::npos ||
+               text.front() == ' ' || text.front() == '\t' ||
+               text.back() == ' ' || text.back() == '\t';
+  if (!quote) {
+    line += text;
+    return;
+  }
+  line += '"';
+  for (char c : text) {
+    if (c == '"')
+      line += '"';
+    line += c;
+  }
+  line += '"';
+}
+
+} // namespace MiniSQL
@@ -4,26 +4,59 @@
  * File: data_store.cpp
  * Description: In-Memory Data Storage Implementation
  *
- * Stores table data as vectors of row maps. Supports CRUD operations
+ * Stores table data as typed column vectors. Supports CRUD operations
  * and CSV file persistence. Pre-loads sample data for demonstration.
  */
 
 #include "../include/data_store.h"
+#include "../include/csv_loader.h"
+#include "../include/memory_tracker.h"
+#include "../include/metrics.h"
+#include "../include/output.h"
+#include "../include/row_cursor.h"
+#include "../include/snapshot.h"
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <numeric>
 
 namespace MiniSQL {
 
+namespace {
+
+// The predicate of a filter an index answers (its first supported
+// conjunct), or nullptr
+const BoundPredicate *indexKey(const BoundFilter &where,
+                               const TableIndex &index) {
+  for (const BoundPredicate *pred : where.conjuncts()) {
+    if (index.supports(*pred))
+      return pred;
+  }
+  return nullptr;
+}
+
+// A DELETE of fewer than 1 / INDEX_ERASE_RATIO of the rows erases them
+// from the indexes row by row; a larger one remaps every index entry
+const size_t INDEX_ERASE_RATIO = 4;
+
+} // namespace
+
 // Constructor
-DataStore::DataStore(const SymbolTable &symbolTable) : dataDir("data") {
+DataStore::DataStore(const SymbolTable &symbolTable)
+    : tablesFixed(false), dataDir("data"), log(nullptr), pool(nullptr),
+      sortMemory(DEFAULT_SORT_MEMORY), compactRatio(DEFAULT_COMPACT_RATIO),
+      compactStopping(false), lazyLoading(false), columnCacheMemory(0),
+      cachedBytes(0), nextCachedId(1) {
   // Initialize table structures from schema
   auto tableNames = symbolTable.getTableNames();
   for (const auto &name : tableNames) {
     const TableInfo *info = symbolTable.getTable(name);
     if (info) {
-      tables[name] = TableData(*info);
+      TableSlot &slot = tables[name];
+      slot.schema = *info;
+      slot.current = std::make_shared<TableData>(*info);
     }
   }
 
@@ -31,6 +64,16 @@ DataStore::DataStore(const SymbolTable &symbolTable) : dataDir("data") {
   loadSampleData();
 }
 
+DataStore::~DataStore() {
+  {
+    std::lock_guard<std::mutex> lock(compactMutex);
+    compactStopping = true;
+  }
+  compactRequested.notify_all();
+  if (compactor.joinable())
+    compactor.join();
+}
+
 // ============================================================================
 // SAMPLE DATA - Pre-loaded for demonstration
 // ============================================================================
@@ -106,103 +149,972 @@ bool DataStore::insertRow(const std::string &tableName,
   if (it == tables.end())
     return false;
 
+  if (it->second.partitioning) {
+    // The row goes to the partition of its key (the logical table never
+    // changes, so it is read without a lock)
+    std::vector<CellValue> cells;
+    if (!convertRow(*it->second.current, columns, values, cells))
+      return false;
+    const PartitionScheme &scheme = *it->second.partitioning;
+    size_t partition = scheme.partitionOf(cells[scheme.columnIndex]);
+    return insertRow(partitionName(tableName, partition), columns, values);
+  }
+
+  std::lock_guard<std::mutex> writer(writeMutex);
+  materialize(tableName, it->second);
+
+  // Convert every value before touching the table, so a bad value leaves
+  // the table unchanged
+  std::vector<CellValue> cells;
+  if (!convertRow(*it->second.current, columns, values, cells))
+    return false;
+
+  uint64_t lsn = 0;
+  if (log) {
+    LogRecord record;
+    record.type = LogRecordType::INSERT;
+    record.table = tableName;
+    record.columns = columns;
+    record.values = values;
+    lsn = logChange(record);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  TableData &table = writableTable(it->second);
+  appendCells(table, cells);
+  if (lsn)
+    table.logSequence = lsn;
+  return true;
+}
+
+bool DataStore::convertRow(const TableData &table,
+                           const std::vector<std::string> &columns,
+                           const std::vector<std::string> &values,
+                           std::vector<CellValue> &cells) {
   if (columns.size() != values.size())
     return false;
 
-  Row row;
+  cells.assign(table.columns.size(), CellValue());
   for (size_t i = 0; i < columns.size(); i++) {
-    row[columns[i]] = values[i];
+    int colIdx = table.columnIndex(columns[i]);
+    if (colIdx < 0)
+      return false;
+    if (!parseCellValue(table.columns[colIdx].getType(), values[i],
+                        cells[colIdx]))
+      return false;
+  }
+  return true;
+}
+
+void DataStore::appendCells(TableData &table,
+                            const std::vector<CellValue> &cells) {
+  for (size_t c = 0; c < table.columns.size(); c++) {
+    table.columns[c].append(cells[c]);
+  }
+  RowId row = static_cast<RowId>(table.rowCount++);
+
+  for (auto &index : table.indexes) {
+    index->insert(table.columns[index->getColumnIndex()], row);
+  }
+}
+
+// ============================================================================
+// BULK INSERT (multi-row INSERT, COPY)
+// ============================================================================
+int DataStore::insertRows(const std::string &tableName,
+                          const std::vector<std::string> &columns,
+                          const std::vector<std::string> &values,
+                          std::string &error) {
+  auto it = tables.find(tableName);
+  if (it == tables.end()) {
+    error = "table '" + tableName + "' not found";
+    return -1;
+  }
+  if (columns.empty() || values.size() % columns.size() != 0) {
+    error = "column/value count mismatch";
+    return -1;
+  }
+
+  // Every value is parsed once, into typed columns, before any lock is
+  // taken
+  TableData staged(it->second.schema);
+  if (!stageRows(columns, values, {}, staged, error))
+    return -1;
+  int count = static_cast<int>(staged.rowCount);
+
+  std::lock_guard<std::mutex> writer(writeMutex);
+  if (it->second.partitioning) {
+    appendPartitions(tableName, it->second,
+                     splitRows(staged, *it->second.partitioning));
+    return count;
+  }
+  materialize(tableName, it->second);
+
+  uint64_t lsn = log ? logRows(tableName, columns, values, {}) : 0;
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  TableData &table = writableTable(it->second);
+  appendTable(table, std::move(staged));
+  if (lsn)
+    table.logSequence = lsn;
+  return count;
+}
+
+int DataStore::copyFromFile(const std::string &tableName,
+                            const std::string &path, size_t &skipped,
+                            std::string &error) {
+  skipped = 0;
+  auto it = tables.find(tableName);
+  if (it == tables.end()) {
+    error = "table '" + tableName + "' not found";
+    return -1;
   }
 
-  it->second.rows.push_back(row);
+  // Parse into chunks of a private table first; readers and writers of
+  // the table are not held up meanwhile
+  TableData staged(it->second.schema);
+  CsvLoadStats stats;
+  if (!loadCsvFile(path, staged, stats, error,
+                   pool ? static_cast<unsigned>(pool->size()) : 0))
+    return -1;
+  if (!stats.ignoredColumns.empty()) {
+    error = "'" + path + "' has column '" + stats.ignoredColumns[0] +
+            "', which table '" + tableName + "' does not have";
+    return -1;
+  }
+  skipped = stats.skipped;
+  int count = static_cast<int>(staged.rowCount);
+
+  if (it->second.partitioning) {
+    std::vector<TableData> parts = splitRows(staged, *it->second.partitioning);
+    std::lock_guard<std::mutex> writer(writeMutex);
+    appendPartitions(tableName, it->second, std::move(parts));
+    return count;
+  }
+
+  std::lock_guard<std::mutex> writer(writeMutex);
+  materialize(tableName, it->second);
+
+  uint64_t lsn = log ? logTable(tableName, staged) : 0;
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  TableData &table = writableTable(it->second);
+  appendTable(table, std::move(staged));
+  if (lsn)
+    table.logSequence = lsn;
+  return count;
+}
+
+uint64_t DataStore::logTable(const std::string &tableName,
+                             const TableData &staged) {
+  // Logged as text, one record per chunk of rows
+  std::vector<std::string> names;
+  for (const auto &col : staged.schema.columns)
+    names.push_back(col.name);
+  std::vector<std::string> values;
+  std::vector<uint8_t> nulls;
+  uint64_t lsn = 0;
+  for (size_t begin = 0; begin < staged.rowCount; begin += COLUMN_CHUNK_ROWS) {
+    size_t end = std::min(staged.rowCount, begin + COLUMN_CHUNK_ROWS);
+    values.clear();
+    nulls.clear();
+    for (size_t row = begin; row < end; row++) {
+      for (const Column &column : staged.columns) {
+        bool isNull = column.isNull(row);
+        nulls.push_back(isNull ? 1 : 0);
+        values.push_back(isNull ? std::string() : column.getText(row));
+      }
+    }
+    lsn = logRows(tableName, names, values, nulls);
+  }
+  return lsn;
+}
+
+void DataStore::appendTable(TableData &table, TableData &&staged) {
+  RowId first = static_cast<RowId>(table.rowCount);
+  for (size_t c = 0; c < table.columns.size(); c++)
+    table.columns[c].appendColumn(std::move(staged.columns[c]));
+  table.rowCount += staged.rowCount;
+  for (auto &index : table.indexes) {
+    index->insertRows(table.columns[index->getColumnIndex()], first,
+                      static_cast<RowId>(table.rowCount));
+  }
+}
+
+void DataStore::appendPartitions(const std::string &tableName,
+                                 TableSlot &slot,
+                                 std::vector<TableData> &&parts) {
+  // Every partition receives its share, all published together
+  std::vector<uint64_t> lsns(parts.size(), 0);
+  for (size_t p = 0; p < parts.size(); p++) {
+    if (log && parts[p].rowCount)
+      lsns[p] = logTable(partitionName(tableName, p), parts[p]);
+  }
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  for (size_t p = 0; p < parts.size(); p++) {
+    if (!parts[p].rowCount)
+      continue;
+    TableData &table = writableTable(*slot.partitions[p]);
+    appendTable(table, std::move(parts[p]));
+    if (lsns[p])
+      table.logSequence = lsns[p];
+  }
+}
+
+bool DataStore::stageRows(const std::vector<std::string> &columns,
+                          const std::vector<std::string> &values,
+                          const std::vector<uint8_t> &nulls,
+                          TableData &staged, std::string &error) {
+  std::vector<uint8_t> listed(staged.columns.size(), 0);
+  for (const auto &name : columns) {
+    int colIdx = staged.columnIndex(name);
+    if (colIdx < 0) {
+      error = "column '" + name + "' not found";
+      return false;
+    }
+    if (listed[colIdx]) {
+      error = "column '" + name + "' is listed twice";
+      return false;
+    }
+    listed[colIdx] = 1;
+  }
+
+  // Column by column: each listed value is parsed straight into the
+  // column's chunks, the other columns are NULL
+  size_t width = columns.size();
+  size_t rows = values.size() / width;
+  CellValue cell;
+  for (size_t k = 0; k < width; k++) {
+    Column &column = staged.columns[staged.columnIndex(columns[k])];
+    for (size_t i = k; i < values.size(); i += width) {
+      if (!nulls.empty() && nulls[i]) {
+        cell.isNull = true;
+      } else if (!parseCellValue(column.getType(), values[i], cell)) {
+        error = "value '" + values[i] +
+                "' does not match the type of column '" + columns[k] + "'";
+        return false;
+      }
+      column.append(cell);
+    }
+  }
+  cell.isNull = true;
+  for (size_t c = 0; c < staged.columns.size(); c++) {
+    for (size_t r = 0; !listed[c] && r < rows; r++)
+      staged.columns[c].append(cell);
+  }
+  staged.rowCount = rows;
   return true;
 }
 
+uint64_t DataStore::logRows(const std::string &tableName,
+                            const std::vector<std::string> &columns,
+                            const std::vector<std::string> &values,
+                            const std::vector<uint8_t> &nulls) {
+  size_t perRecord = COLUMN_CHUNK_ROWS * columns.size();
+  uint64_t lsn = 0;
+  for (size_t begin = 0; begin < values.size(); begin += perRecord) {
+    size_t end = std::min(values.size(), begin + perRecord);
+    LogRecord record;
+    record.type = LogRecordType::INSERT_ROWS;
+    record.table = tableName;
+    record.columns = columns;
+    record.values.assign(values.begin() + begin, values.begin() + end);
+    if (!nulls.empty())
+      record.nulls.assign(nulls.begin() + begin, nulls.begin() + end);
+    lsn = logChange(record);
+  }
+  return lsn;
+}
+
 // ============================================================================
-// GET ALL ROWS
+// TABLE VERSIONS
 // ============================================================================
-std::vector<Row> DataStore::getRows(const std::string &tableName) const {
+TableSnapshot DataStore::snapshot(const std::string &tableName) const {
   auto it = tables.find(tableName);
   if (it == tables.end())
-    return {};
-  return it->second.rows;
+    return nullptr;
+  if (it->second.partitioning)
+    return gatherPartitions(it->second, partitionSnapshots(tableName));
+  std::shared_lock<std::shared_mutex> lock(versionMutex);
+  return it->second.current;
+}
+
+TableData &DataStore::writableTable(TableSlot &slot) {
+  if (slot.current.use_count() > 1) {
+    // A reader holds this version: continue on a copy sharing its chunks
+    slot.current = std::make_shared<TableData>(*slot.current);
+  } else {
+    // Pairs with the release of the last reader's snapshot, so its reads
+    // happen before our writes
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return *slot.current;
 }
 
 // ============================================================================
-// GET FILTERED ROWS (WHERE clause)
+// PARTITIONS
 // ============================================================================
-std::vector<Row> DataStore::getFilteredRows(const std::string &tableName,
-                                            const std::string &column,
-                                            const std::string &op,
-                                            const std::string &value) const {
+bool DataStore::partitionTable(const std::string &tableName,
+                               const PartitionScheme &scheme,
+                               std::string &error) {
+  auto it = tables.find(tableName);
+  if (it == tables.end() || it->second.isPartition) {
+    error = "table '" + tableName + "' not found";
+    return false;
+  }
+  TableSlot &slot = it->second; // Stays valid as partitions are added
+  if (slot.partitioning) {
+    error = "table '" + tableName + "' is partitioned already";
+    return false;
+  }
+  if (tablesFixed || log) {
+    error = std::string(tablesFixed ? "sessions share the tables"
+                                    : "a write-ahead log is attached") +
+            "; partition '" + tableName + "' at startup (--partition)";
+    return false;
+  }
+  if (scheme.columnIndex < 0 ||
+      static_cast<size_t>(scheme.columnIndex) >= slot.schema.columns.size() ||
+      scheme.count < 1 || scheme.count > MAX_PARTITIONS) {
+    error = "invalid partitioning of table '" + tableName + "'";
+    return false;
+  }
+
+  TableSnapshot whole = fullSnapshot(tableName);
+  if (!whole->indexes.empty()) {
+    error = "table '" + tableName +
+            "' has indexes; partition it before creating them";
+    return false;
+  }
+  std::vector<TableData> parts = splitRows(*whole, scheme);
+
+  // The compactor looks tables up while they are added otherwise
+  std::lock_guard<std::mutex> compacting(compactingMutex);
+  std::lock_guard<std::mutex> writer(writeMutex);
+  forgetColumns(tableName);
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  for (size_t p = 0; p < parts.size(); p++) {
+    std::string name = partitionName(tableName, p);
+    TableSlot &part = tables[name];
+    part.schema = slot.schema;
+    part.schema.name = name; // Its checkpoint is <name>.snap
+    parts[p].schema.name = name;
+    part.current = std::make_shared<TableData>(std::move(parts[p]));
+    part.isPartition = true;
+    slot.partitions.push_back(&part);
+  }
+  slot.current = std::make_shared<TableData>(slot.schema);
+  slot.stats = nullptr;
+  slot.partitioning = std::make_shared<const PartitionScheme>(scheme);
+  return true;
+}
+
+std::shared_ptr<const PartitionScheme>
+DataStore::getPartitioning(const std::string &tableName) const {
+  // Set only while one session uses the store (see fixTables), so read
+  // without a lock
+  auto it = tables.find(tableName);
+  return it == tables.end() ? nullptr : it->second.partitioning;
+}
+
+std::vector<TableSnapshot>
+DataStore::partitionSnapshots(const std::string &tableName) const {
+  std::vector<TableSnapshot> parts;
   auto it = tables.find(tableName);
   if (it == tables.end())
+    return parts;
+  std::shared_lock<std::shared_mutex> lock(versionMutex);
+  for (const TableSlot *part : it->second.partitions)
+    parts.push_back(part->current);
+  return parts;
+}
+
+std::vector<std::shared_ptr<RowCursor>>
+DataStore::openPartitionCursors(const std::string &tableName,
+                                const BoundFilter *where,
+                                const std::vector<size_t> &partitions,
+                                const std::vector<AccessPlan> &access) const {
+  auto it = tables.find(tableName);
+  if (it == tables.end() || !it->second.partitioning)
     return {};
+  std::vector<const TableSlot *> slots;
+  for (size_t p : partitions)
+    slots.push_back(it->second.partitions[p]);
+  return openCursors(slots, where, access);
+}
+
+TableSnapshot
+DataStore::gatherPartitions(const TableSlot &slot,
+                            const std::vector<TableSnapshot> &parts) {
+  auto table = std::make_shared<TableData>(slot.schema);
+  for (const TableSnapshot &part : parts) {
+    // The copy shares the partition's chunks until it drops deleted rows
+    TableData rows(*part);
+    rows.indexes.clear();
+    if (!rows.deleted.empty())
+      compactColumns(rows);
+    for (size_t c = 0; c < table->columns.size(); c++)
+      table->columns[c].appendColumn(std::move(rows.columns[c]));
+    table->rowCount += rows.rowCount;
+  }
+  return table;
+}
+
+std::vector<TableData> DataStore::splitRows(const TableData &table,
+                                            const PartitionScheme &scheme) {
+  std::vector<TableData> parts;
+  for (size_t p = 0; p < scheme.count; p++)
+    parts.emplace_back(table.schema);
+
+  const Column &keys = table.columns[scheme.columnIndex];
+  for (size_t row = 0; row < table.rowCount; row++) {
+    if (table.deleted.contains(row))
+      continue;
+    TableData &part = parts[scheme.partitionOf(keys.getCell(row))];
+    for (size_t c = 0; c < table.columns.size(); c++)
+      part.columns[c].append(table.columns[c].getCell(row));
+    part.rowCount++;
+  }
+  return parts;
+}
+
+// ============================================================================
+// LAZY COLUMNS
+// ============================================================================
+ColumnLease::~ColumnLease() {
+  if (store)
+    store->releaseColumns(*this);
+}
+
+void DataStore::loadColumns(const std::string &tableName,
+                            const std::vector<std::string> &columns,
+                            ColumnLease &lease) {
+  auto it = tables.find(tableName);
+  if (it == tables.end())
+    return;
+
+  std::vector<size_t> wanted;
+  for (const auto &name : columns) {
+    if (name == "*") {
+      wanted.resize(it->second.schema.columns.size());
+      std::iota(wanted.begin(), wanted.end(), 0);
+      break;
+    }
+    int colIdx = it->second.schema.columnIndex(name);
+    if (colIdx >= 0)
+      wanted.push_back(static_cast<size_t>(colIdx));
+  }
+
+  // Tables that are not lazy (most) are not held up by the writer lock
+  {
+    std::shared_lock<std::shared_mutex> lock(versionMutex);
+    if (!it->second.current->source)
+      return;
+  }
+  std::lock_guard<std::mutex> writer(writeMutex);
+  residentColumns(tableName, it->second, std::move(wanted), &lease);
+}
+
+void DataStore::residentColumns(const std::string &tableName, TableSlot &slot,
+                                std::vector<size_t> columns,
+                                ColumnLease *lease) {
+  const TableData &current = *slot.current;
+  if (!current.source)
+    return;
+  std::sort(columns.begin(), columns.end());
+  columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+
+  // Parse the missing columns; readers carry on with the current version
+  std::vector<std::pair<size_t, Column>> loaded;
+  for (size_t c : columns) {
+    if (current.isResident(c))
+      continue;
+    loaded.emplace_back(c, Column());
+    current.source->loadColumn(c, loaded.back().second, loadThreads());
+  }
+
+  std::vector<std::pair<std::string, size_t>> evicted;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (const auto &entry : loaded) {
+      MemoryUsage usage;
+      entry.second.memoryUsage(usage);
+      cachedColumns.push_back(CachedColumn{nextCachedId++, tableName,
+                                           entry.first, usage.allocated(), 0});
+      cachedBytes += usage.allocated();
+    }
 
-  std::vector<Row> result;
-  for (const auto &row : it->second.rows) {
-    auto colIt = row.find(column);
-    if (colIt != row.end()) {
-      if (compareValues(colIt->second, op, value)) {
-        result.push_back(row);
+    // The columns used now become the most recently used
+    for (size_t c : columns) {
+      for (auto entry = cachedColumns.begin(); entry != cachedColumns.end();
+           ++entry) {
+        if (entry->table != tableName || entry->column != c)
+          continue;
+        cachedColumns.splice(cachedColumns.end(), cachedColumns, entry);
+        if (lease) {
+          entry->pins++;
+          lease->store = this;
+          lease->columns.push_back(entry->id);
+        }
+        break;
       }
     }
+
+    // Drop the least recently used columns no statement holds and no
+    // index needs
+    auto entry = cachedColumns.begin();
+    while (columnCacheMemory > 0 && cachedBytes > columnCacheMemory &&
+           entry != cachedColumns.end()) {
+      const TableData &owner = *tables.find(entry->table)->second.current;
+      bool indexed = std::any_of(
+          owner.indexes.begin(), owner.indexes.end(), [&](const auto &idx) {
+            return idx->getColumnIndex() == static_cast<int>(entry->column);
+          });
+      if (entry->pins > 0 || indexed ||
+          (entry->table == tableName &&
+           std::binary_search(columns.begin(), columns.end(),
+                              entry->column))) {
+        ++entry;
+        continue;
+      }
+      evicted.emplace_back(entry->table, entry->column);
+      cachedBytes -= entry->bytes;
+      entry = cachedColumns.erase(entry);
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  if (!loaded.empty()) {
+    TableData &table = writableTable(slot);
+    for (auto &entry : loaded) {
+      table.columns[entry.first] = std::move(entry.second);
+      table.resident[entry.first] = 1;
+    }
+  }
+  for (const auto &victim : evicted) {
+    TableData &table = writableTable(tables.find(victim.first)->second);
+    table.columns[victim.second] =
+        Column(table.columns[victim.second].getType());
+    table.resident[victim.second] = 0;
+  }
+}
+
+void DataStore::materialize(const std::string &tableName, TableSlot &slot) {
+  const TableData &current = *slot.current;
+  if (!current.source)
+    return;
+
+  std::vector<std::pair<size_t, Column>> loaded;
+  for (size_t c = 0; c < current.columns.size(); c++) {
+    if (current.isResident(c))
+      continue;
+    loaded.emplace_back(c, Column());
+    current.source->loadColumn(c, loaded.back().second, loadThreads());
+  }
+  forgetColumns(tableName);
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  TableData &table = writableTable(slot);
+  for (auto &entry : loaded)
+    table.columns[entry.first] = std::move(entry.second);
+  table.source.reset();
+  table.resident.clear();
+}
+
+void DataStore::fillColumns(TableData &table) const {
+  if (!table.source)
+    return;
+  for (size_t c = 0; c < table.columns.size(); c++) {
+    if (!table.isResident(c))
+      table.source->loadColumn(c, table.columns[c], loadThreads());
+  }
+  table.source.reset();
+  table.resident.clear();
+}
+
+void DataStore::cacheColumns(const std::string &tableName,
+                             const TableData &table) {
+  if (!table.source)
+    return;
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  for (size_t c = 0; c < table.columns.size(); c++) {
+    if (!table.resident[c])
+      continue;
+    MemoryUsage usage;
+    table.columns[c].memoryUsage(usage);
+    cachedColumns.push_back(
+        CachedColumn{nextCachedId++, tableName, c, usage.allocated(), 0});
+    cachedBytes += usage.allocated();
   }
-  return result;
+}
+
+TableSnapshot DataStore::fullSnapshot(const std::string &tableName) const {
+  TableSnapshot table = snapshot(tableName);
+  if (!table || !table->source)
+    return table;
+  auto copy = std::make_shared<TableData>(*table);
+  fillColumns(*copy);
+  return copy;
+}
+
+void DataStore::forgetColumns(const std::string &tableName) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  for (auto entry = cachedColumns.begin(); entry != cachedColumns.end();) {
+    if (entry->table == tableName) {
+      cachedBytes -= entry->bytes;
+      entry = cachedColumns.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+}
+
+void DataStore::releaseColumns(ColumnLease &lease) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  // Columns forgotten meanwhile (their table was changed) have no entry
+  for (uint64_t id : lease.columns) {
+    for (auto &entry : cachedColumns) {
+      if (entry.id == id) {
+        entry.pins--;
+        break;
+      }
+    }
+  }
+  lease.columns.clear();
+}
+
+// ============================================================================
+// ROW CURSORS (WHERE clause)
+// ============================================================================
+std::shared_ptr<RowCursor>
+DataStore::openCursor(const std::string &tableName, const BoundFilter &where,
+                      const AccessPlan &access) const {
+  auto it = tables.find(tableName);
+  if (it == tables.end())
+    return nullptr;
+
+  if (it->second.partitioning) {
+    // The partitions the filter may match, gathered into one table
+    std::vector<TableSnapshot> parts = partitionSnapshots(tableName);
+    std::vector<TableSnapshot> read;
+    for (size_t p : it->second.partitioning->prune(&where))
+      read.push_back(parts[p]);
+    return std::make_shared<RowCursor>(gatherPartitions(it->second, read),
+                                       where, access.parallel ? pool : nullptr);
+  }
+  return openCursors({&it->second}, &where, {access}).front();
+}
+
+std::vector<std::shared_ptr<RowCursor>>
+DataStore::openCursors(const std::vector<const TableSlot *> &slots,
+                       const BoundFilter *where,
+                       const std::vector<AccessPlan> &access) const {
+  // Indexes describe the newest version, so probe them while taking it
+  std::vector<TableSnapshot> snapshots(slots.size());
+  std::vector<SelectionVector> candidates(slots.size());
+  std::vector<const BoundPredicate *> keys(slots.size(), nullptr);
+  for (size_t i = 0; i < slots.size(); i++) {
+    if (where && access[i].index)
+      keys[i] = indexKey(*where, *access[i].index);
+  }
+  {
+    std::shared_lock<std::shared_mutex> lock(versionMutex);
+    for (size_t i = 0; i < slots.size(); i++) {
+      snapshots[i] = slots[i]->current;
+      if (keys[i])
+        access[i].index->lookup(*keys[i], candidates[i]);
+    }
+  }
+
+  std::vector<std::shared_ptr<RowCursor>> cursors;
+  for (size_t i = 0; i < slots.size(); i++) {
+    if (!where) {
+      cursors.push_back(std::make_shared<RowCursor>(std::move(snapshots[i])));
+    } else if (!keys[i]) {
+      cursors.push_back(std::make_shared<RowCursor>(
+          std::move(snapshots[i]), *where,
+          access[i].parallel ? pool : nullptr));
+    } else {
+      // The index answered the filter, or one AND operand of it, in which
+      // case the rest is checked per candidate
+      recordBytes(candidates[i].capacity() * sizeof(RowId));
+      bool residual = where->kind != BoundFilter::Kind::PREDICATE;
+      cursors.push_back(std::make_shared<RowCursor>(
+          std::move(snapshots[i]), std::move(candidates[i]), *where,
+          residual));
+    }
+  }
+  return cursors;
 }
 
 // ============================================================================
 // UPDATE ROWS
 // ============================================================================
 int DataStore::updateRows(const std::string &tableName,
-                          const std::string &setColumn,
-                          const std::string &setValue,
-                          const std::string &whereColumn,
-                          const std::string &whereOp,
-                          const std::string &whereValue) {
+                          const std::vector<std::string> &columns,
+                          const std::vector<std::string> &values,
+                          const BoundFilter &where, const AccessPlan &access,
+                          std::string &error) {
   auto it = tables.find(tableName);
-  if (it == tables.end())
+  if (it == tables.end()) {
+    error = "table '" + tableName + "' not found";
+    return -1;
+  }
+
+  // Writers are serialized, so the newest version stays put while the
+  // matching rows are found without blocking readers
+  std::lock_guard<std::mutex> writer(writeMutex);
+  if (it->second.partitioning)
+    return updatePartitions(tableName, it->second, columns, values, where,
+                            error);
+  materialize(tableName, it->second);
+  const TableData &current = *it->second.current;
+  std::vector<int> targets;
+  std::vector<CellValue> cells;
+  if (!convertAssignments(current, columns, values, targets, cells, error))
+    return -1;
+
+  SelectionVector rows = matchRows(current, where, access);
+  chargeMemory(rows.capacity() * sizeof(RowId));
+  if (rows.empty())
     return 0;
 
-  int count = 0;
-  for (auto &row : it->second.rows) {
-    auto colIt = row.find(whereColumn);
-    if (colIt != row.end()) {
-      if (compareValues(colIt->second, whereOp, whereValue)) {
-        row[setColumn] = setValue;
-        count++;
-      }
+  uint64_t lsn = 0;
+  if (log) {
+    LogRecord record;
+    record.type = LogRecordType::UPDATE_SET;
+    record.table = tableName;
+    record.columns = columns;
+    record.values = values;
+    record.rows = rows;
+    lsn = logChange(record);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  TableData &table = writableTable(it->second);
+  int count = updateMatching(table, targets, cells, rows);
+  if (lsn)
+    table.logSequence = lsn;
+  return count;
+}
+
+int DataStore::updatePartitions(const std::string &tableName, TableSlot &slot,
+                                const std::vector<std::string> &columns,
+                                const std::vector<std::string> &values,
+                                const BoundFilter &where, std::string &error) {
+  const PartitionScheme &scheme = *slot.partitioning;
+  std::vector<int> targets;
+  std::vector<CellValue> cells;
+  if (!convertAssignments(*slot.current, columns, values, targets, cells,
+                          error))
+    return -1;
+  if (std::find(targets.begin(), targets.end(), scheme.columnIndex) !=
+      targets.end()) {
+    error = "column '" + scheme.column + "' is the partition key of table '" +
+            tableName + "' and cannot be updated";
+    return -1;
+  }
+
+  // Find the rows in each partition the filter may match, then update
+  // all of them together
+  std::vector<size_t> parts = scheme.prune(&where);
+  std::vector<SelectionVector> rows(parts.size());
+  std::vector<uint64_t> lsns(parts.size(), 0);
+  for (size_t i = 0; i < parts.size(); i++) {
+    std::string name = partitionName(tableName, parts[i]);
+    rows[i] = matchRows(*slot.partitions[parts[i]]->current, where,
+                        chooseAccess(name, where));
+    chargeMemory(rows[i].capacity() * sizeof(RowId));
+    if (log && !rows[i].empty()) {
+      LogRecord record;
+      record.type = LogRecordType::UPDATE_SET;
+      record.table = name;
+      record.columns = columns;
+      record.values = values;
+      record.rows = rows[i];
+      lsns[i] = logChange(record);
     }
   }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  int count = 0;
+  for (size_t i = 0; i < parts.size(); i++) {
+    if (rows[i].empty())
+      continue;
+    TableData &table = writableTable(*slot.partitions[parts[i]]);
+    count += updateMatching(table, targets, cells, rows[i]);
+    if (lsns[i])
+      table.logSequence = lsns[i];
+  }
   return count;
 }
 
+bool DataStore::convertAssignments(const TableData &table,
+                                   const std::vector<std::string> &columns,
+                                   const std::vector<std::string> &values,
+                                   std::vector<int> &targets,
+                                   std::vector<CellValue> &cells,
+                                   std::string &error) {
+  if (columns.empty() || columns.size() != values.size()) {
+    error = "column/value count mismatch";
+    return false;
+  }
+  targets.clear();
+  cells.assign(columns.size(), CellValue());
+  for (size_t i = 0; i < columns.size(); i++) {
+    int colIdx = table.columnIndex(columns[i]);
+    if (colIdx < 0) {
+      error = "column '" + columns[i] + "' not found";
+      return false;
+    }
+    if (!parseCellValue(table.columns[colIdx].getType(), values[i],
+                        cells[i])) {
+      error = "value '" + values[i] +
+              "' does not match the type of column '" + columns[i] + "'";
+      return false;
+    }
+    targets.push_back(colIdx);
+  }
+  return true;
+}
+
+int DataStore::updateMatching(TableData &table,
+                              const std::vector<int> &targets,
+                              const std::vector<CellValue> &cells,
+                              const SelectionVector &rows) {
+  // Indexes on an updated column must see the old value removed and the
+  // new value added
+  std::vector<std::vector<TableIndex *>> affected(targets.size());
+  for (auto &idx : table.indexes) {
+    for (size_t i = 0; i < targets.size(); i++) {
+      if (idx->getColumnIndex() == targets[i])
+        affected[i].push_back(idx.get());
+    }
+  }
+
+  for (RowId row : rows) {
+    for (size_t i = 0; i < targets.size(); i++) {
+      Column &target = table.columns[targets[i]];
+      for (auto *idx : affected[i])
+        idx->erase(target, row);
+      target.set(row, cells[i]);
+      for (auto *idx : affected[i])
+        idx->insert(target, row);
+    }
+  }
+  return static_cast<int>(rows.size());
+}
+
 // ============================================================================
 // DELETE ROWS
 // ============================================================================
 int DataStore::deleteRows(const std::string &tableName,
-                          const std::string &whereColumn,
-                          const std::string &whereOp,
-                          const std::string &whereValue) {
+                          const BoundFilter &where,
+                          const AccessPlan &access) {
   auto it = tables.find(tableName);
   if (it == tables.end())
     return 0;
 
-  int originalSize = static_cast<int>(it->second.rows.size());
+  int count = 0;
+  std::vector<std::string> compact;
+  {
+    std::lock_guard<std::mutex> writer(writeMutex);
+    if (it->second.partitioning) {
+      count = deletePartitions(tableName, it->second, where, compact);
+    } else {
+      materialize(tableName, it->second);
+      SelectionVector rows = matchRows(*it->second.current, where, access);
+      chargeMemory(rows.capacity() * sizeof(RowId));
+      if (rows.empty())
+        return 0;
+
+      uint64_t lsn = 0;
+      if (log) {
+        LogRecord record;
+        record.type = LogRecordType::DELETE_MARK;
+        record.table = tableName;
+        record.rows = rows;
+        lsn = logChange(record);
+      }
+
+      std::unique_lock<std::shared_mutex> lock(versionMutex);
+      TableData &table = writableTable(it->second);
+      count = markDeleted(table, rows);
+      if (lsn)
+        table.logSequence = lsn;
+      if (needsCompaction(table))
+        compact.push_back(tableName);
+    }
+  }
+
+  for (const auto &name : compact)
+    requestCompaction(name);
+  return count;
+}
+
+int DataStore::deletePartitions(const std::string &tableName, TableSlot &slot,
+                                const BoundFilter &where,
+                                std::vector<std::string> &compact) {
+  // Find the rows in each partition the filter may match, then delete
+  // all of them together
+  std::vector<size_t> parts = slot.partitioning->prune(&where);
+  std::vector<SelectionVector> rows(parts.size());
+  std::vector<uint64_t> lsns(parts.size(), 0);
+  for (size_t i = 0; i < parts.size(); i++) {
+    std::string name = partitionName(tableName, parts[i]);
+    rows[i] = matchRows(*slot.partitions[parts[i]]->current, where,
+                        chooseAccess(name, where));
+    chargeMemory(rows[i].capacity() * sizeof(RowId));
+    if (log && !rows[i].empty()) {
+      LogRecord record;
+      record.type = LogRecordType::DELETE_MARK;
+      record.table = name;
+      record.rows = rows[i];
+      lsns[i] = logChange(record);
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  int count = 0;
+  for (size_t i = 0; i < parts.size(); i++) {
+    if (rows[i].empty())
+      continue;
+    TableData &table = writableTable(*slot.partitions[parts[i]]);
+    count += markDeleted(table, rows[i]);
+    if (lsns[i])
+      table.logSequence = lsns[i];
+    if (needsCompaction(table))
+      compact.push_back(partitionName(tableName, parts[i]));
+  }
+  return count;
+}
 
-  it->second.rows.erase(
-      std::remove_if(it->second.rows.begin(), it->second.rows.end(),
-                     [&](const Row &row) {
-                       auto colIt = row.find(whereColumn);
-                       if (colIt != row.end()) {
-                         return compareValues(colIt->second, whereOp,
-                                              whereValue);
-                       }
-                       return false;
-                     }),
-      it->second.rows.end());
+int DataStore::markDeleted(TableData &table, const SelectionVector &rows) {
+  // A few rows are erased from the indexes one by one; a large share of
+  // the table in one pass over each index
+  if (rows.size() * INDEX_ERASE_RATIO < table.rowCount) {
+    for (auto &idx : table.indexes) {
+      const Column &values = table.columns[idx->getColumnIndex()];
+      for (RowId row : rows)
+        idx->erase(values, row);
+    }
+  } else if (rows.size() == table.liveRows()) {
+    for (auto &idx : table.indexes)
+      idx->clear();
+  } else if (!table.indexes.empty()) {
+    std::vector<RowId> newIds(table.rowCount);
+    for (size_t row = 0; row < table.rowCount; row++)
+      newIds[row] = static_cast<RowId>(row);
+    for (RowId row : rows)
+      newIds[row] = DELETED_ROW;
+    for (auto &idx : table.indexes)
+      idx->remap(newIds);
+  }
 
-  return originalSize - static_cast<int>(it->second.rows.size());
+  int count = 0;
+  for (RowId row : rows)
+    count += table.deleted.insert(row) ? 1 : 0;
+  return count;
 }
 
 int DataStore::deleteAllRows(const std::string &tableName) {
@@ -210,19 +1122,294 @@ int DataStore::deleteAllRows(const std::string &tableName) {
   if (it == tables.end())
     return 0;
 
-  int count = static_cast<int>(it->second.rows.size());
-  it->second.rows.clear();
+  std::lock_guard<std::mutex> writer(writeMutex);
+  if (it->second.partitioning) {
+    // Every partition is truncated, all published together
+    const auto &parts = it->second.partitions;
+    int count = 0;
+    std::vector<uint64_t> lsns(parts.size(), 0);
+    for (size_t p = 0; p < parts.size(); p++) {
+      count += static_cast<int>(parts[p]->current->rowCount);
+      if (log) {
+        LogRecord record;
+        record.type = LogRecordType::TRUNCATE;
+        record.table = partitionName(tableName, p);
+        lsns[p] = logChange(record);
+      }
+    }
+    std::unique_lock<std::shared_mutex> lock(versionMutex);
+    for (size_t p = 0; p < parts.size(); p++) {
+      TableData &table = writableTable(*parts[p]);
+      clearTable(table);
+      if (lsns[p])
+        table.logSequence = lsns[p];
+    }
+    return count;
+  }
+
+  int count = static_cast<int>(it->second.current->rowCount);
+  // A lazy table's columns are not loaded just to be cleared
+  forgetColumns(tableName);
+
+  uint64_t lsn = 0;
+  if (log) {
+    LogRecord record;
+    record.type = LogRecordType::TRUNCATE;
+    record.table = tableName;
+    lsn = logChange(record);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  TableData &table = writableTable(it->second);
+  clearTable(table);
+  if (lsn)
+    table.logSequence = lsn;
   return count;
 }
 
+void DataStore::clearTable(TableData &table) {
+  for (auto &column : table.columns) {
+    column.clear();
+  }
+  for (auto &index : table.indexes) {
+    index->clear();
+  }
+  table.rowCount = 0;
+  table.deleted.clear();
+  table.source.reset();
+  table.resident.clear();
+}
+
 // ============================================================================
-// UTILITY METHODS
+// COMPACTION
 // ============================================================================
-int DataStore::getRowCount(const std::string &tableName) const {
+std::vector<RowId> DataStore::compactColumns(TableData &table) {
+  std::vector<uint8_t> keep(table.rowCount);
+  std::vector<RowId> newIds(table.rowCount);
+  RowId next = 0;
+  for (size_t row = 0; row < table.rowCount; row++) {
+    keep[row] = !table.deleted.contains(row);
+    newIds[row] = keep[row] ? next++ : DELETED_ROW;
+  }
+  for (auto &column : table.columns)
+    column.compact(keep);
+  table.rowCount = next;
+  table.deleted.clear();
+  return newIds;
+}
+
+int DataStore::compactTable(const std::string &tableName) {
   auto it = tables.find(tableName);
   if (it == tables.end())
     return 0;
-  return static_cast<int>(it->second.rows.size());
+
+  if (it->second.partitioning) {
+    int count = 0;
+    for (size_t p = 0; p < it->second.partitions.size(); p++)
+      count += compactTable(partitionName(tableName, p));
+    return count;
+  }
+
+  std::lock_guard<std::mutex> writer(writeMutex);
+  int count = static_cast<int>(it->second.current->deleted.size());
+  if (count == 0)
+    return 0;
+  materialize(tableName, it->second);
+  const TableData &current = *it->second.current;
+
+  // Compact a copy: readers keep the current version meanwhile, and the
+  // (shared) indexes keep describing it until the copy is published
+  auto compacted = std::make_shared<TableData>(current);
+  std::vector<RowId> newIds = compactColumns(*compacted);
+
+  uint64_t lsn = 0;
+  if (log) {
+    LogRecord record;
+    record.type = LogRecordType::COMPACT;
+    record.table = tableName;
+    lsn = logChange(record);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  for (auto &idx : compacted->indexes)
+    idx->remap(newIds);
+  if (lsn)
+    compacted->logSequence = lsn;
+  it->second.current = std::move(compacted);
+  return count;
+}
+
+bool DataStore::needsCompaction(const TableData &table) const {
+  return compactRatio > 0 && table.deleted.size() >= COMPACT_MIN_ROWS &&
+         static_cast<double>(table.deleted.size()) >=
+             compactRatio * static_cast<double>(table.rowCount);
+}
+
+void DataStore::requestCompaction(const std::string &tableName) {
+  {
+    std::lock_guard<std::mutex> lock(compactMutex);
+    if (compactStopping)
+      return;
+    if (std::find(compactQueue.begin(), compactQueue.end(), tableName) ==
+        compactQueue.end())
+      compactQueue.push_back(tableName);
+    if (!compactor.joinable())
+      compactor = std::thread(&DataStore::compactorLoop, this);
+  }
+  compactRequested.notify_one();
+}
+
+void DataStore::compactorLoop() {
+  std::unique_lock<std::mutex> lock(compactMutex);
+  while (true) {
+    compactRequested.wait(
+        lock, [&] { return compactStopping || !compactQueue.empty(); });
+    if (compactStopping)
+      return;
+    std::string tableName = std::move(compactQueue.front());
+    compactQueue.erase(compactQueue.begin());
+
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> compacting(compactingMutex);
+      compactTable(tableName);
+    }
+    lock.lock();
+  }
+}
+
+// ============================================================================
+// WRITE-AHEAD LOG
+// ============================================================================
+uint64_t DataStore::logChange(LogRecord &record) {
+  return log->append(record);
+}
+
+void DataStore::attachLog(WriteAheadLog *wal) {
+  std::lock_guard<std::mutex> writer(writeMutex);
+  log = wal;
+}
+
+bool DataStore::applyLogRecord(const LogRecord &record) {
+  // The changes of a partitioned table are logged by partition
+  auto it = tables.find(record.table);
+  if (it == tables.end() || it->second.partitioning)
+    return false;
+
+  std::lock_guard<std::mutex> writer(writeMutex);
+  materialize(record.table, it->second);
+  const TableData &current = *it->second.current;
+
+  // UPDATE and DELETE name rows by position; they must exist
+  for (RowId row : record.rows) {
+    if (row >= current.rowCount)
+      return false;
+  }
+
+  // Validate before publishing a new version; replayed changes are never
+  // logged again
+  std::vector<CellValue> cells;
+  std::vector<int> targets;
+  TableData staged(it->second.schema);
+  std::string error;
+  switch (record.type) {
+  case LogRecordType::INSERT:
+    if (!convertRow(current, record.columns, record.values, cells))
+      return false;
+    break;
+  case LogRecordType::INSERT_ROWS:
+    if (record.columns.empty() ||
+        record.values.size() % record.columns.size() != 0 ||
+        (!record.nulls.empty() &&
+         record.nulls.size() != record.values.size()) ||
+        !stageRows(record.columns, record.values, record.nulls, staged,
+                   error))
+      return false;
+    break;
+  case LogRecordType::UPDATE:
+  case LogRecordType::UPDATE_SET:
+    if ((record.type == LogRecordType::UPDATE &&
+         record.columns.size() != 1) ||
+        !convertAssignments(current, record.columns, record.values, targets,
+                            cells, error))
+      return false;
+    break;
+  case LogRecordType::DELETE:
+  case LogRecordType::DELETE_MARK:
+  case LogRecordType::TRUNCATE:
+  case LogRecordType::COMPACT:
+    break;
+  default:
+    return false;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  TableData &table = writableTable(it->second);
+  switch (record.type) {
+  case LogRecordType::INSERT:
+    appendCells(table, cells);
+    break;
+  case LogRecordType::INSERT_ROWS:
+    appendTable(table, std::move(staged));
+    break;
+  case LogRecordType::UPDATE:
+  case LogRecordType::UPDATE_SET:
+    updateMatching(table, targets, cells, record.rows);
+    break;
+  case LogRecordType::DELETE_MARK:
+    markDeleted(table, record.rows);
+    break;
+  case LogRecordType::DELETE:
+    // Older logs removed the rows at once
+    markDeleted(table, record.rows);
+    // fall through
+  case LogRecordType::COMPACT: {
+    std::vector<RowId> newIds = compactColumns(table);
+    for (auto &idx : table.indexes)
+      idx->remap(newIds);
+    break;
+  }
+  case LogRecordType::TRUNCATE:
+    clearTable(table);
+    break;
+  }
+  table.logSequence = record.lsn;
+  return true;
+}
+
+std::vector<TableData> DataStore::captureTables() const {
+  std::lock_guard<std::mutex> writer(writeMutex);
+  std::vector<TableData> copies;
+  for (const auto &pair : tables) {
+    if (pair.second.partitioning)
+      continue; // Its partitions are copied instead
+    TableSnapshot table = snapshot(pair.first);
+    TableData copy(table->schema);
+    copy.columns = table->columns;
+    copy.rowCount = table->rowCount;
+    copy.deleted = table->deleted;
+    copy.logSequence = table->logSequence;
+    copy.source = table->source;
+    copy.resident = table->resident;
+    fillColumns(copy);
+    copies.push_back(std::move(copy));
+  }
+  return copies;
+}
+
+// ============================================================================
+// UTILITY METHODS
+// ============================================================================
+int DataStore::getRowCount(const std::string &tableName) const {
+  auto it = tables.find(tableName);
+  if (it != tables.end() && it->second.partitioning) {
+    size_t rows = 0;
+    for (const TableSnapshot &part : partitionSnapshots(tableName))
+      rows += part->liveRows();
+    return static_cast<int>(rows);
+  }
+  TableSnapshot table = snapshot(tableName);
+  return table ? static_cast<int>(table->liveRows()) : 0;
 }
 
 std::vector<std::string>
@@ -242,47 +1429,245 @@ bool DataStore::tableExists(const std::string &tableName) const {
   return tables.find(tableName) != tables.end();
 }
 
+const TableInfo *DataStore::getSchema(const std::string &tableName) const {
+  auto it = tables.find(tableName);
+  if (it == tables.end())
+    return nullptr;
+  return &it->second.schema;
+}
+
 // ============================================================================
-// VALUE COMPARISON
+// SECONDARY INDEXES
 // ============================================================================
-bool DataStore::compareValues(const std::string &left, const std::string &op,
-                              const std::string &right) const {
-  // Try numeric comparison first
-  try {
-    double lVal = std::stod(left);
-    double rVal = std::stod(right);
+bool DataStore::createIndex(const std::string &tableName,
+                            const std::string &column, IndexKind kind,
+                            std::string &name, std::string &error) {
+  auto it = tables.find(tableName);
+  if (it == tables.end()) {
+    error = "Table '" + tableName + "' not found";
+    return false;
+  }
+
+  int colIdx = it->second.schema.columnIndex(column);
+  if (colIdx < 0) {
+    error = "Column '" + column + "' does not exist in table '" + tableName +
+            "'";
+    return false;
+  }
+  if (name.empty()) {
+    name = tableName + "_" + column +
+           (kind == IndexKind::HASH ? "_hash_idx" : "_idx");
+  }
+
+  if (it->second.partitioning) {
+    // Every partition indexes its own rows, under the table's index name
+    for (size_t p = 0; p < it->second.partitions.size(); p++) {
+      if (!createIndex(partitionName(tableName, p), column, kind, name, error))
+        return false;
+    }
+    return true;
+  }
+
+  std::lock_guard<std::mutex> writer(writeMutex);
+  // The column of an index stays resident
+  residentColumns(tableName, it->second, {static_cast<size_t>(colIdx)},
+                  nullptr);
+  const TableData &current = *it->second.current;
+
+  for (const auto &existing : current.indexes) {
+    if (existing->getName() == name) {
+      error = "Index '" + name + "' already exists";
+      return false;
+    }
+    if (existing->getColumnIndex() == colIdx &&
+        existing->getKind() == kind) {
+      error = "Column '" + column + "' already has a " +
+              indexKindToString(kind) + " index ('" + existing->getName() +
+              "')";
+      return false;
+    }
+  }
+
+  // Built from the newest version before readers can see it
+  std::shared_ptr<TableIndex> index = MiniSQL::createIndex(
+      name, colIdx, current.columns[colIdx].getType(), kind);
+  const Column &values = current.columns[colIdx];
+  for (size_t row = 0; row < current.rowCount; row++) {
+    if (!current.deleted.contains(row))
+      index->insert(values, static_cast<RowId>(row));
+  }
+
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  writableTable(it->second).indexes.push_back(std::move(index));
+  return true;
+}
+
+AccessPlan DataStore::chooseAccess(const std::string &tableName,
+                                   const BoundFilter &where) const {
+  AccessPlan access;
+  auto it = tables.find(tableName);
+  if (it == tables.end())
+    return access;
+
+  std::shared_lock<std::shared_mutex> lock(versionMutex);
+  const TableData &table = *it->second.current;
+  const TableStats *stats = it->second.stats.get();
+  double rows = static_cast<double>(table.liveRows());
+  for (const TableSlot *part : it->second.partitions)
+    rows += static_cast<double>(part->current->liveRows());
+  access.rows = where.selectivity * rows;
+  access.costBased = stats != nullptr;
+
+  // A scan reads every row; in parallel, each thread its share of them
+  access.cost = rows;
+  size_t threads = pool ? pool->size() : 1;
+  if (threads > 1 && rows / threads + PARALLEL_SCAN_COST < rows) {
+    access.parallel = true;
+    access.cost = rows / threads + PARALLEL_SCAN_COST;
+  }
+
+  // Conjuncts come in evaluation order
+  for (const BoundPredicate *pred : where.conjuncts()) {
+    const TableIndex *best = nullptr;
+    for (const auto &index : table.indexes) {
+      if (!index->supports(*pred))
+        continue;
+      // Prefer a hash index for equality
+      if (!best || index->getKind() == IndexKind::HASH)
+        best = index.get();
+    }
+    if (!best)
+      continue;
+
+    double matches = BoundFilter::leaf(*pred, stats).selectivity * rows;
+    double cost = INDEX_PROBE_COST + matches * INDEX_ROW_COST;
+    if (stats) {
+      if (cost >= access.cost)
+        continue;
+    } else if (access.index) {
+      // No statistics: always an index, by the default estimates, so an
+      // equality before a range and, between equalities, a hash index
+      bool hashOverOrdered = best->getKind() == IndexKind::HASH &&
+                             access.index->getKind() != IndexKind::HASH;
+      if (cost > access.cost || (cost == access.cost && !hashOverOrdered))
+        continue;
+    }
+    access.index = best;
+    access.parallel = false;
+    access.cost = cost;
+  }
+  return access;
+}
+
+// ============================================================================
+// STATISTICS (ANALYZE)
+// ============================================================================
+std::shared_ptr<const TableStats>
+DataStore::analyze(const std::string &tableName) {
+  auto it = tables.find(tableName);
+  if (it == tables.end())
+    return nullptr;
+
+  for (size_t p = 0; p < it->second.partitions.size(); p++)
+    analyze(partitionName(tableName, p));
+
+  // Read from a snapshot, so writers carry on meanwhile
+  TableSnapshot table = fullSnapshot(tableName);
+  auto stats = std::make_shared<const TableStats>(analyzeTable(*table, pool));
+  std::unique_lock<std::shared_mutex> lock(versionMutex);
+  it->second.stats = stats;
+  return stats;
+}
+
+std::shared_ptr<const TableStats>
+DataStore::getStats(const std::string &tableName) const {
+  auto it = tables.find(tableName);
+  if (it == tables.end())
+    return nullptr;
+  std::shared_lock<std::shared_mutex> lock(versionMutex);
+  return it->second.stats;
+}
+
+std::vector<TableMemory> DataStore::memoryReport() const {
+  std::vector<TableMemory> report;
+  std::shared_lock<std::shared_mutex> lock(versionMutex);
+  for (const auto &entry : tables) {
+    if (entry.second.partitioning)
+      continue; // Its rows are in its partitions
+    const TableData &table = *entry.second.current;
+    TableMemory memory;
+    memory.table = entry.first;
+    for (const auto &column : table.columns)
+      column.memoryUsage(memory.data);
+    table.deleted.memoryUsage(memory.data);
+    for (const auto &index : table.indexes) {
+      MemoryUsage usage;
+      index->memoryUsage(usage);
+      memory.indexes.emplace_back(index->getName(), usage);
+    }
+    report.push_back(std::move(memory));
+  }
+  std::sort(report.begin(), report.end(),
+            [](const TableMemory &a, const TableMemory &b) {
+              return a.table < b.table;
+            });
+  return report;
+}
 
-    if (op == "=")
-      return lVal == rVal;
-    if (op == "!=")
-      return lVal != rVal;
-    if (op == "<")
-      return lVal < rVal;
-    if (op == "<=")
-      return lVal <= rVal;
-    if (op == ">")
-      return lVal > rVal;
-    if (op == ">=")
-      return lVal >= rVal;
-  } catch (...) {
-    // Fall through to string comparison
+// ============================================================================
+// WHERE EVALUATION
+// ============================================================================
+SelectionVector DataStore::matchRows(const TableData &table,
+                                     const BoundFilter &where,
+                                     const AccessPlan &access) const {
+  SelectionVector matches;
+  const TableIndex *index = access.index;
+  const BoundPredicate *key = index ? indexKey(where, *index) : nullptr;
+  if (key) {
+    // Deleted rows are no longer in the index
+    SelectionVector rows;
+    index->lookup(*key, rows);
+    bool residual = where.kind != BoundFilter::Kind::PREDICATE;
+    for (RowId row : rows) {
+      if (!residual || where.matches(table.columns, row))
+        matches.push_back(row);
+    }
+    std::sort(matches.begin(), matches.end());
+    recordScan(rows.size(), matches.size(),
+               (rows.capacity() + matches.capacity()) * sizeof(RowId));
+    return matches;
   }
 
-  // String comparison
-  if (op == "=")
-    return left == right;
-  if (op == "!=")
-    return left != right;
-  if (op == "<")
-    return left < right;
-  if (op == "<=")
-    return left <= right;
-  if (op == ">")
-    return left > right;
-  if (op == ">=")
-    return left >= right;
+  // Each morsel collects its own rows; appending them in morsel order
+  // keeps them in table order
+  size_t morsels = (table.rowCount + COLUMN_CHUNK_ROWS - 1) / COLUMN_CHUNK_ROWS;
+  std::vector<SelectionVector> parts(morsels);
+  forEachMorsel(table, access.parallel, [&](size_t morsel, size_t count) {
+    where.selectChunk(table.columns, table.deleted, morsel, count,
+                      parts[morsel]);
+  });
+  for (const auto &part : parts)
+    matches.insert(matches.end(), part.begin(), part.end());
+  recordScan(table.rowCount, matches.size(),
+             table.rowCount + matches.capacity() * sizeof(RowId));
+  return matches;
+}
+
+void DataStore::forEachMorsel(
+    const TableData &table, bool parallel,
+    const std::function<void(size_t, size_t)> &fn) const {
+  size_t morsels = (table.rowCount + COLUMN_CHUNK_ROWS - 1) / COLUMN_CHUNK_ROWS;
+  auto runMorsel = [&](size_t morsel) {
+    size_t base = morsel * COLUMN_CHUNK_ROWS;
+    fn(morsel, std::min(COLUMN_CHUNK_ROWS, table.rowCount - base));
+  };
 
-  return false;
+  if (parallel && pool) {
+    pool->run(morsels, runMorsel);
+  } else {
+    for (size_t morsel = 0; morsel < morsels; morsel++)
+      runMorsel(morsel);
+  }
 }
 
 // ============================================================================
@@ -291,66 +1676,102 @@ bool DataStore::compareValues(const std::string &left, const std::string &op,
 void DataStore::loadFromFiles(const std::string &dir) {
   dataDir = dir;
   for (auto &pair : tables) {
+    if (pair.second.isPartition)
+      continue; // Loaded with its table
     std::string filePath = dir + "/" + pair.first + ".csv";
-    std::ifstream file(filePath);
 
-    if (!file.is_open())
-      continue;
+    if (pair.second.partitioning) {
+      // Loaded whole, then split; partitions are never lazy
+      TableData whole(pair.second.schema);
+      CsvLoadStats stats;
+      std::string error;
+      if (!loadCsvFile(filePath, whole, stats, error, loadThreads()))
+        continue;
+      std::vector<TableData> parts =
+          splitRows(whole, *pair.second.partitioning);
 
-    // Clear existing data
-    pair.second.rows.clear();
+      std::lock_guard<std::mutex> writer(writeMutex);
+      std::unique_lock<std::shared_mutex> lock(versionMutex);
+      for (size_t p = 0; p < parts.size(); p++) {
+        TableSlot &part = *pair.second.partitions[p];
+        auto loaded = std::make_shared<TableData>(*part.current);
+        loaded->columns = std::move(parts[p].columns);
+        loaded->rowCount = parts[p].rowCount;
+        loaded->deleted.clear();
+        rebuildIndexes(*loaded);
+        part.current = std::move(loaded);
+      }
 
-    // Read header line
-    std::string headerLine;
-    if (!std::getline(file, headerLine))
+      diag() << "Loaded " << whole.liveRows() << " rows from " << filePath
+             << " into " << parts.size() << " partitions";
+      if (stats.skipped > 0)
+        diag() << " (" << stats.skipped << " malformed rows skipped)";
+      diag() << "\n";
       continue;
-
-    std::vector<std::string> headers;
-    std::istringstream headerStream(headerLine);
-    std::string col;
-    while (std::getline(headerStream, col, ',')) {
-      // Trim whitespace
-      size_t start = col.find_first_not_of(" \t");
-      size_t end = col.find_last_not_of(" \t");
-      if (start != std::string::npos) {
-        headers.push_back(col.substr(start, end - start + 1));
-      }
     }
 
-    // Read data rows
-    std::string rowLine;
-    while (std::getline(file, rowLine)) {
-      if (rowLine.empty())
+    // Loaded into a new version; readers keep seeing the old one meanwhile
+    std::lock_guard<std::mutex> writer(writeMutex);
+    auto loaded = std::make_shared<TableData>(*pair.second.current);
+    TableData &table = *loaded;
+
+    CsvLoadStats stats;
+    std::string error;
+    if (lazyLoading) {
+      auto source = CsvColumnSource::open(filePath, table, stats, error,
+                                          loadThreads());
+      if (!source)
         continue;
+      for (auto &column : table.columns)
+        column = Column(column.getType());
+      table.rowCount = source->rows();
+      table.deleted.clear();
+      table.source = std::move(source);
+      table.resident.assign(table.columns.size(), 0);
+    } else if (!loadCsvFile(filePath, table, stats, error, loadThreads())) {
+      continue;
+    } else {
+      table.source.reset();
+      table.resident.clear();
+    }
 
-      std::vector<std::string> values;
-      std::istringstream rowStream(rowLine);
-      std::string val;
-      while (std::getline(rowStream, val, ',')) {
-        size_t start = val.find_first_not_of(" \t");
-        size_t end = val.find_last_not_of(" \t");
-        if (start != std::string::npos) {
-          values.push_back(val.substr(start, end - start + 1));
-        } else {
-          values.push_back("");
-        }
+    // Indexes need their columns
+    for (const auto &index : table.indexes) {
+      size_t c = static_cast<size_t>(index->getColumnIndex());
+      if (!table.isResident(c)) {
+        table.source->loadColumn(c, table.columns[c], loadThreads());
+        table.resident[c] = 1;
       }
+    }
 
-      if (values.size() == headers.size()) {
-        insertRow(pair.first, headers, values);
-      }
+    forgetColumns(pair.first);
+    {
+      std::unique_lock<std::shared_mutex> lock(versionMutex);
+      rebuildIndexes(table);
+      pair.second.current = std::move(loaded);
     }
+    cacheColumns(pair.first, table);
 
-    file.close();
-    std::cout << "Loaded " << pair.second.rows.size() << " rows from "
-              << filePath << "\n";
+    diag() << (table.source ? "Indexed " : "Loaded ") << table.liveRows()
+           << " rows from " << filePath;
+    if (stats.skipped > 0)
+      diag() << " (" << stats.skipped << " malformed rows skipped)";
+    if (table.source)
+      diag() << " (columns load on first use)";
+    diag() << "\n";
   }
 }
 
 void DataStore::saveToFiles(const std::string &dir) const {
   for (const auto &pair : tables) {
+    if (pair.second.isPartition)
+      continue; // Saved with its table
     std::string filePath = dir + "/" + pair.first + ".csv";
-    std::ofstream file(filePath);
+    TableSnapshot table = fullSnapshot(pair.first);
+
+    // A lazy table may be reading the old file: it keeps it until renamed
+    std::string tempPath = filePath + ".tmp";
+    std::ofstream file(tempPath);
 
     if (!file.is_open()) {
       std::cerr << "Warning: Could not save to " << filePath << "\n";
@@ -358,31 +1779,112 @@ void DataStore::saveToFiles(const std::string &dir) const {
     }
 
     // Write header
-    const auto &cols = pair.second.schema.columns;
+    const auto &cols = table->schema.columns;
+    std::string line;
     for (size_t i = 0; i < cols.size(); i++) {
       if (i > 0)
-        file << ",";
-      file << cols[i].name;
+        line += ',';
+      appendCsvField(line, cols[i].name);
     }
-    file << "\n";
+    file << line << "\n";
 
-    // Write rows
-    for (const auto &row : pair.second.rows) {
-      for (size_t i = 0; i < cols.size(); i++) {
+    // Write rows straight from the column vectors (NULL -> empty field,
+    // strings quoted when needed)
+    const auto &data = table->columns;
+    for (size_t row = 0; row < table->rowCount; row++) {
+      if (table->deleted.contains(row))
+        continue;
+      line.clear();
+      for (size_t i = 0; i < data.size(); i++) {
         if (i > 0)
-          file << ",";
-        auto it = row.find(cols[i].name);
-        if (it != row.end()) {
-          file << it->second;
-        }
+          line += ',';
+        if (data[i].isNull(row))
+          continue;
+        if (data[i].getType() == ColumnType::VARCHAR)
+          appendCsvField(line, std::string(data[i].getString(row)));
+        else
+          line += data[i].getText(row);
       }
-      file << "\n";
+      file << line << '\n';
     }
 
     file.close();
-    std::cout << "Saved " << pair.second.rows.size() << " rows to " << filePath
+    if (!file || std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+      std::remove(tempPath.c_str());
+      std::cerr << "Warning: Could not save to " << filePath << "\n";
+      continue;
+    }
+    std::cout << "Saved " << table->liveRows() << " rows to " << filePath
               << "\n";
   }
 }
 
+void DataStore::loadSnapshots(const std::string &dir) {
+  for (auto &pair : tables) {
+    if (pair.second.partitioning)
+      continue; // Its partitions have snapshots of their own
+    std::string filePath = dir + "/" + pair.first + ".snap";
+
+    if (!std::ifstream(filePath).good())
+      continue;
+
+    std::lock_guard<std::mutex> writer(writeMutex);
+    auto loaded = std::make_shared<TableData>(*pair.second.current);
+    TableData &table = *loaded;
+
+    SnapshotStats stats;
+    std::string error;
+    if (!loadSnapshot(filePath, table, stats, error)) {
+      std::cerr << "Warning: Could not load snapshot: " << error << "\n";
+      continue;
+    }
+    table.source.reset();
+    table.resident.clear();
+    forgetColumns(pair.first);
+
+    {
+      std::unique_lock<std::shared_mutex> lock(versionMutex);
+      rebuildIndexes(table);
+      pair.second.current = std::move(loaded);
+    }
+
+    diag() << "Loaded " << table.liveRows() << " rows from " << filePath
+           << "\n";
+  }
+}
+
+void DataStore::saveSnapshots(const std::string &dir, bool compress) const {
+  for (const auto &pair : tables) {
+    if (pair.second.partitioning)
+      continue; // Saved as its partitions
+    std::string filePath = dir + "/" + pair.first + ".snap";
+
+    TableSnapshot table = fullSnapshot(pair.first);
+
+    SnapshotStats stats;
+    std::string error;
+    if (!saveSnapshot(filePath, *table, compress, stats, error)) {
+      std::cerr << "Warning: Could not save snapshot: " << error << "\n";
+      continue;
+    }
+
+    std::cout << "Saved " << stats.rows << " rows to " << filePath;
+    if (compress)
+      std::cout << " (" << stats.storedBytes << " of " << stats.rawBytes
+                << " bytes)";
+    std::cout << "\n";
+  }
+}
+
+void DataStore::rebuildIndexes(TableData &table) {
+  for (auto &index : table.indexes) {
+    index->clear();
+    const Column &values = table.columns[index->getColumnIndex()];
+    for (size_t row = 0; row < table.rowCount; row++) {
+      if (!table.deleted.contains(row))
+        index->insert(values, static_cast<RowId>(row));
+    }
+  }
+}
+
 } // namespace MiniSQL
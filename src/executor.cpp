@@ -4,14 +4,27 @@
  * File: executor.cpp
  * Description: Query Execution Engine Implementation
  *
- * Traverses validated parse trees and executes queries against
- * the DataStore. Supports SELECT, INSERT, UPDATE, DELETE.
+ * Flattens validated parse trees into QueryPlans and executes them
+ * against the DataStore. Supports SELECT, INSERT, UPDATE, DELETE,
+ * CREATE INDEX, COPY and ANALYZE, each optionally under EXPLAIN [ANALYZE].
  */
 
 #include "../include/executor.h"
+#include "../include/aggregate.h"
+#include "../include/csv_loader.h"
+#include "../include/memory_tracker.h"
+#include "../include/metrics.h"
+#include "../include/output.h"
+#include "../include/partition_worker.h"
+#include "../include/plan_cache.h"
+#include "../include/sort.h"
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 
 namespace MiniSQL {
 
@@ -21,222 +34,1654 @@ Executor::Executor(DataStore &store) : dataStore(store) {}
 // ============================================================================
 // MAIN EXECUTION METHOD
 // ============================================================================
+static void printPhaseHeader() {
+  diag() << "\n========================================\n";
+  diag() << "   PHASE 4: QUERY EXECUTION\n";
+  diag() << "========================================\n";
+}
+
 QueryResult Executor::execute(const ParseTree &tree) {
-  std::cout << "\n========================================\n";
-  std::cout << "   PHASE 4: QUERY EXECUTION\n";
-  std::cout << "========================================\n";
+  QueryPlan plan;
+  if (!tree || !buildPlan(tree, plan)) {
+    printPhaseHeader();
+    QueryResult result;
+    result.message = tree ? "Unknown query type" : "No parse tree to execute";
+    return result;
+  }
+  return execute(plan);
+}
+
+QueryResult Executor::execute(const QueryPlan &plan) {
+  printPhaseHeader();
+
+  // Changes load a lazy table whole; a SELECT only the columns it reads
+  ColumnLease lease;
+  if (plan.type == PlanType::SELECT)
+    loadColumns(plan, lease);
+
+  if (plan.explain != ExplainMode::NONE)
+    return executeExplain(plan);
+  return executeStatement(plan);
+}
+
+QueryResult Executor::executeStatement(const QueryPlan &plan) {
+  QueryResult result;
+  switch (plan.type) {
+  case PlanType::SELECT:
+    result = executeSelect(plan);
+    break;
+  case PlanType::INSERT:
+    result = executeInsert(plan);
+    break;
+  case PlanType::UPDATE:
+    result = executeUpdate(plan);
+    break;
+  case PlanType::DELETE:
+    result = executeDelete(plan);
+    break;
+  case PlanType::CREATE_INDEX:
+    result = executeCreateIndex(plan);
+    break;
+  case PlanType::COPY:
+    result = executeCopy(plan);
+    break;
+  case PlanType::ANALYZE:
+    result = executeAnalyze(plan);
+    break;
+  case PlanType::SHOW_MEMORY:
+    result = executeShowMemory(plan);
+    break;
+  case PlanType::PARTITION:
+    result = executePartition(plan);
+    break;
+  default:
+    result.message = "Unknown query type";
+    break;
+  }
+
+  // SELECT rows are counted as they are pulled from the cursor
+  if (result.columnNames.empty())
+    recordEmitted(static_cast<uint64_t>(result.affectedRows));
+  return result;
+}
+
+// ============================================================================
+// PLAN CONSTRUCTION - Flatten a validated parse tree
+// ============================================================================
+namespace {
+
+std::string lowerCase(std::string_view view) {
+  std::string text(view);
+  std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+  return text;
+}
+
+PlanValue planValue(const ParseTree &node, int &paramCount) {
+  if (node->literalIndex >= 0)
+    paramCount = std::max(paramCount, node->literalIndex + 1);
+  return PlanValue(node->value, node->literalIndex);
+}
+
+void extractExpr(const ParseTree &node, PlanExpr &expr, int &paramCount);
+
+// The first table of a FROM clause is the plan's table, the others are
+// joined to it; their ON conditions are collected in `on`
+void extractTable(const ParseTree &node, QueryPlan &plan,
+                  std::vector<PlanExpr> &on) {
+  if (node->type == NodeType::TABLE_NAME) {
+    plan.table = lowerCase(node->value);
+    return;
+  }
+  for (const auto &fc : node->children) {
+    ParseTree table = fc;
+    if (fc->type == NodeType::JOIN_CLAUSE) {
+      table = fc->children.first;
+      for (const auto &jc : fc->children) {
+        if (jc->type == NodeType::CONDITION ||
+            jc->type == NodeType::AND_EXPR || jc->type == NodeType::OR_EXPR) {
+          on.emplace_back();
+          extractExpr(jc, on.back(), plan.paramCount);
+        }
+      }
+    }
+    if (!table || table->type != NodeType::TABLE_NAME)
+      continue;
+    if (plan.table.empty())
+      plan.table = lowerCase(table->value);
+    else
+      plan.joins.push_back(lowerCase(table->value));
+  }
+}
+
+// A single-table statement may qualify its columns with the table name;
+// the qualifier is dropped so the names match the schema
+void unqualify(std::string &name, const std::string &table) {
+  if (name.size() > table.size() && name[table.size()] == '.' &&
+      lowerCase(std::string_view(name).substr(0, table.size())) == table)
+    name.erase(0, table.size() + 1);
+}
+
+void unqualifyExpr(PlanExpr &expr, const std::string &table) {
+  unqualify(expr.column, table);
+  for (auto &operand : expr.children)
+    unqualifyExpr(operand, table);
+}
+
+// Literal slots are numbered left to right, so operands are visited in
+// query order
+void extractExpr(const ParseTree &node, PlanExpr &expr, int &paramCount) {
+  if (node->type == NodeType::AND_EXPR || node->type == NodeType::OR_EXPR) {
+    expr.kind = node->type == NodeType::AND_EXPR ? PlanExprKind::AND
+                                                 : PlanExprKind::OR;
+    for (const auto &operand : node->children) {
+      expr.children.emplace_back();
+      extractExpr(operand, expr.children.back(), paramCount);
+    }
+    return;
+  }
+
+  expr.kind = PlanExprKind::CONDITION;
+  for (const auto &cc : node->children) {
+    if (cc->type == NodeType::COLUMN)
+      expr.column = cc->value;
+    else if (cc->type == NodeType::OPERATOR)
+      expr.op = cc->value;
+    else if (cc->type == NodeType::VALUE)
+      expr.value = planValue(cc, paramCount);
+  }
+}
+
+void extractWhere(const ParseTree &node, QueryPlan &plan) {
+  plan.hasWhere = true;
+  for (const auto &wc : node->children) {
+    if (wc->type == NodeType::CONDITION || wc->type == NodeType::AND_EXPR ||
+        wc->type == NodeType::OR_EXPR)
+      extractExpr(wc, plan.where, plan.paramCount);
+  }
+}
+
+// Selectivities are estimated from the table's statistics, if any
+bool bindExpr(const TableInfo &schema, const TableStats *stats,
+              const PlanExpr &expr, BoundFilter &out, std::string &error) {
+  if (expr.kind == PlanExprKind::CONDITION) {
+    BoundPredicate pred;
+    if (!bindPredicate(schema, expr.column, expr.op, expr.value.text, pred,
+                       error))
+      return false;
+    out = BoundFilter::leaf(pred, stats);
+    return true;
+  }
+
+  std::vector<BoundFilter> operands(expr.children.size());
+  for (size_t i = 0; i < expr.children.size(); i++) {
+    if (!bindExpr(schema, stats, expr.children[i], operands[i], error))
+      return false;
+  }
+  out = BoundFilter::combine(expr.kind == PlanExprKind::AND
+                                 ? BoundFilter::Kind::AND
+                                 : BoundFilter::Kind::OR,
+                             std::move(operands));
+  return true;
+}
+
+} // namespace
+
+bool Executor::buildPlan(const ParseTree &tree, QueryPlan &plan) const {
+  plan = QueryPlan();
+
+  // EXPLAIN: the plan of the statement, marked to be explained
+  if (tree->type == NodeType::EXPLAIN_QUERY) {
+    ParseTree statement = tree->children.first;
+    if (!statement || statement->type == NodeType::EXPLAIN_QUERY ||
+        !buildPlan(statement, plan))
+      return false;
+    plan.explain = tree->value == "ANALYZE" ? ExplainMode::ANALYZE
+                                            : ExplainMode::PLAN;
+    return true;
+  }
+
+  switch (tree->type) {
+  case NodeType::QUERY:
+    plan.type = PlanType::SELECT;
+    break;
+  case NodeType::INSERT_QUERY:
+    plan.type = PlanType::INSERT;
+    break;
+  case NodeType::UPDATE_QUERY:
+    plan.type = PlanType::UPDATE;
+    break;
+  case NodeType::DELETE_QUERY:
+    plan.type = PlanType::DELETE;
+    break;
+  case NodeType::CREATE_INDEX_QUERY:
+    plan.type = PlanType::CREATE_INDEX;
+    break;
+  case NodeType::COPY_QUERY:
+    plan.type = PlanType::COPY;
+    break;
+  case NodeType::ANALYZE_QUERY:
+    plan.type = PlanType::ANALYZE;
+    break;
+  case NodeType::SHOW_QUERY:
+    plan.type = PlanType::SHOW_MEMORY;
+    return true;
+  case NodeType::PARTITION_QUERY:
+    plan.type = PlanType::PARTITION;
+    plan.partitionMethod = tree->value;
+    break;
+  default:
+    return false;
+  }
+
+  std::vector<PlanExpr> on; // ON conditions of joined tables
+  for (const auto &child : tree->children) {
+    switch (child->type) {
+    case NodeType::TABLE_NAME:
+    case NodeType::FROM_CLAUSE:
+      extractTable(child, plan, on);
+      break;
+    case NodeType::WHERE_CLAUSE:
+      extractWhere(child, plan);
+      break;
+    case NodeType::SELECT_CLAUSE:
+      for (const auto &sc : child->children) {
+        if (sc->type != NodeType::COLUMN_LIST)
+          continue;
+        for (const auto &col : sc->children) {
+          if (col->type == NodeType::AGGREGATE) {
+            // The argument is the entry's column; earlier plain columns
+            // get no function
+            ParseTree arg = col->children.first;
+            plan.aggregates.resize(plan.columns.size(), AggregateFn::NONE);
+            plan.aggregates.push_back(aggregateFnFromString(col->value));
+            plan.columns.emplace_back(arg ? arg->value : "*");
+            continue;
+          }
+          if (col->type != NodeType::COLUMN)
+            continue;
+          if (col->value == "*")
+            plan.selectAll = true;
+          else
+            plan.columns.emplace_back(col->value);
+        }
+        if (!plan.aggregates.empty())
+          plan.aggregates.resize(plan.columns.size(), AggregateFn::NONE);
+      }
+      break;
+    case NodeType::GROUP_BY_CLAUSE:
+      for (const auto &col : child->children) {
+        if (col->type == NodeType::COLUMN)
+          plan.groupBy.emplace_back(col->value);
+      }
+      break;
+    case NodeType::ORDER_BY_CLAUSE:
+      for (const auto &key : child->children) {
+        ParseTree item = key->children.first;
+        if (key->type != NodeType::SORT_KEY || !item)
+          continue;
+        OrderKey order;
+        order.descending = key->value == "DESC";
+        if (item->type == NodeType::AGGREGATE) {
+          ParseTree arg = item->children.first;
+          order.fn = aggregateFnFromString(item->value);
+          order.column = arg ? std::string(arg->value) : "*";
+        } else {
+          order.column = item->value;
+        }
+        plan.orderBy.push_back(order);
+      }
+      break;
+    case NodeType::LIMIT_CLAUSE:
+      if (ParseTree value = child->children.first) {
+        plan.hasLimit = true;
+        plan.limit = planValue(value, plan.paramCount);
+      }
+      break;
+    case NodeType::COLUMN_LIST:
+      for (const auto &col : child->children) {
+        if (col->type == NodeType::COLUMN)
+          plan.columns.emplace_back(col->value);
+      }
+      break;
+    case NodeType::VALUE_LIST:
+      for (const auto &val : child->children) {
+        if (val->type == NodeType::VALUE)
+          plan.values.push_back(planValue(val, plan.paramCount));
+      }
+      break;
+    case NodeType::SET_CLAUSE:
+      for (const auto &assign : child->children) {
+        if (assign->type != NodeType::ASSIGNMENT)
+          continue;
+        for (const auto &ac : assign->children) {
+          if (ac->type == NodeType::COLUMN)
+            plan.setColumns.emplace_back(ac->value);
+          else if (ac->type == NodeType::VALUE)
+            plan.setValues.push_back(planValue(ac, plan.paramCount));
+        }
+      }
+      break;
+    case NodeType::INDEX_NAME:
+      plan.indexName = child->value;
+      break;
+    case NodeType::INDEX_METHOD:
+      plan.indexKind =
+          child->value == "HASH" ? IndexKind::HASH : IndexKind::ORDERED;
+      break;
+    case NodeType::COLUMN:
+      plan.columns.emplace_back(child->value);
+      break;
+    case NodeType::VALUE:
+      plan.source = planValue(child, plan.paramCount);
+      break;
+    default:
+      break;
+    }
+  }
+
+  // An inner join's ON conditions filter like WHERE conditions: all of
+  // them are ANDed into one expression
+  if (!on.empty()) {
+    PlanExpr conjunction;
+    conjunction.kind = PlanExprKind::AND;
+    conjunction.children = std::move(on);
+    if (plan.hasWhere)
+      conjunction.children.push_back(std::move(plan.where));
+    plan.where = std::move(conjunction);
+    plan.hasWhere = true;
+  }
+
+  if (plan.joins.empty()) {
+    for (auto &column : plan.columns)
+      unqualify(column, plan.table);
+    for (auto &column : plan.groupBy)
+      unqualify(column, plan.table);
+    for (auto &key : plan.orderBy)
+      unqualify(key.column, plan.table);
+    for (auto &column : plan.setColumns)
+      unqualify(column, plan.table);
+    unqualifyExpr(plan.where, plan.table);
+  }
+
+  return true;
+}
+
+// ============================================================================
+// SELECT EXECUTION
+// ============================================================================
+namespace {
+
+// Column names a WHERE expression reads; an identifier value may name a
+// column too
+void exprColumns(const PlanExpr &expr, std::vector<std::string> &names) {
+  if (expr.kind == PlanExprKind::CONDITION) {
+    names.push_back(expr.column);
+    if (expr.value.param < 0)
+      names.push_back(expr.value.text);
+    return;
+  }
+  for (const auto &operand : expr.children)
+    exprColumns(operand, names);
+}
+
+// Read ahead and report a SELECT result that is ready to be pulled
+void finishSelect(QueryResult &result) {
+  result.success = true;
+  if (result.rows->prefetch(RESULT_SAMPLE_ROWS)) {
+    result.message = "Query executed successfully. " +
+                     std::to_string(result.rows->buffered().size()) +
+                     " row(s) returned.";
+  } else {
+    result.message =
+        "Query executed successfully. Rows are returned as they are found.";
+  }
+
+  diag() << "Execution: SUCCESS\n";
+  diag() << result.message << "\n";
+}
+
+// LIMIT of a plan (SIZE_MAX without one); on failure, fill result
+bool planLimit(const QueryPlan &plan, size_t &limit, QueryResult &result) {
+  limit = SIZE_MAX;
+  if (!plan.hasLimit)
+    return true;
+  const std::string &text = plan.limit.text;
+  if (text.empty() ||
+      text.find_first_not_of("0123456789") != std::string::npos) {
+    result.message =
+        "LIMIT needs a whole number of rows, not '" + text + "'.";
+    return false;
+  }
+  limit = std::strtoull(text.c_str(), nullptr, 10);
+  return true;
+}
+
+// Sort a SELECT's rows by its ORDER BY keys and cap them to its LIMIT.
+// Without ORDER BY the cursor just stops at the LIMIT, so the rest of the
+// table is never scanned. On failure, fill result.
+bool orderRows(const QueryPlan &plan, const std::vector<SortKey> &keys,
+               const DataStore &store, QueryResult &result) {
+  size_t limit;
+  bool ok = planLimit(plan, limit, result);
+  if (ok && keys.empty()) {
+    result.rows->setLimit(limit);
+    return true;
+  }
+
+  SortStats stats;
+  std::shared_ptr<RowCursor> sorted;
+  std::string error;
+  if (ok && !sortRows(*result.rows, keys, limit, store.getSortMemory(),
+                      store.getThreadPool(), sorted, stats, error)) {
+    result.message = "ORDER BY failed: " + error + ".";
+    ok = false;
+  }
+  if (!ok) {
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return false;
+  }
+
+  result.rows = std::move(sorted);
+  diag() << "Sort: " << sortMethodToString(stats.method) << ", "
+         << stats.rows << " row(s)";
+  if (stats.method == SortMethod::EXTERNAL)
+    diag() << " in " << stats.runs << " run(s), " << stats.spilledBytes
+           << " byte(s) spilled";
+  if (stats.memoryLimited)
+    diag() << " (runs cut short by the memory limit)";
+  diag() << "\n";
+  return true;
+}
+
+// Find a column of the rows being aggregated by name
+using InputResolver = std::function<bool(
+    const std::string &name, AggregateInput &input, std::string &error)>;
+
+// How a plan's SELECT list, GROUP BY and ORDER BY map onto an
+// aggregation: its keys and aggregates, and the result column of each
+// output column and ORDER BY key
+struct AggregateLayout {
+  std::vector<AggregateInput> keys;
+  std::vector<AggregateSpec> specs;
+  std::vector<int> projection;
+  std::vector<std::string> names;
+  std::vector<int> orderColumns;
+};
+
+// Lay out the aggregation a plan asks for over the columns `resolve`
+// finds
+bool layoutAggregate(const QueryPlan &plan, const InputResolver &resolve,
+                     AggregateLayout &layout, std::string &error) {
+  std::vector<AggregateInput> &keys = layout.keys;
+  std::vector<AggregateSpec> &specs = layout.specs;
+  for (const auto &name : plan.groupBy) {
+    keys.emplace_back();
+    if (!resolve(name, keys.back(), error))
+      return false;
+    keys.back().name = name;
+  }
+
+  // A plain column is output from its group key, an aggregate from its
+  // own column after the keys
+  for (size_t i = 0; i < plan.columns.size(); i++) {
+    AggregateFn fn =
+        plan.aggregates.empty() ? AggregateFn::NONE : plan.aggregates[i];
+    if (fn == AggregateFn::NONE) {
+      AggregateInput input;
+      if (!resolve(plan.columns[i], input, error))
+        return false;
+      auto key = std::find_if(keys.begin(), keys.end(),
+                              [&](const AggregateInput &k) {
+                                return k.column == input.column;
+                              });
+      if (key == keys.end()) {
+        error = "column '" + plan.columns[i] + "' is not in GROUP BY";
+        return false;
+      }
+      layout.projection.push_back(static_cast<int>(key - keys.begin()));
+    } else {
+      AggregateSpec spec;
+      spec.fn = fn;
+      if (plan.columns[i] != "*" &&
+          !resolve(plan.columns[i], spec.input, error))
+        return false;
+      spec.input.name = plan.outputName(i);
+      layout.projection.push_back(
+          static_cast<int>(keys.size() + specs.size()));
+      specs.push_back(spec);
+    }
+    layout.names.push_back(plan.outputName(i));
+  }
+
+  // An ORDER BY key is a group key or an aggregate; one that is not in
+  // the SELECT list is computed for the sort alone
+  for (const auto &key : plan.orderBy) {
+    AggregateInput input;
+    if (key.column != "*" && !resolve(key.column, input, error))
+      return false;
+    if (key.fn == AggregateFn::NONE) {
+      auto match = std::find_if(keys.begin(), keys.end(),
+                                [&](const AggregateInput &k) {
+                                  return k.column == input.column;
+                                });
+      if (match == keys.end()) {
+        error = "ORDER BY column '" + key.column + "' is not in GROUP BY";
+        return false;
+      }
+      layout.orderColumns.push_back(static_cast<int>(match - keys.begin()));
+      continue;
+    }
+    auto match = std::find_if(specs.begin(), specs.end(),
+                              [&](const AggregateSpec &spec) {
+                                return spec.fn == key.fn &&
+                                       spec.input.column == input.column;
+                              });
+    if (match == specs.end()) {
+      AggregateSpec spec;
+      spec.fn = key.fn;
+      spec.input = input;
+      spec.input.name = key.name();
+      specs.push_back(spec);
+      match = specs.end() - 1;
+    }
+    layout.orderColumns.push_back(
+        static_cast<int>(keys.size() + (match - specs.begin())));
+  }
+  return true;
+}
+
+// Output the table an aggregation laid out by layoutAggregate returned;
+// `order` receives the ORDER BY keys, as columns of that table
+void aggregateOutput(const QueryPlan &plan, const AggregateLayout &layout,
+                     TableSnapshot table, QueryResult &result,
+                     std::vector<SortKey> &order) {
+  result.table = std::move(table);
+  result.projection = layout.projection;
+  result.columnNames = layout.names;
+  result.rows = std::make_shared<RowCursor>(result.table);
+  for (size_t i = 0; i < layout.orderColumns.size(); i++) {
+    SortKey key;
+    key.column = &result.table->columns[layout.orderColumns[i]];
+    key.descending = plan.orderBy[i].descending;
+    order.push_back(key);
+  }
+}
+
+// Aggregate input positions 0 .. rows - 1 as a plan's SELECT list and
+// GROUP BY ask; the result reads from a table of its own. `order`
+// receives its ORDER BY keys, as columns of that table.
+bool aggregateResult(const QueryPlan &plan, size_t rows,
+                     const InputResolver &resolve, ThreadPool *pool,
+                     QueryResult &result, std::vector<SortKey> &order,
+                     std::string &error) {
+  AggregateLayout layout;
+  if (!layoutAggregate(plan, resolve, layout, error))
+    return false;
+  TableSnapshot table =
+      aggregateRows(rows, layout.keys, layout.specs, pool, error);
+  if (!table)
+    return false;
+  aggregateOutput(plan, layout, std::move(table), result, order);
+  diag() << "Hash aggregation: " << rows << " row(s) into "
+         << result.table->rowCount << " group(s)\n";
+  return true;
+}
+
+// The partitions a SELECT runs a fragment on: those its filter may match
+// (nullptr = all), and at least one, so the result keeps its shape
+std::vector<size_t> fragmentPartitions(const PartitionScheme &scheme,
+                                       const BoundFilter *where) {
+  std::vector<size_t> partitions = scheme.prune(where);
+  if (partitions.empty())
+    partitions.push_back(0);
+  return partitions;
+}
+
+// Run a task as one fragment per partition on a worker, the fragments in
+// parallel on the pool (nullptr = one after another); results[i] is
+// partitions[i]'s. What they measured counts toward the statement.
+void runFragments(PartitionWorker &worker, const FragmentTask &task,
+                  const std::vector<size_t> &partitions, ThreadPool *pool,
+                  std::vector<FragmentResult> &results) {
+  results.assign(partitions.size(), FragmentResult());
+  auto runFragment = [&](size_t i) {
+    worker.runFragment(partitions[i], task, results[i]);
+  };
+  if (pool) {
+    pool->run(partitions.size(), runFragment);
+  } else {
+    for (size_t i = 0; i < partitions.size(); i++)
+      runFragment(i);
+  }
+  if (QueryMetrics *metrics = currentMetrics()) {
+    for (const auto &fragment : results)
+      metrics->add(fragment.metrics);
+  }
+}
+
+// Whether a SELECT only counts every row of its table: COUNT(*) without
+// WHERE or GROUP BY
+bool countsAllRows(const QueryPlan &plan) {
+  if (plan.hasWhere || !plan.groupBy.empty() || plan.aggregates.empty())
+    return false;
+  for (size_t i = 0; i < plan.columns.size(); i++) {
+    if (plan.aggregates[i] != AggregateFn::COUNT || plan.columns[i] != "*")
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+void Executor::loadColumns(const QueryPlan &plan, ColumnLease &lease) {
+  // COUNT(*) reads no column; SELECT * all of them
+  std::vector<std::string> names(plan.columns);
+  names.insert(names.end(), plan.groupBy.begin(), plan.groupBy.end());
+  for (const auto &key : plan.orderBy)
+    names.push_back(key.column);
+  if (plan.hasWhere)
+    exprColumns(plan.where, names);
+  names.erase(std::remove(names.begin(), names.end(), "*"), names.end());
+  if (plan.selectAll)
+    names.push_back("*");
+
+  // A qualified name belongs to its table; an unqualified one is loaded
+  // from every table that has it
+  std::vector<std::string> tables(1, plan.table);
+  tables.insert(tables.end(), plan.joins.begin(), plan.joins.end());
+  for (const auto &table : tables) {
+    std::vector<std::string> own;
+    for (const auto &name : names) {
+      size_t dot = name.find('.');
+      if (dot == std::string::npos)
+        own.push_back(name);
+      else if (lowerCase(std::string_view(name).substr(0, dot)) == table)
+        own.push_back(name.substr(dot + 1));
+    }
+    dataStore.loadColumns(table, own, lease);
+  }
+}
+
+QueryResult Executor::executeSelect(const QueryPlan &plan) {
+  if (!plan.joins.empty())
+    return executeJoin(plan);
+  if (dataStore.getPartitioning(plan.table) && !countsAllRows(plan))
+    return executePartitioned(plan);
+  if (plan.isAggregate())
+    return executeAggregate(plan);
+
+  QueryResult result;
+  const std::string &tableName = plan.table;
+
+  // Get the right columns
+  std::vector<std::string> selectedCols =
+      plan.selectAll ? dataStore.getColumnNames(tableName) : plan.columns;
+
+  TableSnapshot table = dataStore.snapshot(tableName);
+  if (!table) {
+    result.message = "Table '" + tableName + "' not found.";
+    return result;
+  }
+
+  // Resolve the projection to column positions once
+  for (const auto &col : selectedCols) {
+    int idx = table->columnIndex(col);
+    if (idx < 0) {
+      result.message = "Column '" + col + "' not found.";
+      return result;
+    }
+    result.projection.push_back(idx);
+  }
+
+  // Bind the WHERE literals to the column types once, before scanning
+  BoundFilter where;
+  if (plan.hasWhere && !bindWhere(plan, where, result)) {
+    return result;
+  }
+
+  // Open a cursor over the rows: they are found as the output pulls them.
+  // A filtered cursor reads the newest version again, together with the
+  // index probe, so the positions belong to the version it holds.
+  if (plan.hasWhere) {
+    result.rows =
+        dataStore.openCursor(tableName, where, chooseAccess(tableName, where));
+    if (!result.rows) {
+      result.message = "Table '" + tableName + "' not found.";
+      return result;
+    }
+  } else {
+    result.rows = std::make_shared<RowCursor>(std::move(table));
+    recordAccess(AccessPath::ALL_ROWS);
+  }
+  result.table = result.rows->getTable();
+
+  // Sort keys may be any column of the table, output or not
+  std::vector<SortKey> order;
+  for (const auto &key : plan.orderBy) {
+    int idx = result.table->columnIndex(key.column);
+    if (idx < 0) {
+      result.message = "Column '" + key.column + "' not found.";
+      return result;
+    }
+    order.emplace_back();
+    order.back().column = &result.table->columns[idx];
+    order.back().descending = key.descending;
+  }
+  if (!orderRows(plan, order, dataStore, result))
+    return result;
+
+  result.columnNames = selectedCols;
+  finishSelect(result);
+  return result;
+}
+
+// ============================================================================
+// AGGREGATE EXECUTION - Aggregates and GROUP BY over one table
+// ============================================================================
+QueryResult Executor::executeAggregate(const QueryPlan &plan) {
+  QueryResult result;
+  const std::string &tableName = plan.table;
+
+  // COUNT(*) of a whole table is its row count: nothing is read
+  if (countsAllRows(plan)) {
+    for (size_t i = 0; i < plan.columns.size(); i++)
+      result.columnNames.push_back(plan.outputName(i));
+    if (!dataStore.tableExists(tableName)) {
+      result.message = "Table '" + tableName + "' not found.";
+      return result;
+    }
+    size_t count = static_cast<size_t>(dataStore.getRowCount(tableName));
+    result.table = countResult(count, result.columnNames);
+    for (size_t i = 0; i < plan.columns.size(); i++)
+      result.projection.push_back(static_cast<int>(i));
+    result.rows = std::make_shared<RowCursor>(result.table);
+    diag() << "COUNT(*) from the row count of '" << tableName << "'\n";
+    if (!orderRows(plan, {}, dataStore, result))
+      return result;
+    finishSelect(result);
+    return result;
+  }
+
+  // The rows to aggregate: those passing the WHERE filter, or all of them
+  TableSnapshot table;
+  SelectionVector rows;
+  if (plan.hasWhere) {
+    BoundFilter where;
+    if (!bindWhere(plan, where, result))
+      return result;
+    auto cursor =
+        dataStore.openCursor(tableName, where, chooseAccess(tableName, where));
+    if (cursor) {
+      cursor->readAll(rows);
+      table = cursor->getTable();
+    }
+  } else {
+    table = dataStore.snapshot(tableName);
+    recordAccess(AccessPath::ALL_ROWS);
+  }
+  if (!table) {
+    result.message = "Table '" + tableName + "' not found.";
+    return result;
+  }
+
+  // Rows deleted but not yet compacted away are skipped by position
+  bool byPosition = plan.hasWhere || !table->deleted.empty();
+  if (!plan.hasWhere && byPosition)
+    RowCursor(table).readAll(rows);
+  const RowId *positions = byPosition ? rows.data() : nullptr;
+  std::string error;
+  if (!reserveMemory(rows.size() * sizeof(RowId), "the rows to aggregate",
+                     error)) {
+    result.message = "Aggregation failed: " + error + ".";
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return result;
+  }
+  auto resolve = [&](const std::string &name, AggregateInput &input,
+                     std::string &error) {
+    int index = table->columnIndex(name);
+    if (index < 0) {
+      error = "column '" + name + "' not found";
+      return false;
+    }
+    input.column = &table->columns[index];
+    input.rows = positions;
+    return true;
+  };
+  std::vector<SortKey> order;
+  if (!aggregateResult(plan, byPosition ? rows.size() : table->rowCount,
+                       resolve, dataStore.getThreadPool(), result, order,
+                       error)) {
+    result.message = "Aggregation failed: " + error + ".";
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return result;
+  }
+  if (!orderRows(plan, order, dataStore, result))
+    return result;
+
+  finishSelect(result);
+  return result;
+}
+
+// ============================================================================
+// PARTITIONED EXECUTION - One fragment per partition, merged
+// ============================================================================
+QueryResult Executor::executePartitioned(const QueryPlan &plan) {
+  QueryResult result;
+  const std::string &tableName = plan.table;
+  std::shared_ptr<const PartitionScheme> scheme =
+      dataStore.getPartitioning(tableName);
+  const TableInfo &schema = *dataStore.getSchema(tableName);
+  auto fail = [&](const std::string &message) {
+    result.message = message;
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return result;
+  };
+
+  BoundFilter where;
+  if (plan.hasWhere && !bindWhere(plan, where, result))
+    return result;
+  const BoundFilter *filter = plan.hasWhere ? &where : nullptr;
+
+  // Fragments push the filter down: each finds its rows on its own
+  // partition, with its own access path
+  std::vector<size_t> partitions = fragmentPartitions(*scheme, filter);
+  diag() << "Partitions: reading " << partitions.size() << " of "
+         << scheme->count << " (" << scheme->describe() << ")\n";
+  std::vector<AccessPlan> access(partitions.size());
+  if (filter) {
+    for (size_t i = 0; i < partitions.size(); i++)
+      access[i] = chooseAccess(partitionName(tableName, partitions[i]), where);
+  } else {
+    recordAccess(AccessPath::ALL_ROWS);
+  }
+  LocalPartitionWorker worker(dataStore, tableName, filter, partitions,
+                              access);
+  ThreadPool *pool = dataStore.getThreadPool();
+  std::vector<FragmentResult> results;
+  FragmentTask task;
+  std::string error;
+
+  if (plan.isAggregate()) {
+    // Each fragment aggregates its own rows; only the groups are merged.
+    // The layout over the table's (empty) columns names what they compute.
+    TableData shape(schema);
+    auto resolve = [&](const std::string &name, AggregateInput &input,
+                       std::string &error) {
+      int index = shape.columnIndex(name);
+      if (index < 0) {
+        error = "column '" + name + "' not found";
+        return false;
+      }
+      input.column = &shape.columns[index];
+      return true;
+    };
+    AggregateLayout layout;
+    if (!layoutAggregate(plan, resolve, layout, error))
+      return fail("Aggregation failed: " + error + ".");
+    auto columnName = [&](const Column *column) {
+      return schema.columns[column - shape.columns.data()].name;
+    };
+    task.aggregate = true;
+    for (const auto &key : layout.keys)
+      task.groupBy.push_back(columnName(key.column));
+    for (const auto &spec : layout.specs) {
+      task.aggregates.emplace_back();
+      task.aggregates.back().fn = spec.fn;
+      task.aggregates.back().column =
+          spec.input.column ? columnName(spec.input.column) : "*";
+      task.aggregates.back().name = spec.input.name;
+    }
+
+    runFragments(worker, task, partitions, pool, results);
+    std::vector<TableSnapshot> partials;
+    size_t inputRows = 0, partialGroups = 0;
+    for (const auto &fragment : results) {
+      if (!fragment.table)
+        return fail("Aggregation failed: " + fragment.error + ".");
+      inputRows += fragment.inputRows;
+      partialGroups += fragment.table->rowCount;
+      partials.push_back(fragment.table);
+    }
+
+    TableSnapshot merged =
+        mergePartials(partials, layout.keys.size(), layout.specs, pool, error);
+    if (!merged)
+      return fail("Aggregation failed: " + error + ".");
+    std::vector<SortKey> order;
+    aggregateOutput(plan, layout, std::move(merged), result, order);
+    diag() << "Hash aggregation: " << inputRows << " row(s) into "
+           << partialGroups << " partial group(s) in " << partials.size()
+           << " partition(s), merged into " << result.table->rowCount
+           << " group(s)\n";
+    if (!orderRows(plan, order, dataStore, result))
+      return result;
+    finishSelect(result);
+    return result;
+  }
+
+  // Fragments push the projection down: they ship only the output and
+  // ORDER BY columns to the coordinator
+  std::vector<std::string> selectedCols =
+      plan.selectAll ? dataStore.getColumnNames(tableName) : plan.columns;
+  std::vector<std::string> shipped = selectedCols;
+  for (const auto &key : plan.orderBy) {
+    if (std::find(shipped.begin(), shipped.end(), key.column) ==
+        shipped.end())
+      shipped.push_back(key.column);
+  }
+  TableInfo info("result");
+  for (const auto &name : shipped) {
+    int idx = schema.columnIndex(name);
+    if (idx < 0) {
+      result.message = "Column '" + name + "' not found.";
+      return result;
+    }
+    info.addColumn(name, schema.columns[idx].dataType);
+  }
+  if (!planLimit(plan, task.limit, result))
+    return fail(result.message);
+  task.columns = shipped;
+  task.orderBy = plan.orderBy;
+
+  runFragments(worker, task, partitions, pool, results);
+  auto gathered = std::make_shared<TableData>(info);
+  size_t reservedBytes = 0;
+  for (const auto &fragment : results) {
+    if (!fragment.table)
+      return fail(fragment.error + ".");
+    // Without ORDER BY any rows will do: the first fragments' are kept.
+    // With it, orderRows picks the result from all the fragments sent.
+    size_t count = fragment.positions.size();
+    if (plan.orderBy.empty())
+      count = std::min(count, task.limit - gathered->rowCount);
+    for (size_t c = 0; c < gathered->columns.size(); c++) {
+      const Column &column = fragment.table->columns[fragment.columns[c]];
+      for (size_t i = 0; i < count; i++)
+        gathered->columns[c].append(column.getCell(fragment.positions[i]));
+    }
+    gathered->rowCount += count;
+
+    MemoryUsage usage;
+    for (const auto &column : gathered->columns)
+      column.memoryUsage(usage);
+    if (usage.allocated() > reservedBytes &&
+        !reserveMemory(usage.allocated() - reservedBytes,
+                       "the rows gathered from the partitions", error))
+      return fail("Merge failed: " + error + ".");
+    reservedBytes = std::max(reservedBytes, usage.allocated());
+  }
+  diag() << "Merge: " << gathered->rowCount << " row(s) gathered from "
+         << results.size() << " partition(s)\n";
+
+  result.table = gathered;
+  result.rows = std::make_shared<RowCursor>(result.table);
+  for (size_t i = 0; i < selectedCols.size(); i++)
+    result.projection.push_back(static_cast<int>(i));
+  std::vector<SortKey> order;
+  for (const auto &key : plan.orderBy) {
+    order.emplace_back();
+    order.back().column = &result.table->columns[std::find(
+        shipped.begin(), shipped.end(), key.column) - shipped.begin()];
+    order.back().descending = key.descending;
+  }
+  if (!orderRows(plan, order, dataStore, result))
+    return result;
+
+  result.columnNames = selectedCols;
+  finishSelect(result);
+  return result;
+}
+
+// ============================================================================
+// JOIN EXECUTION - Multi-table SELECT
+// ============================================================================
+namespace {
+
+// A multi-table SELECT bound to the schemas of its tables
+struct BoundJoin {
+  std::vector<std::string> tables; // FROM order
+  std::vector<const TableInfo *> schemas;
+  std::vector<bool> filtered;       // Per table: has conditions of its own
+  std::vector<BoundFilter> filters; // Per table: those conditions
+  std::vector<std::vector<JoinCondition>> steps; // Applied when table t
+                                                 // is joined (t >= 1)
+  std::vector<JoinColumn> output;
+  std::vector<std::string> names; // Output column names
+};
+
+// Resolve "column" or "table.column" among the joined tables
+bool resolveColumn(const BoundJoin &join, const std::string &name,
+                   JoinColumn &out, std::string &error) {
+  std::string column = name;
+  size_t first = 0;
+  size_t last = join.tables.size();
+  size_t dot = name.find('.');
+  if (dot != std::string::npos) {
+    std::string qualifier = lowerCase(std::string_view(name).substr(0, dot));
+    auto it = std::find(join.tables.begin(), join.tables.end(), qualifier);
+    if (it == join.tables.end()) {
+      error = "table '" + qualifier + "' of column '" + name +
+              "' is not joined";
+      return false;
+    }
+    first = static_cast<size_t>(it - join.tables.begin());
+    last = first + 1;
+    column = name.substr(dot + 1);
+  }
+
+  out.column = -1;
+  for (size_t t = first; t < last; t++) {
+    int index = join.schemas[t]->columnIndex(column);
+    if (index < 0)
+      continue;
+    if (out.column >= 0) {
+      error = "column '" + name + "' is ambiguous";
+      return false;
+    }
+    out.table = t;
+    out.column = index;
+  }
+  if (out.column < 0) {
+    error = "column '" + name + "' not found";
+    return false;
+  }
+  out.name = name;
+  return true;
+}
+
+// An identifier value refers to a column when it is qualified or names a
+// column of one of the tables (as semantic analysis decides)
+bool namesColumn(const BoundJoin &join, const PlanValue &value) {
+  if (value.param >= 0 || value.text.empty())
+    return false;
+  if (value.text.find('.') != std::string::npos)
+    return true;
+  for (const TableInfo *schema : join.schemas) {
+    if (schema->columnIndex(value.text) >= 0)
+      return true;
+  }
+  return false;
+}
+
+void collectConjuncts(const PlanExpr &expr,
+                      std::vector<const PlanExpr *> &out) {
+  if (expr.kind != PlanExprKind::AND) {
+    out.push_back(&expr);
+    return;
+  }
+  for (const auto &operand : expr.children)
+    collectConjuncts(operand, out);
+}
+
+// Flag the tables whose columns an expression tests
+bool exprTables(const BoundJoin &join, const PlanExpr &expr,
+                std::vector<bool> &tables, std::string &error) {
+  if (expr.kind == PlanExprKind::CONDITION) {
+    if (namesColumn(join, expr.value)) {
+      error = "a comparison of two columns cannot be combined with OR";
+      return false;
+    }
+    JoinColumn column;
+    if (!resolveColumn(join, expr.column, column, error))
+      return false;
+    tables[column.table] = true;
+    return true;
+  }
+  for (const auto &operand : expr.children) {
+    if (!exprTables(join, operand, tables, error))
+      return false;
+  }
+  return true;
+}
+
+// The operator with its operands swapped (a < b is b > a)
+CompareOp flipOperands(CompareOp op) {
+  switch (op) {
+  case CompareOp::LT:
+    return CompareOp::GT;
+  case CompareOp::LE:
+    return CompareOp::GE;
+  case CompareOp::GT:
+    return CompareOp::LT;
+  case CompareOp::GE:
+    return CompareOp::LE;
+  default:
+    return op;
+  }
+}
+
+ColumnType joinColumnType(const BoundJoin &join, const JoinColumn &column) {
+  return columnTypeFromString(
+      join.schemas[column.table]->columns[column.column].dataType);
+}
+
+// Split the WHERE (and ON) conditions of a join: a comparison of two
+// columns becomes a join condition, anything else testing the columns of
+// a single table filters that table's rows before they are joined
+bool bindJoin(const DataStore &store, const QueryPlan &plan, BoundJoin &join,
+              std::string &error) {
+  join.tables.push_back(plan.table);
+  join.tables.insert(join.tables.end(), plan.joins.begin(), plan.joins.end());
+  for (const auto &name : join.tables) {
+    const TableInfo *schema = store.getSchema(name);
+    if (!schema) {
+      error = "table '" + name + "' not found";
+      return false;
+    }
+    join.schemas.push_back(schema);
+  }
+  size_t count = join.tables.size();
+  join.steps.resize(count);
+
+  std::vector<const PlanExpr *> conjuncts;
+  if (plan.hasWhere)
+    collectConjuncts(plan.where, conjuncts);
+  std::vector<std::vector<BoundFilter>> operands(count);
+  for (const PlanExpr *expr : conjuncts) {
+    if (expr->kind == PlanExprKind::CONDITION &&
+        namesColumn(join, expr->value)) {
+      JoinCondition cond;
+      if (!resolveColumn(join, expr->column, cond.left, error) ||
+          !resolveColumn(join, expr->value.text, cond.right, error))
+        return false;
+      if (!compareOpFromString(expr->op, cond.op)) {
+        error = "unknown operator '" + expr->op + "'";
+        return false;
+      }
+      if (!comparableTypes(joinColumnType(join, cond.left),
+                           joinColumnType(join, cond.right))) {
+        error = "cannot compare column '" + cond.left.name +
+                "' with column '" + cond.right.name + "'";
+        return false;
+      }
+      // Applied when the later of its tables is joined, with the right
+      // operand in that table
+      if (cond.left.table > cond.right.table) {
+        std::swap(cond.left, cond.right);
+        cond.op = flipOperands(cond.op);
+      }
+      join.steps[std::max<size_t>(cond.right.table, 1)].push_back(cond);
+      continue;
+    }
+
+    std::vector<bool> tables(count, false);
+    if (!exprTables(join, *expr, tables, error))
+      return false;
+    if (std::count(tables.begin(), tables.end(), true) != 1) {
+      error = "conditions on different tables cannot be combined with OR";
+      return false;
+    }
+    size_t t = static_cast<size_t>(
+        std::find(tables.begin(), tables.end(), true) - tables.begin());
+    PlanExpr local = *expr;
+    unqualifyExpr(local, join.tables[t]);
+    operands[t].emplace_back();
+    if (!bindExpr(*join.schemas[t], store.getStats(join.tables[t]).get(),
+                  local, operands[t].back(), error))
+      return false;
+  }
+
+  for (size_t t = 0; t < count; t++) {
+    join.filtered.push_back(!operands[t].empty());
+    join.filters.push_back(operands[t].size() == 1
+                               ? std::move(operands[t][0])
+                               : BoundFilter::combine(BoundFilter::Kind::AND,
+                                                      std::move(operands[t])));
+  }
+
+  // SELECT * lists every column of every table, qualified
+  if (plan.selectAll) {
+    for (size_t t = 0; t < count; t++) {
+      for (size_t c = 0; c < join.schemas[t]->columns.size(); c++) {
+        JoinColumn column;
+        column.table = t;
+        column.column = static_cast<int>(c);
+        column.name = join.tables[t] + "." + join.schemas[t]->columns[c].name;
+        join.output.push_back(column);
+        join.names.push_back(column.name);
+      }
+    }
+  }
+  // Aggregates are resolved when the join has been executed
+  if (plan.isAggregate())
+    return true;
+  for (const auto &name : plan.columns) {
+    JoinColumn column;
+    if (!resolveColumn(join, name, column, error))
+      return false;
+    join.output.push_back(column);
+    join.names.push_back(name);
+  }
+  return true;
+}
+
+} // namespace
+
+QueryResult Executor::executeJoin(const QueryPlan &plan) {
+  QueryResult result;
+  BoundJoin join;
+  std::string error;
+  if (!bindJoin(dataStore, plan, join, error)) {
+    result.message = "JOIN could not be bound: " + error + ".";
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return result;
+  }
+
+  // Each table contributes the rows passing its own conditions (found by
+  // an index lookup or a scan); the tables are then joined in FROM order
+  JoinRows joined;
+  for (size_t t = 0; t < join.tables.size(); t++) {
+    const std::string &name = join.tables[t];
+    std::shared_ptr<RowCursor> cursor;
+    if (join.filtered[t]) {
+      cursor = dataStore.openCursor(name, join.filters[t],
+                                    chooseAccess(name, join.filters[t]));
+    } else if (TableSnapshot table = dataStore.snapshot(name)) {
+      cursor = std::make_shared<RowCursor>(std::move(table));
+    }
+    if (!cursor) {
+      result.message = "Table '" + name + "' not found.";
+      return result;
+    }
+    SelectionVector rows;
+    cursor->readAll(rows);
+    diag() << "Table '" << name << "': " << rows.size() << " row(s)\n";
+    if (!reserveMemory(rows.size() * sizeof(RowId),
+                       "the rows of table '" + name + "'", error)) {
+      result.message = "JOIN failed: " + error + ".";
+      diag() << "Execution: FAILED\n";
+      diag() << result.message << "\n";
+      return result;
+    }
+
+    if (t == 0) {
+      joined.tables.push_back(cursor->getTable());
+      joined.rows.push_back(std::move(rows));
+      continue;
+    }
+    JoinMethod method;
+    if (!joinTable(joined, cursor->getTable(), rows, join.steps[t],
+                   dataStore.getThreadPool(), method, error)) {
+      result.message = "JOIN failed: " + error + ".";
+      diag() << "Execution: FAILED\n";
+      diag() << result.message << "\n";
+      return result;
+    }
+    diag() << "Join with '" << name << "': " << joinMethodToString(method)
+           << ", " << joined.size() << " row(s)\n";
+  }
 
-  if (!tree) {
-    QueryResult result;
-    result.message = "No parse tree to execute";
+  // Aggregates read the joined columns through the tuples
+  if (plan.isAggregate()) {
+    auto resolve = [&](const std::string &name, AggregateInput &input,
+                       std::string &error) {
+      JoinColumn column;
+      if (!resolveColumn(join, name, column, error))
+        return false;
+      input.column = &joined.tables[column.table]->columns[column.column];
+      input.rows = joined.rows[column.table].data();
+      return true;
+    };
+    std::vector<SortKey> order;
+    if (!aggregateResult(plan, joined.size(), resolve,
+                         dataStore.getThreadPool(), result, order, error)) {
+      result.message = "Aggregation failed: " + error + ".";
+      diag() << "Execution: FAILED\n";
+      diag() << result.message << "\n";
+      return result;
+    }
+    if (!orderRows(plan, order, dataStore, result))
+      return result;
+    finishSelect(result);
     return result;
   }
 
+  for (const auto &column : join.output) {
+    result.sources.push_back(column.table);
+    result.projection.push_back(column.column);
+  }
+  result.columnNames = join.names;
+  result.rows = std::make_shared<RowCursor>(joined.size());
+  result.table = result.rows->getTable();
+  result.join = std::make_shared<JoinRows>(std::move(joined));
+
+  // Sort keys read the joined columns through the tuples
+  std::vector<SortKey> order;
+  for (const auto &key : plan.orderBy) {
+    JoinColumn column;
+    if (!resolveColumn(join, key.column, column, error)) {
+      result.message = "ORDER BY failed: " + error + ".";
+      diag() << "Execution: FAILED\n";
+      diag() << result.message << "\n";
+      return result;
+    }
+    order.emplace_back();
+    order.back().column =
+        &result.join->tables[column.table]->columns[column.column];
+    order.back().rows = result.join->rows[column.table].data();
+    order.back().descending = key.descending;
+  }
+  if (!orderRows(plan, order, dataStore, result))
+    return result;
+  finishSelect(result);
+  return result;
+}
+
+// ============================================================================
+// INSERT EXECUTION
+// ============================================================================
+QueryResult Executor::executeInsert(const QueryPlan &plan) {
   QueryResult result;
 
-  switch (tree->type) {
-  case NodeType::QUERY:
-    result = executeSelect(tree);
-    break;
-  case NodeType::INSERT_QUERY:
-    result = executeInsert(tree);
-    break;
-  case NodeType::UPDATE_QUERY:
-    result = executeUpdate(tree);
-    break;
-  case NodeType::DELETE_QUERY:
-    result = executeDelete(tree);
-    break;
-  default:
-    result.message = "Unknown query type";
-    break;
+  std::vector<std::string> values;
+  values.reserve(plan.values.size());
+  for (const auto &value : plan.values) {
+    values.push_back(value.text);
   }
 
+  // All rows go in at once, or none does
+  std::string error;
+  int inserted = dataStore.insertRows(plan.table, plan.columns, values, error);
+  bool ok = inserted >= 0;
+  result.success = ok;
+  result.affectedRows = ok ? inserted : 0;
+  if (!ok)
+    result.message = "INSERT failed: " + error + ".";
+  else if (inserted == 1)
+    result.message = "1 row inserted successfully.";
+  else
+    result.message = std::to_string(inserted) + " rows inserted successfully.";
+
+  diag() << "Execution: " << (ok ? "SUCCESS" : "FAILED") << "\n";
+  diag() << result.message << "\n";
+
   return result;
 }
 
 // ============================================================================
-// SELECT EXECUTION
+// COPY EXECUTION
 // ============================================================================
-QueryResult Executor::executeSelect(const ParseTree &tree) {
+QueryResult Executor::executeCopy(const QueryPlan &plan) {
   QueryResult result;
 
-  std::string tableName;
-  std::vector<std::string> selectedCols;
-  bool selectAll = false;
+  size_t skipped = 0;
+  std::string error;
+  int copied =
+      dataStore.copyFromFile(plan.table, plan.source.text, skipped, error);
+  bool ok = copied >= 0;
+  result.success = ok;
+  result.affectedRows = ok ? copied : 0;
+  if (ok) {
+    result.message = std::to_string(copied) + " row(s) copied from '" +
+                     plan.source.text + "'";
+    if (skipped > 0)
+      result.message +=
+          " (" + std::to_string(skipped) + " malformed rows skipped)";
+    result.message += ".";
+  } else {
+    result.message = "COPY failed: " + error + ".";
+  }
 
-  // WHERE clause info
-  std::string whereCol, whereOp, whereVal;
-  bool hasWhere = false;
+  diag() << "Execution: " << (ok ? "SUCCESS" : "FAILED") << "\n";
+  diag() << result.message << "\n";
 
-  // Extract information from parse tree
-  for (const auto &child : tree->children) {
-    if (child->type == NodeType::FROM_CLAUSE) {
-      for (const auto &fc : child->children) {
-        if (fc->type == NodeType::TABLE_NAME) {
-          tableName = fc->value;
-          // Convert to lowercase
-          std::transform(tableName.begin(), tableName.end(), tableName.begin(),
-                         ::tolower);
-        }
-      }
-    } else if (child->type == NodeType::SELECT_CLAUSE) {
-      for (const auto &sc : child->children) {
-        if (sc->type == NodeType::COLUMN_LIST) {
-          for (const auto &col : sc->children) {
-            if (col->type == NodeType::COLUMN) {
-              if (col->value == "*") {
-                selectAll = true;
-              } else {
-                selectedCols.push_back(col->value);
-              }
-            }
-          }
-        }
-      }
-    } else if (child->type == NodeType::WHERE_CLAUSE) {
-      hasWhere = true;
-      for (const auto &wc : child->children) {
-        if (wc->type == NodeType::CONDITION) {
-          for (const auto &cc : wc->children) {
-            if (cc->type == NodeType::COLUMN)
-              whereCol = cc->value;
-            else if (cc->type == NodeType::OPERATOR)
-              whereOp = cc->value;
-            else if (cc->type == NodeType::VALUE)
-              whereVal = cc->value;
-          }
-        }
-      }
-    }
+  return result;
+}
+
+// ============================================================================
+// ANALYZE EXECUTION - Table statistics for the planner
+// ============================================================================
+namespace {
+
+std::string statText(const CellValue &value, ColumnType type) {
+  if (value.isNull)
+    return "NULL";
+  switch (type) {
+  case ColumnType::INT:
+    return std::to_string(value.intValue);
+  case ColumnType::FLOAT:
+    return formatFloat(value.floatValue);
+  case ColumnType::VARCHAR:
+    return value.stringValue;
   }
+  return "";
+}
 
-  // Get the right columns
-  if (selectAll) {
-    selectedCols = dataStore.getColumnNames(tableName);
+// The most common values of a column with their shares, e.g.
+// "Engineering 40.0%, Sales 30.0%"
+std::string frequentText(const ColumnStats &stats) {
+  const size_t shown = 3;
+  std::ostringstream text;
+  for (size_t i = 0; i < stats.frequent.size() && i < shown; i++) {
+    text << (i ? ", " : "") << statText(stats.frequent[i].value, stats.type)
+         << " " << std::fixed << std::setprecision(1)
+         << stats.frequent[i].fraction * 100 << "%";
+  }
+  return stats.frequent.empty() ? "-" : text.str();
+}
+
+} // namespace
+
+QueryResult Executor::executeAnalyze(const QueryPlan &plan) {
+  QueryResult result;
+  const std::string &tableName = plan.table;
+  std::shared_ptr<const TableStats> stats = dataStore.analyze(tableName);
+  if (!stats) {
+    result.message = "Table '" + tableName + "' not found.";
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return result;
   }
+  recordAccess(AccessPath::ALL_ROWS);
 
-  // Fetch rows
-  std::vector<Row> rows;
-  if (hasWhere) {
-    rows = dataStore.getFilteredRows(tableName, whereCol, whereOp, whereVal);
-  } else {
-    rows = dataStore.getRows(tableName);
+  // One row per column of the table
+  TableInfo info("analyze");
+  const std::vector<std::pair<const char *, const char *>> columns = {
+      {"column", "VARCHAR"},  {"type", "VARCHAR"}, {"nulls", "INT"},
+      {"distinct", "INT"},    {"min", "VARCHAR"},  {"max", "VARCHAR"},
+      {"buckets", "INT"},     {"most common", "VARCHAR"}};
+  for (const auto &column : columns)
+    info.addColumn(column.first, column.second);
+  auto table = std::make_shared<TableData>(info);
+  const TableInfo *schema = dataStore.getSchema(tableName);
+  for (size_t c = 0; c < stats->columns.size(); c++) {
+    const ColumnStats &col = stats->columns[c];
+    std::vector<std::string> texts = {
+        schema->columns[c].name,
+        schema->columns[c].dataType,
+        std::to_string(col.nulls),
+        std::to_string(col.distinct),
+        statText(col.min, col.type),
+        statText(col.max, col.type),
+        std::to_string(col.bounds.empty() ? 0 : col.bounds.size() - 1),
+        frequentText(col)};
+    for (size_t i = 0; i < texts.size(); i++) {
+      CellValue cell;
+      parseCellValue(table->columns[i].getType(), texts[i], cell);
+      table->columns[i].append(cell);
+    }
+    table->rowCount++;
   }
 
   result.success = true;
-  result.columnNames = selectedCols;
-  result.rows = rows;
-  result.message = "Query executed successfully. " +
-                   std::to_string(rows.size()) + " row(s) returned.";
+  for (const auto &column : columns)
+    result.columnNames.push_back(column.first);
+  for (size_t i = 0; i < columns.size(); i++)
+    result.projection.push_back(static_cast<int>(i));
+  result.rows = std::make_shared<RowCursor>(std::move(table));
+  result.table = result.rows->getTable();
+  result.message = "Table '" + tableName + "' analyzed: " +
+                   std::to_string(stats->rows) + " row(s).";
 
-  std::cout << "Execution: SUCCESS\n";
-  std::cout << result.message << "\n";
+  diag() << "Execution: SUCCESS\n";
+  diag() << result.message << "\n";
 
   return result;
 }
 
 // ============================================================================
-// INSERT EXECUTION
+// SHOW MEMORY EXECUTION - Memory per table, index and running statement
 // ============================================================================
-QueryResult Executor::executeInsert(const ParseTree &tree) {
+namespace {
+
+// A SHOW MEMORY cell: NULL where a number does not apply
+CellValue memoryCell(size_t bytes, bool known = true) {
+  CellValue cell;
+  cell.isNull = !known;
+  cell.intValue = static_cast<int64_t>(bytes);
+  return cell;
+}
+
+// The memory limits, e.g. "per query 64.0 MiB, all queries none"
+std::string describeMemoryLimits() {
+  size_t perQuery = getQueryMemoryLimit();
+  size_t global = getGlobalMemoryLimit();
+  return "per query " + (perQuery ? formatBytes(perQuery) : "none") +
+         ", all queries " + (global ? formatBytes(global) : "none");
+}
+
+// A statement's text on one line, shortened for the report
+std::string statementText(const std::string &query) {
+  const size_t shown = 60;
+  std::string text;
+  for (char ch : query) {
+    bool space = std::isspace(static_cast<unsigned char>(ch));
+    if (space && (text.empty() || text.back() == ' '))
+      continue;
+    text += space ? ' ' : ch;
+  }
+  while (!text.empty() && text.back() == ' ')
+    text.pop_back();
+  if (text.size() > shown)
+    text = text.substr(0, shown - 3) + "...";
+  return text;
+}
+
+} // namespace
+
+QueryResult Executor::executeShowMemory(const QueryPlan &) {
   QueryResult result;
+  TableInfo info("memory");
+  const std::vector<std::pair<const char *, const char *>> columns = {
+      {"scope", "VARCHAR"}, {"name", "VARCHAR"}, {"bytes", "INT"},
+      {"values", "INT"},    {"strings", "INT"},  {"maps", "INT"},
+      {"reserved", "INT"},  {"peak", "INT"},     {"limit", "INT"}};
+  for (const auto &column : columns)
+    info.addColumn(column.first, column.second);
+  auto table = std::make_shared<TableData>(info);
 
-  std::string tableName;
-  std::vector<std::string> columns;
-  std::vector<std::string> values;
+  auto addRow = [&](const std::string &scope, const std::string &name,
+                    const std::vector<CellValue> &numbers) {
+    CellValue text;
+    text.isNull = false;
+    text.stringValue = scope;
+    table->columns[0].append(text);
+    text.stringValue = name;
+    table->columns[1].append(text);
+    for (size_t i = 0; i < numbers.size(); i++)
+      table->columns[2 + i].append(numbers[i]);
+    table->rowCount++;
+  };
+  auto usageRow = [&](const std::string &scope, const std::string &name,
+                      const MemoryUsage &usage) {
+    addRow(scope, name,
+           {memoryCell(usage.total()), memoryCell(usage.values),
+            memoryCell(usage.strings), memoryCell(usage.maps),
+            memoryCell(usage.reserved), memoryCell(0, false),
+            memoryCell(0, false)});
+  };
 
-  for (const auto &child : tree->children) {
-    if (child->type == NodeType::TABLE_NAME) {
-      tableName = child->value;
-      std::transform(tableName.begin(), tableName.end(), tableName.begin(),
-                     ::tolower);
-    } else if (child->type == NodeType::COLUMN_LIST) {
-      for (const auto &col : child->children) {
-        if (col->type == NodeType::COLUMN) {
-          columns.push_back(col->value);
-        }
-      }
-    } else if (child->type == NodeType::VALUE_LIST) {
-      for (const auto &val : child->children) {
-        if (val->type == NodeType::VALUE) {
-          values.push_back(val->value);
-        }
-      }
+  // Table data belongs to no statement and is not limited
+  MemoryUsage tables;
+  for (const TableMemory &memory : dataStore.memoryReport()) {
+    usageRow("table", memory.table, memory.data);
+    tables += memory.data;
+    for (const auto &index : memory.indexes) {
+      usageRow("index", memory.table + "." + index.first, index.second);
+      tables += index.second;
     }
   }
 
-  bool ok = dataStore.insertRow(tableName, columns, values);
-  result.success = ok;
-  result.affectedRows = ok ? 1 : 0;
-  result.message =
-      ok ? "1 row inserted successfully."
-         : "INSERT failed: column/value count mismatch or table not found.";
+  // Running statements (this one included) hold their account's bytes
+  size_t perQuery = getQueryMemoryLimit();
+  size_t global = getGlobalMemoryLimit();
+  std::vector<LiveQuery> queries = liveQueries();
+  for (const LiveQuery &query : queries) {
+    addRow("query",
+           "#" + std::to_string(query.id) + " " + statementText(query.query),
+           {memoryCell(query.used), memoryCell(0, false),
+            memoryCell(0, false), memoryCell(0, false),
+            memoryCell(0, false), memoryCell(query.peak),
+            memoryCell(perQuery, perQuery != 0)});
+  }
 
-  std::cout << "Execution: " << (ok ? "SUCCESS" : "FAILED") << "\n";
-  std::cout << result.message << "\n";
+  usageRow("total", "tables", tables);
+  addRow("total", "queries",
+         {memoryCell(globalQueryMemory()), memoryCell(0, false),
+          memoryCell(0, false), memoryCell(0, false), memoryCell(0, false),
+          memoryCell(0, false), memoryCell(global, global != 0)});
+
+  result.success = true;
+  for (const auto &column : columns)
+    result.columnNames.push_back(column.first);
+  for (size_t i = 0; i < columns.size(); i++)
+    result.projection.push_back(static_cast<int>(i));
+  result.rows = std::make_shared<RowCursor>(std::move(table));
+  result.table = result.rows->getTable();
+  result.message = "Tables hold " + formatBytes(tables.total()) + " (" +
+                   formatBytes(tables.reserved) + " more reserved), " +
+                   std::to_string(queries.size()) + " running statement(s) " +
+                   formatBytes(globalQueryMemory()) + " (limits: " +
+                   describeMemoryLimits() + ").";
 
+  diag() << "Execution: SUCCESS\n";
+  diag() << result.message << "\n";
   return result;
 }
 
 // ============================================================================
 // UPDATE EXECUTION
 // ============================================================================
-QueryResult Executor::executeUpdate(const ParseTree &tree) {
+QueryResult Executor::executeUpdate(const QueryPlan &plan) {
   QueryResult result;
+  const std::string &tableName = plan.table;
 
-  std::string tableName;
-  std::string setCol, setVal;
-  std::string whereCol, whereOp, whereVal;
-  bool hasWhere = false;
+  if (!plan.hasWhere) {
+    result.message = "UPDATE without WHERE is not supported for safety.";
+    result.success = false;
+    return result;
+  }
 
-  for (const auto &child : tree->children) {
-    if (child->type == NodeType::TABLE_NAME) {
-      tableName = child->value;
-      std::transform(tableName.begin(), tableName.end(), tableName.begin(),
-                     ::tolower);
-    } else if (child->type == NodeType::SET_CLAUSE) {
-      for (const auto &assign : child->children) {
-        if (assign->type == NodeType::ASSIGNMENT) {
-          for (const auto &ac : assign->children) {
-            if (ac->type == NodeType::COLUMN)
-              setCol = ac->value;
-            else if (ac->type == NodeType::VALUE)
-              setVal = ac->value;
-          }
-        }
-      }
-    } else if (child->type == NodeType::WHERE_CLAUSE) {
-      hasWhere = true;
-      for (const auto &wc : child->children) {
-        if (wc->type == NodeType::CONDITION) {
-          for (const auto &cc : wc->children) {
-            if (cc->type == NodeType::COLUMN)
-              whereCol = cc->value;
-            else if (cc->type == NodeType::OPERATOR)
-              whereOp = cc->value;
-            else if (cc->type == NodeType::VALUE)
-              whereVal = cc->value;
-          }
-        }
-      }
-    }
+  BoundFilter where;
+  if (!bindWhere(plan, where, result)) {
+    return result;
   }
 
-  if (!hasWhere) {
-    result.message = "UPDATE without WHERE is not supported for safety.";
+  std::vector<std::string> values;
+  for (const auto &value : plan.setValues)
+    values.push_back(value.text);
+  std::string error;
+  int count = dataStore.updateRows(tableName, plan.setColumns, values, where,
+                                   chooseAccess(tableName, where), error);
+  if (count < 0) {
     result.success = false;
+    result.message = "UPDATE failed: " + error + ".";
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
     return result;
   }
 
-  int count = dataStore.updateRows(tableName, setCol, setVal, whereCol, whereOp,
-                                   whereVal);
   result.success = true;
   result.affectedRows = count;
   result.message = std::to_string(count) + " row(s) updated successfully.";
 
-  std::cout << "Execution: SUCCESS\n";
-  std::cout << result.message << "\n";
+  diag() << "Execution: SUCCESS\n";
+  diag() << result.message << "\n";
 
   return result;
 }
@@ -244,43 +1689,20 @@ QueryResult Executor::executeUpdate(const ParseTree &tree) {
 // ============================================================================
 // DELETE EXECUTION
 // ============================================================================
-QueryResult Executor::executeDelete(const ParseTree &tree) {
+QueryResult Executor::executeDelete(const QueryPlan &plan) {
   QueryResult result;
-
-  std::string tableName;
-  std::string whereCol, whereOp, whereVal;
-  bool hasWhere = false;
-
-  for (const auto &child : tree->children) {
-    if (child->type == NodeType::FROM_CLAUSE) {
-      for (const auto &fc : child->children) {
-        if (fc->type == NodeType::TABLE_NAME) {
-          tableName = fc->value;
-          std::transform(tableName.begin(), tableName.end(), tableName.begin(),
-                         ::tolower);
-        }
-      }
-    } else if (child->type == NodeType::WHERE_CLAUSE) {
-      hasWhere = true;
-      for (const auto &wc : child->children) {
-        if (wc->type == NodeType::CONDITION) {
-          for (const auto &cc : wc->children) {
-            if (cc->type == NodeType::COLUMN)
-              whereCol = cc->value;
-            else if (cc->type == NodeType::OPERATOR)
-              whereOp = cc->value;
-            else if (cc->type == NodeType::VALUE)
-              whereVal = cc->value;
-          }
-        }
-      }
-    }
-  }
+  const std::string &tableName = plan.table;
 
   int count;
-  if (hasWhere) {
-    count = dataStore.deleteRows(tableName, whereCol, whereOp, whereVal);
+  if (plan.hasWhere) {
+    BoundFilter where;
+    if (!bindWhere(plan, where, result)) {
+      return result;
+    }
+    count = dataStore.deleteRows(tableName, where,
+                                 chooseAccess(tableName, where));
   } else {
+    recordAccess(AccessPath::ALL_ROWS);
     count = dataStore.deleteAllRows(tableName);
   }
 
@@ -288,26 +1710,620 @@ QueryResult Executor::executeDelete(const ParseTree &tree) {
   result.affectedRows = count;
   result.message = std::to_string(count) + " row(s) deleted successfully.";
 
-  std::cout << "Execution: SUCCESS\n";
-  std::cout << result.message << "\n";
+  diag() << "Execution: SUCCESS\n";
+  diag() << result.message << "\n";
+
+  return result;
+}
+
+// ============================================================================
+// CREATE INDEX EXECUTION
+// ============================================================================
+QueryResult Executor::executeCreateIndex(const QueryPlan &plan) {
+  QueryResult result;
+  const std::string &tableName = plan.table;
+  std::string column = plan.columns.empty() ? "" : plan.columns[0];
+  std::string indexName = plan.indexName;
+
+  std::string error;
+  if (!dataStore.createIndex(tableName, column, plan.indexKind, indexName,
+                             error)) {
+    result.success = false;
+    result.message = "CREATE INDEX failed: " + error + ".";
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return result;
+  }
+
+  result.success = true;
+  result.affectedRows = dataStore.getRowCount(tableName);
+  result.message = indexKindToString(plan.indexKind) + " index '" +
+                   indexName + "' created on " + tableName + "(" + column +
+                   ").";
+
+  diag() << "Execution: SUCCESS\n";
+  diag() << result.message << "\n";
+
+  return result;
+}
+
+// ============================================================================
+// ALTER TABLE ... PARTITION BY EXECUTION
+// ============================================================================
+bool Executor::planPartitioning(const QueryPlan &plan, PartitionScheme &scheme,
+                                std::string &error) const {
+  const TableInfo *schema = dataStore.getSchema(plan.table);
+  if (!schema || plan.columns.empty()) {
+    error = "table '" + plan.table + "' not found";
+    return false;
+  }
+  std::vector<std::string> args;
+  for (const auto &value : plan.values)
+    args.push_back(value.text);
+  return makePartitionScheme(*schema, plan.partitionMethod, plan.columns[0],
+                             args, scheme, error);
+}
+
+QueryResult Executor::executePartition(const QueryPlan &plan) {
+  QueryResult result;
+  PartitionScheme scheme;
+  std::string error;
+  if (!planPartitioning(plan, scheme, error) ||
+      !dataStore.partitionTable(plan.table, scheme, error)) {
+    result.message = "ALTER TABLE failed: " + error + ".";
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return result;
+  }
+
+  result.success = true;
+  result.affectedRows = dataStore.getRowCount(plan.table);
+  result.message = "Table '" + plan.table + "' partitioned by " +
+                   scheme.describe() + ".";
+  diag() << "Execution: SUCCESS\n";
+  diag() << result.message << "\n";
+  return result;
+}
+
+// ============================================================================
+// ACCESS PATH SELECTION
+// ============================================================================
+AccessPlan Executor::chooseAccess(const std::string &tableName,
+                                  const BoundFilter &where) const {
+  AccessPlan access = dataStore.chooseAccess(tableName, where);
+  if (access.index) {
+    diag() << "Access path: index lookup using '" << access.index->getName()
+           << "' (" << indexKindToString(access.index->getKind()) << ")\n";
+    recordAccess(AccessPath::INDEX, access.index->getName());
+  } else if (access.parallel) {
+    diag() << "Access path: parallel full table scan\n";
+    recordAccess(AccessPath::PARALLEL_SCAN);
+  } else {
+    diag() << "Access path: full table scan\n";
+    recordAccess(AccessPath::FULL_SCAN);
+  }
+  return access;
+}
+
+// ============================================================================
+// EXPLAIN [ANALYZE]
+// ============================================================================
+namespace {
+
+std::string percent(double fraction) {
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(fraction < 0.001 ? 3 : 1)
+       << fraction * 100 << "%";
+  return text.str();
+}
+
+std::string micros(uint64_t nanos) {
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(1) << nanos / 1e3 << " us";
+  return text.str();
+}
+
+std::string describePredicate(const BoundPredicate &pred) {
+  std::string value =
+      pred.mode == CompareMode::VARCHAR ? "'" + pred.text + "'" : pred.text;
+  return pred.column + " " + compareOpToString(pred.op) + " " + value;
+}
+
+// One line per node, operands indented below their AND / OR, in the
+// order they are evaluated
+void describeFilter(const BoundFilter &filter, const std::string &indent,
+                    std::vector<std::string> &lines) {
+  std::string estimate = "  (est. " + percent(filter.selectivity) + ")";
+  if (filter.kind == BoundFilter::Kind::PREDICATE) {
+    lines.push_back(indent + describePredicate(filter.predicate) + estimate);
+    return;
+  }
+  lines.push_back(indent +
+                  (filter.kind == BoundFilter::Kind::AND ? "AND" : "OR") +
+                  estimate);
+  for (const auto &operand : filter.children)
+    describeFilter(operand, indent + "  ", lines);
+}
+
+// "index lookup using 'idx' (HASH) on age", "parallel full table scan
+// (4 threads)", ...
+std::string describeAccess(const AccessPlan &access, const TableInfo &schema,
+                           const ThreadPool *pool) {
+  if (access.index) {
+    return "index lookup using '" + access.index->getName() + "' (" +
+           indexKindToString(access.index->getKind()) + ") on " +
+           schema.columns[access.index->getColumnIndex()].name;
+  }
+  if (access.parallel)
+    return "parallel full table scan (" + std::to_string(pool->size()) +
+           " threads)";
+  return "full table scan";
+}
+
+// Estimated matches and cost of an access path, and what they are based on
+std::string describeEstimate(const AccessPlan &access) {
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(0) << "  Estimate: " << access.rows
+       << " row(s), cost " << access.cost
+       << (access.costBased ? " (from statistics)"
+                            : " (default selectivities; not analyzed)");
+  return text.str();
+}
+
+// How a scan evaluates the filter of a plan bound by bindWhere
+std::string describeExecution(const QueryPlan &plan, const BoundFilter &where) {
+  if (where.compiled)
+    return "compiled, fused scan of " +
+           std::to_string(where.compiled->stageCount()) + " condition(s)";
+  if (plan.hot)
+    return "interpreted (OR and text comparisons are not compiled)";
+  return "interpreted (compiled once the query shape has run " +
+         std::to_string(COMPILE_THRESHOLD) + " times)";
+}
+
+std::string joinNames(const std::vector<std::string> &names) {
+  std::string text;
+  for (size_t i = 0; i < names.size(); i++)
+    text += (i ? ", " : "") + names[i];
+  return text;
+}
+
+// The aggregation step of a SELECT with aggregates or GROUP BY, and its
+// output columns
+void describeAggregate(const QueryPlan &plan, const ThreadPool *pool,
+                       std::vector<std::string> &lines) {
+  if (countsAllRows(plan)) {
+    lines.push_back("  Aggregate: COUNT(*) from the table's row count");
+  } else {
+    std::string line = "  Aggregate: hash aggregation";
+    if (!plan.groupBy.empty())
+      line += " by " + joinNames(plan.groupBy);
+    size_t threads = pool ? pool->size() : 1;
+    line += " (" + std::to_string(threads) + " partial" +
+            (threads == 1 ? "" : "s, merged") + ")";
+    lines.push_back(line);
+  }
+  std::vector<std::string> names;
+  for (size_t i = 0; i < plan.columns.size(); i++)
+    names.push_back(plan.outputName(i));
+  lines.push_back("  Output: " + joinNames(names));
+}
+
+// The ORDER BY and LIMIT steps of a SELECT
+void describeOrder(const QueryPlan &plan, size_t memory,
+                   std::vector<std::string> &lines) {
+  if (plan.orderBy.empty()) {
+    if (plan.hasLimit)
+      lines.push_back("  Limit: " + plan.limit.text +
+                      " (reading stops once found)");
+    return;
+  }
+
+  std::vector<std::string> keys;
+  for (const auto &key : plan.orderBy)
+    keys.push_back(key.name() + (key.descending ? " DESC" : ""));
+  std::string line = "  Sort: " + joinNames(keys) + " (";
+  QueryResult ignored;
+  size_t limit = SIZE_MAX;
+  planLimit(plan, limit, ignored);
+  if (chooseSortMethod(limit) == SortMethod::TOP_K) {
+    line += sortMethodToString(SortMethod::TOP_K) + " of " +
+            std::to_string(limit) + ")";
+  } else {
+    line += sortMethodToString(SortMethod::PARALLEL) + "; " +
+            sortMethodToString(SortMethod::EXTERNAL) + " beyond " +
+            std::to_string(memory >> 20) + " MiB)";
+  }
+  lines.push_back(line);
+  if (plan.hasLimit && limit > TOP_K_MAX_ROWS)
+    lines.push_back("  Limit: " + plan.limit.text);
+}
+
+// The columns of a lazily loaded table that are resident
+void describeLazy(const TableData &table, const std::string &indent,
+                  std::vector<std::string> &lines) {
+  if (!table.source)
+    return;
+  size_t resident = static_cast<size_t>(
+      std::count(table.resident.begin(), table.resident.end(), 1));
+  lines.push_back(indent + "Lazy columns: " + std::to_string(resident) +
+                  " of " + std::to_string(table.columns.size()) +
+                  " resident, the others load from '" +
+                  table.source->getPath() + "' on first use");
+}
+
+} // namespace
+
+bool Executor::describePlan(const QueryPlan &plan,
+                            std::vector<std::string> &lines,
+                            QueryResult &result) const {
+  if (!plan.joins.empty())
+    return describeJoin(plan, lines, result);
+  if (plan.type == PlanType::SHOW_MEMORY) {
+    lines.push_back("SHOW MEMORY");
+    lines.push_back("  Report: per table and index (values, strings, "
+                    "maps, reserved), then per running statement");
+    lines.push_back("  Limits: " + describeMemoryLimits());
+    return true;
+  }
+
+  const TableInfo *schema = dataStore.getSchema(plan.table);
+  if (!schema) {
+    result.message = "Table '" + plan.table + "' not found.";
+    return false;
+  }
+
+  std::string head = planTypeToString(plan.type) + " " + plan.table;
+  if (plan.type == PlanType::UPDATE) {
+    for (size_t i = 0; i < plan.setColumns.size(); i++)
+      head += (i == 0 ? " SET " : ", ") + plan.setColumns[i] + " = " +
+              plan.setValues[i].text;
+  } else if (plan.type == PlanType::CREATE_INDEX) {
+    head += " (" + joinNames(plan.columns) + ") USING " +
+            indexKindToString(plan.indexKind);
+  } else if (plan.type == PlanType::COPY) {
+    head += " FROM '" + plan.source.text + "'";
+  }
+  PartitionScheme split;
+  if (plan.type == PlanType::PARTITION) {
+    std::string error;
+    if (!planPartitioning(plan, split, error)) {
+      result.message = "ALTER TABLE failed: " + error + ".";
+      return false;
+    }
+    head += " PARTITION BY " + split.describe();
+  }
+  lines.push_back(head);
+  std::shared_ptr<const PartitionScheme> scheme =
+      dataStore.getPartitioning(plan.table);
+  if (scheme) {
+    lines.push_back("  Table rows: " +
+                    std::to_string(dataStore.getRowCount(plan.table)));
+  } else {
+    TableSnapshot table = dataStore.snapshot(plan.table);
+    std::string count = "  Table rows: " + std::to_string(table->liveRows());
+    if (!table->deleted.empty())
+      count += " (+ " + std::to_string(table->deleted.size()) +
+               " deleted, not yet compacted)";
+    lines.push_back(count);
+    describeLazy(*table, "  ", lines);
+  }
+  std::shared_ptr<const TableStats> stats = dataStore.getStats(plan.table);
+  lines.push_back(stats ? "  Statistics: analyzed at " +
+                              std::to_string(stats->rows) + " rows"
+                        : "  Statistics: none (ANALYZE " + plan.table + ")");
+
+  // Access path, exactly as execution would choose it
+  std::string access = "none";
+  BoundFilter where;
+  AccessPlan chosen;
+  bool filtered = plan.hasWhere && plan.type != PlanType::INSERT &&
+                  plan.type != PlanType::CREATE_INDEX;
+  if (filtered) {
+    if (!bindWhere(plan, where, result))
+      return false;
+    chosen = dataStore.chooseAccess(plan.table, where);
+    access = describeAccess(chosen, *schema, dataStore.getThreadPool());
+  } else if (plan.type == PlanType::SELECT && countsAllRows(plan)) {
+    access = "none (row count)";
+  } else if (plan.type == PlanType::SELECT || plan.type == PlanType::DELETE ||
+             plan.type == PlanType::ANALYZE) {
+    access = "all rows (no WHERE)";
+  }
+  lines.push_back("  Access: " + access);
+
+  // A partitioned table runs a fragment on each partition the filter may
+  // match (changes too), each with its own access path
+  bool fragments = plan.type == PlanType::UPDATE ||
+                   plan.type == PlanType::DELETE ||
+                   (plan.type == PlanType::SELECT && !countsAllRows(plan));
+  if (scheme && fragments) {
+    std::vector<size_t> partitions =
+        fragmentPartitions(*scheme, filtered ? &where : nullptr);
+    ThreadPool *pool = dataStore.getThreadPool();
+    bool parallel = plan.type == PlanType::SELECT && pool &&
+                    pool->size() > 1 && partitions.size() > 1;
+    lines.push_back("  Partitions: " + scheme->describe() + "; " +
+                    std::to_string(partitions.size()) + " read" +
+                    (parallel ? ", in parallel" : ""));
+    for (size_t p = 0; filtered && p < partitions.size(); p++) {
+      std::string name = partitionName(plan.table, partitions[p]);
+      lines.push_back(
+          "    " + name + ": " +
+          describeAccess(dataStore.chooseAccess(name, where), *schema,
+                         dataStore.getThreadPool()));
+    }
+  } else if (scheme) {
+    lines.push_back("  Partitions: " + scheme->describe());
+  }
+
+  if (filtered) {
+    lines.push_back(describeEstimate(chosen));
+    lines.push_back("  Filter:");
+    describeFilter(where, "    ", lines);
+    if (!chosen.index)
+      lines.push_back("  Filter execution: " + describeExecution(plan, where));
+  }
+
+  if (plan.type == PlanType::SELECT && plan.isAggregate()) {
+    describeAggregate(plan, dataStore.getThreadPool(), lines);
+    if (scheme && fragments)
+      lines.push_back("  Merge: partial aggregates of each partition, "
+                      "combined by group key");
+    describeOrder(plan, dataStore.getSortMemory(), lines);
+  } else if (plan.type == PlanType::SELECT) {
+    std::vector<std::string> columns =
+        plan.selectAll ? dataStore.getColumnNames(plan.table) : plan.columns;
+    lines.push_back("  Output: " + joinNames(columns));
+    if (scheme) {
+      std::string merge = "  Merge: output and ORDER BY columns gathered "
+                          "from each partition";
+      if (!plan.orderBy.empty() && plan.hasLimit)
+        merge += ", each sorted to its first " + plan.limit.text + " rows";
+      else if (plan.hasLimit)
+        merge += ", until " + plan.limit.text + " rows are found";
+      lines.push_back(merge);
+    }
+    describeOrder(plan, dataStore.getSortMemory(), lines);
+  } else if (plan.type == PlanType::INSERT) {
+    std::string values = "  Values: " + std::to_string(plan.values.size());
+    size_t rows = plan.columns.empty()
+                      ? 0
+                      : plan.values.size() / plan.columns.size();
+    if (rows > 1)
+      values += " (" + std::to_string(rows) + " rows)";
+    lines.push_back(values);
+  } else if (plan.type == PlanType::UPDATE) {
+    lines.push_back("  Assignments: " +
+                    std::to_string(plan.setColumns.size()) +
+                    " per row, in one pass over the matching rows");
+  } else if (plan.type == PlanType::DELETE && plan.hasWhere) {
+    std::string del = "  Delete: rows marked in the tombstone bitmap";
+    double ratio = dataStore.getCompactRatio();
+    if (ratio > 0)
+      del += "; compacted in the background once " +
+             std::to_string(static_cast<int>(ratio * 100 + 0.5)) +
+             "% are deleted";
+    lines.push_back(del);
+  } else if (plan.type == PlanType::ANALYZE) {
+    lines.push_back("  Collect: per column NULLs, distinct (HyperLogLog), "
+                    "min / max, " +
+                    std::to_string(HISTOGRAM_BUCKETS) +
+                    "-bucket histogram, most common values");
+  } else if (plan.type == PlanType::PARTITION) {
+    lines.push_back("  Split: rows moved into " +
+                    partitionName(plan.table, 0) + " .. " +
+                    partitionName(plan.table, split.count - 1) +
+                    " by " + split.column);
+  }
+  return true;
+}
+
+// Every table with its access path and filter, then each join step with the
+// method execution would choose for the estimated input sizes
+bool Executor::describeJoin(const QueryPlan &plan,
+                            std::vector<std::string> &lines,
+                            QueryResult &result) const {
+  BoundJoin join;
+  std::string error;
+  if (!bindJoin(dataStore, plan, join, error)) {
+    result.message = "JOIN could not be bound: " + error + ".";
+    return false;
+  }
+
+  std::string head = "SELECT " + plan.table;
+  for (const auto &name : plan.joins)
+    head += " JOIN " + name;
+  lines.push_back(head);
+
+  auto describeCondition = [](const JoinCondition &cond) {
+    return cond.left.name + " " + compareOpToString(cond.op) + " " +
+           cond.right.name;
+  };
+  double joinedRows = 0;
+  for (size_t t = 0; t < join.tables.size(); t++) {
+    const std::string &name = join.tables[t];
+    size_t tableRows = dataStore.getRowCount(name);
+    double rows = static_cast<double>(tableRows);
+    std::string access = "all rows";
+    if (join.filtered[t]) {
+      AccessPlan chosen = dataStore.chooseAccess(name, join.filters[t]);
+      access = describeAccess(chosen, *join.schemas[t],
+                              dataStore.getThreadPool());
+      rows = chosen.rows;
+    }
+    lines.push_back("  Scan " + name + ": " + access + " (" +
+                    std::to_string(tableRows) + " rows)");
+    if (auto scheme = dataStore.getPartitioning(name)) {
+      size_t read =
+          scheme->prune(join.filtered[t] ? &join.filters[t] : nullptr).size();
+      lines.push_back("    Gathered from " + std::to_string(read) + " of " +
+                      std::to_string(scheme->count) + " partitions (" +
+                      scheme->describe() + ")");
+    } else if (TableSnapshot table = dataStore.snapshot(name)) {
+      describeLazy(*table, "    ", lines);
+    }
+    if (join.filtered[t]) {
+      lines.push_back("    Filter:");
+      describeFilter(join.filters[t], "      ", lines);
+    }
+    if (t == 0) {
+      joinedRows = rows;
+      continue;
+    }
+
+    const auto &conditions = join.steps[t];
+    int key;
+    JoinMethod method =
+        chooseJoinMethod(conditions, static_cast<size_t>(joinedRows),
+                         static_cast<size_t>(rows), key);
+    std::string step = "  Join " + name + ": " + joinMethodToString(method);
+    if (key >= 0)
+      step += " on " + describeCondition(conditions[key]);
+    else if (conditions.empty())
+      step += " (every pair)";
+    lines.push_back(step);
+    for (size_t i = 0; i < conditions.size(); i++) {
+      if (static_cast<int>(i) != key)
+        lines.push_back("    Check: " + describeCondition(conditions[i]));
+    }
+    // A key match keeps about the larger input; anything else may pair all
+    joinedRows = key >= 0 ? std::max(joinedRows, rows) : joinedRows * rows;
+  }
+  if (plan.isAggregate())
+    describeAggregate(plan, dataStore.getThreadPool(), lines);
+  else
+    lines.push_back("  Output: " + joinNames(join.names));
+  describeOrder(plan, dataStore.getSortMemory(), lines);
+  return true;
+}
+
+QueryResult Executor::executeExplain(const QueryPlan &plan) {
+  QueryPlan statement = plan;
+  statement.explain = ExplainMode::NONE;
+
+  QueryResult result;
+  std::vector<std::string> lines;
+  if (!describePlan(statement, lines, result)) {
+    diag() << "Execution: FAILED\n";
+    diag() << result.message << "\n";
+    return result;
+  }
+
+  if (plan.explain == ExplainMode::ANALYZE) {
+    // Phases 1-3 have been measured by the caller's scope, if any
+    QueryMetrics compiled;
+    if (const QueryMetrics *outer = currentMetrics())
+      compiled = *outer;
+
+    // Run the statement for real, counting it separately; its execution
+    // time is already part of the caller's execution phase
+    MetricsScope scope;
+    auto start = std::chrono::steady_clock::now();
+    QueryResult executed = executeStatement(statement);
+    if (executed.rows)
+      executed.rows->count();
+    uint64_t executeNanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+    if (!executed.success)
+      return executed;
+
+    const QueryMetrics &actual = scope.get();
+    bool isSelect = !executed.columnNames.empty();
+    lines.push_back("Actual:");
+    lines.push_back("  Access: " + actual.accessDescription());
+    if (actual.access == AccessPath::FULL_SCAN ||
+        actual.access == AccessPath::PARALLEL_SCAN ||
+        actual.access == AccessPath::INDEX) {
+      lines.push_back("  Rows scanned: " +
+                      std::to_string(actual.rowsScanned));
+      lines.push_back("  Rows matched: " +
+                      std::to_string(actual.rowsMatched));
+    }
+    lines.push_back(std::string(isSelect ? "  Rows returned: "
+                                         : "  Rows affected: ") +
+                    std::to_string(actual.rowsEmitted));
+    lines.push_back("  Bytes allocated: " +
+                    std::to_string(compiled.bytesAllocated +
+                                   actual.bytesAllocated));
+    if (compiled.planCached) {
+      lines.push_back("  Plan cache: hit (phases 1-3 skipped)");
+    } else {
+      for (Phase phase : {Phase::LEX, Phase::PARSE, Phase::SEMANTIC})
+        lines.push_back("  " + phaseToString(phase) + ": " +
+                        micros(compiled.phaseNanos[static_cast<size_t>(
+                            phase)]));
+    }
+    lines.push_back("  " + phaseToString(Phase::EXECUTE) + ": " +
+                    micros(executeNanos));
+  }
+
+  // The description is an ordinary one-column result
+  TableInfo info("explain");
+  info.addColumn("QUERY PLAN", "VARCHAR");
+  auto table = std::make_shared<TableData>(info);
+  for (const auto &line : lines) {
+    CellValue cell;
+    cell.isNull = false;
+    cell.stringValue = line;
+    table->columns[0].append(cell);
+  }
+  table->rowCount = lines.size();
+
+  result.success = true;
+  result.columnNames = {"QUERY PLAN"};
+  result.projection = {0};
+  result.rows = std::make_shared<RowCursor>(std::move(table));
+  result.table = result.rows->getTable();
+  result.message = "Plan of " + planTypeToString(plan.type) + " described.";
+
+  diag() << "Execution: SUCCESS\n";
+  diag() << result.message << "\n";
 
   return result;
 }
 
+// ============================================================================
+// WHERE BINDING
+// ============================================================================
+bool Executor::bindWhere(const QueryPlan &plan, BoundFilter &out,
+                         QueryResult &result) const {
+  std::string error;
+  const TableInfo *schema = dataStore.getSchema(plan.table);
+  if (!schema) {
+    error = "Table '" + plan.table + "' not found";
+  } else if (bindExpr(*schema, dataStore.getStats(plan.table).get(),
+                      plan.where, out, error)) {
+    // A hot plan runs its filter compiled, if it has a compiled form
+    if (plan.hot && out.compile())
+      diag() << "WHERE filter compiled: fused scan of "
+             << out.compiled->stageCount() << " condition(s)\n";
+    return true;
+  }
+
+  result.success = false;
+  result.message = "WHERE clause could not be bound: " + error + ".";
+  diag() << "Execution: FAILED\n";
+  diag() << result.message << "\n";
+  return false;
+}
+
 // ============================================================================
 // RESULT PRINTING
 // ============================================================================
 void Executor::printResults(const QueryResult &result) const {
   if (!result.success) {
-    std::cout << "\nExecution Error: " << result.message << "\n";
+    diag() << "\nExecution Error: " << result.message << "\n";
     return;
   }
 
   // For non-SELECT queries (INSERT/UPDATE/DELETE)
   if (result.columnNames.empty()) {
-    std::cout << "\n" << result.message << "\n";
+    diag() << "\n" << result.message << "\n";
     if (result.affectedRows > 0) {
-      std::cout << "Affected rows: " << result.affectedRows << "\n";
+      diag() << "Affected rows: " << result.affectedRows << "\n";
     }
     return;
   }
@@ -317,8 +2333,9 @@ void Executor::printResults(const QueryResult &result) const {
 }
 
 void Executor::printResultTable(const QueryResult &result) const {
-  if (result.columnNames.empty())
+  if (result.columnNames.empty() || !result.rows)
     return;
+  RowCursor &rows = *result.rows;
 
   // Calculate column widths
   std::vector<size_t> widths;
@@ -326,13 +2343,12 @@ void Executor::printResultTable(const QueryResult &result) const {
     widths.push_back(col.length());
   }
 
-  // Check row data widths
-  for (const auto &row : result.rows) {
+  // Size the columns from the rows read ahead (all of them, for a result
+  // that fits); a wider value further down overflows its cell
+  rows.prefetch(RESULT_SAMPLE_ROWS);
+  for (RowId row : rows.buffered()) {
     for (size_t i = 0; i < result.columnNames.size(); i++) {
-      auto it = row.find(result.columnNames[i]);
-      if (it != row.end()) {
-        widths[i] = std::max(widths[i], it->second.length());
-      }
+      widths[i] = std::max(widths[i], result.getValue(row, i).length());
     }
   }
 
@@ -344,51 +2360,54 @@ void Executor::printResultTable(const QueryResult &result) const {
 
   // Print separator
   auto printSep = [&]() {
-    std::cout << "+";
+    diag() << "+";
     for (size_t w : widths) {
       for (size_t i = 0; i < w + 2; i++)
-        std::cout << "-";
-      std::cout << "+";
+        diag() << "-";
+      diag() << "+";
     }
-    std::cout << "\n";
+    diag() << "\n";
   };
 
-  std::cout << "\n--- Query Results ---\n";
+  diag() << "\n--- Query Results ---\n";
   printSep();
 
   // Print header
-  std::cout << "|";
+  diag() << "|";
   for (size_t i = 0; i < result.columnNames.size(); i++) {
-    std::cout << " " << std::left << std::setw(widths[i] + 1)
-              << result.columnNames[i] << "|";
+    diag() << " " << std::left << std::setw(widths[i] + 1)
+           << result.columnNames[i] << "|";
   }
-  std::cout << "\n";
+  diag() << "\n";
   printSep();
 
-  // Print rows
-  if (result.rows.empty()) {
-    std::cout << "| (no rows returned)";
+  // Print rows as they are pulled from the cursor
+  size_t before = rows.returned();
+  SelectionVector batch;
+  while (rows.next(batch)) {
+    for (RowId row : batch) {
+      diag() << "|";
+      for (size_t i = 0; i < result.columnNames.size(); i++) {
+        diag() << " " << std::left << std::setw(widths[i] + 1)
+               << result.getValue(row, i) << "|";
+      }
+      diag() << "\n";
+    }
+  }
+  size_t rowCount = rows.returned() - before;
+
+  if (rowCount == 0) {
+    diag() << "| (no rows returned)";
     size_t totalWidth = 0;
     for (size_t w : widths)
       totalWidth += w + 3;
     for (size_t i = 19; i < totalWidth - 1; i++)
-      std::cout << " ";
-    std::cout << "|\n";
-    printSep();
-  } else {
-    for (const auto &row : result.rows) {
-      std::cout << "|";
-      for (size_t i = 0; i < result.columnNames.size(); i++) {
-        auto it = row.find(result.columnNames[i]);
-        std::string val = (it != row.end()) ? it->second : "NULL";
-        std::cout << " " << std::left << std::setw(widths[i] + 1) << val << "|";
-      }
-      std::cout << "\n";
-    }
-    printSep();
+      diag() << " ";
+    diag() << "|\n";
   }
+  printSep();
 
-  std::cout << result.rows.size() << " row(s) in set\n";
+  diag() << rowCount << " row(s) in set\n";
 }
 
 } // namespace MiniSQL
@@ -0,0 +1,236 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: filter.cpp
+ * Description: Compound WHERE Filter Implementation
+ */
+
+#include "../include/filter.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace MiniSQL {
+
+namespace {
+
+// Below one undecided row in SPARSE_RATIO, operands test rows one by one
+// instead of scanning the whole chunk
+constexpr size_t SPARSE_RATIO = 8;
+
+// Default selectivities (table not analyzed): equality picks few rows,
+// inequality most, a range about a third
+double defaultSelectivity(const BoundPredicate &pred) {
+  switch (pred.op) {
+  case CompareOp::EQ:
+    return 0.1;
+  case CompareOp::NE:
+    return 0.9;
+  default:
+    return 1.0 / 3.0;
+  }
+}
+
+// Relative cost of testing a row: text comparisons format every value, a
+// compound filter costs at most all of its operands
+double evaluationCost(const BoundFilter &filter) {
+  if (filter.kind != BoundFilter::Kind::PREDICATE) {
+    double cost = 0.0;
+    for (const auto &child : filter.children)
+      cost += evaluationCost(child);
+    return cost;
+  }
+  switch (filter.predicate.mode) {
+  case CompareMode::VARCHAR:
+    return 2.0;
+  case CompareMode::TEXT:
+    return 4.0;
+  default:
+    return 1.0;
+  }
+}
+
+// Cost per row an operand decides: rows it rejects (AND) or accepts (OR).
+// An operand that decides no row goes last.
+double evaluationRank(const BoundFilter &filter, BoundFilter::Kind kind) {
+  double decided = kind == BoundFilter::Kind::AND ? 1.0 - filter.selectivity
+                                                  : filter.selectivity;
+  if (decided <= 0.0)
+    return std::numeric_limits<double>::infinity();
+  return evaluationCost(filter) / decided;
+}
+
+size_t countSet(const uint8_t *flags, size_t count) {
+  size_t set = 0;
+  for (size_t i = 0; i < count; i++)
+    set += flags[i];
+  return set;
+}
+
+} // namespace
+
+BoundFilter BoundFilter::leaf(const BoundPredicate &predicate,
+                              const TableStats *stats) {
+  BoundFilter filter;
+  filter.kind = Kind::PREDICATE;
+  filter.predicate = predicate;
+  filter.selectivity = defaultSelectivity(predicate);
+  if (stats)
+    estimateSelectivity(*stats, predicate, filter.selectivity);
+  return filter;
+}
+
+BoundFilter BoundFilter::combine(Kind kind, std::vector<BoundFilter> operands) {
+  BoundFilter filter;
+  filter.kind = kind;
+  for (auto &operand : operands) {
+    if (operand.kind == kind) {
+      for (auto &nested : operand.children)
+        filter.children.push_back(std::move(nested));
+    } else {
+      filter.children.push_back(std::move(operand));
+    }
+  }
+
+  // AND: P(all match) = product; OR: P(any match) = 1 - product of misses
+  // (operands are assumed independent)
+  double product = 1.0;
+  for (const auto &child : filter.children) {
+    product *= kind == Kind::AND ? child.selectivity : 1.0 - child.selectivity;
+  }
+  filter.selectivity = kind == Kind::AND ? product : 1.0 - product;
+
+  // Lowest cost per decided row first; ties keep the written order
+  std::vector<double> ranks;
+  for (const auto &child : filter.children)
+    ranks.push_back(evaluationRank(child, kind));
+  std::vector<size_t> order(filter.children.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&ranks](size_t a, size_t b) { return ranks[a] < ranks[b]; });
+  std::vector<BoundFilter> sorted;
+  for (size_t i : order)
+    sorted.push_back(std::move(filter.children[i]));
+  filter.children = std::move(sorted);
+  return filter;
+}
+
+void BoundFilter::evaluate(const std::vector<Column> &columns,
+                           size_t rowCount, std::vector<uint8_t> &out) const {
+  out.assign(rowCount, 0);
+  for (size_t base = 0, c = 0; base < rowCount;
+       base += COLUMN_CHUNK_ROWS, c++) {
+    size_t count = std::min(COLUMN_CHUNK_ROWS, rowCount - base);
+    evaluateChunk(columns, c, count, out.data() + base);
+  }
+}
+
+void BoundFilter::evaluateChunk(const std::vector<Column> &columns,
+                                size_t chunkIndex, size_t count,
+                                uint8_t *out) const {
+  if (kind == Kind::PREDICATE) {
+    int col = predicate.columnIndex;
+    if (col < 0 || col >= static_cast<int>(columns.size())) {
+      std::memset(out, 0, count);
+      return;
+    }
+    predicate.scan(predicate, columns[col].getChunk(chunkIndex), count, out);
+    return;
+  }
+
+  // Operand 0 decides every row; later operands only revisit rows whose
+  // outcome is still open (selected rows for AND, unselected for OR)
+  size_t base = chunkIndex * COLUMN_CHUNK_ROWS;
+  uint8_t open = kind == Kind::AND ? 1 : 0;
+  children[0].evaluateChunk(columns, chunkIndex, count, out);
+
+  std::vector<uint8_t> operand;
+  for (size_t k = 1; k < children.size(); k++) {
+    size_t set = countSet(out, count);
+    size_t undecided = open ? set : count - set;
+    if (undecided == 0)
+      return;
+
+    const BoundFilter &child = children[k];
+    if (undecided * SPARSE_RATIO < count) {
+      for (size_t i = 0; i < count; i++) {
+        if (out[i] == open)
+          out[i] = child.matches(columns, base + i);
+      }
+      continue;
+    }
+
+    operand.resize(count);
+    child.evaluateChunk(columns, chunkIndex, count, operand.data());
+    if (open) {
+      for (size_t i = 0; i < count; i++)
+        out[i] &= operand[i];
+    } else {
+      for (size_t i = 0; i < count; i++)
+        out[i] |= operand[i];
+    }
+  }
+}
+
+bool BoundFilter::matches(const std::vector<Column> &columns,
+                          size_t row) const {
+  switch (kind) {
+  case Kind::PREDICATE: {
+    int col = predicate.columnIndex;
+    return col >= 0 && col < static_cast<int>(columns.size()) &&
+           predicate.matches(columns[col], row);
+  }
+  case Kind::AND:
+    for (const auto &child : children) {
+      if (!child.matches(columns, row))
+        return false;
+    }
+    return true;
+  case Kind::OR:
+    for (const auto &child : children) {
+      if (child.matches(columns, row))
+        return true;
+    }
+    return false;
+  }
+  return false;
+}
+
+bool BoundFilter::compile() {
+  compiled = CompiledFilter::compile(*this);
+  return compiled != nullptr;
+}
+
+void BoundFilter::selectChunk(const std::vector<Column> &columns,
+                              const DeleteBitmap &deleted, size_t chunkIndex,
+                              size_t count, SelectionVector &out) const {
+  if (compiled) {
+    compiled->selectChunk(columns, deleted, chunkIndex, count, out);
+    return;
+  }
+
+  std::vector<uint8_t> flags(count);
+  evaluateChunk(columns, chunkIndex, count, flags.data());
+  deleted.mask(chunkIndex, count, flags.data());
+  size_t base = chunkIndex * COLUMN_CHUNK_ROWS;
+  for (size_t r = 0; r < count; r++) {
+    if (flags[r])
+      out.push_back(static_cast<RowId>(base + r));
+  }
+}
+
+std::vector<const BoundPredicate *> BoundFilter::conjuncts() const {
+  std::vector<const BoundPredicate *> result;
+  if (kind == Kind::PREDICATE) {
+    result.push_back(&predicate);
+  } else if (kind == Kind::AND) {
+    for (const auto &child : children) {
+      if (child.kind == Kind::PREDICATE)
+        result.push_back(&child.predicate);
+    }
+  }
+  return result;
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,299 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: index.cpp
+ * Description: Secondary Index Implementation
+ *
+ * Both index kinds are templates over the key type (int64_t for INT,
+ * double for FLOAT, std::string for VARCHAR):
+ * - HashIndex:    std::unordered_map from key to the rows holding it
+ * - OrderedIndex: std::multimap (balanced search tree) from key to row
+ *
+ * Lookups return row positions sorted into table order, so an index
+ * lookup produces exactly the same result as a full scan.
+ */
+
+#include "../include/index.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+namespace MiniSQL {
+
+bool TableIndex::supports(const BoundPredicate &where) const {
+  if (where.columnIndex != columnIndex)
+    return false;
+  if (where.mode != CompareMode::INT && where.mode != CompareMode::FLOAT &&
+      where.mode != CompareMode::VARCHAR)
+    return false;
+  if (kind == IndexKind::HASH)
+    return where.op == CompareOp::EQ;
+  return where.op != CompareOp::NE;
+}
+
+namespace {
+
+// ============================================================================
+// KEY ACCESS - Read a typed key from a column or a bound literal
+// ============================================================================
+template <typename Key> Key keyOf(const Column &values, RowId row);
+
+template <> int64_t keyOf<int64_t>(const Column &values, RowId row) {
+  return values.getInt(row);
+}
+template <> double keyOf<double>(const Column &values, RowId row) {
+  return values.getFloat(row);
+}
+template <> std::string keyOf<std::string>(const Column &values, RowId row) {
+  return std::string(values.getString(row));
+}
+
+template <typename Key> const Key &literalKey(const BoundPredicate &where);
+
+template <> const int64_t &literalKey<int64_t>(const BoundPredicate &where) {
+  return where.literal.intValue;
+}
+template <> const double &literalKey<double>(const BoundPredicate &where) {
+  return where.literal.floatValue;
+}
+template <>
+const std::string &literalKey<std::string>(const BoundPredicate &where) {
+  return where.literal.stringValue;
+}
+
+// Heap bytes of a key outside its node
+size_t keyHeapBytes(int64_t) { return 0; }
+size_t keyHeapBytes(double) { return 0; }
+size_t keyHeapBytes(const std::string &key) { return stringHeapBytes(key); }
+
+// Per-node overhead of the standard containers: the links of a hash
+// chain node (next pointer, cached hash) and of a red-black tree node
+// (three pointers and the color)
+const size_t HASH_NODE_LINKS = 2 * sizeof(void *);
+const size_t TREE_NODE_LINKS = 4 * sizeof(void *);
+
+// ============================================================================
+// HASH INDEX - Equality lookups in O(1)
+// ============================================================================
+template <typename Key> class HashIndex : public TableIndex {
+private:
+  std::unordered_map<Key, std::vector<RowId>> entries;
+  size_t count = 0;
+
+public:
+  HashIndex(const std::string &n, int column)
+      : TableIndex(n, column, IndexKind::HASH) {}
+
+  void insert(const Column &values, RowId row) override {
+    if (values.isNull(row))
+      return;
+    entries[keyOf<Key>(values, row)].push_back(row);
+    count++;
+  }
+
+  void insertRows(const Column &values, RowId first, RowId end) override {
+    // Runs of one key (sorted or low-cardinality batches) share a lookup
+    auto last = entries.end();
+    for (RowId row = first; row < end; row++) {
+      if (values.isNull(row))
+        continue;
+      Key key = keyOf<Key>(values, row);
+      if (last == entries.end() || !(last->first == key))
+        last = entries.try_emplace(std::move(key)).first;
+      last->second.push_back(row);
+      count++;
+    }
+  }
+
+  void erase(const Column &values, RowId row) override {
+    if (values.isNull(row))
+      return;
+    auto it = entries.find(keyOf<Key>(values, row));
+    if (it == entries.end())
+      return;
+    auto &rows = it->second;
+    auto pos = std::find(rows.begin(), rows.end(), row);
+    if (pos != rows.end()) {
+      *pos = rows.back();
+      rows.pop_back();
+      count--;
+    }
+    if (rows.empty())
+      entries.erase(it);
+  }
+
+  void clear() override {
+    entries.clear();
+    count = 0;
+  }
+
+  void remap(const std::vector<RowId> &newIds) override {
+    count = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+      auto &rows = it->second;
+      size_t kept = 0;
+      for (RowId row : rows) {
+        if (newIds[row] != DELETED_ROW)
+          rows[kept++] = newIds[row];
+      }
+      rows.resize(kept);
+      count += kept;
+      it = rows.empty() ? entries.erase(it) : std::next(it);
+    }
+  }
+
+  void lookup(const BoundPredicate &where,
+              SelectionVector &out) const override {
+    out.clear();
+    auto it = entries.find(literalKey<Key>(where));
+    if (it == entries.end())
+      return;
+    out = it->second;
+    std::sort(out.begin(), out.end());
+  }
+
+  size_t size() const override { return count; }
+
+  void memoryUsage(MemoryUsage &usage) const override {
+    usage.maps += entries.bucket_count() * sizeof(void *) +
+                  entries.size() * (HASH_NODE_LINKS +
+                                    sizeof(typename decltype(
+                                        entries)::value_type));
+    for (const auto &entry : entries) {
+      usage.values += entry.second.size() * sizeof(RowId);
+      usage.reserved +=
+          (entry.second.capacity() - entry.second.size()) * sizeof(RowId);
+      usage.strings += keyHeapBytes(entry.first);
+    }
+  }
+};
+
+// ============================================================================
+// ORDERED INDEX - Equality and range lookups in O(log n + matches)
+// ============================================================================
+template <typename Key> class OrderedIndex : public TableIndex {
+private:
+  std::multimap<Key, RowId> entries;
+
+public:
+  OrderedIndex(const std::string &n, int column)
+      : TableIndex(n, column, IndexKind::ORDERED) {}
+
+  void insert(const Column &values, RowId row) override {
+    if (values.isNull(row))
+      return;
+    entries.emplace(keyOf<Key>(values, row), row);
+  }
+
+  void insertRows(const Column &values, RowId first, RowId end) override {
+    // Sorted first, each entry goes in right after the previous one
+    std::vector<std::pair<Key, RowId>> batch;
+    batch.reserve(end - first);
+    for (RowId row = first; row < end; row++) {
+      if (!values.isNull(row))
+        batch.emplace_back(keyOf<Key>(values, row), row);
+    }
+    std::sort(batch.begin(), batch.end());
+    auto hint = entries.end();
+    for (auto &entry : batch) {
+      hint = std::next(entries.emplace_hint(hint, std::move(entry.first),
+                                            entry.second));
+    }
+  }
+
+  void erase(const Column &values, RowId row) override {
+    if (values.isNull(row))
+      return;
+    auto range = entries.equal_range(keyOf<Key>(values, row));
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == row) {
+        entries.erase(it);
+        return;
+      }
+    }
+  }
+
+  void clear() override { entries.clear(); }
+
+  void remap(const std::vector<RowId> &newIds) override {
+    for (auto it = entries.begin(); it != entries.end();) {
+      RowId moved = newIds[it->second];
+      if (moved == DELETED_ROW) {
+        it = entries.erase(it);
+      } else {
+        it->second = moved;
+        ++it;
+      }
+    }
+  }
+
+  void lookup(const BoundPredicate &where,
+              SelectionVector &out) const override {
+    out.clear();
+    const Key &key = literalKey<Key>(where);
+
+    auto first = entries.begin();
+    auto last = entries.end();
+    switch (where.op) {
+    case CompareOp::EQ:
+      first = entries.lower_bound(key);
+      last = entries.upper_bound(key);
+      break;
+    case CompareOp::LT:
+      last = entries.lower_bound(key);
+      break;
+    case CompareOp::LE:
+      last = entries.upper_bound(key);
+      break;
+    case CompareOp::GT:
+      first = entries.upper_bound(key);
+      break;
+    case CompareOp::GE:
+      first = entries.lower_bound(key);
+      break;
+    case CompareOp::NE:
+      return;
+    }
+
+    for (auto it = first; it != last; ++it) {
+      out.push_back(it->second);
+    }
+    std::sort(out.begin(), out.end());
+  }
+
+  size_t size() const override { return entries.size(); }
+
+  void memoryUsage(MemoryUsage &usage) const override {
+    usage.maps += entries.size() *
+                  (TREE_NODE_LINKS +
+                   sizeof(typename decltype(entries)::value_type));
+    for (const auto &entry : entries)
+      usage.strings += keyHeapBytes(entry.first);
+  }
+};
+
+template <typename Key>
+std::unique_ptr<TableIndex> makeIndex(const std::string &name, int columnIndex,
+                                      IndexKind kind) {
+  if (kind == IndexKind::HASH)
+    return std::make_unique<HashIndex<Key>>(name, columnIndex);
+  return std::make_unique<OrderedIndex<Key>>(name, columnIndex);
+}
+
+} // namespace
+
+std::unique_ptr<TableIndex> createIndex(const std::string &name,
+                                        int columnIndex, ColumnType type,
+                                        IndexKind kind) {
+  switch (type) {
+  case ColumnType::INT:
+    return makeIndex<int64_t>(name, columnIndex, kind);
+  case ColumnType::FLOAT:
+    return makeIndex<double>(name, columnIndex, kind);
+  case ColumnType::VARCHAR:
+    return makeIndex<std::string>(name, columnIndex, kind);
+  }
+  return nullptr;
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,478 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: join.cpp
+ * Description: Hash, Radix Hash and Nested-Loop Join Implementation
+ *
+ * Every join produces (tuple, row) pairs: a tuple of the tables joined so
+ * far and a row of the table being joined. Pairs are collected per morsel
+ * (or per partition) and appended in morsel order, so the result does not
+ * depend on the number of threads.
+ */
+
+#include "../include/join.h"
+#include "../include/memory_tracker.h"
+#include "../include/metrics.h"
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace MiniSQL {
+
+namespace {
+
+// Probe keys (hash join) or joined tuples (nested loop) per morsel
+const size_t HASH_MORSEL_ROWS = COLUMN_CHUNK_ROWS;
+const size_t NESTED_LOOP_MORSEL_ROWS = 64;
+
+// Build keys per radix partition: the partition's table (two 16-byte
+// slots per key) stays within a 256 KB cache
+const size_t PARTITION_ROWS = size_t(1) << 13;
+const size_t MAX_PARTITION_BITS = 10;
+
+// Tuples are addressed by RowId when the result is read
+const size_t MAX_JOIN_ROWS = std::numeric_limits<RowId>::max();
+
+// How both sides of an equality are compared
+enum class KeyKind { INT, FLOAT, TEXT };
+
+KeyKind keyKind(ColumnType a, ColumnType b) {
+  if (a == ColumnType::INT && b == ColumnType::INT)
+    return KeyKind::INT;
+  if (a == ColumnType::VARCHAR || b == ColumnType::VARCHAR)
+    return KeyKind::TEXT;
+  return KeyKind::FLOAT; // INT = FLOAT compares as FLOAT
+}
+
+// The keys of one join input: the non-NULL values of its key column, in
+// input order
+struct JoinKeys {
+  KeyKind kind;
+  std::vector<uint32_t> entries; // Input position of each key
+  std::vector<uint64_t> hashes;
+  std::vector<int64_t> ints;           // INT
+  std::vector<double> floats;          // FLOAT
+  std::vector<std::string_view> texts; // TEXT (views into the chunks)
+
+  size_t size() const { return entries.size(); }
+
+  bool equal(size_t i, const JoinKeys &other, size_t j) const {
+    switch (kind) {
+    case KeyKind::INT:
+      return ints[i] == other.ints[j];
+    case KeyKind::FLOAT:
+      return floats[i] == other.floats[j];
+    case KeyKind::TEXT:
+      return texts[i] == other.texts[j];
+    }
+    return false;
+  }
+
+  size_t memoryUsage() const {
+    return entries.capacity() * sizeof(uint32_t) +
+           hashes.capacity() * sizeof(uint64_t) +
+           ints.capacity() * sizeof(int64_t) +
+           floats.capacity() * sizeof(double) +
+           texts.capacity() * sizeof(std::string_view);
+  }
+
+  // Bytes of the keys of `rows` input positions, at most
+  static size_t bytesFor(KeyKind kind, size_t rows) {
+    size_t value = kind == KeyKind::TEXT ? sizeof(std::string_view)
+                                         : sizeof(int64_t);
+    return rows * (sizeof(uint32_t) + sizeof(uint64_t) + value);
+  }
+};
+
+// Keys of column at rows[i] for every input position i
+void extractKeys(const Column &column, const SelectionVector &rows,
+                 KeyKind kind, JoinKeys &keys) {
+  keys.kind = kind;
+  keys.entries.reserve(rows.size());
+  keys.hashes.reserve(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    RowId row = rows[i];
+    if (column.isNull(row))
+      continue; // NULL never matches
+    keys.entries.push_back(static_cast<uint32_t>(i));
+    switch (kind) {
+    case KeyKind::INT: {
+      int64_t value = column.getInt(row);
+      keys.ints.push_back(value);
+      keys.hashes.push_back(mixHash(static_cast<uint64_t>(value)));
+      break;
+    }
+    case KeyKind::FLOAT: {
+      double value = column.getType() == ColumnType::INT
+                         ? static_cast<double>(column.getInt(row))
+                         : column.getFloat(row);
+      if (value == 0.0)
+        value = 0.0; // -0.0 and 0.0 are equal, so they must hash alike
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      keys.floats.push_back(value);
+      keys.hashes.push_back(mixHash(bits));
+      break;
+    }
+    case KeyKind::TEXT: {
+      std::string_view value = column.getString(row);
+      keys.texts.push_back(value);
+      keys.hashes.push_back(mixHash(std::hash<std::string_view>()(value)));
+      break;
+    }
+    }
+  }
+}
+
+// ============================================================================
+// HASH TABLE - Open addressing over the keys of the build input
+// ============================================================================
+// A slot holds the key's full hash next to its position, so a probe
+// compares keys only when the hashes are equal. Equal keys occupy
+// consecutive slots of the same run and are found in insertion order.
+class KeyTable {
+private:
+  static const uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+
+  struct Slot {
+    uint64_t hash;
+    uint32_t key; // Position in the build JoinKeys, or EMPTY
+  };
+
+  std::vector<Slot> slots;
+  size_t mask;
+
+  static size_t capacityFor(size_t count) {
+    size_t capacity = 16;
+    while (capacity < 2 * count)
+      capacity *= 2;
+    return capacity;
+  }
+
+public:
+  // Table of build.hashes[keys[0 .. count - 1]], at most half full
+  KeyTable(const JoinKeys &build, const uint32_t *keys, size_t count) {
+    size_t capacity = capacityFor(count);
+    slots.assign(capacity, Slot{0, EMPTY});
+    mask = capacity - 1;
+    for (size_t i = 0; i < count; i++) {
+      uint64_t hash = build.hashes[keys[i]];
+      size_t slot = hash & mask;
+      while (slots[slot].key != EMPTY)
+        slot = (slot + 1) & mask;
+      slots[slot] = Slot{hash, keys[i]};
+    }
+  }
+
+  // Call fn(key) for every build key with the given hash
+  template <typename Fn> void probe(uint64_t hash, Fn &&fn) const {
+    for (size_t slot = hash & mask; slots[slot].key != EMPTY;
+         slot = (slot + 1) & mask) {
+      if (slots[slot].hash == hash)
+        fn(slots[slot].key);
+    }
+  }
+
+  size_t memoryUsage() const { return slots.capacity() * sizeof(Slot); }
+
+  static size_t bytesFor(size_t count) {
+    return capacityFor(count) * sizeof(Slot);
+  }
+};
+
+// (tuple, row) pairs found by one morsel or partition: a tuple of the
+// tables joined so far and a position in the new table's rows
+struct JoinPairs {
+  std::vector<uint32_t> tuples;
+  std::vector<uint32_t> rows;
+
+  void add(uint32_t tuple, uint32_t row) {
+    tuples.push_back(tuple);
+    rows.push_back(row);
+  }
+};
+
+void runParallel(ThreadPool *pool, size_t count,
+                 const std::function<void(size_t)> &fn) {
+  if (pool) {
+    pool->run(count, fn);
+  } else {
+    for (size_t i = 0; i < count; i++)
+      fn(i);
+  }
+}
+
+} // namespace
+
+std::string joinMethodToString(JoinMethod method) {
+  switch (method) {
+  case JoinMethod::HASH:
+    return "hash join";
+  case JoinMethod::RADIX_HASH:
+    return "radix hash join";
+  case JoinMethod::NESTED_LOOP:
+    return "nested-loop join";
+  }
+  return "join";
+}
+
+bool comparableTypes(ColumnType a, ColumnType b) {
+  return (a == ColumnType::VARCHAR) == (b == ColumnType::VARCHAR);
+}
+
+bool compareCells(const Column &a, size_t rowA, CompareOp op,
+                  const Column &b, size_t rowB) {
+  if (a.isNull(rowA) || b.isNull(rowB))
+    return false;
+
+  int order;
+  if (a.getType() == ColumnType::INT && b.getType() == ColumnType::INT) {
+    int64_t x = a.getInt(rowA);
+    int64_t y = b.getInt(rowB);
+    order = (x > y) - (x < y);
+  } else if (a.getType() == ColumnType::VARCHAR &&
+             b.getType() == ColumnType::VARCHAR) {
+    int c = a.getString(rowA).compare(b.getString(rowB));
+    order = (c > 0) - (c < 0);
+  } else if (comparableTypes(a.getType(), b.getType())) {
+    double x = a.getType() == ColumnType::INT
+                   ? static_cast<double>(a.getInt(rowA))
+                   : a.getFloat(rowA);
+    double y = b.getType() == ColumnType::INT
+                   ? static_cast<double>(b.getInt(rowB))
+                   : b.getFloat(rowB);
+    order = (x > y) - (x < y);
+  } else {
+    int c = a.getText(rowA).compare(b.getText(rowB));
+    order = (c > 0) - (c < 0);
+  }
+
+  switch (op) {
+  case CompareOp::EQ:
+    return order == 0;
+  case CompareOp::NE:
+    return order != 0;
+  case CompareOp::LT:
+    return order < 0;
+  case CompareOp::LE:
+    return order <= 0;
+  case CompareOp::GT:
+    return order > 0;
+  case CompareOp::GE:
+    return order >= 0;
+  }
+  return false;
+}
+
+JoinMethod chooseJoinMethod(const std::vector<JoinCondition> &conditions,
+                            size_t joinedRows, size_t tableRows, int &key) {
+  key = -1;
+  for (size_t i = 0; i < conditions.size(); i++) {
+    const JoinCondition &cond = conditions[i];
+    if (cond.op == CompareOp::EQ && cond.left.table != cond.right.table) {
+      key = static_cast<int>(i);
+      break;
+    }
+  }
+  if (key < 0)
+    return JoinMethod::NESTED_LOOP;
+  return std::min(joinedRows, tableRows) >= RADIX_JOIN_MIN_ROWS
+             ? JoinMethod::RADIX_HASH
+             : JoinMethod::HASH;
+}
+
+// ============================================================================
+// JOIN
+// ============================================================================
+bool joinTable(JoinRows &joined, TableSnapshot table,
+               const SelectionVector &rows,
+               const std::vector<JoinCondition> &conditions,
+               ThreadPool *pool, JoinMethod &method, std::string &error) {
+  const size_t added = joined.tables.size();
+  const size_t tupleCount = joined.size();
+  int key = -1;
+  method = chooseJoinMethod(conditions, tupleCount, rows.size(), key);
+
+  auto columnOf = [&](const JoinColumn &col) -> const Column & {
+    const TableData &data =
+        col.table == added ? *table : *joined.tables[col.table];
+    return data.columns[col.column];
+  };
+  auto rowOf = [&](const JoinColumn &col, uint32_t tuple, uint32_t row) {
+    return col.table == added ? rows[row] : joined.rows[col.table][tuple];
+  };
+
+  // Conditions other than the hash key, checked on every pair
+  std::vector<const JoinCondition *> checks;
+  for (size_t i = 0; i < conditions.size(); i++) {
+    if (static_cast<int>(i) != key)
+      checks.push_back(&conditions[i]);
+  }
+  auto passes = [&](uint32_t tuple, uint32_t row) {
+    for (const JoinCondition *cond : checks) {
+      if (!compareCells(columnOf(cond->left), rowOf(cond->left, tuple, row),
+                        cond->op, columnOf(cond->right),
+                        rowOf(cond->right, tuple, row)))
+        return false;
+    }
+    return true;
+  };
+
+  // What the join works with is reserved before it is built
+  MemoryReservation working;
+  auto reserve = [&](size_t more, const std::string &what) {
+    if (working.resize(working.size() + more))
+      return true;
+    error = memoryLimitError(what, working.size() + more);
+    return false;
+  };
+
+  std::vector<JoinPairs> parts;
+  size_t bytes = 0;
+  if (method == JoinMethod::NESTED_LOOP) {
+    if (checks.empty() && rows.size() > 0 &&
+        tupleCount > MAX_JOIN_ROWS / rows.size()) {
+      error = "the join has more than " + std::to_string(MAX_JOIN_ROWS) +
+              " rows";
+      return false;
+    }
+    size_t morsels = (tupleCount + NESTED_LOOP_MORSEL_ROWS - 1) /
+                     NESTED_LOOP_MORSEL_ROWS;
+    parts.resize(morsels);
+    runParallel(pool, morsels, [&](size_t m) {
+      size_t end = std::min(tupleCount, (m + 1) * NESTED_LOOP_MORSEL_ROWS);
+      for (size_t t = m * NESTED_LOOP_MORSEL_ROWS; t < end; t++) {
+        for (size_t r = 0; r < rows.size(); r++) {
+          if (passes(static_cast<uint32_t>(t), static_cast<uint32_t>(r)))
+            parts[m].add(static_cast<uint32_t>(t), static_cast<uint32_t>(r));
+        }
+      }
+    });
+  } else {
+    const JoinCondition &cond = conditions[key];
+    const Column &leftColumn = columnOf(cond.left);
+    const Column &rightColumn = columnOf(cond.right);
+    KeyKind kind = keyKind(leftColumn.getType(), rightColumn.getType());
+    if (!reserve(JoinKeys::bytesFor(kind, tupleCount + rows.size()),
+                 "the join keys"))
+      return false;
+    JoinKeys tupleKeys, rowKeys;
+    extractKeys(leftColumn, joined.rows[cond.left.table], kind, tupleKeys);
+    extractKeys(rightColumn, rows, kind, rowKeys);
+
+    // The smaller input is built, the larger one probes
+    bool buildTuples = tupleKeys.size() < rowKeys.size();
+    const JoinKeys &build = buildTuples ? tupleKeys : rowKeys;
+    const JoinKeys &probe = buildTuples ? rowKeys : tupleKeys;
+    auto emit = [&](JoinPairs &out, uint32_t b, uint32_t p) {
+      uint32_t tuple = buildTuples ? build.entries[b] : probe.entries[p];
+      uint32_t row = buildTuples ? probe.entries[p] : build.entries[b];
+      if (passes(tuple, row))
+        out.add(tuple, row);
+    };
+    bytes += tupleKeys.memoryUsage() + rowKeys.memoryUsage();
+
+    if (method == JoinMethod::HASH) {
+      if (!reserve(KeyTable::bytesFor(build.size()) +
+                       build.size() * sizeof(uint32_t),
+                   "the join hash table"))
+        return false;
+      std::vector<uint32_t> all(build.size());
+      for (size_t i = 0; i < all.size(); i++)
+        all[i] = static_cast<uint32_t>(i);
+      KeyTable hashTable(build, all.data(), all.size());
+      bytes += hashTable.memoryUsage();
+
+      size_t morsels = (probe.size() + HASH_MORSEL_ROWS - 1) / HASH_MORSEL_ROWS;
+      parts.resize(morsels);
+      runParallel(pool, morsels, [&](size_t m) {
+        size_t end = std::min(probe.size(), (m + 1) * HASH_MORSEL_ROWS);
+        for (size_t p = m * HASH_MORSEL_ROWS; p < end; p++) {
+          hashTable.probe(probe.hashes[p], [&](uint32_t b) {
+            if (build.equal(b, probe, p))
+              emit(parts[m], b, static_cast<uint32_t>(p));
+          });
+        }
+      });
+    } else {
+      // Radix: group both inputs by the high bits of their hashes
+      // (counting sort), then join partition i of one with partition i of
+      // the other, each with a hash table that fits in cache
+      size_t bits = 1;
+      while (bits < MAX_PARTITION_BITS &&
+             (build.size() >> bits) > PARTITION_ROWS)
+        bits++;
+      size_t partitions = size_t(1) << bits;
+      if (!reserve((build.size() + probe.size()) * sizeof(uint32_t),
+                   "the join partitions"))
+        return false;
+      auto partition = [bits](uint64_t hash) { return hash >> (64 - bits); };
+      auto scatter = [&](const JoinKeys &keys, std::vector<uint32_t> &order,
+                         std::vector<size_t> &start) {
+        start.assign(partitions + 1, 0);
+        for (uint64_t hash : keys.hashes)
+          start[partition(hash) + 1]++;
+        for (size_t i = 0; i < partitions; i++)
+          start[i + 1] += start[i];
+        std::vector<size_t> next(start.begin(), start.end() - 1);
+        order.resize(keys.size());
+        for (size_t i = 0; i < keys.size(); i++)
+          order[next[partition(keys.hashes[i])]++] = static_cast<uint32_t>(i);
+      };
+      std::vector<uint32_t> buildOrder, probeOrder;
+      std::vector<size_t> buildStart, probeStart;
+      scatter(build, buildOrder, buildStart);
+      scatter(probe, probeOrder, probeStart);
+      bytes += (buildOrder.capacity() + probeOrder.capacity()) *
+               sizeof(uint32_t);
+
+      parts.resize(partitions);
+      runParallel(pool, partitions, [&](size_t i) {
+        KeyTable hashTable(build, buildOrder.data() + buildStart[i],
+                           buildStart[i + 1] - buildStart[i]);
+        for (size_t k = probeStart[i]; k < probeStart[i + 1]; k++) {
+          uint32_t p = probeOrder[k];
+          hashTable.probe(probe.hashes[p], [&](uint32_t b) {
+            if (build.equal(b, probe, p))
+              emit(parts[i], b, p);
+          });
+        }
+      });
+    }
+  }
+
+  size_t total = 0;
+  for (const auto &part : parts)
+    total += part.tuples.size();
+  if (total > MAX_JOIN_ROWS) {
+    error = "the join has more than " + std::to_string(MAX_JOIN_ROWS) +
+            " rows";
+    return false;
+  }
+  // The tuples are kept until the statement ends
+  if (!reserveMemory((added + 1) * total * sizeof(RowId), "the join result",
+                     error))
+    return false;
+
+  // Expand the pairs into tuples of every table, the new one last
+  JoinRows result;
+  result.tables = joined.tables;
+  result.tables.push_back(std::move(table));
+  result.rows.resize(added + 1);
+  for (auto &column : result.rows)
+    column.reserve(total);
+  for (const auto &part : parts) {
+    for (size_t i = 0; i < part.tuples.size(); i++) {
+      for (size_t t = 0; t < added; t++)
+        result.rows[t].push_back(joined.rows[t][part.tuples[i]]);
+      result.rows[added].push_back(rows[part.rows[i]]);
+    }
+  }
+  bytes += (added + 1) * total * sizeof(RowId);
+  recordBytes(bytes);
+
+  joined = std::move(result);
+  return true;
+}
+
+} // namespace MiniSQL
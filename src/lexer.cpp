@@ -21,21 +21,35 @@
  *
  * PATTERN RECOGNITION:
  * - Keywords: Predefined reserved words (SELECT, FROM, WHERE)
- * - Identifiers: Start with letter/underscore, followed by alphanumeric
+ * - Identifiers: Start with letter/underscore, followed by alphanumeric;
+ *   a column may be qualified with its table (employees.name)
  * - Numbers: Sequence of digits (with optional decimal point)
  * - Strings: Characters enclosed in single quotes
  * - Operators: Single-character symbols (=, <, >, *, etc.)
  */
 
 #include "../include/lexer.h"
-#include <algorithm>
+#include "../include/output.h"
 #include <cctype>
 #include <iostream>
 
 namespace MiniSQL {
 
-// Initialize keyword lookup table
-std::unordered_map<std::string, TokenType> Lexer::keywords = {
+namespace {
+
+// ============================================================================
+// KEYWORD TABLE - Compile-time perfect hash
+// ============================================================================
+// Every keyword lands in its own slot of a 64-entry table, so recognizing
+// a keyword is one hash of its first and last letters and length, then a
+// single case-insensitive comparison. The static_assert below rejects any
+// new keyword that would collide.
+struct Keyword {
+  std::string_view spelling; // Upper case
+  TokenType type;
+};
+
+constexpr Keyword KEYWORDS[] = {
     {"SELECT", TokenType::KEYWORD_SELECT},
     {"FROM", TokenType::KEYWORD_FROM},
     {"WHERE", TokenType::KEYWORD_WHERE},
@@ -48,10 +62,71 @@ std::unordered_map<std::string, TokenType> Lexer::keywords = {
     {"SET", TokenType::KEYWORD_SET},
     {"DELETE", TokenType::KEYWORD_DELETE},
     {"CREATE", TokenType::KEYWORD_CREATE},
-    {"TABLE", TokenType::KEYWORD_TABLE}};
+    {"TABLE", TokenType::KEYWORD_TABLE},
+    {"INDEX", TokenType::KEYWORD_INDEX},
+    {"ON", TokenType::KEYWORD_ON},
+    {"USING", TokenType::KEYWORD_USING},
+    {"EXPLAIN", TokenType::KEYWORD_EXPLAIN},
+    {"COPY", TokenType::KEYWORD_COPY},
+    {"JOIN", TokenType::KEYWORD_JOIN},
+    {"GROUP", TokenType::KEYWORD_GROUP},
+    {"BY", TokenType::KEYWORD_BY},
+    {"ORDER", TokenType::KEYWORD_ORDER},
+    {"LIMIT", TokenType::KEYWORD_LIMIT}};
+
+constexpr size_t KEYWORD_SLOTS = 64;
+
+// Identifier characters are ASCII letters, digits and '_'; clearing bit 5
+// upper-cases letters and never turns a digit or '_' into a letter
+constexpr char foldCase(char c) { return static_cast<char>(c & ~0x20); }
+
+constexpr size_t keywordHash(std::string_view text) {
+  return (7 * static_cast<size_t>(foldCase(text.front())) +
+          12 * static_cast<size_t>(foldCase(text.back())) + text.size()) &
+         (KEYWORD_SLOTS - 1);
+}
+
+struct KeywordTable {
+  Keyword slots[KEYWORD_SLOTS];
+  bool perfect;
+};
+
+constexpr KeywordTable buildKeywordTable() {
+  KeywordTable table{};
+  table.perfect = true;
+  for (const Keyword &keyword : KEYWORDS) {
+    Keyword &slot = table.slots[keywordHash(keyword.spelling)];
+    if (!slot.spelling.empty())
+      table.perfect = false;
+    slot = keyword;
+  }
+  return table;
+}
+
+constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+static_assert(KEYWORD_TABLE.perfect, "keyword hash has a collision");
+
+// Find the keyword an identifier spells, ignoring case
+const Keyword *findKeyword(std::string_view text) {
+  const Keyword &slot = KEYWORD_TABLE.slots[keywordHash(text)];
+  if (slot.spelling.size() != text.size())
+    return nullptr;
+  for (size_t i = 0; i < text.size(); i++) {
+    if (foldCase(text[i]) != slot.spelling[i])
+      return nullptr;
+  }
+  return &slot;
+}
+
+} // namespace
+
+std::string_view Lexer::keywordSpelling(std::string_view text) {
+  const Keyword *keyword = findKeyword(text);
+  return keyword ? keyword->spelling : std::string_view();
+}
 
 // Constructor
-Lexer::Lexer(const std::string &source)
+Lexer::Lexer(std::string_view source)
     : source(source), start(0), current(0), line(1), column(1), startColumn(1) {
 }
 
@@ -61,11 +136,12 @@ Lexer::Lexer(const std::string &source)
 std::vector<Token> Lexer::tokenize() {
   tokens.clear();
   errors.clear();
+  tokens.reserve(source.size() / 4 + 1);
 
-  std::cout << "\n========================================\n";
-  std::cout << "   PHASE 1: LEXICAL ANALYSIS\n";
-  std::cout << "========================================\n";
-  std::cout << "Input Query: " << source << "\n\n";
+  diag() << "\n========================================\n";
+  diag() << "   PHASE 1: LEXICAL ANALYSIS\n";
+  diag() << "========================================\n";
+  diag() << "Input Query: " << source << "\n\n";
 
   while (!isAtEnd()) {
     // Mark the beginning of the next token
@@ -78,11 +154,11 @@ std::vector<Token> Lexer::tokenize() {
   tokens.push_back(Token(TokenType::END_OF_INPUT, "", line, column));
 
   if (errors.empty()) {
-    std::cout << "Lexical Analysis: SUCCESS\n";
-    std::cout << "Total Tokens Generated: " << tokens.size() << "\n";
+    diag() << "Lexical Analysis: SUCCESS\n";
+    diag() << "Total Tokens Generated: " << tokens.size() << "\n";
   } else {
-    std::cout << "Lexical Analysis: FAILED with " << errors.size()
-              << " error(s)\n";
+    diag() << "Lexical Analysis: FAILED with " << errors.size()
+           << " error(s)\n";
   }
 
   return tokens;
@@ -177,23 +253,25 @@ void Lexer::scanToken() {
 // IDENTIFIER SCANNING - Handles keywords and identifiers
 // ============================================================================
 void Lexer::scanIdentifier() {
-  // Continue while we see alphanumeric characters or underscore
-  while (!isAtEnd() && (std::isalnum(peek()) || peek() == '_')) {
-    advance();
+  // Continue while we see alphanumeric characters or underscore; a '.'
+  // followed by another name qualifies a column with its table
+  while (!isAtEnd()) {
+    if (std::isalnum(peek()) || peek() == '_') {
+      advance();
+    } else if (peek() == '.' &&
+               (std::isalpha(peekNext()) || peekNext() == '_')) {
+      advance();
+    } else {
+      break;
+    }
   }
 
-  // Extract the identifier text
-  std::string text = source.substr(start, current - start);
-
-  // Convert to uppercase for keyword matching
-  std::string upperText = text;
-  std::transform(upperText.begin(), upperText.end(), upperText.begin(),
-                 ::toupper);
+  // Identifier text, viewed in place
+  std::string_view text = source.substr(start, current - start);
 
-  // Check if it's a keyword
-  auto it = keywords.find(upperText);
-  if (it != keywords.end()) {
-    addToken(it->second, upperText);
+  // Check if it's a keyword (the token carries the upper-case spelling)
+  if (const Keyword *keyword = findKeyword(text)) {
+    addToken(keyword->type, keyword->spelling);
   } else {
     // It's a regular identifier
     addToken(TokenType::IDENTIFIER, text);
@@ -220,8 +298,7 @@ void Lexer::scanNumber() {
     }
   }
 
-  std::string numStr = source.substr(start, current - start);
-  addToken(TokenType::NUMBER, numStr);
+  addToken(TokenType::NUMBER, source.substr(start, current - start));
 }
 
 // ============================================================================
@@ -251,9 +328,9 @@ void Lexer::scanString() {
   // Consume closing quote
   advance();
 
-  // Extract string value (without quotes)
-  std::string value = source.substr(start + 1, current - start - 2);
-  addToken(TokenType::STRING_LITERAL, value);
+  // String value without the quotes
+  addToken(TokenType::STRING_LITERAL,
+           source.substr(start + 1, current - start - 2));
 }
 
 // ============================================================================
@@ -290,12 +367,12 @@ bool Lexer::match(char expected) {
 }
 
 void Lexer::addToken(TokenType type) {
-  std::string text = source.substr(start, current - start);
-  tokens.push_back(Token(type, text, line, startColumn));
+  tokens.emplace_back(type, source.substr(start, current - start), line,
+                      startColumn);
 }
 
-void Lexer::addToken(TokenType type, const std::string &value) {
-  tokens.push_back(Token(type, value, line, startColumn));
+void Lexer::addToken(TokenType type, std::string_view value) {
+  tokens.emplace_back(type, value, line, startColumn);
 }
 
 void Lexer::reportError(const std::string &message) {
@@ -311,18 +388,19 @@ std::vector<CompilerError> Lexer::getErrors() const { return errors; }
 // DISPLAY TOKEN STREAM
 // ============================================================================
 void Lexer::printTokens() const {
-  std::cout << "\n--- Token Stream ---\n";
-  std::cout << "+-----------------------+------------------+------+-----+\n";
-  std::cout << "| Token Type            | Value            | Line | Col |\n";
-  std::cout << "+-----------------------+------------------+------+-----+\n";
+  diag() << "\n--- Token Stream ---\n";
+  diag() << "+-----------------------+------------------+------+-----+\n";
+  diag() << "| Token Type            | Value            | Line | Col |\n";
+  diag() << "+-----------------------+------------------+------+-----+\n";
 
   for (const auto &token : tokens) {
-    printf("| %-21s | %-16s | %4d | %3d |\n",
-           tokenTypeToString(token.type).c_str(), token.value.c_str(),
+    printf("| %-21s | %-16.*s | %4d | %3d |\n",
+           tokenTypeToString(token.type).c_str(),
+           static_cast<int>(token.value.size()), token.value.data(),
            token.line, token.column);
   }
 
-  std::cout << "+-----------------------+------------------+------+-----+\n";
+  diag() << "+-----------------------+------------------+------+-----+\n";
 }
 
 } // namespace MiniSQL
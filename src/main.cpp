@@ -27,9 +27,14 @@
  * Supported SQL:
  * --------------------
  * SELECT column1, column2, ... | * FROM table_name [WHERE condition];
- * INSERT INTO table (col1, col2) VALUES (val1, val2);
- * UPDATE table SET col = val WHERE condition;
+ * INSERT INTO table (col1, col2) VALUES (val1, val2) [, (val1, val2) ...];
+ * UPDATE table SET col = val [, col = val ...] WHERE condition;
  * DELETE FROM table [WHERE condition];
+ * CREATE INDEX [name] ON table [USING HASH | BTREE] (column);
+ * COPY table FROM 'file.csv';
+ * ANALYZE table;
+ * SHOW MEMORY;
+ * EXPLAIN [ANALYZE] statement;
  *
  * Operators: =, !=, <, <=, >, >=
  *
@@ -38,6 +43,16 @@
  * ./sql_compiler                               (Interactive mode)
  * ./sql_compiler --demo                        (Demo mode)
  * ./sql_compiler --file queries.txt            (Batch mode)
+ * ./sql_compiler --file q.txt --quiet --format jsonl (Quiet batch mode)
+ * ./sql_compiler --no-cache ...                (Disable the plan cache)
+ * ./sql_compiler --wal wal ...                  (Durable changes, see wal.h)
+ * ./sql_compiler --query-memory-mb 64 ...      (Memory limits, see
+ *                                               memory_tracker.h)
+ * ./sql_compiler --load data --lazy-load ...   (Load CSV files, columns on
+ *                                               first use; see data_store.h)
+ * ./sql_compiler --partition employees:hash:id:4 ... (Partitioned table,
+ *                                               see partition.h)
+ * ./sql_compiler --serve 5433                  (TCP server, see server.h)
  * echo "SELECT * FROM users;" | ./sql_compiler (Pipe mode)
  *
  * ============================================================================
@@ -47,46 +62,233 @@
 #include "../include/error_handler.h"
 #include "../include/executor.h"
 #include "../include/lexer.h"
+#include "../include/memory_tracker.h"
+#include "../include/metrics.h"
+#include "../include/output.h"
 #include "../include/parser.h"
+#include "../include/plan_cache.h"
+#include "../include/result_writer.h"
 #include "../include/semantic.h"
+#include "../include/server.h"
+#include "../include/thread_pool.h"
+#include "../include/wal.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 
 using namespace MiniSQL;
 
+// Global schema, built once and shared read-only by all phases
+static const Catalog globalCatalog = std::make_shared<const SymbolTable>();
+
 // Global data store (persists across queries in a session)
-static SymbolTable globalSymbolTable;
-static DataStore globalDataStore(globalSymbolTable);
+static DataStore globalDataStore(*globalCatalog);
+
+// Validated plans of previously compiled queries, keyed by query shape
+static PlanCache globalPlanCache;
+static bool planCacheEnabled = true;
+
+// Write-ahead log of the data store (--wal); declared after the store so
+// it is destroyed (and synced) first
+static std::unique_ptr<WriteAheadLog> globalLog;
+static bool waitForCommit = true; // false in batch mode (group commit)
+
+// Threads that scan tables in parallel (--threads)
+static std::unique_ptr<ThreadPool> globalPool;
+
+// Quiet batch mode: results go through this writer instead of the console
+// table, and phase diagnostics are disabled
+static std::unique_ptr<ResultWriter> resultWriter;
+
+// Outcome of one statement, collected for the batch summary
+struct QueryOutcome {
+  std::string statement; // "SELECT", "INSERT", ... or "INVALID"
+  bool success;
+  size_t rows;       // Rows returned (SELECT) or affected
+  std::string error; // First error message when !success
+  double micros;     // Wall time from lexing to result output
+
+  QueryOutcome() : statement("INVALID"), success(false), rows(0), micros(0) {}
+};
+
+// Options for quiet batch mode
+struct BatchOptions {
+  bool quiet = false;
+  OutputFormat format = OutputFormat::CSV;
+  std::string outputPath;  // Result destination (empty = stdout)
+  std::string timingsPath; // Per-query timing CSV (empty = none)
+};
+
+// Receives the result of an executed statement (instead of the console
+// table or the result writer)
+using ResultSink = std::function<void(const QueryResult &)>;
 
 // Function prototypes
 void printBanner();
 void printHelp();
-void compileAndExecute(const std::string &query);
+QueryOutcome compileAndExecute(const std::string &query,
+                               const ResultSink &sink = nullptr);
 void runInteractiveMode();
 void runDemoMode();
-void runBatchMode(const std::string &filePath);
+void runBatchMode(const std::string &filePath,
+                  const BatchOptions &options = BatchOptions());
+bool runServerMode(const std::string &host, int port);
+void printBatchSummary(const std::vector<QueryOutcome> &outcomes,
+                       double totalMicros);
+void commitChanges();
 
 // ============================================================================
 // MAIN FUNCTION
 // ============================================================================
 int main(int argc, char *argv[]) {
-  printBanner();
+  BatchOptions batch;
+  std::string batchFile;
+  std::string walDir;
+  size_t checkpointMb = 64;
+  size_t threads = 0; // One per hardware thread
+  size_t sortMemoryMb = DEFAULT_SORT_MEMORY >> 20;
+  size_t queryMemoryMb = 0;  // No limit
+  size_t globalMemoryMb = 0; // No limit
+  double compactPercent = DEFAULT_COMPACT_RATIO * 100;
+  std::string loadDir;
+  bool lazyLoad = false;
+  size_t columnCacheMb = 0; // No limit
+  std::vector<std::string> partitionSpecs; // <table>:<scheme>
+  bool demo = false;
+  int servePort = -1;
+  std::string serveHost = "127.0.0.1";
 
   // Check for command line arguments
-  if (argc > 1) {
-    std::string arg = argv[1];
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
     if (arg == "--help" || arg == "-h") {
+      printBanner();
       printHelp();
       return 0;
+    } else if (arg == "--no-cache") {
+      planCacheEnabled = false;
+    } else if (arg == "--quiet" || arg == "-q") {
+      batch.quiet = true;
+    } else if (arg == "--format" && i + 1 < argc) {
+      if (!outputFormatFromString(argv[++i], batch.format)) {
+        std::cerr << "Error: Unknown output format '" << argv[i]
+                  << "' (expected csv, tsv or jsonl)\n";
+        return 1;
+      }
+    } else if (arg == "--output" && i + 1 < argc) {
+      batch.outputPath = argv[++i];
+    } else if (arg == "--timings" && i + 1 < argc) {
+      batch.timingsPath = argv[++i];
+    } else if (arg == "--wal" && i + 1 < argc) {
+      walDir = argv[++i];
+    } else if (arg == "--checkpoint-mb" && i + 1 < argc) {
+      checkpointMb = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--sort-memory-mb" && i + 1 < argc) {
+      sortMemoryMb = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--query-memory-mb" && i + 1 < argc) {
+      queryMemoryMb = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--memory-limit-mb" && i + 1 < argc) {
+      globalMemoryMb = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--load" && i + 1 < argc) {
+      loadDir = argv[++i];
+    } else if (arg == "--lazy-load") {
+      lazyLoad = true;
+    } else if (arg == "--column-cache-mb" && i + 1 < argc) {
+      columnCacheMb = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--partition" && i + 1 < argc) {
+      partitionSpecs.push_back(argv[++i]);
+    } else if (arg == "--compact-percent" && i + 1 < argc) {
+      compactPercent = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--serve" && i + 1 < argc) {
+      servePort = std::atoi(argv[++i]);
+    } else if (arg == "--bind" && i + 1 < argc) {
+      serveHost = argv[++i];
     } else if (arg == "--demo") {
-      runDemoMode();
-      return 0;
-    } else if (arg == "--file" && argc > 2) {
-      runBatchMode(argv[2]);
-      return 0;
+      demo = true;
+    } else if ((arg == "--file" || arg == "--batch") && i + 1 < argc) {
+      batchFile = argv[++i];
+    }
+  }
+
+  if (batch.quiet && batchFile.empty()) {
+    std::cerr << "Error: --quiet requires --file <path>\n";
+    return 1;
+  }
+
+  if (batch.quiet || servePort >= 0)
+    setDiagnostics(false);
+  else
+    printBanner();
+
+  globalPool = std::make_unique<ThreadPool>(threads);
+  globalDataStore.setThreadPool(globalPool.get());
+  globalDataStore.setSortMemory(sortMemoryMb << 20);
+  globalDataStore.setCompactRatio(compactPercent / 100);
+  setMemoryLimits(queryMemoryMb << 20, globalMemoryMb << 20);
+  globalDataStore.setLazyLoading(lazyLoad);
+  globalDataStore.setColumnCacheMemory(columnCacheMb << 20);
+
+  // Partition tables before their rows are recovered or loaded
+  for (const auto &spec : partitionSpecs) {
+    size_t colon = spec.find(':');
+    std::string table = spec.substr(0, colon);
+    std::transform(table.begin(), table.end(), table.begin(), ::tolower);
+    const TableInfo *schema = globalDataStore.getSchema(table);
+    PartitionScheme scheme;
+    std::string error;
+    if (colon == std::string::npos) {
+      error = "expected <table>:hash:<column>:<partitions> or "
+              "<table>:range:<column>:<bound>,...";
+    } else if (!schema) {
+      error = "table '" + table + "' not found";
+    } else if (parsePartitionScheme(*schema, spec.substr(colon + 1), scheme,
+                                    error)) {
+      globalDataStore.partitionTable(table, scheme, error);
+    }
+    if (!error.empty()) {
+      std::cerr << "Error: Invalid --partition '" << spec << "': " << error
+                << "\n";
+      return 1;
     }
+    diag() << "Partitioned " << table << ": " << scheme.describe() << "\n";
+  }
+
+  // Recover the data store from its log before running anything
+  if (!walDir.empty()) {
+    globalLog = std::make_unique<WriteAheadLog>(walDir, checkpointMb << 20);
+    std::string error;
+    if (!globalLog->open(globalDataStore, error)) {
+      std::cerr << "Error: Could not open write-ahead log: " << error << "\n";
+      return 1;
+    }
+  }
+
+  if (!loadDir.empty()) {
+    globalDataStore.loadFromFiles(loadDir);
+    // Loaded rows are not logged; start the log over from them
+    if (globalLog)
+      globalLog->checkpoint(globalDataStore, false);
+  }
+
+  if (servePort >= 0)
+    return runServerMode(serveHost, servePort) ? 0 : 1;
+  if (demo) {
+    runDemoMode();
+    return 0;
+  }
+  if (!batchFile.empty()) {
+    runBatchMode(batchFile, batch);
+    return 0;
   }
 
   // Interactive mode
@@ -127,12 +329,54 @@ void printHelp() {
   std::cout << "\nOptions:\n";
   std::cout << "  --help, -h         Show this help message\n";
   std::cout << "  --demo             Run demo with sample queries\n";
-  std::cout << "  --file <path>      Execute queries from a file\n";
+  std::cout << "  --file <path>      Execute queries from a file (alias: --batch)\n";
+  std::cout << "  --quiet, -q        With --file: no diagnostics, results only\n";
+  std::cout << "  --format <fmt>     Quiet result format: csv (default), tsv, "
+               "jsonl\n";
+  std::cout << "  --output <path>    Quiet result destination (default stdout)\n";
+  std::cout << "  --timings <path>   Write per-query timings as CSV\n";
+  std::cout << "  --no-cache         Compile every query (disable plan cache)\n";
+  std::cout << "  --wal <dir>        Log changes to <dir> and recover from it\n";
+  std::cout << "  --checkpoint-mb <n> Checkpoint after n MiB of log "
+               "(default 64, 0 = never)\n";
+  std::cout << "  --threads <n>      Scan with n threads (default: all "
+               "cores)\n";
+  std::cout << "  --sort-memory-mb <n> Sort n MiB in memory before spilling "
+               "to disk (default 256)\n";
+  std::cout << "  --query-memory-mb <n> Let one statement hold at most n "
+               "MiB (default 0 = no limit)\n";
+  std::cout << "  --memory-limit-mb <n> Let all running statements hold at "
+               "most n MiB together (default 0 = no limit)\n";
+  std::cout << "  --load <dir>       Load <dir>/<table>.csv files at startup\n";
+  std::cout << "  --lazy-load        Loading CSV files only indexes them; "
+               "columns are parsed on first use\n";
+  std::cout << "  --column-cache-mb <n> Keep at most n MiB of lazily loaded "
+               "columns (default 0 = no limit)\n";
+  std::cout << "  --partition <table>:hash:<column>:<n>\n"
+               "  --partition <table>:range:<column>:<bound>,...\n"
+               "                     Split a table into partitions by a "
+               "column (repeatable)\n";
+  std::cout << "  --compact-percent <n> Compact a table once n% of its rows "
+               "are deleted (default 25, 0 = never)\n";
+  std::cout << "  --serve <port>     Serve statements over TCP (see "
+               "server.h)\n";
+  std::cout << "  --bind <addr>      Address to serve on (default "
+               "127.0.0.1)\n";
   std::cout << "\nSupported SQL Syntax:\n";
   std::cout << "  SELECT col1, col2 | * FROM table [WHERE col op value];\n";
-  std::cout << "  INSERT INTO table (col1, col2) VALUES (val1, val2);\n";
-  std::cout << "  UPDATE table SET col = value [WHERE col op value];\n";
+  std::cout << "  SELECT t1.col, t2.col FROM t1 JOIN t2 ON t1.col = t2.col;\n";
+  std::cout << "  SELECT col, COUNT(*), SUM(col) FROM table GROUP BY col;\n";
+  std::cout << "  SELECT ... ORDER BY col [ASC | DESC] [, ...] [LIMIT n];\n";
+  std::cout << "  INSERT INTO table (col1, col2) VALUES (val1, val2)"
+               " [, (...)];\n";
+  std::cout << "  UPDATE table SET col = value [, col = value]"
+               " [WHERE col op value];\n";
   std::cout << "  DELETE FROM table [WHERE col op value];\n";
+  std::cout << "  CREATE INDEX [name] ON table [USING HASH | BTREE] (col);\n";
+  std::cout << "  COPY table FROM 'file.csv';\n";
+  std::cout << "  ANALYZE table;\n";
+  std::cout << "  SHOW MEMORY;\n";
+  std::cout << "  EXPLAIN [ANALYZE] statement;\n";
   std::cout << "\nOperators: =, !=, <, <=, >, >=\n";
   std::cout << "\nAvailable Tables (with sample data):\n";
   std::cout << "  employees   (id, name, age, salary, department)\n";
@@ -142,63 +386,175 @@ void printHelp() {
   std::cout << "\nInteractive Commands:\n";
   std::cout << "  help       Show this help message\n";
   std::cout << "  tables     Show available tables and schema\n";
+  std::cout << "  cache      Show plan cache statistics\n";
+  std::cout << "  metrics    Show execution metrics of all statements\n";
+  std::cout << "  metrics reset\n"
+               "             Set the execution metrics back to zero\n";
   std::cout << "  demo       Run demo queries\n";
   std::cout << "  clear      Clear screen\n";
   std::cout << "  save       Save data to CSV files (data/ directory)\n";
   std::cout << "  load       Load data from CSV files\n";
+  std::cout << "  save snapshot [compress]\n"
+               "             Save binary table snapshots (data/*.snap)\n";
+  std::cout << "  load snapshot\n"
+               "             Load binary table snapshots\n";
+  std::cout << "  checkpoint Checkpoint the write-ahead log (--wal)\n";
+  std::cout << "  wal        Show write-ahead log statistics\n";
   std::cout << "  exit/quit  Exit the compiler\n";
 }
 
 // ============================================================================
 // QUERY COMPILATION & EXECUTION - Main pipeline
 // ============================================================================
-void compileAndExecute(const std::string &query) {
+// Statement kind for the batch summary
+static std::string statementName(const QueryPlan &plan) {
+  return plan.explain == ExplainMode::NONE ? planTypeToString(plan.type)
+                                           : "EXPLAIN";
+}
+
+// Execute a plan as the statement's execution phase (reading and
+// reporting a SELECT's rows is added to it as they are output)
+static QueryResult timedExecute(Executor &executor, const QueryPlan &plan) {
+  PhaseTimer timer(Phase::EXECUTE);
+  return executor.execute(plan);
+}
+
+QueryOutcome compileAndExecute(const std::string &query,
+                               const ResultSink &sink) {
+  auto startTime = std::chrono::steady_clock::now();
+  bool verbose = diagnosticsEnabled();
+  QueryOutcome outcome;
+  MetricsScope metrics; // Counts this statement (see metrics.h)
+  MemoryScope memory(query); // Its memory account (see memory_tracker.h)
+
   ErrorHandler errorHandler;
   errorHandler.setSource(query);
 
   bool syntaxValid = false;
   bool semanticValid = false;
+  ParseArena arena; // Owns the parse tree; released when the query is done
   ParseTree parseTree = nullptr;
 
-  std::cout << "\n══════════════════════════════════════════\n";
-  std::cout << "Starting compilation of query...\n";
-  std::cout << "══════════════════════════════════════════\n";
+  diag() << "\n══════════════════════════════════════════\n";
+  diag() << "Starting compilation of query...\n";
+  diag() << "══════════════════════════════════════════\n";
+
+  // Execute a plan and report its result (console table or result writer)
+  // A SELECT's rows are found while they are output, so that is timed as
+  // execution too
+  auto run = [&](Executor &executor, const QueryResult &result) {
+    outcome.success = result.success;
+    if (!result.success)
+      outcome.error = result.message;
+    commitChanges();
+    PhaseTimer timer(Phase::EXECUTE);
+    if (sink)
+      sink(result);
+    else if (resultWriter)
+      resultWriter->write(result);
+    else
+      executor.printResults(result);
+    outcome.rows = result.rows ? result.rows->count()
+                               : static_cast<size_t>(result.affectedRows);
+  };
+
+  // Record the first compile error for the batch summary
+  auto fail = [&]() {
+    if (errorHandler.hasErrors() && outcome.error.empty()) {
+      std::vector<CompilerError> errs;
+      for (ErrorType type : {ErrorType::LEXICAL_ERROR, ErrorType::SYNTAX_ERROR,
+                             ErrorType::SEMANTIC_ERROR}) {
+        errs = errorHandler.getErrorsByType(type);
+        if (!errs.empty())
+          break;
+      }
+      if (!errs.empty())
+        outcome.error = errs.front().toString();
+    }
+  };
+
+  auto finish = [&]() {
+    outcome.micros = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - startTime)
+                         .count();
+    return outcome;
+  };
+
+  // ========================================
+  // PLAN CACHE LOOKUP
+  // ========================================
+  // A query whose shape (text with literals replaced by their kind) was
+  // compiled before reuses the validated plan: phases 1-3 are skipped.
+  std::string cacheKey;
+  std::vector<std::string> cacheParams;
+  bool cacheable = planCacheEnabled &&
+                   PlanCache::normalize(query, cacheKey, cacheParams);
+  QueryPlan plan;
+
+  if (cacheable && globalPlanCache.lookup(cacheKey, cacheParams,
+                                          globalCatalog->getVersion(), plan)) {
+    diag() << "Plan cache: HIT (lexical, syntax and semantic analysis "
+              "skipped)\n";
+    metrics.get().planCached = true;
+    outcome.statement = statementName(plan);
+    Executor executor(globalDataStore);
+    run(executor, timedExecute(executor, plan));
+    if (verbose)
+      errorHandler.printSummary(true, true);
+    return finish();
+  }
 
   // ========================================
   // PHASE 1: LEXICAL ANALYSIS (Member 1)
   // ========================================
   Lexer lexer(query);
-  std::vector<Token> tokens = lexer.tokenize();
+  std::vector<Token> tokens;
+  {
+    PhaseTimer timer(Phase::LEX);
+    tokens = lexer.tokenize();
+  }
 
   // Display token stream
-  lexer.printTokens();
+  if (verbose)
+    lexer.printTokens();
 
   // Check for lexical errors
   if (lexer.hasErrors()) {
     errorHandler.addErrors(lexer.getErrors());
-    errorHandler.printErrors();
-    errorHandler.printSummary(false, false);
-    return;
+    if (verbose) {
+      errorHandler.printErrors();
+      errorHandler.printSummary(false, false);
+    }
+    fail();
+    return finish();
   }
 
   // ========================================
   // PHASE 2: SYNTAX ANALYSIS (Member 2)
   // ========================================
-  Parser parser(tokens);
-  parseTree = parser.parse();
+  Parser parser(tokens, arena);
+  {
+    PhaseTimer timer(Phase::PARSE);
+    parseTree = parser.parse();
+  }
+  recordBytes(arena.used() + tokens.capacity() * sizeof(Token));
+  chargeMemory(arena.used() + tokens.capacity() * sizeof(Token));
 
   // Check for syntax errors
   if (parser.hasErrors()) {
     errorHandler.addErrors(parser.getErrors());
-    errorHandler.printErrors();
-    errorHandler.printSummary(false, false);
-    return;
+    if (verbose) {
+      errorHandler.printErrors();
+      errorHandler.printSummary(false, false);
+    }
+    fail();
+    return finish();
   }
 
   syntaxValid = (parseTree != nullptr);
 
   // Display parse tree
-  if (parseTree) {
+  if (parseTree && verbose) {
     std::cout << "\n--- Parse Tree (Intermediate Representation) ---\n";
     Parser::printParseTree(parseTree);
   }
@@ -206,13 +562,18 @@ void compileAndExecute(const std::string &query) {
   // ========================================
   // PHASE 3: SEMANTIC ANALYSIS (Member 3)
   // ========================================
-  SemanticAnalyzer semanticAnalyzer;
+  SemanticAnalyzer semanticAnalyzer(globalCatalog);
 
   // Optionally print symbol table
-  std::cout << "\n--- Available Schema for Validation ---\n";
-  semanticAnalyzer.printSymbolTable();
+  if (verbose) {
+    std::cout << "\n--- Available Schema for Validation ---\n";
+    semanticAnalyzer.printSymbolTable();
+  }
 
-  semanticValid = semanticAnalyzer.analyze(parseTree);
+  {
+    PhaseTimer timer(Phase::SEMANTIC);
+    semanticValid = semanticAnalyzer.analyze(parseTree);
+  }
 
   // Check for semantic errors
   if (semanticAnalyzer.hasErrors()) {
@@ -224,18 +585,40 @@ void compileAndExecute(const std::string &query) {
   // ========================================
   if (syntaxValid && semanticValid && parseTree) {
     Executor executor(globalDataStore);
-    QueryResult result = executor.execute(parseTree);
-    executor.printResults(result);
+    if (executor.buildPlan(parseTree, plan)) {
+      // Every literal must map to a plan slot for the plan to be reusable
+      if (cacheable &&
+          static_cast<size_t>(plan.paramCount) == cacheParams.size()) {
+        plan.catalogVersion = globalCatalog->getVersion();
+        globalPlanCache.insert(cacheKey, plan);
+        if (plan.explain == ExplainMode::PLAN)
+          plan.hot =
+              globalPlanCache.statementHot(cacheKey, plan.catalogVersion);
+      }
+      outcome.statement = statementName(plan);
+      run(executor, timedExecute(executor, plan));
+    } else {
+      QueryResult result;
+      {
+        PhaseTimer timer(Phase::EXECUTE);
+        result = executor.execute(parseTree);
+      }
+      run(executor, result);
+    }
   }
 
   // ========================================
   // PHASE 5: FINAL OUTPUT (Member 4)
   // ========================================
-  if (errorHandler.hasErrors()) {
-    errorHandler.printErrors();
+  if (verbose) {
+    if (errorHandler.hasErrors()) {
+      errorHandler.printErrors();
+    }
+    errorHandler.printSummary(syntaxValid, semanticValid);
   }
 
-  errorHandler.printSummary(syntaxValid, semanticValid);
+  fail();
+  return finish();
 }
 
 // ============================================================================
@@ -276,8 +659,22 @@ void runInteractiveMode() {
     }
 
     if (line == "tables") {
-      SemanticAnalyzer temp;
-      temp.printSymbolTable();
+      globalCatalog->print();
+      continue;
+    }
+
+    if (line == "cache") {
+      globalPlanCache.printStats();
+      continue;
+    }
+
+    if (line == "metrics" || line == "metrics reset") {
+      if (line == "metrics") {
+        printMetrics();
+      } else {
+        resetMetrics();
+        std::cout << "Metrics reset.\n";
+      }
       continue;
     }
 
@@ -302,6 +699,35 @@ void runInteractiveMode() {
     if (line == "load") {
       globalDataStore.loadFromFiles("data");
       std::cout << "Data loaded from data/ directory.\n";
+      // Loaded rows are not logged; start the log over from them
+      if (globalLog)
+        globalLog->checkpoint(globalDataStore, false);
+      continue;
+    }
+
+    if (line == "save snapshot" || line == "save snapshot compress") {
+      system("mkdir -p data");
+      globalDataStore.saveSnapshots("data", line != "save snapshot");
+      std::cout << "Snapshots saved to data/ directory.\n";
+      continue;
+    }
+
+    if (line == "load snapshot") {
+      globalDataStore.loadSnapshots("data");
+      std::cout << "Snapshots loaded from data/ directory.\n";
+      if (globalLog)
+        globalLog->checkpoint(globalDataStore, false);
+      continue;
+    }
+
+    if (line == "checkpoint" || line == "wal") {
+      if (!globalLog) {
+        std::cout << "Write-ahead log is off (start with --wal <dir>).\n";
+      } else if (line == "wal") {
+        globalLog->printStats();
+      } else if (globalLog->checkpoint(globalDataStore, false)) {
+        std::cout << "Checkpoint complete.\n";
+      }
       continue;
     }
 
@@ -391,18 +817,36 @@ void runDemoMode() {
 // ============================================================================
 // BATCH MODE - Execute queries from a file
 // ============================================================================
-void runBatchMode(const std::string &filePath) {
+void runBatchMode(const std::string &filePath, const BatchOptions &options) {
   std::ifstream file(filePath);
   if (!file.is_open()) {
     std::cerr << "Error: Could not open file '" << filePath << "'\n";
     return;
   }
 
-  std::cout << "\n--- Batch Mode: Processing file '" << filePath << "' ---\n";
+  // Quiet mode: silence the phases and send results to the writer
+  FILE *out = stdout;
+  if (options.quiet) {
+    if (!options.outputPath.empty()) {
+      out = std::fopen(options.outputPath.c_str(), "w");
+      if (!out) {
+        std::cerr << "Error: Could not open output file '"
+                  << options.outputPath << "'\n";
+        return;
+      }
+    }
+    setDiagnostics(false);
+    resultWriter = std::make_unique<ResultWriter>(out, options.format);
+  }
+
+  diag() << "\n--- Batch Mode: Processing file '" << filePath << "' ---\n";
 
   std::string line;
   std::string query;
   int queryCount = 0;
+  std::vector<QueryOutcome> outcomes;
+  auto batchStart = std::chrono::steady_clock::now();
+  waitForCommit = false;
 
   while (std::getline(file, line)) {
     // Skip empty lines and comments
@@ -418,17 +862,142 @@ void runBatchMode(const std::string &filePath) {
 
     if (query.find(';') != std::string::npos) {
       queryCount++;
-      std::cout << "\n╔════════════════════════════════════════╗\n";
-      std::cout << "║  Query #" << queryCount << "\n";
-      std::cout << "║  " << query << "\n";
-      std::cout << "╚════════════════════════════════════════╝\n";
-
-      compileAndExecute(query);
+      diag() << "\n╔════════════════════════════════════════╗\n";
+      diag() << "║  Query #" << queryCount << "\n";
+      diag() << "║  " << query << "\n";
+      diag() << "╚════════════════════════════════════════╝\n";
+
+      outcomes.push_back(compileAndExecute(query));
+      if (options.quiet && !outcomes.back().success) {
+        std::cerr << "Query #" << queryCount
+                  << " failed: " << outcomes.back().error << "\n";
+      }
       query.clear();
     }
   }
 
   file.close();
-  std::cout << "\n--- Batch Mode Complete: " << queryCount
-            << " queries processed ---\n";
+  waitForCommit = true;
+  commitChanges();
+  double totalMicros = std::chrono::duration<double, std::micro>(
+                           std::chrono::steady_clock::now() - batchStart)
+                           .count();
+
+  if (resultWriter) {
+    resultWriter.reset(); // Flushes buffered results
+    if (out != stdout)
+      std::fclose(out);
+    setDiagnostics(true);
+  }
+
+  if (!options.timingsPath.empty()) {
+    std::ofstream timings(options.timingsPath);
+    timings << "query,statement,status,rows,micros\n";
+    for (size_t i = 0; i < outcomes.size(); i++) {
+      const QueryOutcome &q = outcomes[i];
+      timings << (i + 1) << "," << q.statement << ","
+              << (q.success ? "ok" : "failed") << "," << q.rows << ","
+              << static_cast<long long>(q.micros) << "\n";
+    }
+  }
+
+  if (options.quiet) {
+    printBatchSummary(outcomes, totalMicros);
+  } else {
+    std::cout << "\n--- Batch Mode Complete: " << queryCount
+              << " queries processed ---\n";
+  }
+}
+
+// ============================================================================
+// SERVER MODE - Answer statements from TCP clients (see server.h)
+// ============================================================================
+bool runServerMode(const std::string &host, int port) {
+  // Every session shares the store and plan cache; at least a few
+  // workers, so one client that stops reading cannot stall the rest
+  globalDataStore.fixTables();
+  size_t workers = std::max<size_t>(globalPool->size(), 4);
+  Server server(host, port, workers,
+                [](const std::string &sql, ReplyWriter &reply) {
+                  QueryOutcome outcome = compileAndExecute(
+                      sql, [&](const QueryResult &result) {
+                        reply.writeRows(result);
+                      });
+                  reply.finish(outcome.success, outcome.rows, outcome.error);
+                });
+
+  std::string error;
+  if (!server.run(error)) {
+    std::cerr << "Error: Could not serve: " << error << "\n";
+    return false;
+  }
+  return true;
+}
+
+// ============================================================================
+// COMMIT - Make logged changes durable at statement boundaries
+// ============================================================================
+void commitChanges() {
+  if (!globalLog)
+    return;
+  if (!globalLog->commit(waitForCommit))
+    std::cerr << "Warning: write-ahead log sync failed; recent changes may "
+                 "not survive a crash\n";
+
+  // Server sessions commit concurrently; one of them starts a checkpoint
+  static std::mutex checkpointMutex;
+  std::lock_guard<std::mutex> lock(checkpointMutex);
+  globalLog->maybeCheckpoint(globalDataStore);
+}
+
+// ============================================================================
+// BATCH SUMMARY - Per-statement timing and row counts (written to stderr)
+// ============================================================================
+void printBatchSummary(const std::vector<QueryOutcome> &outcomes,
+                       double totalMicros) {
+  struct Totals {
+    size_t count = 0, failed = 0, rows = 0;
+    double micros = 0, maxMicros = 0;
+  };
+  std::vector<std::pair<std::string, Totals>> byStatement;
+  Totals all;
+  size_t slowest = 0;
+
+  for (size_t i = 0; i < outcomes.size(); i++) {
+    const QueryOutcome &q = outcomes[i];
+    auto it = std::find_if(byStatement.begin(), byStatement.end(),
+                           [&](const auto &p) { return p.first == q.statement; });
+    if (it == byStatement.end()) {
+      byStatement.emplace_back(q.statement, Totals());
+      it = byStatement.end() - 1;
+    }
+    for (Totals *t : {&it->second, &all}) {
+      t->count++;
+      t->failed += q.success ? 0 : 1;
+      t->rows += q.rows;
+      t->micros += q.micros;
+      t->maxMicros = std::max(t->maxMicros, q.micros);
+    }
+    if (q.micros > outcomes[slowest].micros)
+      slowest = i;
+  }
+
+  std::fprintf(stderr, "\n--- Batch Summary ---\n");
+  std::fprintf(stderr, "%-14s %8s %8s %10s %12s %10s %10s\n", "Statement",
+               "Queries", "Failed", "Rows", "Total ms", "Avg us", "Max us");
+  auto printRow = [](const std::string &name, const Totals &t) {
+    std::fprintf(stderr, "%-14s %8zu %8zu %10zu %12.3f %10.1f %10.1f\n",
+                 name.c_str(), t.count, t.failed, t.rows, t.micros / 1000.0,
+                 t.count ? t.micros / t.count : 0.0, t.maxMicros);
+  };
+  for (const auto &p : byStatement)
+    printRow(p.first, p.second);
+  printRow("TOTAL", all);
+
+  std::fprintf(stderr, "Wall time: %.3f ms", totalMicros / 1000.0);
+  if (!outcomes.empty()) {
+    std::fprintf(stderr, " (slowest: query #%zu, %.1f us)", slowest + 1,
+                 outcomes[slowest].micros);
+  }
+  std::fprintf(stderr, "\n");
 }
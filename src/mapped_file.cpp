@@ -0,0 +1,43 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: mapped_file.cpp
+ * Description: Read-Only Memory-Mapped File Implementation
+ */
+
+#include "../include/mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace MiniSQL {
+
+MappedFile::MappedFile(const std::string &path)
+    : fd(-1), bytes(nullptr), length(0) {
+  fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+    return;
+
+  size_t size = static_cast<size_t>(info.st_size);
+  void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    return;
+  // Loaders read the file front to back
+  ::madvise(map, size, MADV_SEQUENTIAL);
+  bytes = static_cast<const char *>(map);
+  length = size;
+}
+
+MappedFile::~MappedFile() {
+  if (bytes)
+    ::munmap(const_cast<char *>(bytes), length);
+  if (fd >= 0)
+    ::close(fd);
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,204 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: memory_tracker.cpp
+ * Description: Per-Query Memory Accounting Implementation
+ */
+
+#include "../include/memory_tracker.h"
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <list>
+#include <mutex>
+#include <sstream>
+
+namespace MiniSQL {
+
+namespace {
+
+thread_local QueryMemory *activeMemory = nullptr;
+
+std::atomic<size_t> queryLimit{0};
+std::atomic<size_t> globalLimit{0};
+std::atomic<size_t> globalUsed{0}; // Held by all live statements
+std::atomic<uint64_t> nextQueryId{1};
+
+// Live statements, oldest first
+std::mutex liveMutex;
+std::list<QueryMemory *> live;
+
+size_t load(const std::atomic<size_t> &value) {
+  return value.load(std::memory_order_relaxed);
+}
+
+// Bytes left under a limit (SIZE_MAX without one)
+size_t left(size_t limit, size_t used) {
+  if (limit == 0)
+    return SIZE_MAX;
+  return used < limit ? limit - used : 0;
+}
+
+std::string describeLimit(size_t limit) {
+  return limit ? formatBytes(limit) : "none";
+}
+
+} // namespace
+
+size_t stringHeapBytes(const std::string &text) {
+  // Short strings keep their characters inside the object
+  const char *inside = reinterpret_cast<const char *>(&text);
+  if (text.data() >= inside && text.data() < inside + sizeof(text))
+    return 0;
+  return text.capacity() + 1;
+}
+
+void setMemoryLimits(size_t perQuery, size_t global) {
+  queryLimit.store(perQuery, std::memory_order_relaxed);
+  globalLimit.store(global, std::memory_order_relaxed);
+}
+
+size_t getQueryMemoryLimit() { return load(queryLimit); }
+size_t getGlobalMemoryLimit() { return load(globalLimit); }
+
+// ============================================================================
+// QUERY ACCOUNT
+// ============================================================================
+QueryMemory::QueryMemory(uint64_t queryId, std::string text)
+    : id(queryId), query(std::move(text)), used(0), peak(0) {}
+
+bool QueryMemory::reserve(size_t bytes) {
+  size_t before = used.fetch_add(bytes, std::memory_order_relaxed);
+  size_t limit = load(queryLimit);
+  if (limit && before + bytes > limit) {
+    used.fetch_sub(bytes, std::memory_order_relaxed);
+    return false;
+  }
+  size_t all = globalUsed.fetch_add(bytes, std::memory_order_relaxed);
+  limit = load(globalLimit);
+  if (limit && all + bytes > limit) {
+    globalUsed.fetch_sub(bytes, std::memory_order_relaxed);
+    used.fetch_sub(bytes, std::memory_order_relaxed);
+    return false;
+  }
+
+  size_t now = before + bytes;
+  size_t highest = load(peak);
+  while (now > highest &&
+         !peak.compare_exchange_weak(highest, now, std::memory_order_relaxed)) {
+  }
+  return true;
+}
+
+void QueryMemory::charge(size_t bytes) {
+  size_t now = used.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  globalUsed.fetch_add(bytes, std::memory_order_relaxed);
+  size_t highest = load(peak);
+  while (now > highest &&
+         !peak.compare_exchange_weak(highest, now, std::memory_order_relaxed)) {
+  }
+}
+
+void QueryMemory::release(size_t bytes) {
+  used.fetch_sub(bytes, std::memory_order_relaxed);
+  globalUsed.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+size_t QueryMemory::available() const {
+  return std::min(left(load(queryLimit), load(used)),
+                  left(load(globalLimit), load(globalUsed)));
+}
+
+QueryMemory *currentMemory() { return activeMemory; }
+
+MemoryScope::MemoryScope(const std::string &query)
+    : account(nextQueryId.fetch_add(1, std::memory_order_relaxed), query),
+      previous(activeMemory) {
+  activeMemory = &account;
+  std::lock_guard<std::mutex> lock(liveMutex);
+  live.push_back(&account);
+}
+
+MemoryScope::~MemoryScope() {
+  activeMemory = previous;
+  {
+    std::lock_guard<std::mutex> lock(liveMutex);
+    live.remove(&account);
+  }
+  account.release(account.getUsed());
+}
+
+MemoryAccountScope::MemoryAccountScope(QueryMemory *account)
+    : previous(activeMemory) {
+  activeMemory = account;
+}
+
+MemoryAccountScope::~MemoryAccountScope() { activeMemory = previous; }
+
+bool MemoryReservation::resize(size_t total) {
+  if (account) {
+    if (total > bytes && !account->reserve(total - bytes))
+      return false;
+    if (total < bytes)
+      account->release(bytes - total);
+  }
+  bytes = total;
+  return true;
+}
+
+// ============================================================================
+// CURRENT STATEMENT
+// ============================================================================
+bool reserveMemory(size_t bytes, const std::string &what, std::string &error) {
+  if (!activeMemory || activeMemory->reserve(bytes))
+    return true;
+  error = memoryLimitError(what, bytes);
+  return false;
+}
+
+void chargeMemory(size_t bytes) {
+  if (activeMemory)
+    activeMemory->charge(bytes);
+}
+
+size_t availableMemory() {
+  return activeMemory ? activeMemory->available() : SIZE_MAX;
+}
+
+std::string memoryLimitError(const std::string &what, size_t bytes) {
+  return "memory limit exceeded: " + formatBytes(bytes) + " needed for " +
+         what + " (limit per query: " + describeLimit(load(queryLimit)) +
+         ", for all queries: " + describeLimit(load(globalLimit)) + ")";
+}
+
+// ============================================================================
+// LIVE STATEMENTS
+// ============================================================================
+std::vector<LiveQuery> liveQueries() {
+  std::lock_guard<std::mutex> lock(liveMutex);
+  std::vector<LiveQuery> queries;
+  for (const QueryMemory *account : live) {
+    queries.push_back(LiveQuery{account->getId(), account->getQuery(),
+                                account->getUsed(), account->getPeak()});
+  }
+  return queries;
+}
+
+size_t globalQueryMemory() { return load(globalUsed); }
+
+std::string formatBytes(size_t bytes) {
+  if (bytes < 1024)
+    return std::to_string(bytes) + " B";
+  static const char *units[] = {"KiB", "MiB", "GiB", "TiB"};
+  double value = bytes / 1024.0;
+  size_t unit = 0;
+  while (value >= 1024 && unit + 1 < 4) {
+    value /= 1024;
+    unit++;
+  }
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(1) << value << " " << units[unit];
+  return text.str();
+}
+
+} // namespace MiniSQL
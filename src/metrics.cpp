@@ -0,0 +1,237 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: metrics.cpp
+ * Description: Per-Statement Instrumentation Implementation
+ */
+
+#include "../include/metrics.h"
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+
+namespace MiniSQL {
+
+namespace {
+
+thread_local QueryMetrics *activeMetrics = nullptr;
+
+// Totals of all finished statements
+struct MetricsTotals {
+  std::atomic<uint64_t> statements{0};
+  std::atomic<uint64_t> cachedPlans{0};
+  std::atomic<uint64_t> phaseNanos[PHASE_COUNT] = {};
+  std::atomic<uint64_t> rowsScanned{0};
+  std::atomic<uint64_t> rowsMatched{0};
+  std::atomic<uint64_t> rowsEmitted{0};
+  std::atomic<uint64_t> bytesAllocated{0};
+  std::atomic<uint64_t> allRowReads{0};
+  std::atomic<uint64_t> fullScans{0};
+  std::atomic<uint64_t> indexLookups{0};
+};
+
+MetricsTotals totals;
+
+void addTotal(std::atomic<uint64_t> &total, uint64_t value) {
+  total.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t readTotal(const std::atomic<uint64_t> &total) {
+  return total.load(std::memory_order_relaxed);
+}
+
+void publish(const QueryMetrics &m) {
+  addTotal(totals.statements, 1);
+  if (m.planCached)
+    addTotal(totals.cachedPlans, 1);
+  for (size_t p = 0; p < PHASE_COUNT; p++)
+    addTotal(totals.phaseNanos[p], m.phaseNanos[p]);
+  addTotal(totals.rowsScanned, m.rowsScanned);
+  addTotal(totals.rowsMatched, m.rowsMatched);
+  addTotal(totals.rowsEmitted, m.rowsEmitted);
+  addTotal(totals.bytesAllocated, m.bytesAllocated);
+  switch (m.access) {
+  case AccessPath::ALL_ROWS:
+    addTotal(totals.allRowReads, 1);
+    break;
+  case AccessPath::FULL_SCAN:
+  case AccessPath::PARALLEL_SCAN:
+    addTotal(totals.fullScans, 1);
+    break;
+  case AccessPath::INDEX:
+    addTotal(totals.indexLookups, 1);
+    break;
+  case AccessPath::NONE:
+    break;
+  }
+}
+
+} // namespace
+
+std::string phaseToString(Phase phase) {
+  switch (phase) {
+  case Phase::LEX:
+    return "Lexical analysis";
+  case Phase::PARSE:
+    return "Syntax analysis";
+  case Phase::SEMANTIC:
+    return "Semantic analysis";
+  case Phase::EXECUTE:
+    return "Execution";
+  }
+  return "Unknown";
+}
+
+// ============================================================================
+// QUERY METRICS
+// ============================================================================
+void QueryMetrics::clear() {
+  for (auto &nanos : phaseNanos)
+    nanos = 0;
+  planCached = false;
+  rowsScanned = 0;
+  rowsMatched = 0;
+  rowsEmitted = 0;
+  bytesAllocated = 0;
+  access = AccessPath::NONE;
+  indexName.clear();
+}
+
+uint64_t QueryMetrics::totalNanos() const {
+  uint64_t total = 0;
+  for (uint64_t nanos : phaseNanos)
+    total += nanos;
+  return total;
+}
+
+std::string QueryMetrics::accessDescription() const {
+  switch (access) {
+  case AccessPath::NONE:
+    return "none";
+  case AccessPath::ALL_ROWS:
+    return "all rows (no WHERE)";
+  case AccessPath::FULL_SCAN:
+    return "full table scan";
+  case AccessPath::PARALLEL_SCAN:
+    return "parallel full table scan";
+  case AccessPath::INDEX:
+    return "index lookup using '" + indexName + "'";
+  }
+  return "unknown";
+}
+
+void QueryMetrics::add(const QueryMetrics &other) {
+  for (size_t p = 0; p < PHASE_COUNT; p++)
+    phaseNanos[p] += other.phaseNanos[p];
+  planCached = planCached || other.planCached;
+  rowsScanned += other.rowsScanned;
+  rowsMatched += other.rowsMatched;
+  rowsEmitted += other.rowsEmitted;
+  bytesAllocated += other.bytesAllocated;
+  if (other.access != AccessPath::NONE) {
+    access = other.access;
+    indexName = other.indexName;
+  }
+}
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+QueryMetrics *currentMetrics() { return activeMetrics; }
+
+MetricsScope::MetricsScope() : previous(activeMetrics) {
+  activeMetrics = &metrics;
+}
+
+MetricsScope::~MetricsScope() {
+  activeMetrics = previous;
+  if (previous)
+    previous->add(metrics);
+  else
+    publish(metrics);
+}
+
+MetricsCapture::MetricsCapture(QueryMetrics &into) : previous(activeMetrics) {
+  activeMetrics = &into;
+}
+
+MetricsCapture::~MetricsCapture() { activeMetrics = previous; }
+
+PhaseTimer::~PhaseTimer() {
+  if (!activeMetrics)
+    return;
+  activeMetrics->phaseNanos[static_cast<size_t>(phase)] +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+}
+
+void recordScan(uint64_t scanned, uint64_t matched, uint64_t bytes) {
+  if (!activeMetrics)
+    return;
+  activeMetrics->rowsScanned += scanned;
+  activeMetrics->rowsMatched += matched;
+  activeMetrics->bytesAllocated += bytes;
+}
+
+void recordAccess(AccessPath access, const std::string &indexName) {
+  if (!activeMetrics)
+    return;
+  activeMetrics->access = access;
+  activeMetrics->indexName = indexName;
+}
+
+void recordEmitted(uint64_t rows) {
+  if (activeMetrics)
+    activeMetrics->rowsEmitted += rows;
+}
+
+void recordBytes(uint64_t bytes) {
+  if (activeMetrics)
+    activeMetrics->bytesAllocated += bytes;
+}
+
+// ============================================================================
+// METRICS DUMP
+// ============================================================================
+void printMetrics() {
+  uint64_t statements = readTotal(totals.statements);
+
+  std::cout << "\n--- Metrics ---\n";
+  std::cout << "Statements        : " << statements << " ("
+            << readTotal(totals.cachedPlans) << " from cached plans)\n";
+
+  std::cout << std::fixed << std::setprecision(3);
+  for (size_t p = 0; p < PHASE_COUNT; p++) {
+    double ms = readTotal(totals.phaseNanos[p]) / 1e6;
+    std::cout << std::left << std::setw(18)
+              << phaseToString(static_cast<Phase>(p)) << ": " << ms << " ms";
+    if (statements > 0)
+      std::cout << " (avg " << ms * 1000 / statements << " us)";
+    std::cout << "\n";
+  }
+  std::cout.unsetf(std::ios::floatfield);
+  std::cout << std::setprecision(6);
+
+  std::cout << "Rows scanned      : " << readTotal(totals.rowsScanned) << "\n";
+  std::cout << "Rows matched      : " << readTotal(totals.rowsMatched) << "\n";
+  std::cout << "Rows emitted      : " << readTotal(totals.rowsEmitted) << "\n";
+  std::cout << "Bytes allocated   : " << readTotal(totals.bytesAllocated)
+            << "\n";
+  std::cout << "Index lookups     : " << readTotal(totals.indexLookups)
+            << "\n";
+  std::cout << "Full table scans  : " << readTotal(totals.fullScans) << "\n";
+  std::cout << "All-row reads     : " << readTotal(totals.allRowReads) << "\n";
+}
+
+void resetMetrics() {
+  for (auto *total :
+       {&totals.statements, &totals.cachedPlans, &totals.rowsScanned,
+        &totals.rowsMatched, &totals.rowsEmitted, &totals.bytesAllocated,
+        &totals.allRowReads, &totals.fullScans, &totals.indexLookups})
+    total->store(0, std::memory_order_relaxed);
+  for (auto &nanos : totals.phaseNanos)
+    nanos.store(0, std::memory_order_relaxed);
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,28 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: output.cpp
+ * Description: Diagnostic Output Stream Implementation
+ */
+
+#include "../include/output.h"
+#include <iostream>
+
+namespace MiniSQL {
+
+namespace {
+
+// A stream without a buffer is always in a failed state, so every
+// insertion returns immediately without formatting anything
+std::ostream nullStream(nullptr);
+bool enabled = true;
+
+} // namespace
+
+std::ostream &diag() { return enabled ? std::cout : nullStream; }
+
+void setDiagnostics(bool on) { enabled = on; }
+
+bool diagnosticsEnabled() { return enabled; }
+
+} // namespace MiniSQL
@@ -0,0 +1,44 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: parse_arena.cpp
+ * Description: Per-Query Bump Allocator Implementation
+ */
+
+#include "../include/parse_arena.h"
+#include <algorithm>
+#include <cstring>
+
+namespace MiniSQL {
+
+ParseArena::ParseArena()
+    : cursor(inlineBlock), limit(inlineBlock + INLINE_BYTES),
+      nextBlockBytes(MIN_BLOCK_BYTES), bytesUsed(0) {}
+
+// Current block exhausted: continue in a new, larger block
+void *ParseArena::allocateSlow(size_t size, size_t align) {
+  size_t blockBytes = std::max(nextBlockBytes, size + align);
+  blocks.emplace_back(new char[blockBytes]);
+  nextBlockBytes = blockBytes * 2;
+  cursor = blocks.back().get();
+  limit = cursor + blockBytes;
+  return allocate(size, align);
+}
+
+std::string_view ParseArena::copy(std::string_view text) {
+  if (text.empty())
+    return {};
+  char *bytes = static_cast<char *>(allocate(text.size(), 1));
+  std::memcpy(bytes, text.data(), text.size());
+  return std::string_view(bytes, text.size());
+}
+
+void ParseArena::reset() {
+  blocks.clear();
+  cursor = inlineBlock;
+  limit = inlineBlock + INLINE_BYTES;
+  nextBlockBytes = MIN_BLOCK_BYTES;
+  bytesUsed = 0;
+}
+
+} // namespace MiniSQL
@@ -29,29 +29,32 @@
  */
 
 #include "../include/parser.h"
+#include "../include/output.h"
+#include <cctype>
 #include <iostream>
 
 namespace MiniSQL {
 
 // Constructor
-Parser::Parser(const std::vector<Token> &tokens) : tokens(tokens), current(0) {}
+Parser::Parser(const std::vector<Token> &tokens, ParseArena &arena)
+    : tokens(tokens), arena(arena), current(0), literalCount(0) {}
 
 // ============================================================================
 // MAIN PARSING METHOD
 // ============================================================================
 ParseTree Parser::parse() {
-  std::cout << "\n========================================\n";
-  std::cout << "   PHASE 2: SYNTAX ANALYSIS\n";
-  std::cout << "========================================\n";
+  diag() << "\n========================================\n";
+  diag() << "   PHASE 2: SYNTAX ANALYSIS\n";
+  diag() << "========================================\n";
 
   ParseTree tree = parseQuery();
 
   if (errors.empty() && tree != nullptr) {
-    std::cout << "Syntax Analysis: SUCCESS\n";
-    std::cout << "Parse Tree constructed successfully.\n";
+    diag() << "Syntax Analysis: SUCCESS\n";
+    diag() << "Parse Tree constructed successfully.\n";
   } else {
-    std::cout << "Syntax Analysis: FAILED with " << errors.size()
-              << " error(s)\n";
+    diag() << "Syntax Analysis: FAILED with " << errors.size()
+           << " error(s)\n";
   }
 
   return tree;
@@ -59,20 +62,40 @@ ParseTree Parser::parse() {
 
 // ============================================================================
 // GRAMMAR RULE: <query> ::= SELECT <column_list> FROM <table_name>
-// [<where_clause>] ;
+// [<where_clause>] [<group_by>] [<order_by>] [LIMIT NUMBER] ;
 // ============================================================================
 ParseTree Parser::parseQuery() {
   // Dispatch based on first keyword
-  if (check(TokenType::KEYWORD_INSERT)) {
+  if (check(TokenType::KEYWORD_EXPLAIN)) {
+    return parseExplain();
+  } else if (check(TokenType::KEYWORD_INSERT)) {
     return parseInsert();
+  } else if (check(TokenType::KEYWORD_COPY)) {
+    return parseCopy();
   } else if (check(TokenType::KEYWORD_UPDATE)) {
     return parseUpdate();
   } else if (check(TokenType::KEYWORD_DELETE)) {
     return parseDelete();
+  } else if (check(TokenType::KEYWORD_CREATE)) {
+    return parseCreateIndex();
+  }
+
+  // ANALYZE, SHOW and ALTER are only keywords here, so they stay usable
+  // as names elsewhere
+  if (check(TokenType::IDENTIFIER)) {
+    std::string word(peek().value);
+    for (auto &ch : word)
+      ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    if (word == "ANALYZE")
+      return parseAnalyze();
+    if (word == "SHOW")
+      return parseShow();
+    if (word == "ALTER")
+      return parsePartition();
   }
 
   // Default: SELECT query
-  auto queryNode = std::make_shared<ParseTreeNode>(NodeType::QUERY);
+  auto queryNode = makeNode(NodeType::QUERY);
 
   // Parse SELECT clause
   auto selectClause = parseSelectClause();
@@ -100,6 +123,36 @@ ParseTree Parser::parseQuery() {
     }
   }
 
+  // Parse optional GROUP BY clause
+  if (check(TokenType::KEYWORD_GROUP)) {
+    auto groupBy = parseGroupBy();
+    if (groupBy) {
+      queryNode->addChild(groupBy);
+    } else {
+      return nullptr;
+    }
+  }
+
+  // Parse optional ORDER BY clause
+  if (check(TokenType::KEYWORD_ORDER)) {
+    auto orderBy = parseOrderBy();
+    if (orderBy) {
+      queryNode->addChild(orderBy);
+    } else {
+      return nullptr;
+    }
+  }
+
+  // Parse optional LIMIT clause
+  if (check(TokenType::KEYWORD_LIMIT)) {
+    auto limit = parseLimit();
+    if (limit) {
+      queryNode->addChild(limit);
+    } else {
+      return nullptr;
+    }
+  }
+
   // Expect semicolon at the end
   consume(TokenType::OP_SEMICOLON, "Expected ';' at end of query");
 
@@ -116,8 +169,7 @@ ParseTree Parser::parseSelectClause() {
     return nullptr;
   }
 
-  auto selectNode =
-      std::make_shared<ParseTreeNode>(NodeType::SELECT_CLAUSE, "SELECT");
+  auto selectNode = makeNode(NodeType::SELECT_CLAUSE, "SELECT");
 
   // Parse column list
   auto columnList = parseColumnList();
@@ -131,14 +183,14 @@ ParseTree Parser::parseSelectClause() {
 }
 
 // ============================================================================
-// GRAMMAR RULE: <column_list> ::= * | <column_name> { , <column_name> }*
+// GRAMMAR RULE: <column_list> ::= * | <select_item> { , <select_item> }*
 // ============================================================================
 ParseTree Parser::parseColumnList() {
-  auto columnListNode = std::make_shared<ParseTreeNode>(NodeType::COLUMN_LIST);
+  auto columnListNode = makeNode(NodeType::COLUMN_LIST);
 
   // Check for SELECT *
   if (match(TokenType::OP_STAR)) {
-    auto starColumn = std::make_shared<ParseTreeNode>(NodeType::COLUMN, "*");
+    auto starColumn = makeNode(NodeType::COLUMN, "*");
     columnListNode->addChild(starColumn);
     return columnListNode;
   }
@@ -150,9 +202,10 @@ ParseTree Parser::parseColumnList() {
   }
 
   // Add first column
-  Token colToken = advance();
-  auto column =
-      std::make_shared<ParseTreeNode>(NodeType::COLUMN, colToken.value);
+  auto column = parseSelectItem();
+  if (!column) {
+    return nullptr;
+  }
   columnListNode->addChild(column);
 
   // Parse additional columns separated by commas
@@ -161,9 +214,10 @@ ParseTree Parser::parseColumnList() {
       error("Expected column name after ','");
       return nullptr;
     }
-    Token nextCol = advance();
-    auto nextColumn =
-        std::make_shared<ParseTreeNode>(NodeType::COLUMN, nextCol.value);
+    auto nextColumn = parseSelectItem();
+    if (!nextColumn) {
+      return nullptr;
+    }
     columnListNode->addChild(nextColumn);
   }
 
@@ -171,7 +225,41 @@ ParseTree Parser::parseColumnList() {
 }
 
 // ============================================================================
-// GRAMMAR RULE: FROM <table_name>
+// GRAMMAR RULE: <select_item> ::= <column_name>
+//                               | <function> ( <column_name> | * )
+// ============================================================================
+ParseTree Parser::parseSelectItem() {
+  const Token &nameToken = advance();
+  if (!check(TokenType::OP_LPAREN)) {
+    return makeNode(NodeType::COLUMN, nameToken.value);
+  }
+
+  // Function names are only recognized before '(', so they stay usable
+  // as column names; semantic analysis checks the name
+  std::string function(nameToken.value);
+  for (auto &ch : function)
+    ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+  auto aggregate = makeNode(NodeType::AGGREGATE, function);
+  advance(); // (
+
+  if (match(TokenType::OP_STAR)) {
+    aggregate->addChild(makeNode(NodeType::COLUMN, "*"));
+  } else if (check(TokenType::IDENTIFIER)) {
+    aggregate->addChild(makeNode(NodeType::COLUMN, advance().value));
+  } else {
+    error("Expected column name or '*' after '" + function + "('");
+    return nullptr;
+  }
+
+  if (!consume(TokenType::OP_RPAREN, "Expected ')' after function argument")) {
+    return nullptr;
+  }
+  return aggregate;
+}
+
+// ============================================================================
+// GRAMMAR RULE: FROM <table_name> { , <table_name>
+//                                 | JOIN <table_name> ON <or_expr> }
 // ============================================================================
 ParseTree Parser::parseFromClause() {
   if (!match(TokenType::KEYWORD_FROM)) {
@@ -179,34 +267,60 @@ ParseTree Parser::parseFromClause() {
     return nullptr;
   }
 
-  auto fromNode =
-      std::make_shared<ParseTreeNode>(NodeType::FROM_CLAUSE, "FROM");
+  auto fromNode = makeNode(NodeType::FROM_CLAUSE, "FROM");
 
   if (!check(TokenType::IDENTIFIER)) {
     error("Expected table name after 'FROM'");
     return nullptr;
   }
 
-  Token tableToken = advance();
-  auto tableName =
-      std::make_shared<ParseTreeNode>(NodeType::TABLE_NAME, tableToken.value);
+  const Token &tableToken = advance();
+  auto tableName = makeNode(NodeType::TABLE_NAME, tableToken.value);
   fromNode->addChild(tableName);
 
+  // Further tables: listed after ',' (joined by the WHERE conditions) or
+  // joined with their own ON condition
+  while (check(TokenType::OP_COMMA) || check(TokenType::KEYWORD_JOIN)) {
+    bool join = advance().type == TokenType::KEYWORD_JOIN;
+    if (!check(TokenType::IDENTIFIER)) {
+      error(join ? "Expected table name after 'JOIN'"
+                 : "Expected table name after ','");
+      return nullptr;
+    }
+    auto table = makeNode(NodeType::TABLE_NAME, advance().value);
+    if (!join) {
+      fromNode->addChild(table);
+      continue;
+    }
+
+    auto joinNode = makeNode(NodeType::JOIN_CLAUSE, "JOIN");
+    joinNode->addChild(table);
+    if (!match(TokenType::KEYWORD_ON)) {
+      error("Expected 'ON' after joined table name");
+      return nullptr;
+    }
+    auto condition = parseOrExpr();
+    if (!condition) {
+      return nullptr;
+    }
+    joinNode->addChild(condition);
+    fromNode->addChild(joinNode);
+  }
+
   return fromNode;
 }
 
 // ============================================================================
-// GRAMMAR RULE: WHERE <condition>
+// GRAMMAR RULE: WHERE <or_expr>
 // ============================================================================
 ParseTree Parser::parseWhereClause() {
   if (!match(TokenType::KEYWORD_WHERE)) {
     return nullptr;
   }
 
-  auto whereNode =
-      std::make_shared<ParseTreeNode>(NodeType::WHERE_CLAUSE, "WHERE");
+  auto whereNode = makeNode(NodeType::WHERE_CLAUSE, "WHERE");
 
-  auto condition = parseCondition();
+  auto condition = parseOrExpr();
   if (condition) {
     whereNode->addChild(condition);
   } else {
@@ -216,20 +330,166 @@ ParseTree Parser::parseWhereClause() {
   return whereNode;
 }
 
+// ============================================================================
+// GRAMMAR RULE: GROUP BY <column_name> { , <column_name> }
+// ============================================================================
+ParseTree Parser::parseGroupBy() {
+  if (!match(TokenType::KEYWORD_GROUP)) {
+    return nullptr;
+  }
+  if (!match(TokenType::KEYWORD_BY)) {
+    error("Expected 'BY' after 'GROUP'");
+    return nullptr;
+  }
+
+  auto groupNode = makeNode(NodeType::GROUP_BY_CLAUSE, "GROUP BY");
+  do {
+    if (!check(TokenType::IDENTIFIER)) {
+      error("Expected column name in GROUP BY");
+      return nullptr;
+    }
+    groupNode->addChild(makeNode(NodeType::COLUMN, advance().value));
+  } while (match(TokenType::OP_COMMA));
+
+  return groupNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: ORDER BY <sort_key> { , <sort_key> }
+//               <sort_key> ::= <select_item> [ASC | DESC]
+// ============================================================================
+ParseTree Parser::parseOrderBy() {
+  if (!match(TokenType::KEYWORD_ORDER)) {
+    return nullptr;
+  }
+  if (!match(TokenType::KEYWORD_BY)) {
+    error("Expected 'BY' after 'ORDER'");
+    return nullptr;
+  }
+
+  auto orderNode = makeNode(NodeType::ORDER_BY_CLAUSE, "ORDER BY");
+  do {
+    if (!check(TokenType::IDENTIFIER)) {
+      error("Expected column name in ORDER BY");
+      return nullptr;
+    }
+    auto item = parseSelectItem();
+    if (!item) {
+      return nullptr;
+    }
+
+    // ASC and DESC are only keywords here, so they stay usable as names
+    std::string direction = "ASC";
+    if (check(TokenType::IDENTIFIER)) {
+      std::string word(peek().value);
+      for (auto &ch : word)
+        ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+      if (word == "ASC" || word == "DESC") {
+        direction = word;
+        advance();
+      }
+    }
+    auto key = makeNode(NodeType::SORT_KEY, direction);
+    key->addChild(item);
+    orderNode->addChild(key);
+  } while (match(TokenType::OP_COMMA));
+
+  return orderNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: LIMIT NUMBER
+// ============================================================================
+ParseTree Parser::parseLimit() {
+  if (!match(TokenType::KEYWORD_LIMIT)) {
+    return nullptr;
+  }
+  if (!check(TokenType::NUMBER)) {
+    error("Expected row count after 'LIMIT'");
+    return nullptr;
+  }
+
+  auto limitNode = makeNode(NodeType::LIMIT_CLAUSE, "LIMIT");
+  limitNode->addChild(makeValueNode(advance()));
+  return limitNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: <or_expr> ::= <and_expr> { OR <and_expr> }
+// ============================================================================
+ParseTree Parser::parseOrExpr() {
+  auto first = parseAndExpr();
+  if (!first || !check(TokenType::KEYWORD_OR)) {
+    return first;
+  }
+
+  auto orNode = makeNode(NodeType::OR_EXPR, "OR");
+  orNode->addChild(first);
+  while (match(TokenType::KEYWORD_OR)) {
+    auto operand = parseAndExpr();
+    if (!operand) {
+      return nullptr;
+    }
+    orNode->addChild(operand);
+  }
+
+  return orNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: <and_expr> ::= <primary> { AND <primary> }
+// ============================================================================
+ParseTree Parser::parseAndExpr() {
+  auto first = parsePrimaryCondition();
+  if (!first || !check(TokenType::KEYWORD_AND)) {
+    return first;
+  }
+
+  auto andNode = makeNode(NodeType::AND_EXPR, "AND");
+  andNode->addChild(first);
+  while (match(TokenType::KEYWORD_AND)) {
+    auto operand = parsePrimaryCondition();
+    if (!operand) {
+      return nullptr;
+    }
+    andNode->addChild(operand);
+  }
+
+  return andNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: <primary> ::= ( <or_expr> ) | <condition>
+// ============================================================================
+ParseTree Parser::parsePrimaryCondition() {
+  if (!match(TokenType::OP_LPAREN)) {
+    return parseCondition();
+  }
+
+  auto inner = parseOrExpr();
+  if (!inner) {
+    return nullptr;
+  }
+  if (!consume(TokenType::OP_RPAREN, "Expected ')' after condition")) {
+    return nullptr;
+  }
+
+  return inner;
+}
+
 // ============================================================================
 // GRAMMAR RULE: <condition> ::= <column_name> <rel_op> <value>
 // ============================================================================
 ParseTree Parser::parseCondition() {
-  auto conditionNode = std::make_shared<ParseTreeNode>(NodeType::CONDITION);
+  auto conditionNode = makeNode(NodeType::CONDITION);
 
   // Left operand: column name
   if (!check(TokenType::IDENTIFIER)) {
     error("Expected column name in WHERE condition");
     return nullptr;
   }
-  Token colToken = advance();
-  auto column =
-      std::make_shared<ParseTreeNode>(NodeType::COLUMN, colToken.value);
+  const Token &colToken = advance();
+  auto column = makeNode(NodeType::COLUMN, colToken.value);
   conditionNode->addChild(column);
 
   // Relational operator
@@ -240,9 +500,8 @@ ParseTree Parser::parseCondition() {
     error("Expected relational operator (=, !=, <, <=, >, >=) in condition");
     return nullptr;
   }
-  Token opToken = advance();
-  auto opNode =
-      std::make_shared<ParseTreeNode>(NodeType::OPERATOR, opToken.value);
+  const Token &opToken = advance();
+  auto opNode = makeNode(NodeType::OPERATOR, opToken.value);
   conditionNode->addChild(opNode);
 
   // Right operand: value (identifier, number, or string)
@@ -251,10 +510,8 @@ ParseTree Parser::parseCondition() {
     error("Expected value (identifier, number, or string) in condition");
     return nullptr;
   }
-  Token valueToken = advance();
-  auto valueNode =
-      std::make_shared<ParseTreeNode>(NodeType::VALUE, valueToken.value);
-  conditionNode->addChild(valueNode);
+  const Token &valueToken = advance();
+  conditionNode->addChild(makeValueNode(valueToken));
 
   return conditionNode;
 }
@@ -263,11 +520,11 @@ ParseTree Parser::parseCondition() {
 // TOKEN NAVIGATION HELPERS
 // ============================================================================
 
-Token Parser::peek() const { return tokens[current]; }
+const Token &Parser::peek() const { return tokens[current]; }
 
-Token Parser::previous() const { return tokens[current - 1]; }
+const Token &Parser::previous() const { return tokens[current - 1]; }
 
-Token Parser::advance() {
+const Token &Parser::advance() {
   if (!isAtEnd())
     current++;
   return previous();
@@ -289,11 +546,27 @@ bool Parser::match(TokenType type) {
   return false;
 }
 
-Token Parser::consume(TokenType type, const std::string &message) {
-  if (check(type))
-    return advance();
+bool Parser::consume(TokenType type, const std::string &message) {
+  if (match(type))
+    return true;
   error(message);
-  return Token(TokenType::UNKNOWN, "", peek().line, peek().column);
+  return false;
+}
+
+// Allocate a node in the arena, with its own copy of the token text
+ParseTree Parser::makeNode(NodeType type, std::string_view value) {
+  return arena.make<ParseTreeNode>(type, arena.copy(value));
+}
+
+// Build a VALUE node; literals are numbered in query order so a cached
+// plan can bind new values into the same slots
+ParseTree Parser::makeValueNode(const Token &token) {
+  auto node = makeNode(NodeType::VALUE, token.value);
+  if (token.type == TokenType::NUMBER ||
+      token.type == TokenType::STRING_LITERAL) {
+    node->literalIndex = literalCount++;
+  }
+  return node;
 }
 
 // ============================================================================
@@ -301,9 +574,10 @@ Token Parser::consume(TokenType type, const std::string &message) {
 // ============================================================================
 
 void Parser::error(const std::string &message) {
-  Token token = peek();
+  const Token &token = peek();
+  std::string found(token.value);
   errors.push_back(CompilerError(ErrorType::SYNTAX_ERROR,
-                                 message + " (found '" + token.value + "')",
+                                 message + " (found '" + found + "')",
                                  token.line, token.column));
 }
 
@@ -325,10 +599,11 @@ void Parser::synchronize() {
 }
 
 // ============================================================================
-// GRAMMAR RULE: INSERT INTO <table> (<columns>) VALUES (<values>);
+// GRAMMAR RULE: INSERT INTO <table> (<columns>) VALUES (<values>)
+//               {, (<values>)}* ;
 // ============================================================================
 ParseTree Parser::parseInsert() {
-  auto insertNode = std::make_shared<ParseTreeNode>(NodeType::INSERT_QUERY);
+  auto insertNode = makeNode(NodeType::INSERT_QUERY);
 
   // Consume INSERT
   if (!match(TokenType::KEYWORD_INSERT)) {
@@ -347,32 +622,29 @@ ParseTree Parser::parseInsert() {
     error("Expected table name after 'INSERT INTO'");
     return nullptr;
   }
-  Token tableToken = advance();
-  auto tableName =
-      std::make_shared<ParseTreeNode>(NodeType::TABLE_NAME, tableToken.value);
+  const Token &tableToken = advance();
+  auto tableName = makeNode(NodeType::TABLE_NAME, tableToken.value);
   insertNode->addChild(tableName);
 
   // Column list in parentheses
   consume(TokenType::OP_LPAREN, "Expected '(' after table name");
 
-  auto columnList = std::make_shared<ParseTreeNode>(NodeType::COLUMN_LIST);
+  auto columnList = makeNode(NodeType::COLUMN_LIST);
   if (!check(TokenType::IDENTIFIER)) {
     error("Expected column name in column list");
     return nullptr;
   }
 
-  Token colToken = advance();
-  columnList->addChild(
-      std::make_shared<ParseTreeNode>(NodeType::COLUMN, colToken.value));
+  const Token &colToken = advance();
+  columnList->addChild(makeNode(NodeType::COLUMN, colToken.value));
 
   while (match(TokenType::OP_COMMA)) {
     if (!check(TokenType::IDENTIFIER)) {
       error("Expected column name after ','");
       return nullptr;
     }
-    Token nextCol = advance();
-    columnList->addChild(
-        std::make_shared<ParseTreeNode>(NodeType::COLUMN, nextCol.value));
+    const Token &nextCol = advance();
+    columnList->addChild(makeNode(NodeType::COLUMN, nextCol.value));
   }
 
   consume(TokenType::OP_RPAREN, "Expected ')' after column list");
@@ -384,15 +656,20 @@ ParseTree Parser::parseInsert() {
     return nullptr;
   }
 
-  // Value list in parentheses
-  consume(TokenType::OP_LPAREN, "Expected '(' after VALUES");
-  auto valueList = parseValueList();
-  if (valueList) {
-    insertNode->addChild(valueList);
-  } else {
-    return nullptr;
-  }
-  consume(TokenType::OP_RPAREN, "Expected ')' after value list");
+  // One value list in parentheses per row
+  bool first = true;
+  do {
+    consume(TokenType::OP_LPAREN, first ? "Expected '(' after VALUES"
+                                        : "Expected '(' after ','");
+    first = false;
+    auto valueList = parseValueList();
+    if (valueList) {
+      insertNode->addChild(valueList);
+    } else {
+      return nullptr;
+    }
+    consume(TokenType::OP_RPAREN, "Expected ')' after value list");
+  } while (match(TokenType::OP_COMMA));
 
   // Semicolon
   consume(TokenType::OP_SEMICOLON, "Expected ';' at end of INSERT statement");
@@ -401,10 +678,11 @@ ParseTree Parser::parseInsert() {
 }
 
 // ============================================================================
-// GRAMMAR RULE: UPDATE <table> SET <col> = <val> WHERE <condition>;
+// GRAMMAR RULE: UPDATE <table> SET <col> = <val> {, <col> = <val>}
+//               WHERE <condition>;
 // ============================================================================
 ParseTree Parser::parseUpdate() {
-  auto updateNode = std::make_shared<ParseTreeNode>(NodeType::UPDATE_QUERY);
+  auto updateNode = makeNode(NodeType::UPDATE_QUERY);
 
   // Consume UPDATE
   if (!match(TokenType::KEYWORD_UPDATE)) {
@@ -417,9 +695,8 @@ ParseTree Parser::parseUpdate() {
     error("Expected table name after 'UPDATE'");
     return nullptr;
   }
-  Token tableToken = advance();
-  auto tableName =
-      std::make_shared<ParseTreeNode>(NodeType::TABLE_NAME, tableToken.value);
+  const Token &tableToken = advance();
+  auto tableName = makeNode(NodeType::TABLE_NAME, tableToken.value);
   updateNode->addChild(tableName);
 
   // SET keyword
@@ -428,30 +705,30 @@ ParseTree Parser::parseUpdate() {
     return nullptr;
   }
 
-  // SET clause: col = value
-  auto setClause = std::make_shared<ParseTreeNode>(NodeType::SET_CLAUSE, "SET");
-  auto assignment = std::make_shared<ParseTreeNode>(NodeType::ASSIGNMENT);
+  // SET clause: col = value {, col = value}
+  auto setClause = makeNode(NodeType::SET_CLAUSE, "SET");
+  do {
+    auto assignment = makeNode(NodeType::ASSIGNMENT);
 
-  if (!check(TokenType::IDENTIFIER)) {
-    error("Expected column name in SET clause");
-    return nullptr;
-  }
-  Token setCol = advance();
-  assignment->addChild(
-      std::make_shared<ParseTreeNode>(NodeType::COLUMN, setCol.value));
+    if (!check(TokenType::IDENTIFIER)) {
+      error("Expected column name in SET clause");
+      return nullptr;
+    }
+    const Token &setCol = advance();
+    assignment->addChild(makeNode(NodeType::COLUMN, setCol.value));
 
-  consume(TokenType::OP_EQUALS, "Expected '=' in SET clause");
+    consume(TokenType::OP_EQUALS, "Expected '=' in SET clause");
 
-  if (!check(TokenType::IDENTIFIER) && !check(TokenType::NUMBER) &&
-      !check(TokenType::STRING_LITERAL)) {
-    error("Expected value in SET clause");
-    return nullptr;
-  }
-  Token setVal = advance();
-  assignment->addChild(
-      std::make_shared<ParseTreeNode>(NodeType::VALUE, setVal.value));
+    if (!check(TokenType::IDENTIFIER) && !check(TokenType::NUMBER) &&
+        !check(TokenType::STRING_LITERAL)) {
+      error("Expected value in SET clause");
+      return nullptr;
+    }
+    const Token &setVal = advance();
+    assignment->addChild(makeValueNode(setVal));
 
-  setClause->addChild(assignment);
+    setClause->addChild(assignment);
+  } while (match(TokenType::OP_COMMA));
   updateNode->addChild(setClause);
 
   // Optional WHERE clause
@@ -474,7 +751,7 @@ ParseTree Parser::parseUpdate() {
 // GRAMMAR RULE: DELETE FROM <table> [WHERE <condition>];
 // ============================================================================
 ParseTree Parser::parseDelete() {
-  auto deleteNode = std::make_shared<ParseTreeNode>(NodeType::DELETE_QUERY);
+  auto deleteNode = makeNode(NodeType::DELETE_QUERY);
 
   // Consume DELETE
   if (!match(TokenType::KEYWORD_DELETE)) {
@@ -506,11 +783,290 @@ ParseTree Parser::parseDelete() {
   return deleteNode;
 }
 
+// ============================================================================
+// GRAMMAR RULE: CREATE INDEX [<name>] ON <table> [USING HASH|BTREE] (<col>);
+// ============================================================================
+ParseTree Parser::parseCreateIndex() {
+  auto indexNode = makeNode(NodeType::CREATE_INDEX_QUERY);
+
+  // Consume CREATE
+  if (!match(TokenType::KEYWORD_CREATE)) {
+    error("Expected 'CREATE' keyword");
+    return nullptr;
+  }
+
+  // Only indexes can be created; tables come from the built-in schema
+  if (!match(TokenType::KEYWORD_INDEX)) {
+    error("Expected 'INDEX' after 'CREATE' (only CREATE INDEX is supported)");
+    return nullptr;
+  }
+
+  // Optional index name
+  if (check(TokenType::IDENTIFIER)) {
+    const Token &nameToken = advance();
+    indexNode->addChild(makeNode(NodeType::INDEX_NAME, nameToken.value));
+  }
+
+  // ON <table>
+  if (!match(TokenType::KEYWORD_ON)) {
+    error("Expected 'ON' in CREATE INDEX statement");
+    return nullptr;
+  }
+  if (!check(TokenType::IDENTIFIER)) {
+    error("Expected table name after 'ON'");
+    return nullptr;
+  }
+  const Token &tableToken = advance();
+  indexNode->addChild(makeNode(NodeType::TABLE_NAME, tableToken.value));
+
+  // Optional USING HASH | BTREE
+  if (match(TokenType::KEYWORD_USING)) {
+    std::string method(peek().value);
+    for (auto &ch : method)
+      ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    if (!check(TokenType::IDENTIFIER) ||
+        (method != "HASH" && method != "BTREE")) {
+      error("Expected index method HASH or BTREE after 'USING'");
+      return nullptr;
+    }
+    advance();
+    indexNode->addChild(makeNode(NodeType::INDEX_METHOD, method));
+  }
+
+  // ( <column> )
+  consume(TokenType::OP_LPAREN, "Expected '(' before indexed column");
+  if (!check(TokenType::IDENTIFIER)) {
+    error("Expected column name in CREATE INDEX statement");
+    return nullptr;
+  }
+  const Token &colToken = advance();
+  indexNode->addChild(makeNode(NodeType::COLUMN, colToken.value));
+  consume(TokenType::OP_RPAREN, "Expected ')' after indexed column");
+
+  // Semicolon
+  consume(TokenType::OP_SEMICOLON,
+          "Expected ';' at end of CREATE INDEX statement");
+
+  return indexNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: COPY <table> FROM '<path>' ;
+// ============================================================================
+ParseTree Parser::parseCopy() {
+  auto copyNode = makeNode(NodeType::COPY_QUERY);
+
+  // Consume COPY
+  if (!match(TokenType::KEYWORD_COPY)) {
+    error("Expected 'COPY' keyword");
+    return nullptr;
+  }
+
+  // Table name
+  if (!check(TokenType::IDENTIFIER)) {
+    error("Expected table name after 'COPY'");
+    return nullptr;
+  }
+  const Token &tableToken = advance();
+  copyNode->addChild(makeNode(NodeType::TABLE_NAME, tableToken.value));
+
+  // Consume FROM
+  if (!match(TokenType::KEYWORD_FROM)) {
+    error("Expected 'FROM' after table name");
+    return nullptr;
+  }
+
+  // File path
+  if (!check(TokenType::STRING_LITERAL)) {
+    error("Expected quoted file path after 'FROM'");
+    return nullptr;
+  }
+  copyNode->addChild(makeValueNode(advance()));
+
+  // Semicolon
+  consume(TokenType::OP_SEMICOLON, "Expected ';' at end of COPY statement");
+
+  return copyNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: ANALYZE <table> ;
+// ============================================================================
+ParseTree Parser::parseAnalyze() {
+  auto analyzeNode = makeNode(NodeType::ANALYZE_QUERY);
+
+  // Consume ANALYZE (an identifier, see parseQuery)
+  advance();
+
+  // Table name
+  if (!check(TokenType::IDENTIFIER)) {
+    error("Expected table name after 'ANALYZE'");
+    return nullptr;
+  }
+  const Token &tableToken = advance();
+  analyzeNode->addChild(makeNode(NodeType::TABLE_NAME, tableToken.value));
+
+  // Semicolon
+  consume(TokenType::OP_SEMICOLON,
+          "Expected ';' at end of ANALYZE statement");
+
+  return analyzeNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: SHOW MEMORY ;
+// ============================================================================
+ParseTree Parser::parseShow() {
+  // Consume SHOW (an identifier, see parseQuery)
+  advance();
+
+  // What to show: MEMORY is the only report
+  std::string what(peek().value);
+  for (auto &ch : what)
+    ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+  if (!check(TokenType::IDENTIFIER) || what != "MEMORY") {
+    error("Expected 'MEMORY' after 'SHOW'");
+    return nullptr;
+  }
+  advance();
+  auto showNode = makeNode(NodeType::SHOW_QUERY, what);
+
+  // Semicolon
+  consume(TokenType::OP_SEMICOLON, "Expected ';' at end of SHOW statement");
+
+  return showNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: ALTER TABLE <table> PARTITION BY HASH (<col>) PARTITIONS <n> ;
+//               ALTER TABLE <table> PARTITION BY RANGE (<col>) VALUES (...) ;
+// ============================================================================
+ParseTree Parser::parsePartition() {
+  // ALTER, PARTITION, PARTITIONS, HASH and RANGE are identifiers: they are
+  // only keywords here
+  auto isWord = [&](const char *word) {
+    std::string text(peek().value);
+    for (auto &ch : text)
+      ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    return check(TokenType::IDENTIFIER) && text == word;
+  };
+
+  // Consume ALTER (see parseQuery)
+  advance();
+  if (!match(TokenType::KEYWORD_TABLE)) {
+    error("Expected 'TABLE' after 'ALTER'");
+    return nullptr;
+  }
+  if (!check(TokenType::IDENTIFIER)) {
+    error("Expected table name after 'ALTER TABLE'");
+    return nullptr;
+  }
+  const Token &tableToken = advance();
+
+  // PARTITION BY HASH | RANGE
+  if (!isWord("PARTITION")) {
+    error("Expected 'PARTITION BY' after table name (only partitioning is "
+          "supported)");
+    return nullptr;
+  }
+  advance();
+  if (!consume(TokenType::KEYWORD_BY, "Expected 'BY' after 'PARTITION'"))
+    return nullptr;
+  bool hash = isWord("HASH");
+  if (!hash && !isWord("RANGE")) {
+    error("Expected partitioning method HASH or RANGE after 'PARTITION BY'");
+    return nullptr;
+  }
+  advance();
+  auto partitionNode =
+      makeNode(NodeType::PARTITION_QUERY, hash ? "HASH" : "RANGE");
+  partitionNode->addChild(makeNode(NodeType::TABLE_NAME, tableToken.value));
+
+  // ( <column> )
+  if (!consume(TokenType::OP_LPAREN, "Expected '(' before partition key"))
+    return nullptr;
+  if (!check(TokenType::IDENTIFIER)) {
+    error("Expected partition key column");
+    return nullptr;
+  }
+  partitionNode->addChild(makeNode(NodeType::COLUMN, advance().value));
+  if (!consume(TokenType::OP_RPAREN, "Expected ')' after partition key"))
+    return nullptr;
+
+  // HASH: PARTITIONS <n>, a list of one value; RANGE: VALUES (<bounds>)
+  if (hash) {
+    if (!isWord("PARTITIONS")) {
+      error("Expected 'PARTITIONS <n>' after the partition key");
+      return nullptr;
+    }
+    advance();
+    if (!check(TokenType::NUMBER)) {
+      error("Expected number of partitions after 'PARTITIONS'");
+      return nullptr;
+    }
+    auto count = makeNode(NodeType::VALUE_LIST);
+    count->addChild(makeValueNode(advance()));
+    partitionNode->addChild(count);
+  } else {
+    if (!consume(TokenType::KEYWORD_VALUES,
+                 "Expected 'VALUES (<bounds>)' after the partition key") ||
+        !consume(TokenType::OP_LPAREN, "Expected '(' after 'VALUES'"))
+      return nullptr;
+    auto bounds = parseValueList();
+    if (!bounds)
+      return nullptr;
+    partitionNode->addChild(bounds);
+    if (!consume(TokenType::OP_RPAREN, "Expected ')' after range bounds"))
+      return nullptr;
+  }
+
+  // Semicolon
+  consume(TokenType::OP_SEMICOLON,
+          "Expected ';' at end of ALTER TABLE statement");
+
+  return partitionNode;
+}
+
+// ============================================================================
+// GRAMMAR RULE: EXPLAIN [ANALYZE] <statement>
+// ============================================================================
+ParseTree Parser::parseExplain() {
+  // Consume EXPLAIN
+  if (!match(TokenType::KEYWORD_EXPLAIN)) {
+    error("Expected 'EXPLAIN' keyword");
+    return nullptr;
+  }
+
+  // ANALYZE is only a keyword here, so it stays usable as a name elsewhere.
+  // Followed by a table name it is the ANALYZE statement being explained.
+  std::string mode(peek().value);
+  for (auto &ch : mode)
+    ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+  bool analyze = check(TokenType::IDENTIFIER) && mode == "ANALYZE" &&
+                 tokens[current + 1].type != TokenType::IDENTIFIER;
+  if (analyze)
+    advance();
+
+  if (check(TokenType::KEYWORD_EXPLAIN)) {
+    error("EXPLAIN cannot be nested");
+    return nullptr;
+  }
+
+  auto explainNode =
+      makeNode(NodeType::EXPLAIN_QUERY, analyze ? "ANALYZE" : "");
+  auto statement = parseQuery();
+  if (!statement)
+    return nullptr;
+  explainNode->addChild(statement);
+
+  return explainNode;
+}
+
 // ============================================================================
 // VALUE LIST PARSING - For INSERT VALUES clause
 // ============================================================================
 ParseTree Parser::parseValueList() {
-  auto valueListNode = std::make_shared<ParseTreeNode>(NodeType::VALUE_LIST);
+  auto valueListNode = makeNode(NodeType::VALUE_LIST);
 
   // First value
   if (!check(TokenType::IDENTIFIER) && !check(TokenType::NUMBER) &&
@@ -518,9 +1074,8 @@ ParseTree Parser::parseValueList() {
     error("Expected value in VALUES list");
     return nullptr;
   }
-  Token val = advance();
-  valueListNode->addChild(
-      std::make_shared<ParseTreeNode>(NodeType::VALUE, val.value));
+  const Token &val = advance();
+  valueListNode->addChild(makeValueNode(val));
 
   // Additional values
   while (match(TokenType::OP_COMMA)) {
@@ -529,9 +1084,8 @@ ParseTree Parser::parseValueList() {
       error("Expected value after ',' in VALUES list");
       return nullptr;
     }
-    Token nextVal = advance();
-    valueListNode->addChild(
-        std::make_shared<ParseTreeNode>(NodeType::VALUE, nextVal.value));
+    const Token &nextVal = advance();
+    valueListNode->addChild(makeValueNode(nextVal));
   }
 
   return valueListNode;
@@ -550,15 +1104,15 @@ void Parser::printParseTree(const ParseTree &node, int indent) {
 
   // Print indentation
   for (int i = 0; i < indent; i++) {
-    std::cout << "  ";
+    diag() << "  ";
   }
 
   // Print node
-  std::cout << "|-- " << nodeTypeToString(node->type);
+  diag() << "|-- " << nodeTypeToString(node->type);
   if (!node->value.empty()) {
-    std::cout << ": \"" << node->value << "\"";
+    diag() << ": \"" << node->value << "\"";
   }
-  std::cout << "\n";
+  diag() << "\n";
 
   // Recursively print children
   for (const auto &child : node->children) {
@@ -0,0 +1,271 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: partition.cpp
+ * Description: Hash and Range Partitioning Implementation
+ */
+
+#include "../include/partition.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace MiniSQL {
+
+namespace {
+
+// FNV-1a: unlike std::hash, the same in every build, so rows stay in the
+// partition a checkpoint or log put them in
+uint64_t hashText(const std::string &text) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : text) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Three-way comparison of two non-NULL values of the key type
+int compareKeys(ColumnType type, const CellValue &a, const CellValue &b) {
+  switch (type) {
+  case ColumnType::INT:
+    return a.intValue < b.intValue ? -1 : a.intValue > b.intValue;
+  case ColumnType::FLOAT:
+    return a.floatValue < b.floatValue ? -1 : a.floatValue > b.floatValue;
+  case ColumnType::VARCHAR: {
+    int order = a.stringValue.compare(b.stringValue);
+    return order < 0 ? -1 : order > 0;
+  }
+  }
+  return 0;
+}
+
+// Whether a predicate compares the key with a literal of its own type
+bool testsKey(const PartitionScheme &scheme, const BoundPredicate &pred) {
+  if (pred.columnIndex != scheme.columnIndex)
+    return false;
+  switch (scheme.type) {
+  case ColumnType::INT:
+    return pred.mode == CompareMode::INT;
+  case ColumnType::FLOAT:
+    return pred.mode == CompareMode::FLOAT;
+  case ColumnType::VARCHAR:
+    return pred.mode == CompareMode::VARCHAR;
+  }
+  return false;
+}
+
+// The partitions a filter may match, one flag per partition
+std::vector<uint8_t> candidates(const PartitionScheme &scheme,
+                                const BoundFilter &where) {
+  if (where.kind != BoundFilter::Kind::PREDICATE) {
+    bool all = where.kind == BoundFilter::Kind::AND;
+    std::vector<uint8_t> flags(scheme.count, all ? 1 : 0);
+    for (const auto &operand : where.children) {
+      std::vector<uint8_t> own = candidates(scheme, operand);
+      for (size_t p = 0; p < scheme.count; p++)
+        flags[p] = all ? (flags[p] & own[p]) : (flags[p] | own[p]);
+    }
+    return flags;
+  }
+
+  const BoundPredicate &pred = where.predicate;
+  std::vector<uint8_t> flags(scheme.count, 1);
+  if (!testsKey(scheme, pred) || pred.op == CompareOp::NE)
+    return flags;
+  size_t home = scheme.partitionOf(pred.literal);
+  if (pred.op == CompareOp::EQ) {
+    flags.assign(scheme.count, 0);
+    flags[home] = 1;
+    return flags;
+  }
+  if (scheme.method == PartitionMethod::HASH)
+    return flags; // Hashing keeps no order
+
+  // Ranges: the literal's partition and those below or above it
+  bool below = pred.op == CompareOp::LT || pred.op == CompareOp::LE;
+  for (size_t p = 0; p < scheme.count; p++)
+    flags[p] = below ? p <= home : p >= home;
+  // Keys below the lower bound of the literal's partition are all in
+  // earlier partitions
+  if (pred.op == CompareOp::LT && home > 0 &&
+      compareKeys(scheme.type, scheme.bounds[home - 1], pred.literal) == 0)
+    flags[home] = 0;
+  return flags;
+}
+
+std::string keyText(ColumnType type, const CellValue &value) {
+  switch (type) {
+  case ColumnType::INT:
+    return std::to_string(value.intValue);
+  case ColumnType::FLOAT:
+    return formatFloat(value.floatValue);
+  case ColumnType::VARCHAR:
+    return "'" + value.stringValue + "'";
+  }
+  return "";
+}
+
+std::vector<std::string> split(const std::string &text, char separator,
+                               size_t limit = SIZE_MAX) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (parts.size() + 1 < limit) {
+    size_t end = text.find(separator, start);
+    if (end == std::string::npos)
+      break;
+    parts.push_back(text.substr(start, end - start));
+    start = end + 1;
+  }
+  parts.push_back(text.substr(start));
+  return parts;
+}
+
+} // namespace
+
+// ============================================================================
+// PARTITION SCHEME
+// ============================================================================
+size_t PartitionScheme::partitionOf(const CellValue &key) const {
+  if (key.isNull)
+    return 0;
+
+  if (method == PartitionMethod::RANGE) {
+    // The first bound above the key ends its partition
+    auto above = std::upper_bound(
+        bounds.begin(), bounds.end(), key,
+        [&](const CellValue &value, const CellValue &bound) {
+          return compareKeys(type, value, bound) < 0;
+        });
+    return static_cast<size_t>(above - bounds.begin());
+  }
+
+  uint64_t hash = 0;
+  switch (type) {
+  case ColumnType::INT:
+    hash = static_cast<uint64_t>(key.intValue);
+    break;
+  case ColumnType::FLOAT: {
+    double value = key.floatValue == 0.0 ? 0.0 : key.floatValue; // -0.0
+    std::memcpy(&hash, &value, sizeof(hash));
+    break;
+  }
+  case ColumnType::VARCHAR:
+    hash = hashText(key.stringValue);
+    break;
+  }
+  return static_cast<size_t>(mixHash(hash) % count);
+}
+
+std::vector<size_t> PartitionScheme::prune(const BoundFilter *where) const {
+  std::vector<uint8_t> flags(count, 1);
+  if (where)
+    flags = candidates(*this, *where);
+  std::vector<size_t> partitions;
+  for (size_t p = 0; p < count; p++) {
+    if (flags[p])
+      partitions.push_back(p);
+  }
+  return partitions;
+}
+
+std::string PartitionScheme::describe() const {
+  std::string text =
+      (method == PartitionMethod::HASH ? "HASH (" : "RANGE (") + column + ")";
+  if (method == PartitionMethod::RANGE) {
+    for (size_t i = 0; i < bounds.size(); i++)
+      text += (i == 0 ? " at " : ", ") + keyText(type, bounds[i]);
+  }
+  return text + " into " + std::to_string(count) + " partitions";
+}
+
+bool makePartitionScheme(const TableInfo &schema, const std::string &method,
+                         const std::string &column,
+                         const std::vector<std::string> &args,
+                         PartitionScheme &out, std::string &error) {
+  std::string lower = method;
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (lower == "hash") {
+    out.method = PartitionMethod::HASH;
+  } else if (lower == "range") {
+    out.method = PartitionMethod::RANGE;
+  } else {
+    error = "unknown partitioning method '" + method +
+            "' (expected hash or range)";
+    return false;
+  }
+
+  out.column = column;
+  out.columnIndex = schema.columnIndex(out.column);
+  if (out.columnIndex < 0) {
+    error = "column '" + out.column + "' does not exist in table '" +
+            schema.name + "'";
+    return false;
+  }
+  out.type = columnTypeFromString(schema.columns[out.columnIndex].dataType);
+
+  if (out.method == PartitionMethod::HASH) {
+    std::string count = args.size() == 1 ? args[0] : "";
+    char *end = nullptr;
+    unsigned long partitions = std::strtoul(count.c_str(), &end, 10);
+    if (count.empty() || *end != '\0' || partitions < 1 ||
+        partitions > MAX_PARTITIONS) {
+      error = "the number of partitions must be 1 to " +
+              std::to_string(MAX_PARTITIONS) + ", not '" + count + "'";
+      return false;
+    }
+    out.count = partitions;
+    out.bounds.clear();
+    return true;
+  }
+
+  out.bounds.clear();
+  for (const auto &bound : args) {
+    CellValue value;
+    if (!parseCellValue(out.type, bound, value)) {
+      error = "bound '" + bound + "' does not match the type of column '" +
+              out.column + "'";
+      return false;
+    }
+    if (!out.bounds.empty() &&
+        compareKeys(out.type, out.bounds.back(), value) >= 0) {
+      error = "range bounds must be ascending";
+      return false;
+    }
+    out.bounds.push_back(value);
+  }
+  if (out.bounds.size() + 1 > MAX_PARTITIONS) {
+    error = "at most " + std::to_string(MAX_PARTITIONS) +
+            " partitions are supported";
+    return false;
+  }
+  out.count = out.bounds.size() + 1;
+  return true;
+}
+
+bool parsePartitionScheme(const TableInfo &schema, const std::string &text,
+                          PartitionScheme &out, std::string &error) {
+  std::vector<std::string> parts = split(text, ':', 3);
+  if (parts.size() != 3) {
+    error = "expected hash:<column>:<partitions> or "
+            "range:<column>:<bound>,<bound>,...";
+    return false;
+  }
+  // The bounds of a range are separated by commas; a hash has a count
+  std::string method = parts[0];
+  std::transform(method.begin(), method.end(), method.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  std::vector<std::string> args = {parts[2]};
+  if (method == "range")
+    args = split(parts[2], ',');
+  return makePartitionScheme(schema, parts[0], parts[1], args, out, error);
+}
+
+std::string partitionName(const std::string &table, size_t partition) {
+  return table + "#" + std::to_string(partition);
+}
+
+} // namespace MiniSQL
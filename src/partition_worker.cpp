@@ -0,0 +1,142 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: partition_worker.cpp
+ * Description: Local Partition Worker Implementation
+ */
+
+#include "../include/partition_worker.h"
+#include "../include/aggregate.h"
+#include "../include/sort.h"
+#include <algorithm>
+
+namespace MiniSQL {
+
+LocalPartitionWorker::LocalPartitionWorker(
+    const DataStore &store, const std::string &tableName,
+    const BoundFilter *where, const std::vector<size_t> &parts,
+    const std::vector<AccessPlan> &access)
+    : partitions(parts),
+      cursors(store.openPartitionCursors(tableName, where, parts, access)),
+      sortMemory(store.getSortMemory()), pool(store.getThreadPool()),
+      account(currentMemory()) {}
+
+bool LocalPartitionWorker::runFragment(size_t partition,
+                                       const FragmentTask &task,
+                                       FragmentResult &out) {
+  // Count the fragment toward the statement, whichever thread runs it
+  MetricsCapture metrics(out.metrics);
+  MemoryAccountScope memory(account);
+
+  auto open = std::find(partitions.begin(), partitions.end(), partition);
+  if (open == partitions.end() ||
+      static_cast<size_t>(open - partitions.begin()) >= cursors.size()) {
+    out.error = "partition " + std::to_string(partition) +
+                " is not read by this statement";
+    return false;
+  }
+  std::shared_ptr<RowCursor> cursor = cursors[open - partitions.begin()];
+  return task.aggregate ? aggregate(*cursor, task, out)
+                        : shipRows(std::move(cursor), task, out);
+}
+
+bool LocalPartitionWorker::aggregate(RowCursor &cursor,
+                                     const FragmentTask &task,
+                                     FragmentResult &out) const {
+  const TableSnapshot &part = cursor.getTable();
+  SelectionVector rows;
+  cursor.readAll(rows);
+  if (!reserveMemory(rows.size() * sizeof(RowId), "the rows to aggregate",
+                     out.error))
+    return false;
+
+  auto resolve = [&](const std::string &name, AggregateInput &input) {
+    int index = part->columnIndex(name);
+    if (index < 0) {
+      out.error = "column '" + name + "' not found";
+      return false;
+    }
+    input.column = &part->columns[index];
+    input.rows = rows.data();
+    input.name = name;
+    return true;
+  };
+  std::vector<AggregateInput> keys(task.groupBy.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!resolve(task.groupBy[i], keys[i]))
+      return false;
+  }
+  std::vector<AggregateSpec> specs(task.aggregates.size());
+  for (size_t i = 0; i < specs.size(); i++) {
+    const FragmentAggregate &aggregate = task.aggregates[i];
+    specs[i].fn = aggregate.fn;
+    if (aggregate.column != "*" && !resolve(aggregate.column, specs[i].input))
+      return false;
+    specs[i].input.name = aggregate.name;
+  }
+
+  TableSnapshot groups = aggregateRows(rows.size(), keys, partialSpecs(specs),
+                                       pool, out.error);
+  if (!groups)
+    return false;
+  out.table = std::move(groups);
+  out.inputRows = rows.size();
+  return true;
+}
+
+bool LocalPartitionWorker::shipRows(std::shared_ptr<RowCursor> cursor,
+                                    const FragmentTask &task,
+                                    FragmentResult &out) const {
+  TableSnapshot part = cursor->getTable();
+  std::vector<int> columns;
+  for (const auto &name : task.columns) {
+    int index = part->columnIndex(name);
+    if (index < 0) {
+      out.error = "column '" + name + "' not found";
+      return false;
+    }
+    columns.push_back(index);
+  }
+
+  // Only the first LIMIT rows in ORDER BY order can be among the result's
+  if (!task.orderBy.empty() && task.limit != SIZE_MAX) {
+    std::vector<SortKey> keys;
+    for (const auto &key : task.orderBy) {
+      int index = part->columnIndex(key.column);
+      if (index < 0) {
+        out.error = "column '" + key.column + "' not found";
+        return false;
+      }
+      keys.emplace_back();
+      keys.back().column = &part->columns[index];
+      keys.back().descending = key.descending;
+    }
+    std::shared_ptr<RowCursor> sorted;
+    SortStats stats;
+    if (!sortRows(*cursor, keys, task.limit, sortMemory, pool, sorted, stats,
+                  out.error)) {
+      out.error = "ORDER BY failed: " + out.error;
+      return false;
+    }
+    cursor = std::move(sorted);
+  }
+
+  SelectionVector rows;
+  while (out.positions.size() < task.limit && cursor->readNext(rows)) {
+    size_t count = std::min(rows.size(), task.limit - out.positions.size());
+    out.positions.insert(out.positions.end(), rows.begin(),
+                         rows.begin() + count);
+  }
+  // Held until the coordinator has gathered the rows
+  if (!reserveMemory(out.positions.capacity() * sizeof(RowId),
+                     "the rows shipped by a partition", out.error)) {
+    out.error = "Merge failed: " + out.error;
+    return false;
+  }
+  out.inputRows = out.positions.size();
+  out.columns = std::move(columns);
+  out.table = std::move(part);
+  return true;
+}
+
+} // namespace MiniSQL
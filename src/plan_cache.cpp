@@ -0,0 +1,198 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: plan_cache.cpp
+ * Description: Compiled-Plan Cache Implementation
+ *
+ * A least-recently-used cache from normalized query text to validated
+ * QueryPlans. When full, the plan used longest ago is evicted.
+ */
+
+#include "../include/plan_cache.h"
+#include "../include/lexer.h"
+#include <cctype>
+#include <iostream>
+
+namespace MiniSQL {
+
+PlanCache::PlanCache(size_t capacity)
+    : capacity(capacity), hits(0), misses(0) {}
+
+// ============================================================================
+// NORMALIZATION - One token at a time, literals replaced (mirrors Lexer)
+// ============================================================================
+bool PlanCache::normalize(const std::string &query, std::string &key,
+                          std::vector<std::string> &params) {
+  key.clear();
+  params.clear();
+  key.reserve(query.size());
+
+  auto isNameChar = [&](size_t at) {
+    return at < query.size() &&
+           (std::isalnum(static_cast<unsigned char>(query[at])) ||
+            query[at] == '_');
+  };
+  auto isDigit = [&](size_t at) {
+    return at < query.size() &&
+           std::isdigit(static_cast<unsigned char>(query[at]));
+  };
+
+  size_t i = 0;
+  while (i < query.size()) {
+    unsigned char c = static_cast<unsigned char>(query[i]);
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      i++;
+      continue;
+    }
+    if (!key.empty())
+      key += ' '; // Tokens are separated by one space, however written
+
+    if (c == '\'') {
+      // String literal: everything up to the closing quote
+      size_t close = query.find('\'', i + 1);
+      if (close == std::string::npos)
+        return false;
+      params.push_back(query.substr(i + 1, close - i - 1));
+      key += "?s";
+      i = close + 1;
+    } else if (std::isalpha(c) || c == '_') {
+      // Identifier (possibly table.column) or keyword; keywords are
+      // upper-cased, identifiers keep their case
+      size_t start = i;
+      while (isNameChar(i) ||
+             (query[i] == '.' && i + 1 < query.size() &&
+              (std::isalpha(static_cast<unsigned char>(query[i + 1])) ||
+               query[i + 1] == '_')))
+        i++;
+      std::string_view text(query.data() + start, i - start);
+      std::string_view keyword = Lexer::keywordSpelling(text);
+      key.append(keyword.empty() ? text : keyword);
+    } else if (std::isdigit(c)) {
+      // Number: digits with an optional fractional part
+      size_t start = i;
+      bool decimal = false;
+      while (isDigit(i))
+        i++;
+      if (i < query.size() && query[i] == '.' && isDigit(i + 1)) {
+        decimal = true;
+        i++;
+        while (isDigit(i))
+          i++;
+      }
+      params.push_back(query.substr(start, i - start));
+      key += decimal ? "?f" : "?i";
+    } else if (c == '?') {
+      // Not a token of the language: "?s" in the text would read as a
+      // string literal of another query
+      return false;
+    } else {
+      // Operator: "!=", "<=" and ">=" are one token
+      key += static_cast<char>(c);
+      i++;
+      if ((c == '!' || c == '<' || c == '>') && i < query.size() &&
+          query[i] == '=') {
+        key += '=';
+        i++;
+      }
+    }
+  }
+  return true;
+}
+
+// ============================================================================
+// LOOKUP / INSERT
+// ============================================================================
+bool PlanCache::lookup(const std::string &key,
+                       const std::vector<std::string> &params,
+                       uint64_t catalogVersion, QueryPlan &out) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = entries.find(key);
+  if (it == entries.end()) {
+    misses++;
+    return false;
+  }
+
+  // Stale plan: the schema changed since it was validated
+  if (it->second.plan.catalogVersion != catalogVersion) {
+    lru.erase(it->second.lruPos);
+    entries.erase(it);
+    misses++;
+    return false;
+  }
+
+  out = it->second.plan;
+  if (!out.bindParameters(params)) {
+    misses++;
+    return false;
+  }
+
+  // Mark as most recently used
+  lru.splice(lru.begin(), lru, it->second.lruPos);
+  hits++;
+  if (out.explain == ExplainMode::PLAN)
+    out.hot = isStatementHot(key, catalogVersion);
+  else
+    out.hot = ++it->second.executions >= COMPILE_THRESHOLD;
+  return true;
+}
+
+void PlanCache::insert(const std::string &key, const QueryPlan &plan) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (capacity == 0)
+    return;
+
+  auto it = entries.find(key);
+  if (it != entries.end()) {
+    it->second.plan = plan;
+    lru.splice(lru.begin(), lru, it->second.lruPos);
+    return;
+  }
+
+  if (entries.size() >= capacity) {
+    entries.erase(lru.back());
+    lru.pop_back();
+  }
+
+  lru.push_front(key);
+  entries[key] =
+      Entry{plan, lru.begin(), plan.explain == ExplainMode::PLAN ? 0u : 1u};
+}
+
+bool PlanCache::statementHot(const std::string &key,
+                             uint64_t catalogVersion) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return isStatementHot(key, catalogVersion);
+}
+
+bool PlanCache::isStatementHot(const std::string &key,
+                               uint64_t catalogVersion) const {
+  // The statement's own key follows "EXPLAIN "
+  const std::string prefix = "EXPLAIN ";
+  if (key.size() <= prefix.size() || key.compare(0, prefix.size(), prefix) != 0)
+    return false;
+  auto it = entries.find(key.substr(prefix.size()));
+  return it != entries.end() &&
+         it->second.plan.catalogVersion == catalogVersion &&
+         it->second.executions >= COMPILE_THRESHOLD;
+}
+
+void PlanCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  lru.clear();
+}
+
+void PlanCache::printStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t lookups = hits + misses;
+  std::cout << "\n--- Plan Cache ---\n";
+  std::cout << "Cached plans : " << entries.size() << " / " << capacity
+            << "\n";
+  std::cout << "Hits         : " << hits << "\n";
+  std::cout << "Misses       : " << misses << "\n";
+  if (lookups > 0) {
+    std::cout << "Hit rate     : " << (100.0 * hits / lookups) << "%\n";
+  }
+}
+
+} // namespace MiniSQL
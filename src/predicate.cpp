@@ -0,0 +1,291 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: predicate.cpp
+ * Description: Type-Bound WHERE Predicate Implementation
+ *
+ * One scan kernel is instantiated per (comparison mode x operator).
+ * The kernel is chosen when the predicate is bound, so the per-row loop
+ * is a straight comparison of typed values against a typed literal.
+ *
+ * INT and FLOAT comparisons and VARCHAR equality use the vectorized
+ * kernels of simd_scan.h. VARCHAR kernels use the chunk dictionary:
+ * equality looks the literal up once per chunk and then compares integer
+ * codes; range operators are evaluated once per distinct string and
+ * mapped back through codes.
+ */
+
+#include "../include/predicate.h"
+#include "../include/simd_scan.h"
+#include <functional>
+
+namespace MiniSQL {
+
+bool compareOpFromString(const std::string &op, CompareOp &out) {
+  if (op == "=")
+    out = CompareOp::EQ;
+  else if (op == "!=")
+    out = CompareOp::NE;
+  else if (op == "<")
+    out = CompareOp::LT;
+  else if (op == "<=")
+    out = CompareOp::LE;
+  else if (op == ">")
+    out = CompareOp::GT;
+  else if (op == ">=")
+    out = CompareOp::GE;
+  else
+    return false;
+  return true;
+}
+
+std::string compareOpToString(CompareOp op) {
+  switch (op) {
+  case CompareOp::EQ:
+    return "=";
+  case CompareOp::NE:
+    return "!=";
+  case CompareOp::LT:
+    return "<";
+  case CompareOp::LE:
+    return "<=";
+  case CompareOp::GT:
+    return ">";
+  case CompareOp::GE:
+    return ">=";
+  }
+  return "?";
+}
+
+namespace {
+
+// ============================================================================
+// SCAN KERNELS - One instantiation per comparison functor
+// ============================================================================
+// Numeric comparisons run on the vector kernels selected for this CPU
+// (simd_scan.h); the operator indexes the kernel table
+struct IntScan {
+  static void run(const BoundPredicate &pred, const ColumnChunk &chunk,
+                  size_t count, uint8_t *out) {
+    scanKernels().ints[static_cast<int>(pred.op)](
+        chunk.ints.data(), chunk.nulls.data(), count, pred.literal.intValue,
+        out);
+  }
+};
+
+struct FloatScan {
+  static void run(const BoundPredicate &pred, const ColumnChunk &chunk,
+                  size_t count, uint8_t *out) {
+    scanKernels().floats[static_cast<int>(pred.op)](
+        chunk.floats.data(), chunk.nulls.data(), count,
+        pred.literal.floatValue, out);
+  }
+};
+
+template <typename Cmp> struct IntAsFloatScan {
+  static void run(const BoundPredicate &pred, const ColumnChunk &chunk,
+                  size_t count, uint8_t *out) {
+    const int64_t *values = chunk.ints.data();
+    const uint8_t *nulls = chunk.nulls.data();
+    const double literal = pred.literal.floatValue;
+    Cmp cmp;
+    for (size_t i = 0; i < count; i++) {
+      out[i] = static_cast<uint8_t>(
+          (nulls[i] == 0) & cmp(static_cast<double>(values[i]), literal));
+    }
+  }
+};
+
+// Range comparison on strings: evaluate each distinct value once
+template <typename Cmp> struct VarcharScan {
+  static void run(const BoundPredicate &pred, const ColumnChunk &chunk,
+                  size_t count, uint8_t *out) {
+    std::string_view literal(pred.literal.stringValue);
+    std::vector<uint8_t> codeMatches(chunk.dict.size());
+    Cmp cmp;
+    for (uint32_t code = 0; code < codeMatches.size(); code++) {
+      codeMatches[code] = cmp(chunk.dict.get(code), literal) ? 1 : 0;
+    }
+
+    const uint32_t *codes = chunk.codes.data();
+    const uint8_t *nulls = chunk.nulls.data();
+    for (size_t i = 0; i < count; i++) {
+      out[i] = static_cast<uint8_t>((nulls[i] == 0) & codeMatches[codes[i]]);
+    }
+  }
+};
+
+// Equality on strings: one dictionary probe, then integer compares
+template <bool Equal> struct VarcharCodeScan {
+  static void run(const BoundPredicate &pred, const ColumnChunk &chunk,
+                  size_t count, uint8_t *out) {
+    const uint8_t *nulls = chunk.nulls.data();
+    uint32_t target;
+    if (!chunk.dict.find(pred.literal.stringValue, target)) {
+      // Literal absent from this chunk: nothing equal, everything unequal
+      for (size_t i = 0; i < count; i++) {
+        out[i] = Equal ? 0 : static_cast<uint8_t>(nulls[i] == 0);
+      }
+      return;
+    }
+
+    const ScanKernels &kernels = scanKernels();
+    (Equal ? kernels.codesEqual : kernels.codesNotEqual)(
+        chunk.codes.data(), nulls, count, target, out);
+  }
+};
+
+// Fallback for a non-numeric literal on a numeric column
+template <typename Cmp, bool IsInt> struct TextScan {
+  static void run(const BoundPredicate &pred, const ColumnChunk &chunk,
+                  size_t count, uint8_t *out) {
+    Cmp cmp;
+    for (size_t i = 0; i < count; i++) {
+      if (chunk.nulls[i]) {
+        out[i] = 0;
+        continue;
+      }
+      std::string text = IsInt ? std::to_string(chunk.ints[i])
+                               : formatFloat(chunk.floats[i]);
+      out[i] = cmp(text, pred.text) ? 1 : 0;
+    }
+  }
+};
+
+template <typename Cmp> using IntTextScan = TextScan<Cmp, true>;
+template <typename Cmp> using FloatTextScan = TextScan<Cmp, false>;
+
+// Select the kernel instantiation for an operator
+template <template <typename> class Kernel> ChunkScanFn selectKernel(CompareOp op) {
+  switch (op) {
+  case CompareOp::EQ:
+    return &Kernel<std::equal_to<>>::run;
+  case CompareOp::NE:
+    return &Kernel<std::not_equal_to<>>::run;
+  case CompareOp::LT:
+    return &Kernel<std::less<>>::run;
+  case CompareOp::LE:
+    return &Kernel<std::less_equal<>>::run;
+  case CompareOp::GT:
+    return &Kernel<std::greater<>>::run;
+  case CompareOp::GE:
+    return &Kernel<std::greater_equal<>>::run;
+  }
+  return nullptr;
+}
+
+template <typename T> bool compareWith(const T &left, CompareOp op, const T &right) {
+  switch (op) {
+  case CompareOp::EQ:
+    return left == right;
+  case CompareOp::NE:
+    return left != right;
+  case CompareOp::LT:
+    return left < right;
+  case CompareOp::LE:
+    return left <= right;
+  case CompareOp::GT:
+    return left > right;
+  case CompareOp::GE:
+    return left >= right;
+  }
+  return false;
+}
+
+} // namespace
+
+// ============================================================================
+// BINDING
+// ============================================================================
+bool bindPredicate(const TableInfo &schema, const std::string &column,
+                   const std::string &op, const std::string &value,
+                   BoundPredicate &out, std::string &error) {
+  out = BoundPredicate();
+  out.column = column;
+  out.text = value;
+
+  out.columnIndex = schema.columnIndex(column);
+  if (out.columnIndex < 0) {
+    error = "Column '" + column + "' does not exist in table '" +
+            schema.name + "'";
+    return false;
+  }
+
+  if (!compareOpFromString(op, out.op)) {
+    error = "Unsupported operator '" + op + "'";
+    return false;
+  }
+
+  ColumnType type =
+      columnTypeFromString(schema.columns[out.columnIndex].dataType);
+
+  switch (type) {
+  case ColumnType::INT:
+    if (parseCellValue(ColumnType::INT, value, out.literal)) {
+      out.mode = CompareMode::INT;
+      out.scan = &IntScan::run;
+    } else if (parseCellValue(ColumnType::FLOAT, value, out.literal)) {
+      out.mode = CompareMode::INT_AS_FLOAT;
+      out.scan = selectKernel<IntAsFloatScan>(out.op);
+    } else {
+      out.mode = CompareMode::TEXT;
+      out.scan = selectKernel<IntTextScan>(out.op);
+    }
+    break;
+  case ColumnType::FLOAT:
+    if (parseCellValue(ColumnType::FLOAT, value, out.literal)) {
+      out.mode = CompareMode::FLOAT;
+      out.scan = &FloatScan::run;
+    } else {
+      out.mode = CompareMode::TEXT;
+      out.scan = selectKernel<FloatTextScan>(out.op);
+    }
+    break;
+  case ColumnType::VARCHAR:
+    parseCellValue(ColumnType::VARCHAR, value, out.literal);
+    out.mode = CompareMode::VARCHAR;
+    if (out.op == CompareOp::EQ)
+      out.scan = &VarcharCodeScan<true>::run;
+    else if (out.op == CompareOp::NE)
+      out.scan = &VarcharCodeScan<false>::run;
+    else
+      out.scan = selectKernel<VarcharScan>(out.op);
+    break;
+  }
+  return true;
+}
+
+// ============================================================================
+// EVALUATION
+// ============================================================================
+void BoundPredicate::evaluate(const Column &values,
+                              std::vector<uint8_t> &out) const {
+  out.resize(values.size());
+  for (size_t c = 0; c < values.chunkCount(); c++) {
+    const ColumnChunk &chunk = values.getChunk(c);
+    scan(*this, chunk, chunk.nulls.size(), out.data() + c * COLUMN_CHUNK_ROWS);
+  }
+}
+
+bool BoundPredicate::matches(const Column &values, size_t row) const {
+  if (values.isNull(row))
+    return false;
+
+  switch (mode) {
+  case CompareMode::INT:
+    return compareWith(values.getInt(row), op, literal.intValue);
+  case CompareMode::FLOAT:
+    return compareWith(values.getFloat(row), op, literal.floatValue);
+  case CompareMode::INT_AS_FLOAT:
+    return compareWith(static_cast<double>(values.getInt(row)), op,
+                       literal.floatValue);
+  case CompareMode::VARCHAR:
+    return compareWith(values.getString(row), op,
+                       std::string_view(literal.stringValue));
+  case CompareMode::TEXT:
+    return compareWith(values.getText(row), op, text);
+  }
+  return false;
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,48 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: query_plan.cpp
+ * Description: Execution Plan Implementation
+ */
+
+#include "../include/query_plan.h"
+
+namespace MiniSQL {
+
+namespace {
+
+bool bindValue(PlanValue &value, const std::vector<std::string> &params) {
+  if (value.param < 0)
+    return true;
+  if (static_cast<size_t>(value.param) >= params.size())
+    return false;
+  value.text = params[value.param];
+  return true;
+}
+
+bool bindExpr(PlanExpr &expr, const std::vector<std::string> &params) {
+  bool ok = bindValue(expr.value, params);
+  for (auto &child : expr.children) {
+    ok = ok && bindExpr(child, params);
+  }
+  return ok;
+}
+
+} // namespace
+
+bool QueryPlan::bindParameters(const std::vector<std::string> &params) {
+  if (params.size() != static_cast<size_t>(paramCount))
+    return false;
+
+  bool ok = bindExpr(where, params) && bindValue(source, params) &&
+            bindValue(limit, params);
+  for (auto &value : values) {
+    ok = ok && bindValue(value, params);
+  }
+  for (auto &value : setValues) {
+    ok = ok && bindValue(value, params);
+  }
+  return ok;
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,203 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: result_writer.cpp
+ * Description: Buffered Machine-Readable Result Output Implementation
+ */
+
+#include "../include/result_writer.h"
+
+namespace MiniSQL {
+
+bool outputFormatFromString(const std::string &name, OutputFormat &out) {
+  if (name == "csv") {
+    out = OutputFormat::CSV;
+  } else if (name == "tsv") {
+    out = OutputFormat::TSV;
+  } else if (name == "jsonl" || name == "json") {
+    out = OutputFormat::JSONL;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+ResultWriter::ResultWriter(FILE *out, OutputFormat format, size_t bufferLimit)
+    : out(out), format(format), bufferLimit(bufferLimit), resultSets(0) {
+  buffer.reserve(bufferLimit + 1024);
+}
+
+ResultWriter::~ResultWriter() { flush(); }
+
+void ResultWriter::flush() {
+  if (!buffer.empty()) {
+    std::fwrite(buffer.data(), 1, buffer.size(), out);
+    buffer.clear();
+  }
+  std::fflush(out);
+}
+
+// ============================================================================
+// FIELD ENCODING
+// ============================================================================
+void ResultWriter::appendField(std::string_view text) {
+  if (format == OutputFormat::CSV) {
+    // Quote fields containing separators, quotes or line breaks
+    if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+      buffer.append(text);
+      return;
+    }
+    buffer += '"';
+    for (char c : text) {
+      if (c == '"')
+        buffer += '"';
+      buffer += c;
+    }
+    buffer += '"';
+    return;
+  }
+
+  // TSV: escape the characters that would break the line structure
+  for (char c : text) {
+    switch (c) {
+    case '\t':
+      buffer += "\\t";
+      break;
+    case '\n':
+      buffer += "\\n";
+      break;
+    case '\r':
+      buffer += "\\r";
+      break;
+    case '\\':
+      buffer += "\\\\";
+      break;
+    default:
+      buffer += c;
+    }
+  }
+}
+
+void ResultWriter::appendJsonString(std::string_view text) {
+  static const char hex[] = "0123456789abcdef";
+  buffer += '"';
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      buffer += "\\\"";
+      break;
+    case '\\':
+      buffer += "\\\\";
+      break;
+    case '\n':
+      buffer += "\\n";
+      break;
+    case '\r':
+      buffer += "\\r";
+      break;
+    case '\t':
+      buffer += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        buffer += "\\u00";
+        buffer += hex[(c >> 4) & 0xF];
+        buffer += hex[c & 0xF];
+      } else {
+        buffer += c;
+      }
+    }
+  }
+  buffer += '"';
+}
+
+void ResultWriter::appendCell(const QueryResult &result, RowId row,
+                              size_t col) {
+  const Column &column = result.getColumn(col);
+  RowId id = result.sourceRow(row, col);
+
+  if (column.isNull(id)) {
+    if (format == OutputFormat::TSV)
+      buffer += "\\N";
+    else if (format == OutputFormat::JSONL)
+      buffer += "null";
+    return;
+  }
+
+  switch (column.getType()) {
+  case ColumnType::INT:
+    buffer += std::to_string(column.getInt(id));
+    break;
+  case ColumnType::FLOAT:
+    buffer += formatResultFloat(column.getFloat(id));
+    break;
+  case ColumnType::VARCHAR:
+    if (format == OutputFormat::JSONL)
+      appendJsonString(column.getString(id));
+    else
+      appendField(column.getString(id));
+    break;
+  }
+}
+
+// ============================================================================
+// RESULT OUTPUT
+// ============================================================================
+size_t ResultWriter::write(const QueryResult &result) {
+  if (!result.success || !result.rows || result.columnNames.empty())
+    return 0;
+
+  RowCursor &rows = *result.rows;
+  size_t before = rows.returned();
+  size_t cols = result.columnNames.size();
+  SelectionVector batch;
+
+  if (format == OutputFormat::JSONL) {
+    while (rows.next(batch)) {
+      for (RowId row : batch) {
+        buffer += '{';
+        for (size_t c = 0; c < cols; c++) {
+          if (c > 0)
+            buffer += ',';
+          appendJsonString(result.columnNames[c]);
+          buffer += ':';
+          appendCell(result, row, c);
+        }
+        buffer += "}\n";
+        if (buffer.size() >= bufferLimit)
+          flush();
+      }
+    }
+    resultSets++;
+    return rows.returned() - before;
+  }
+
+  char separator = format == OutputFormat::CSV ? ',' : '\t';
+  if (resultSets > 0)
+    buffer += '\n';
+
+  for (size_t c = 0; c < cols; c++) {
+    if (c > 0)
+      buffer += separator;
+    appendField(result.columnNames[c]);
+  }
+  buffer += '\n';
+
+  while (rows.next(batch)) {
+    for (RowId row : batch) {
+      for (size_t c = 0; c < cols; c++) {
+        if (c > 0)
+          buffer += separator;
+        appendCell(result, row, c);
+      }
+      buffer += '\n';
+      if (buffer.size() >= bufferLimit)
+        flush();
+    }
+  }
+
+  resultSets++;
+  return rows.returned() - before;
+}
+
+} // namespace MiniSQL
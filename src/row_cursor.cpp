@@ -0,0 +1,176 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: row_cursor.cpp
+ * Description: Pull-Based Result Iteration Implementation
+ */
+
+#include "../include/row_cursor.h"
+#include "../include/metrics.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace MiniSQL {
+
+namespace {
+
+// Morsels per pool thread in one window of a filtered scan
+const size_t WINDOW_MORSELS_PER_THREAD = 4;
+
+// A table of `rows` rows without columns
+TableSnapshot positionsOnly(size_t rows) {
+  auto table = std::make_shared<TableData>();
+  table->rowCount = rows;
+  return table;
+}
+
+} // namespace
+
+RowCursor::RowCursor(TableSnapshot t)
+    : table(std::move(t)), source(Source::ALL), residual(false),
+      pool(nullptr), position(0), exhausted(false), returnedRows(0),
+      limit(SIZE_MAX) {}
+
+RowCursor::RowCursor(size_t rows) : RowCursor(positionsOnly(rows)) {}
+
+RowCursor::RowCursor(TableSnapshot t, BoundFilter filter, ThreadPool *threads)
+    : table(std::move(t)), source(Source::SCAN), where(std::move(filter)),
+      residual(true), pool(threads), position(0), exhausted(false),
+      returnedRows(0), limit(SIZE_MAX) {}
+
+RowCursor::RowCursor(TableSnapshot t, SelectionVector rows,
+                     BoundFilter filter, bool check)
+    : table(std::move(t)), source(Source::CANDIDATES),
+      where(std::move(filter)), residual(check), pool(nullptr),
+      candidates(std::move(rows)), position(0), exhausted(false),
+      returnedRows(0), limit(SIZE_MAX) {}
+
+RowCursor::RowCursor(TableSnapshot t, std::unique_ptr<RowSource> rows)
+    : table(std::move(t)), source(Source::ORDERED), residual(false),
+      pool(nullptr), ordered(std::move(rows)), position(0), exhausted(false),
+      returnedRows(0), limit(SIZE_MAX) {}
+
+// ============================================================================
+// READING
+// ============================================================================
+void RowCursor::readWindow(SelectionVector &out) {
+  const TableData &data = *table;
+
+  if (source == Source::ALL) {
+    // One chunk of rows per window, without the deleted ones
+    size_t end = std::min(data.rowCount, position + COLUMN_CHUNK_ROWS);
+    bool anyDeleted = data.deleted.anyIn(position >> COLUMN_CHUNK_SHIFT);
+    for (; position < end; position++) {
+      if (!anyDeleted || !data.deleted.contains(position))
+        out.push_back(static_cast<RowId>(position));
+    }
+    exhausted = position >= data.rowCount;
+    return;
+  }
+
+  if (source == Source::ORDERED) {
+    exhausted = !ordered->read(out, COLUMN_CHUNK_ROWS);
+    if (exhausted)
+      ordered.reset();
+    return;
+  }
+
+  if (source == Source::CANDIDATES) {
+    size_t end = std::min(candidates.size(), position + COLUMN_CHUNK_ROWS);
+    size_t before = out.size();
+    for (size_t i = position; i < end; i++) {
+      if (!residual || where.matches(data.columns, candidates[i]))
+        out.push_back(candidates[i]);
+    }
+    recordScan(end - position, out.size() - before, 0);
+    position = end;
+    exhausted = position >= candidates.size();
+    if (exhausted)
+      SelectionVector().swap(candidates);
+    return;
+  }
+
+  // Each morsel of the window collects its own rows; appending them in
+  // morsel order keeps the result in table order
+  size_t morsels = (data.rowCount + COLUMN_CHUNK_ROWS - 1) / COLUMN_CHUNK_ROWS;
+  size_t window = std::min(
+      morsels - position,
+      WINDOW_MORSELS_PER_THREAD * (pool ? pool->size() : 1));
+  std::vector<SelectionVector> parts(window);
+  auto runMorsel = [&](size_t i) {
+    size_t morsel = position + i;
+    size_t count =
+        std::min(COLUMN_CHUNK_ROWS, data.rowCount - morsel * COLUMN_CHUNK_ROWS);
+    where.selectChunk(data.columns, data.deleted, morsel, count, parts[i]);
+  };
+  if (pool) {
+    pool->run(window, runMorsel);
+  } else {
+    for (size_t i = 0; i < window; i++)
+      runMorsel(i);
+  }
+
+  size_t scanned = 0;
+  size_t matched = 0;
+  size_t bytes = 0;
+  for (size_t i = 0; i < window; i++) {
+    scanned += std::min(COLUMN_CHUNK_ROWS,
+                        data.rowCount - (position + i) * COLUMN_CHUNK_ROWS);
+    matched += parts[i].size();
+    bytes += parts[i].capacity() * sizeof(RowId);
+    out.insert(out.end(), parts[i].begin(), parts[i].end());
+  }
+  recordScan(scanned, matched, scanned + bytes);
+  position += window;
+  exhausted = position >= morsels;
+}
+
+bool RowCursor::next(SelectionVector &rows) {
+  rows.clear();
+  if (remaining() == 0)
+    return false;
+  if (!ahead.empty()) {
+    rows.swap(ahead);
+  } else {
+    while (rows.empty() && !exhausted)
+      readWindow(rows);
+  }
+  if (rows.size() > remaining())
+    rows.resize(remaining());
+  returnedRows += rows.size();
+  recordEmitted(rows.size());
+  return !rows.empty();
+}
+
+bool RowCursor::prefetch(size_t rows) {
+  size_t wanted = std::min(rows, remaining());
+  while (ahead.size() < wanted && !exhausted)
+    readWindow(ahead);
+  if (ahead.size() > remaining())
+    ahead.resize(remaining());
+  return complete();
+}
+
+void RowCursor::readAll(SelectionVector &rows) {
+  rows.clear();
+  rows.swap(ahead);
+  while (!exhausted)
+    readWindow(rows);
+}
+
+bool RowCursor::readNext(SelectionVector &rows) {
+  rows.clear();
+  rows.swap(ahead);
+  while (rows.empty() && !exhausted)
+    readWindow(rows);
+  return !rows.empty();
+}
+
+size_t RowCursor::count() {
+  SelectionVector rows;
+  while (next(rows)) {
+  }
+  return returnedRows;
+}
+
+} // namespace MiniSQL
@@ -28,47 +28,75 @@
  * PROCESS:
  * 1. First validate FROM clause to establish table context
  * 2. Then validate SELECT columns against that table
- * 3. Finally validate WHERE conditions
+ * 3. Finally validate WHERE conditions (and GROUP BY)
  */
 
 #include "../include/semantic.h"
+#include "../include/column_store.h"
+#include "../include/output.h"
 #include <algorithm>
 #include <iostream>
+#include <utility>
 
 namespace MiniSQL {
 
-SemanticAnalyzer::SemanticAnalyzer() : currentTable("") {}
+SemanticAnalyzer::SemanticAnalyzer(Catalog catalog)
+    : symbolTable(std::move(catalog)), currentTable(""), selectAll(false),
+      hasAggregates(false) {}
 
 // ============================================================================
 // MAIN ANALYSIS METHOD
 // ============================================================================
 bool SemanticAnalyzer::analyze(const ParseTree &tree) {
-  std::cout << "\n========================================\n";
-  std::cout << "   PHASE 3: SEMANTIC ANALYSIS\n";
-  std::cout << "========================================\n";
+  diag() << "\n========================================\n";
+  diag() << "   PHASE 3: SEMANTIC ANALYSIS\n";
+  diag() << "========================================\n";
 
   errors.clear();
   currentTable = "";
+  fromTables.clear();
   selectedColumns.clear();
+  selectAll = false;
+  hasAggregates = false;
 
   if (!tree) {
     reportError("No parse tree to analyze");
     return false;
   }
 
+  // EXPLAIN is valid when the statement it describes is
+  ParseTree statement = tree;
+  if (tree->type == NodeType::EXPLAIN_QUERY && tree->children.first)
+    statement = tree->children.first;
+
   // Dispatch based on query type
-  switch (tree->type) {
+  switch (statement->type) {
   case NodeType::QUERY:
-    validateQuery(tree);
+    validateQuery(statement);
     break;
   case NodeType::INSERT_QUERY:
-    validateInsert(tree);
+    validateInsert(statement);
     break;
   case NodeType::UPDATE_QUERY:
-    validateUpdate(tree);
+    validateUpdate(statement);
     break;
   case NodeType::DELETE_QUERY:
-    validateDelete(tree);
+    validateDelete(statement);
+    break;
+  case NodeType::CREATE_INDEX_QUERY:
+    validateCreateIndex(statement);
+    break;
+  case NodeType::COPY_QUERY:
+    validateCopy(statement);
+    break;
+  case NodeType::ANALYZE_QUERY:
+    validateAnalyze(statement);
+    break;
+  case NodeType::SHOW_QUERY:
+    diag() << "SHOW MEMORY names no table or column.\n";
+    break;
+  case NodeType::PARTITION_QUERY:
+    validatePartition(statement);
     break;
   default:
     reportError("Unknown query type for semantic analysis");
@@ -76,12 +104,12 @@ bool SemanticAnalyzer::analyze(const ParseTree &tree) {
   }
 
   if (errors.empty()) {
-    std::cout << "Semantic Analysis: SUCCESS\n";
-    std::cout << "All identifiers resolved correctly.\n";
+    diag() << "Semantic Analysis: SUCCESS\n";
+    diag() << "All identifiers resolved correctly.\n";
     return true;
   } else {
-    std::cout << "Semantic Analysis: FAILED with " << errors.size()
-              << " error(s)\n";
+    diag() << "Semantic Analysis: FAILED with " << errors.size()
+           << " error(s)\n";
     return false;
   }
 }
@@ -99,6 +127,9 @@ void SemanticAnalyzer::validateQuery(const ParseTree &node) {
   ParseTree fromClause = nullptr;
   ParseTree selectClause = nullptr;
   ParseTree whereClause = nullptr;
+  ParseTree groupByClause = nullptr;
+  ParseTree orderByClause = nullptr;
+  ParseTree limitClause = nullptr;
 
   // Find clauses
   for (const auto &child : node->children) {
@@ -112,14 +143,30 @@ void SemanticAnalyzer::validateQuery(const ParseTree &node) {
     case NodeType::WHERE_CLAUSE:
       whereClause = child;
       break;
+    case NodeType::GROUP_BY_CLAUSE:
+      groupByClause = child;
+      break;
+    case NodeType::ORDER_BY_CLAUSE:
+      orderByClause = child;
+      break;
+    case NodeType::LIMIT_CLAUSE:
+      limitClause = child;
+      break;
     default:
       break;
     }
   }
 
-  // Validate in correct order: FROM -> SELECT -> WHERE
+  // Validate in correct order: FROM (with its JOIN conditions) -> SELECT
+  // -> WHERE
   if (fromClause) {
     validateFromClause(fromClause);
+    if (errors.empty()) {
+      for (const auto &child : fromClause->children) {
+        if (child->type == NodeType::JOIN_CLAUSE)
+          validateWhereClause(child);
+      }
+    }
   }
 
   if (selectClause && !currentTable.empty()) {
@@ -129,34 +176,57 @@ void SemanticAnalyzer::validateQuery(const ParseTree &node) {
   if (whereClause && !currentTable.empty()) {
     validateWhereClause(whereClause);
   }
+
+  if ((groupByClause || hasAggregates) && !currentTable.empty() &&
+      errors.empty()) {
+    validateGroupBy(groupByClause);
+  }
+
+  if (orderByClause && !currentTable.empty() && errors.empty()) {
+    validateOrderBy(orderByClause, groupByClause);
+  }
+
+  if (limitClause) {
+    validateLimit(limitClause);
+  }
 }
 
 // ============================================================================
 // FROM CLAUSE VALIDATION - Validate table exists
 // ============================================================================
 void SemanticAnalyzer::validateFromClause(const ParseTree &node) {
-  for (const auto &child : node->children) {
-    if (child->type == NodeType::TABLE_NAME) {
-      std::string tableName = child->value;
+  for (auto child : node->children) {
+    // A joined table comes with its ON condition, validated afterwards
+    if (child->type == NodeType::JOIN_CLAUSE)
+      child = child->children.first;
+    if (child && child->type == NodeType::TABLE_NAME) {
+      std::string tableName(child->value);
 
       // Convert to lowercase for comparison
       std::string lowerTable = tableName;
       std::transform(lowerTable.begin(), lowerTable.end(), lowerTable.begin(),
                      ::tolower);
 
-      if (!symbolTable.tableExists(lowerTable)) {
+      if (!symbolTable->tableExists(lowerTable)) {
         std::string msg = "Table '" + tableName + "' does not exist. ";
         msg += "Available tables: ";
-        auto tables = symbolTable.getTableNames();
+        auto tables = symbolTable->getTableNames();
         for (size_t i = 0; i < tables.size(); i++) {
           if (i > 0)
             msg += ", ";
           msg += tables[i];
         }
         reportError(msg);
+      } else if (std::find(fromTables.begin(), fromTables.end(),
+                           lowerTable) != fromTables.end()) {
+        reportError("Table '" + tableName +
+                    "' appears more than once in FROM; a table cannot be "
+                    "joined with itself.");
       } else {
-        currentTable = lowerTable;
-        std::cout << "Table '" << tableName << "' validated.\n";
+        if (currentTable.empty())
+          currentTable = lowerTable;
+        fromTables.push_back(lowerTable);
+        diag() << "Table '" << tableName << "' validated.\n";
       }
     }
   }
@@ -170,22 +240,139 @@ void SemanticAnalyzer::validateSelectClause(const ParseTree &node) {
     if (child->type == NodeType::COLUMN_LIST) {
       for (const auto &column : child->children) {
         if (column->type == NodeType::COLUMN) {
-          std::string colName = column->value;
+          std::string colName(column->value);
 
           // * is always valid
           if (colName == "*") {
-            std::cout << "SELECT * - All columns selected.\n";
+            selectAll = true;
+            diag() << "SELECT * - All columns selected.\n";
             continue;
           }
 
           validateColumn(colName, 1, 1);
           selectedColumns.push_back(colName);
+        } else if (column->type == NodeType::AGGREGATE) {
+          validateAggregate(column);
         }
       }
     }
   }
 }
 
+// ============================================================================
+// AGGREGATE VALIDATION - Known function, argument of a suitable type
+// ============================================================================
+void SemanticAnalyzer::validateAggregate(const ParseTree &node) {
+  hasAggregates = true;
+  std::string function(node->value);
+  ParseTree arg = node->children.first;
+  std::string argName(arg ? arg->value : "*");
+
+  if (function != "COUNT" && function != "SUM" && function != "AVG" &&
+      function != "MIN" && function != "MAX") {
+    reportError("Unknown function '" + function +
+                "'. Available aggregates: COUNT, SUM, AVG, MIN, MAX.");
+    return;
+  }
+
+  if (argName == "*") {
+    if (function != "COUNT")
+      reportError(function + "(*) is not supported; only COUNT(*) counts "
+                             "rows.");
+    return;
+  }
+
+  validateColumn(argName, 1, 1);
+  const ColumnInfo *info = findColumn(argName);
+  if (info && (function == "SUM" || function == "AVG") &&
+      info->dataType != "INT" && info->dataType != "FLOAT") {
+    reportError(function + " needs a numeric column, but '" + argName +
+                "' is " + info->dataType + ".");
+    return;
+  }
+  diag() << "Aggregate " << function << "(" << argName << ") validated.\n";
+}
+
+// ============================================================================
+// GROUP BY VALIDATION - Grouping columns, and every plain SELECT column
+// among them
+// ============================================================================
+void SemanticAnalyzer::validateGroupBy(const ParseTree &node) {
+  std::vector<const ColumnInfo *> keys;
+  if (node) {
+    for (const auto &child : node->children) {
+      if (child->type != NodeType::COLUMN)
+        continue;
+      std::string colName(child->value);
+      validateColumn(colName, 1, 1);
+      keys.push_back(findColumn(colName));
+    }
+  }
+
+  if (selectAll) {
+    reportError("SELECT * cannot be combined with aggregates or GROUP BY; "
+                "list the grouped columns.");
+    return;
+  }
+
+  // A column outside GROUP BY has no single value per group
+  for (const auto &colName : selectedColumns) {
+    const ColumnInfo *info = findColumn(colName);
+    if (info && std::find(keys.begin(), keys.end(), info) == keys.end())
+      reportError("Column '" + colName +
+                  "' must appear in GROUP BY or be used in an aggregate.");
+  }
+}
+
+// ============================================================================
+// ORDER BY VALIDATION - Sort keys that have one value per result row
+// ============================================================================
+void SemanticAnalyzer::validateOrderBy(const ParseTree &node,
+                                       const ParseTree &groupBy) {
+  bool grouped = groupBy || hasAggregates;
+  std::vector<const ColumnInfo *> keys;
+  if (groupBy) {
+    for (const auto &child : groupBy->children) {
+      if (child->type == NodeType::COLUMN)
+        keys.push_back(findColumn(std::string(child->value)));
+    }
+  }
+
+  for (const auto &sortKey : node->children) {
+    ParseTree item = sortKey->children.first;
+    if (!item)
+      continue;
+
+    if (item->type == NodeType::AGGREGATE) {
+      if (!grouped) {
+        reportError("ORDER BY " + std::string(item->value) +
+                    "(...) needs aggregates in SELECT or GROUP BY.");
+        continue;
+      }
+      validateAggregate(item);
+      continue;
+    }
+
+    std::string colName(item->value);
+    validateColumn(colName, 1, 1);
+    const ColumnInfo *info = findColumn(colName);
+    if (grouped && info &&
+        std::find(keys.begin(), keys.end(), info) == keys.end())
+      reportError("ORDER BY column '" + colName +
+                  "' must appear in GROUP BY or be used in an aggregate.");
+  }
+}
+
+// ============================================================================
+// LIMIT VALIDATION - A whole number of rows
+// ============================================================================
+void SemanticAnalyzer::validateLimit(const ParseTree &node) {
+  ParseTree value = node->children.first;
+  if (value && value->value.find('.') != std::string_view::npos)
+    reportError("LIMIT needs a whole number of rows, not '" +
+                std::string(value->value) + "'.");
+}
+
 // ============================================================================
 // WHERE CLAUSE VALIDATION
 // ============================================================================
@@ -193,6 +380,9 @@ void SemanticAnalyzer::validateWhereClause(const ParseTree &node) {
   for (const auto &child : node->children) {
     if (child->type == NodeType::CONDITION) {
       validateCondition(child);
+    } else if (child->type == NodeType::AND_EXPR ||
+               child->type == NodeType::OR_EXPR) {
+      validateWhereClause(child); // Every operand is checked
     }
   }
 }
@@ -204,6 +394,7 @@ void SemanticAnalyzer::validateCondition(const ParseTree &node) {
   std::string columnName;
   std::string operatorStr;
   std::string value;
+  bool identifierValue = false;
 
   for (const auto &child : node->children) {
     switch (child->type) {
@@ -216,37 +407,57 @@ void SemanticAnalyzer::validateCondition(const ParseTree &node) {
       break;
     case NodeType::VALUE:
       value = child->value;
+      identifierValue = child->literalIndex < 0;
       break;
     default:
       break;
     }
   }
 
+  // In a multi-table SELECT an identifier value naming a column of any of
+  // the tables compares two columns (a join condition); a qualified one
+  // must name a column
+  if (fromTables.size() > 1 && identifierValue && namesColumn(value)) {
+    validateColumn(value, 1, 1);
+    const ColumnInfo *left = findColumn(columnName);
+    const ColumnInfo *right = findColumn(value);
+    if (left && right) {
+      bool leftText = columnTypeFromString(left->dataType) ==
+                      ColumnType::VARCHAR;
+      bool rightText = columnTypeFromString(right->dataType) ==
+                       ColumnType::VARCHAR;
+      if (leftText != rightText) {
+        reportError("Cannot compare " + left->dataType + " column '" +
+                    columnName + "' with " + right->dataType + " column '" +
+                    value + "'.");
+        return;
+      }
+    }
+    diag() << "Join condition validated: " << columnName << " "
+           << operatorStr << " " << value << "\n";
+    return;
+  }
+
   // Basic type compatibility check
   if (!columnName.empty() && !value.empty()) {
-    const TableInfo *table = symbolTable.getTable(currentTable);
-    if (table) {
-      for (const auto &col : table->columns) {
-        if (col.name == columnName) {
-          // Check type compatibility
-          bool isNumericColumn =
-              (col.dataType == "INT" || col.dataType == "FLOAT");
-          bool isNumericValue =
-              !value.empty() && (std::isdigit(value[0]) ||
-                                 (value[0] == '-' && value.length() > 1));
-
-          if (isNumericColumn && !isNumericValue) {
-            std::cout << "Warning: Comparing numeric column '" << columnName
-                      << "' with non-numeric value.\n";
-          }
-          break;
-        }
+    if (const ColumnInfo *found = findColumn(columnName)) {
+      // Check type compatibility
+      const ColumnInfo &col = *found;
+      bool isNumericColumn =
+          (col.dataType == "INT" || col.dataType == "FLOAT");
+      bool isNumericValue =
+          !value.empty() && (std::isdigit(value[0]) ||
+                             (value[0] == '-' && value.length() > 1));
+
+      if (isNumericColumn && !isNumericValue) {
+        diag() << "Warning: Comparing numeric column '" << columnName
+               << "' with non-numeric value.\n";
       }
     }
   }
 
-  std::cout << "Condition validated: " << columnName << " " << operatorStr
-            << " " << value << "\n";
+  diag() << "Condition validated: " << columnName << " " << operatorStr
+         << " " << value << "\n";
 }
 
 // ============================================================================
@@ -259,15 +470,40 @@ void SemanticAnalyzer::validateColumn(const std::string &columnName, int line,
     return;
   }
 
-  // Convert to lowercase for comparison
-  std::string lowerCol = columnName;
-  std::transform(lowerCol.begin(), lowerCol.end(), lowerCol.begin(), ::tolower);
+  std::string lowerCol;
+  std::vector<std::string> tables = lookupTables(columnName, lowerCol);
+  if (tables.empty()) {
+    reportError("Column '" + columnName +
+                    "' refers to a table that is not part of the query.",
+                line, col);
+    return;
+  }
 
-  if (!symbolTable.columnExists(currentTable, lowerCol)) {
+  std::vector<std::string> owners;
+  for (const auto &table : tables) {
+    if (symbolTable->columnExists(table, lowerCol))
+      owners.push_back(table);
+  }
+
+  if (owners.size() == 1) {
+    diag() << "Column '" << columnName << "' validated in table '"
+           << owners[0] << "'.\n";
+  } else if (owners.size() > 1) {
+    std::string msg =
+        "Column '" + columnName + "' is ambiguous: it exists in tables ";
+    for (size_t i = 0; i < owners.size(); i++)
+      msg += (i > 0 ? ", " : "") + owners[i];
+    reportError(msg + ". Qualify it as table.column.", line, col);
+  } else if (tables.size() > 1) {
+    std::string msg = "Column '" + columnName + "' does not exist in tables ";
+    for (size_t i = 0; i < tables.size(); i++)
+      msg += (i > 0 ? ", " : "") + tables[i];
+    reportError(msg + ".", line, col);
+  } else {
     std::string msg = "Column '" + columnName + "' does not exist in table '" +
-                      currentTable + "'. Available columns: ";
+                      tables[0] + "'. Available columns: ";
 
-    const TableInfo *table = symbolTable.getTable(currentTable);
+    const TableInfo *table = symbolTable->getTable(tables[0]);
     if (table) {
       for (size_t i = 0; i < table->columns.size(); i++) {
         if (i > 0)
@@ -276,19 +512,64 @@ void SemanticAnalyzer::validateColumn(const std::string &columnName, int line,
       }
     }
     reportError(msg, line, col);
-  } else {
-    std::cout << "Column '" << columnName << "' validated in table '"
-              << currentTable << "'.\n";
   }
 }
 
+std::vector<std::string>
+SemanticAnalyzer::lookupTables(const std::string &name,
+                               std::string &column) const {
+  // Convert to lowercase for comparison
+  column = name;
+  std::transform(column.begin(), column.end(), column.begin(), ::tolower);
+
+  std::vector<std::string> tables = fromTables;
+  if (tables.empty())
+    tables.push_back(currentTable);
+
+  // A qualified name is looked up in its own table only
+  size_t dot = column.find('.');
+  if (dot == std::string::npos)
+    return tables;
+  std::string qualifier = column.substr(0, dot);
+  column = column.substr(dot + 1);
+  if (std::find(tables.begin(), tables.end(), qualifier) == tables.end())
+    return {};
+  return {qualifier};
+}
+
+bool SemanticAnalyzer::namesColumn(const std::string &name) const {
+  if (name.find('.') != std::string::npos)
+    return true;
+  std::string column;
+  for (const auto &table : lookupTables(name, column)) {
+    if (symbolTable->columnExists(table, column))
+      return true;
+  }
+  return false;
+}
+
+const ColumnInfo *SemanticAnalyzer::findColumn(const std::string &name) const {
+  std::string column;
+  const ColumnInfo *found = nullptr;
+  for (const auto &table : lookupTables(name, column)) {
+    const TableInfo *info = symbolTable->getTable(table);
+    int position = info ? info->columnIndex(column) : -1;
+    if (position < 0)
+      continue;
+    if (found)
+      return nullptr; // Ambiguous
+    found = &info->columns[position];
+  }
+  return found;
+}
+
 // ============================================================================
 // INSERT VALIDATION
 // ============================================================================
 void SemanticAnalyzer::validateInsert(const ParseTree &node) {
   std::string tableName;
   std::vector<std::string> columns;
-  int valueCount = 0;
+  std::vector<ParseTree> rows; // One VALUE_LIST per row
 
   for (const auto &child : node->children) {
     if (child->type == NodeType::TABLE_NAME) {
@@ -297,35 +578,116 @@ void SemanticAnalyzer::validateInsert(const ParseTree &node) {
       std::transform(lowerTable.begin(), lowerTable.end(), lowerTable.begin(),
                      ::tolower);
 
-      if (!symbolTable.tableExists(lowerTable)) {
+      if (!symbolTable->tableExists(lowerTable)) {
         std::string msg = "Table '" + tableName + "' does not exist.";
         reportError(msg);
         return;
       }
       currentTable = lowerTable;
-      std::cout << "Table '" << tableName << "' validated for INSERT.\n";
+      diag() << "Table '" << tableName << "' validated for INSERT.\n";
     } else if (child->type == NodeType::COLUMN_LIST) {
       for (const auto &col : child->children) {
         if (col->type == NodeType::COLUMN) {
-          columns.push_back(col->value);
-          validateColumn(col->value, 1, 1);
+          columns.emplace_back(col->value);
+          validateColumn(std::string(col->value), 1, 1);
         }
       }
     } else if (child->type == NodeType::VALUE_LIST) {
-      for (const auto &val : child->children) {
-        if (val->type == NodeType::VALUE) {
-          valueCount++;
-        }
+      rows.push_back(child);
+    }
+  }
+
+  // Resolve the column types once; every row is checked against them
+  const TableInfo *table = symbolTable->getTable(currentTable);
+  std::vector<const ColumnInfo *> targets;
+  for (const auto &name : columns) {
+    std::string lowerCol = name;
+    std::transform(lowerCol.begin(), lowerCol.end(), lowerCol.begin(),
+                   ::tolower);
+    int idx = table ? table->columnIndex(lowerCol) : -1;
+    if (idx < 0)
+      return; // Already reported
+    targets.push_back(&table->columns[idx]);
+  }
+
+  // Check every row: value count, then value types. The first bad row
+  // is reported.
+  CellValue cell;
+  for (size_t r = 0; r < rows.size(); r++) {
+    std::string where =
+        rows.size() > 1 ? " in row " + std::to_string(r + 1) : "";
+    size_t valueCount = 0;
+    for (const auto &val : rows[r]->children) {
+      if (val->type == NodeType::VALUE)
+        valueCount++;
+    }
+    if (!columns.empty() && valueCount > 0 &&
+        columns.size() != valueCount) {
+      reportError("Column count (" + std::to_string(columns.size()) +
+                  ") does not match value count (" +
+                  std::to_string(valueCount) + ")" + where);
+      return;
+    }
+
+    size_t i = 0;
+    for (const auto &val : rows[r]->children) {
+      if (val->type != NodeType::VALUE)
+        continue;
+      const ColumnInfo &target = *targets[i++];
+      std::string text(val->value);
+      if (!parseCellValue(columnTypeFromString(target.dataType), text,
+                          cell)) {
+        reportError("Value '" + text + "' does not match type " +
+                    target.dataType + " of column '" + target.name + "'" +
+                    where);
+        return;
       }
     }
   }
+}
+
+// ============================================================================
+// COPY VALIDATION
+// ============================================================================
+void SemanticAnalyzer::validateCopy(const ParseTree &node) {
+  for (const auto &child : node->children) {
+    if (child->type == NodeType::TABLE_NAME) {
+      std::string tableName(child->value);
+      std::string lowerTable = tableName;
+      std::transform(lowerTable.begin(), lowerTable.end(), lowerTable.begin(),
+                     ::tolower);
 
-  // Check column count matches value count
-  if (!columns.empty() && valueCount > 0 &&
-      columns.size() != static_cast<size_t>(valueCount)) {
-    reportError("Column count (" + std::to_string(columns.size()) +
-                ") does not match value count (" + std::to_string(valueCount) +
-                ")");
+      if (!symbolTable->tableExists(lowerTable)) {
+        std::string msg = "Table '" + tableName + "' does not exist.";
+        reportError(msg);
+        return;
+      }
+      currentTable = lowerTable;
+      diag() << "Table '" << tableName << "' validated for COPY.\n";
+    } else if (child->type == NodeType::VALUE && child->value.empty()) {
+      reportError("COPY needs a file path");
+    }
+  }
+}
+
+// ============================================================================
+// ANALYZE VALIDATION
+// ============================================================================
+void SemanticAnalyzer::validateAnalyze(const ParseTree &node) {
+  for (const auto &child : node->children) {
+    if (child->type != NodeType::TABLE_NAME)
+      continue;
+    std::string tableName(child->value);
+    std::string lowerTable = tableName;
+    std::transform(lowerTable.begin(), lowerTable.end(), lowerTable.begin(),
+                   ::tolower);
+
+    if (!symbolTable->tableExists(lowerTable)) {
+      reportError("Table '" + tableName + "' does not exist.");
+      return;
+    }
+    currentTable = lowerTable;
+    diag() << "Table '" << tableName << "' validated for ANALYZE.\n";
   }
 }
 
@@ -335,25 +697,38 @@ void SemanticAnalyzer::validateInsert(const ParseTree &node) {
 void SemanticAnalyzer::validateUpdate(const ParseTree &node) {
   for (const auto &child : node->children) {
     if (child->type == NodeType::TABLE_NAME) {
-      std::string tableName = child->value;
+      std::string tableName(child->value);
       std::string lowerTable = tableName;
       std::transform(lowerTable.begin(), lowerTable.end(), lowerTable.begin(),
                      ::tolower);
 
-      if (!symbolTable.tableExists(lowerTable)) {
+      if (!symbolTable->tableExists(lowerTable)) {
         std::string msg = "Table '" + tableName + "' does not exist.";
         reportError(msg);
         return;
       }
       currentTable = lowerTable;
-      std::cout << "Table '" << tableName << "' validated for UPDATE.\n";
+      diag() << "Table '" << tableName << "' validated for UPDATE.\n";
     } else if (child->type == NodeType::SET_CLAUSE) {
+      // All assignments are applied in one pass, so each column may be
+      // assigned only once
+      std::vector<std::string> assigned;
       for (const auto &assign : child->children) {
         if (assign->type == NodeType::ASSIGNMENT) {
           for (const auto &ac : assign->children) {
-            if (ac->type == NodeType::COLUMN) {
-              validateColumn(ac->value, 1, 1);
+            if (ac->type != NodeType::COLUMN)
+              continue;
+            std::string colName(ac->value);
+            validateColumn(colName, 1, 1);
+            std::string lowerCol = colName.substr(colName.find('.') + 1);
+            std::transform(lowerCol.begin(), lowerCol.end(),
+                           lowerCol.begin(), ::tolower);
+            if (std::find(assigned.begin(), assigned.end(), lowerCol) !=
+                assigned.end()) {
+              reportError("Column '" + colName +
+                          "' is assigned more than once in SET.");
             }
+            assigned.push_back(lowerCol);
           }
         }
       }
@@ -370,6 +745,11 @@ void SemanticAnalyzer::validateDelete(const ParseTree &node) {
   for (const auto &child : node->children) {
     if (child->type == NodeType::FROM_CLAUSE) {
       validateFromClause(child);
+      if (fromTables.size() > 1) {
+        reportError("DELETE removes rows from a single table; it cannot "
+                    "join others.");
+        return;
+      }
     } else if (child->type == NodeType::WHERE_CLAUSE) {
       if (!currentTable.empty()) {
         validateWhereClause(child);
@@ -378,6 +758,55 @@ void SemanticAnalyzer::validateDelete(const ParseTree &node) {
   }
 }
 
+// ============================================================================
+// CREATE INDEX VALIDATION
+// ============================================================================
+void SemanticAnalyzer::validateCreateIndex(const ParseTree &node) {
+  for (const auto &child : node->children) {
+    if (child->type == NodeType::TABLE_NAME) {
+      std::string tableName(child->value);
+      std::string lowerTable = tableName;
+      std::transform(lowerTable.begin(), lowerTable.end(), lowerTable.begin(),
+                     ::tolower);
+
+      if (!symbolTable->tableExists(lowerTable)) {
+        std::string msg = "Table '" + tableName + "' does not exist.";
+        reportError(msg);
+        return;
+      }
+      currentTable = lowerTable;
+      diag() << "Table '" << tableName << "' validated for CREATE INDEX.\n";
+    } else if (child->type == NodeType::COLUMN) {
+      validateColumn(std::string(child->value), 1, 1);
+    }
+  }
+}
+
+// ============================================================================
+// ALTER TABLE ... PARTITION BY VALIDATION
+// ============================================================================
+// The table and its partition key; the count and bounds are checked
+// against the column's type when the table is split
+void SemanticAnalyzer::validatePartition(const ParseTree &node) {
+  for (const auto &child : node->children) {
+    if (child->type == NodeType::TABLE_NAME) {
+      std::string tableName(child->value);
+      std::string lowerTable = tableName;
+      std::transform(lowerTable.begin(), lowerTable.end(), lowerTable.begin(),
+                     ::tolower);
+
+      if (!symbolTable->tableExists(lowerTable)) {
+        reportError("Table '" + tableName + "' does not exist.");
+        return;
+      }
+      currentTable = lowerTable;
+      diag() << "Table '" << tableName << "' validated for PARTITION BY.\n";
+    } else if (child->type == NodeType::COLUMN) {
+      validateColumn(std::string(child->value), 1, 1);
+    }
+  }
+}
+
 // ============================================================================
 // ERROR HANDLING
 // ============================================================================
@@ -393,10 +822,10 @@ std::vector<CompilerError> SemanticAnalyzer::getErrors() const {
   return errors;
 }
 
-void SemanticAnalyzer::printSymbolTable() const { symbolTable.print(); }
+void SemanticAnalyzer::printSymbolTable() const { symbolTable->print(); }
 
 const SymbolTable &SemanticAnalyzer::getSymbolTable() const {
-  return symbolTable;
+  return *symbolTable;
 }
 
 } // namespace MiniSQL
@@ -0,0 +1,595 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: server.cpp
+ * Description: TCP Server with Pipelined Statements Implementation
+ */
+
+#include "../include/server.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace MiniSQL {
+
+namespace {
+
+const size_t REPLY_BATCH_BYTES = size_t(64) << 10; // Bytes per send
+const size_t STATEMENT_SLICE = 64; // Statements before yielding a worker
+
+// Set by SIGINT / SIGTERM; the handler also wakes the event loop
+volatile sig_atomic_t stopRequested = 0;
+int signalWakeFd = -1;
+
+void onStopSignal(int) {
+  stopRequested = 1;
+  uint64_t one = 1;
+  if (signalWakeFd >= 0 && ::write(signalWakeFd, &one, sizeof(one)) < 0) {
+    // Nothing to do: the loop also checks the flag after every wakeup
+  }
+}
+
+void putInt(std::string &out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+uint32_t getU32(const std::string &in, size_t pos) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; i--)
+    value = (value << 8) | static_cast<unsigned char>(in[pos + i]);
+  return value;
+}
+
+uint8_t wireType(ColumnType type) {
+  switch (type) {
+  case ColumnType::INT:
+    return 0;
+  case ColumnType::FLOAT:
+    return 1;
+  case ColumnType::VARCHAR:
+    return 2;
+  }
+  return 2;
+}
+
+} // namespace
+
+// ============================================================================
+// REPLY ENCODING
+// ============================================================================
+ReplyWriter::ReplyWriter(std::function<void(std::string &)> send)
+    : send(std::move(send)) {}
+
+size_t ReplyWriter::beginFrame(char kind) {
+  size_t start = buffer.size();
+  buffer.append(4, '\0'); // Length, filled in by endFrame()
+  buffer += kind;
+  return start;
+}
+
+void ReplyWriter::endFrame(size_t start) {
+  uint32_t length = static_cast<uint32_t>(buffer.size() - start - 4);
+  for (int i = 0; i < 4; i++)
+    buffer[start + i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+}
+
+void ReplyWriter::writeRows(const QueryResult &result) {
+  if (!result.success || !result.rows || result.columnNames.empty())
+    return;
+
+  size_t cols = result.columnNames.size();
+  std::vector<const Column *> columns;
+  for (size_t c = 0; c < cols; c++)
+    columns.push_back(&result.getColumn(c));
+
+  size_t frame = beginFrame('H');
+  putInt(buffer, cols, 2);
+  for (size_t c = 0; c < cols; c++) {
+    const std::string &name = result.columnNames[c];
+    putInt(buffer, wireType(columns[c]->getType()), 1);
+    putInt(buffer, name.size(), 2);
+    buffer += name;
+  }
+  endFrame(frame);
+
+  // Rows go out in frames of about REPLY_BATCH_BYTES each, as the cursor
+  // produces them
+  size_t bitmapBytes = (cols + 7) / 8;
+  bool open = false;
+  size_t countPos = 0;
+  uint32_t count = 0;
+  auto closeFrame = [&]() {
+    for (int i = 0; i < 4; i++)
+      buffer[countPos + i] = static_cast<char>((count >> (8 * i)) & 0xFF);
+    endFrame(frame);
+    open = false;
+    if (buffer.size() >= REPLY_BATCH_BYTES)
+      send(buffer);
+  };
+
+  SelectionVector batch;
+  while (result.rows->next(batch)) {
+    for (RowId row : batch) {
+      if (!open) {
+        frame = beginFrame('D');
+        countPos = buffer.size();
+        putInt(buffer, 0, 4);
+        count = 0;
+        open = true;
+      }
+
+      size_t bitmap = buffer.size();
+      buffer.append(bitmapBytes, '\0');
+      for (size_t c = 0; c < cols; c++) {
+        const Column &column = *columns[c];
+        RowId id = result.sourceRow(row, c);
+        if (column.isNull(id)) {
+          buffer[bitmap + c / 8] |= static_cast<char>(1 << (c % 8));
+          continue;
+        }
+        switch (column.getType()) {
+        case ColumnType::INT:
+          putInt(buffer, static_cast<uint64_t>(column.getInt(id)), 8);
+          break;
+        case ColumnType::FLOAT: {
+          double value = column.getFloat(id);
+          uint64_t bits;
+          std::memcpy(&bits, &value, sizeof(bits));
+          putInt(buffer, bits, 8);
+          break;
+        }
+        case ColumnType::VARCHAR: {
+          std::string_view text = column.getString(id);
+          putInt(buffer, text.size(), 4);
+          buffer.append(text);
+          break;
+        }
+        }
+      }
+      count++;
+      if (buffer.size() >= REPLY_BATCH_BYTES)
+        closeFrame();
+    }
+  }
+  if (open)
+    closeFrame();
+}
+
+void ReplyWriter::finish(bool success, uint64_t rows,
+                         const std::string &message) {
+  size_t frame = beginFrame('K');
+  putInt(buffer, success ? 1 : 0, 1);
+  putInt(buffer, rows, 8);
+  putInt(buffer, message.size(), 4);
+  buffer += message;
+  endFrame(frame);
+  send(buffer);
+}
+
+// ============================================================================
+// SERVER SETUP
+// ============================================================================
+Server::Server(const std::string &host, int port, size_t workers,
+               Handler handler)
+    : host(host), port(port), workerCount(workers ? workers : 1),
+      handler(std::move(handler)), listenFd(-1), epollFd(-1), wakeFd(-1),
+      stopping(false) {}
+
+Server::~Server() {
+  for (auto &pair : connections)
+    ::close(pair.first);
+  for (int fd : {listenFd, epollFd, wakeFd}) {
+    if (fd >= 0)
+      ::close(fd);
+  }
+}
+
+bool Server::listenOn(std::string &error) {
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+    error = "invalid listen address '" + host + "'";
+    return false;
+  }
+
+  listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  int on = 1;
+  if (listenFd < 0 ||
+      ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+      ::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+          0 ||
+      ::listen(listenFd, SOMAXCONN) != 0) {
+    error = host + ":" + std::to_string(port) + ": " + std::strerror(errno);
+    return false;
+  }
+
+  // Report the port the kernel picked for port 0
+  socklen_t length = sizeof(addr);
+  if (::getsockname(listenFd, reinterpret_cast<sockaddr *>(&addr),
+                    &length) == 0)
+    port = ntohs(addr.sin_port);
+  return true;
+}
+
+// ============================================================================
+// EVENT LOOP
+// ============================================================================
+bool Server::run(std::string &error) {
+  if (!listenOn(error))
+    return false;
+
+  epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+  wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epollFd < 0 || wakeFd < 0) {
+    error = std::string("epoll: ") + std::strerror(errno);
+    return false;
+  }
+  for (int fd : {listenFd, wakeFd}) {
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+  }
+
+  // Stop cleanly on Ctrl-C, so the write-ahead log is synced on exit
+  signalWakeFd = wakeFd;
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = onStopSignal;
+  ::sigaction(SIGINT, &action, nullptr);
+  ::sigaction(SIGTERM, &action, nullptr);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  for (size_t w = 0; w < workerCount; w++)
+    workers.emplace_back(&Server::workerLoop, this);
+  std::cerr << "Listening on " << host << ":" << port << " (" << workerCount
+            << " workers)\n";
+
+  const int MAX_EVENTS = 64;
+  epoll_event events[MAX_EVENTS];
+  while (!stopRequested) {
+    int ready = ::epoll_wait(epollFd, events, MAX_EVENTS, -1);
+    if (ready < 0) {
+      if (errno == EINTR)
+        continue;
+      error = std::string("epoll_wait: ") + std::strerror(errno);
+      break;
+    }
+
+    for (int i = 0; i < ready; i++) {
+      int fd = events[i].data.fd;
+      if (fd == listenFd) {
+        acceptClients();
+        continue;
+      }
+      if (fd == wakeFd) {
+        uint64_t count;
+        while (::read(wakeFd, &count, sizeof(count)) > 0) {
+        }
+        serviceWoken();
+        continue;
+      }
+
+      auto it = connections.find(fd);
+      if (it == connections.end())
+        continue;
+      ConnectionPtr conn = it->second;
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        readClient(conn);
+      if ((events[i].events & EPOLLOUT) && connections.count(fd))
+        writeClient(conn);
+    }
+  }
+
+  // Let running statements finish; statements not started are dropped
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    stopping = true;
+  }
+  queueReady.notify_all();
+  for (auto &pair : connections) {
+    std::lock_guard<std::mutex> lock(pair.second->mutex);
+    pair.second->broken = true;
+    pair.second->pending.clear();
+    pair.second->pendingBytes = 0;
+    pair.second->drained.notify_all();
+  }
+  for (auto &worker : workers)
+    worker.join();
+  workers.clear();
+  signalWakeFd = -1;
+  std::cerr << "Server stopped\n";
+  return error.empty();
+}
+
+void Server::acceptClients() {
+  for (;;) {
+    int fd = ::accept4(listenFd, nullptr, nullptr,
+                       SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      return; // EAGAIN: no more pending connections (or out of fds)
+    }
+
+    // Responses are small and latency matters more than packet count
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    auto conn = std::make_shared<Connection>(fd);
+    conn->events = EPOLLIN;
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = conn->events;
+    event.data.fd = fd;
+    if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+      ::close(fd);
+      continue;
+    }
+    connections[fd] = std::move(conn);
+  }
+}
+
+void Server::readClient(const ConnectionPtr &conn) {
+  bool closed = false, failed = false;
+  char chunk[65536];
+  // A request may be SERVER_MAX_REQUEST bytes long, so one call reads up
+  // to SERVER_INPUT_LIMIT; the rest waits in the socket for the next one
+  static_assert(SERVER_INPUT_LIMIT > SERVER_MAX_REQUEST + 4,
+                "a whole request must fit in one read");
+  while (conn->input.size() < SERVER_INPUT_LIMIT) {
+    ssize_t n = ::read(conn->fd, chunk, sizeof(chunk));
+    if (n > 0) {
+      conn->input.append(chunk, static_cast<size_t>(n));
+      continue;
+    }
+    if (n == 0)
+      closed = true;
+    else if (errno == EINTR)
+      continue;
+    else if (errno != EAGAIN && errno != EWOULDBLOCK)
+      failed = true;
+    break;
+  }
+
+  // Split off every complete request
+  std::vector<std::string> statements;
+  size_t pos = 0;
+  while (conn->input.size() - pos >= 4) {
+    uint32_t length = getU32(conn->input, pos);
+    if (length > SERVER_MAX_REQUEST) {
+      failed = true; // Not a client of this protocol
+      break;
+    }
+    if (conn->input.size() - pos - 4 < length)
+      break;
+    statements.emplace_back(conn->input, pos + 4, length);
+    pos += 4 + length;
+  }
+  conn->input.erase(0, pos);
+
+  bool schedule = false;
+  {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    for (auto &statement : statements) {
+      conn->pendingBytes += statement.size();
+      conn->pending.push_back(std::move(statement));
+    }
+    conn->peerClosed = conn->peerClosed || closed;
+    if (failed) {
+      conn->broken = true;
+      conn->pending.clear();
+      conn->pendingBytes = 0;
+      conn->output.clear();
+      conn->drained.notify_all();
+    }
+    if (!conn->running && !conn->broken && !conn->pending.empty()) {
+      conn->running = true;
+      schedule = true;
+    }
+  }
+
+  if (schedule) {
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      runQueue.push_back(conn);
+    }
+    queueReady.notify_one();
+  }
+  updateConnection(conn);
+}
+
+void Server::writeClient(const ConnectionPtr &conn) {
+  {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    flushLocked(*conn);
+  }
+  updateConnection(conn);
+}
+
+void Server::serviceWoken() {
+  std::vector<ConnectionPtr> woken;
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    woken.swap(wakeQueue);
+  }
+  for (const auto &conn : woken) {
+    // Skip connections closed since (their fd may already be reused)
+    auto it = connections.find(conn->fd);
+    if (it != connections.end() && it->second == conn)
+      updateConnection(conn);
+  }
+}
+
+// Close a finished connection, or register the events it now waits for
+void Server::updateConnection(const ConnectionPtr &conn) {
+  bool close;
+  uint32_t events;
+  {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    bool idle = !conn->running;
+    close = idle && (conn->broken || (conn->peerClosed &&
+                                      conn->pending.empty() &&
+                                      conn->output.empty()));
+    // A client whose queue is full is not read from until it drains
+    bool reading = !conn->peerClosed && !conn->broken && !conn->inputFull();
+    events = (reading ? uint32_t(EPOLLIN) : 0u) |
+             (conn->waiting && !conn->broken ? uint32_t(EPOLLOUT) : 0u);
+  }
+
+  if (close) {
+    closeConnection(conn);
+    return;
+  }
+  if (events != conn->events) {
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = conn->fd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->fd, &event);
+    conn->events = events;
+  }
+}
+
+void Server::closeConnection(const ConnectionPtr &conn) {
+  ::epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+  ::close(conn->fd);
+  connections.erase(conn->fd);
+}
+
+// ============================================================================
+// WORKERS
+// ============================================================================
+void Server::workerLoop() {
+  for (;;) {
+    ConnectionPtr conn;
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      queueReady.wait(lock, [this]() { return stopping || !runQueue.empty(); });
+      if (stopping)
+        return;
+      conn = std::move(runQueue.front());
+      runQueue.pop_front();
+    }
+    runStatements(conn);
+  }
+}
+
+void Server::runStatements(const ConnectionPtr &conn) {
+  ReplyWriter reply(
+      [this, &conn](std::string &bytes) { queueOutput(conn, bytes); });
+
+  for (size_t done = 0;; done++) {
+    std::string sql;
+    bool resume = false;
+    {
+      std::lock_guard<std::mutex> lock(conn->mutex);
+      if (conn->broken || conn->pending.empty()) {
+        conn->running = false;
+        if (!conn->peerClosed && !conn->broken)
+          return; // Nothing for the loop to do until more requests arrive
+        break;
+      }
+      if (done == STATEMENT_SLICE) {
+        // Give other connections a turn; this one stays scheduled
+        std::lock_guard<std::mutex> queueLock(queueMutex);
+        runQueue.push_back(conn);
+        queueReady.notify_one();
+        return;
+      }
+      bool full = conn->inputFull();
+      sql = std::move(conn->pending.front());
+      conn->pending.pop_front();
+      conn->pendingBytes -= sql.size();
+      resume = full && !conn->inputFull();
+    }
+    if (resume)
+      wakeLoop(conn); // To read from the client again
+    handler(sql, reply);
+  }
+  wakeLoop(conn); // May now be closed
+}
+
+void Server::queueOutput(const ConnectionPtr &conn, std::string &bytes) {
+  bool wake;
+  {
+    std::unique_lock<std::mutex> lock(conn->mutex);
+    if (conn->broken) {
+      bytes.clear();
+      return;
+    }
+    bool wasWaiting = conn->waiting;
+    conn->output.append(bytes);
+    bytes.clear();
+    if (!wasWaiting)
+      flushLocked(*conn);
+    wake = (conn->waiting && !wasWaiting) || conn->broken;
+
+    // A client that does not read its responses holds this worker
+    if (conn->output.size() > SERVER_OUTPUT_LIMIT) {
+      if (wake)
+        wakeLoop(conn);
+      wake = false;
+      conn->drained.wait(lock, [&]() {
+        return conn->broken || conn->output.size() <= SERVER_OUTPUT_LIMIT;
+      });
+    }
+  }
+  if (wake)
+    wakeLoop(conn);
+}
+
+// Send as much output as the socket takes (connection mutex held)
+bool Server::flushLocked(Connection &conn) {
+  size_t sent = 0;
+  while (sent < conn.output.size()) {
+    ssize_t n = ::send(conn.fd, conn.output.data() + sent,
+                       conn.output.size() - sent, MSG_NOSIGNAL);
+    if (n > 0) {
+      sent += static_cast<size_t>(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    conn.broken = true; // Peer reset or gone
+    conn.pending.clear();
+    conn.pendingBytes = 0;
+    conn.output.clear();
+    conn.drained.notify_all();
+    return false;
+  }
+
+  conn.output.erase(0, sent);
+  conn.waiting = !conn.output.empty();
+  if (sent > 0)
+    conn.drained.notify_all();
+  return !conn.waiting;
+}
+
+void Server::wakeLoop(const ConnectionPtr &conn) {
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    wakeQueue.push_back(conn);
+  }
+  uint64_t one = 1;
+  if (::write(wakeFd, &one, sizeof(one)) < 0) {
+    // The counter only saturates if the loop is already due to wake
+  }
+}
+
+} // namespace MiniSQL
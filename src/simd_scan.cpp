@@ -0,0 +1,466 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: simd_scan.cpp
+ * Description: Vectorized Comparison Kernel Implementation
+ *
+ * Each instruction set gets its own functions, compiled with a target
+ * attribute rather than global compiler flags, so one binary runs on any
+ * CPU of its architecture. Vector loops compare a block of rows into a
+ * bit mask, clear the bits of NULL rows and expand the mask into flag
+ * bytes; the rows after the last full block go through the scalar code.
+ */
+
+#include "../include/simd_scan.h"
+#include "../include/predicate.h"
+#include <cstdlib>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MINISQL_SIMD_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define MINISQL_SIMD_NEON 1
+#endif
+
+namespace MiniSQL {
+
+namespace {
+
+// Kernel table entries for all six operators, in CompareOp order
+#define KERNELS_BY_OP(kernel)                                                \
+  {                                                                          \
+    &kernel<CompareOp::EQ>, &kernel<CompareOp::NE>, &kernel<CompareOp::LT>,  \
+        &kernel<CompareOp::LE>, &kernel<CompareOp::GT>,                      \
+        &kernel<CompareOp::GE>                                               \
+  }
+
+// ============================================================================
+// SCALAR KERNELS - Portable fallback and tail rows
+// ============================================================================
+template <CompareOp Op, typename T> inline bool compare(T left, T right) {
+  switch (Op) {
+  case CompareOp::EQ:
+    return left == right;
+  case CompareOp::NE:
+    return left != right;
+  case CompareOp::LT:
+    return left < right;
+  case CompareOp::LE:
+    return left <= right;
+  case CompareOp::GT:
+    return left > right;
+  case CompareOp::GE:
+    return left >= right;
+  }
+  return false;
+}
+
+template <CompareOp Op, typename T>
+void scalarCompare(const T *values, const uint8_t *nulls, size_t count,
+                   T literal, uint8_t *out) {
+  for (size_t i = 0; i < count; i++) {
+    out[i] = static_cast<uint8_t>((nulls[i] == 0) &
+                                  compare<Op>(values[i], literal));
+  }
+}
+
+template <CompareOp Op>
+void scalarInts(const int64_t *values, const uint8_t *nulls, size_t count,
+                int64_t literal, uint8_t *out) {
+  scalarCompare<Op>(values, nulls, count, literal, out);
+}
+
+template <CompareOp Op>
+void scalarFloats(const double *values, const uint8_t *nulls, size_t count,
+                  double literal, uint8_t *out) {
+  scalarCompare<Op>(values, nulls, count, literal, out);
+}
+
+template <CompareOp Op>
+void scalarCodes(const uint32_t *codes, const uint8_t *nulls, size_t count,
+                 uint32_t code, uint8_t *out) {
+  scalarCompare<Op>(codes, nulls, count, code, out);
+}
+
+const ScanKernels SCALAR_KERNELS = {"scalar", KERNELS_BY_OP(scalarInts),
+                                    KERNELS_BY_OP(scalarFloats),
+                                    &scalarCodes<CompareOp::EQ>,
+                                    &scalarCodes<CompareOp::NE>};
+
+#ifdef MINISQL_SIMD_X86
+
+// Ordered, non-signaling float predicates; != is unordered so that NaN
+// compares unequal, as in the scalar code
+template <CompareOp Op> constexpr int floatPredicate() {
+  switch (Op) {
+  case CompareOp::EQ:
+    return _CMP_EQ_OQ;
+  case CompareOp::NE:
+    return _CMP_NEQ_UQ;
+  case CompareOp::LT:
+    return _CMP_LT_OQ;
+  case CompareOp::LE:
+    return _CMP_LE_OQ;
+  case CompareOp::GT:
+    return _CMP_GT_OQ;
+  case CompareOp::GE:
+    return _CMP_GE_OQ;
+  }
+  return _CMP_EQ_OQ;
+}
+
+// ============================================================================
+// AVX-512 KERNELS - 64 rows per step
+// ============================================================================
+template <CompareOp Op> constexpr int intPredicate() {
+  switch (Op) {
+  case CompareOp::EQ:
+    return _MM_CMPINT_EQ;
+  case CompareOp::NE:
+    return _MM_CMPINT_NE;
+  case CompareOp::LT:
+    return _MM_CMPINT_LT;
+  case CompareOp::LE:
+    return _MM_CMPINT_LE;
+  case CompareOp::GT:
+    return _MM_CMPINT_NLE;
+  case CompareOp::GE:
+    return _MM_CMPINT_NLT;
+  }
+  return _MM_CMPINT_EQ;
+}
+
+__attribute__((target("avx512f,avx512bw"))) inline __mmask64
+notNull64(const uint8_t *nulls) {
+  return _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(nulls),
+                                _mm512_setzero_si512());
+}
+
+__attribute__((target("avx512f,avx512bw"))) inline void
+storeFlags64(uint8_t *out, __mmask64 mask) {
+  _mm512_storeu_si512(out, _mm512_maskz_mov_epi8(mask, _mm512_set1_epi8(1)));
+}
+
+template <CompareOp Op>
+__attribute__((target("avx512f,avx512bw"))) void
+avx512Ints(const int64_t *values, const uint8_t *nulls, size_t count,
+           int64_t literal, uint8_t *out) {
+  constexpr int PREDICATE = intPredicate<Op>();
+  const __m512i lit = _mm512_set1_epi64(literal);
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    __mmask64 mask = 0;
+    for (int k = 0; k < 8; k++) {
+      __m512i v = _mm512_loadu_si512(values + i + 8 * k);
+      mask |= static_cast<__mmask64>(_mm512_cmp_epi64_mask(v, lit, PREDICATE))
+              << (8 * k);
+    }
+    storeFlags64(out + i, mask & notNull64(nulls + i));
+  }
+  scalarInts<Op>(values + i, nulls + i, count - i, literal, out + i);
+}
+
+template <CompareOp Op>
+__attribute__((target("avx512f,avx512bw"))) void
+avx512Floats(const double *values, const uint8_t *nulls, size_t count,
+             double literal, uint8_t *out) {
+  constexpr int PREDICATE = floatPredicate<Op>();
+  const __m512d lit = _mm512_set1_pd(literal);
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    __mmask64 mask = 0;
+    for (int k = 0; k < 8; k++) {
+      __m512d v = _mm512_loadu_pd(values + i + 8 * k);
+      mask |= static_cast<__mmask64>(_mm512_cmp_pd_mask(v, lit, PREDICATE))
+              << (8 * k);
+    }
+    storeFlags64(out + i, mask & notNull64(nulls + i));
+  }
+  scalarFloats<Op>(values + i, nulls + i, count - i, literal, out + i);
+}
+
+template <CompareOp Op>
+__attribute__((target("avx512f,avx512bw"))) void
+avx512Codes(const uint32_t *codes, const uint8_t *nulls, size_t count,
+            uint32_t code, uint8_t *out) {
+  constexpr int PREDICATE = intPredicate<Op>();
+  const __m512i target = _mm512_set1_epi32(static_cast<int>(code));
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    __mmask64 mask = 0;
+    for (int k = 0; k < 4; k++) {
+      __m512i v = _mm512_loadu_si512(codes + i + 16 * k);
+      mask |= static_cast<__mmask64>(_mm512_cmp_epu32_mask(v, target,
+                                                          PREDICATE))
+              << (16 * k);
+    }
+    storeFlags64(out + i, mask & notNull64(nulls + i));
+  }
+  scalarCodes<Op>(codes + i, nulls + i, count - i, code, out + i);
+}
+
+const ScanKernels AVX512_KERNELS = {"avx512", KERNELS_BY_OP(avx512Ints),
+                                    KERNELS_BY_OP(avx512Floats),
+                                    &avx512Codes<CompareOp::EQ>,
+                                    &avx512Codes<CompareOp::NE>};
+
+// ============================================================================
+// AVX2 KERNELS - 32 rows per step
+// ============================================================================
+__attribute__((target("avx2"))) inline uint32_t
+notNull32(const uint8_t *nulls) {
+  __m256i n = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(nulls));
+  return static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(n, _mm256_setzero_si256())));
+}
+
+// Bit i of mask -> byte i of out (0 or 1)
+__attribute__((target("avx2"))) inline void storeFlags32(uint8_t *out,
+                                                          uint32_t mask) {
+  const __m256i spread = _mm256_setr_epi64x(
+      0x0000000000000000, 0x0101010101010101, 0x0202020202020202,
+      0x0303030303030303);
+  const __m256i bits = _mm256_set1_epi64x(0x8040201008040201);
+  __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(mask)),
+                                  spread);
+  v = _mm256_cmpeq_epi8(_mm256_and_si256(v, bits), bits);
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(out),
+                      _mm256_and_si256(v, _mm256_set1_epi8(1)));
+}
+
+// AVX2 only has == and > for integers: the other operators swap the
+// operands and/or invert the result
+template <CompareOp Op>
+__attribute__((target("avx2"))) inline uint32_t compareInts4(__m256i v,
+                                                              __m256i lit) {
+  __m256i r;
+  if (Op == CompareOp::EQ || Op == CompareOp::NE)
+    r = _mm256_cmpeq_epi64(v, lit);
+  else if (Op == CompareOp::GT || Op == CompareOp::LE)
+    r = _mm256_cmpgt_epi64(v, lit);
+  else
+    r = _mm256_cmpgt_epi64(lit, v);
+  uint32_t bits =
+      static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(r)));
+  bool invert =
+      Op == CompareOp::NE || Op == CompareOp::LE || Op == CompareOp::GE;
+  return invert ? bits ^ 0xF : bits;
+}
+
+template <CompareOp Op>
+__attribute__((target("avx2"))) void
+avx2Ints(const int64_t *values, const uint8_t *nulls, size_t count,
+         int64_t literal, uint8_t *out) {
+  const __m256i lit = _mm256_set1_epi64x(literal);
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    uint32_t mask = 0;
+    for (int k = 0; k < 8; k++) {
+      __m256i v = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(values + i + 4 * k));
+      mask |= compareInts4<Op>(v, lit) << (4 * k);
+    }
+    storeFlags32(out + i, mask & notNull32(nulls + i));
+  }
+  scalarInts<Op>(values + i, nulls + i, count - i, literal, out + i);
+}
+
+template <CompareOp Op>
+__attribute__((target("avx2"))) void
+avx2Floats(const double *values, const uint8_t *nulls, size_t count,
+           double literal, uint8_t *out) {
+  constexpr int PREDICATE = floatPredicate<Op>();
+  const __m256d lit = _mm256_set1_pd(literal);
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    uint32_t mask = 0;
+    for (int k = 0; k < 8; k++) {
+      __m256d v = _mm256_loadu_pd(values + i + 4 * k);
+      mask |= static_cast<uint32_t>(
+                  _mm256_movemask_pd(_mm256_cmp_pd(v, lit, PREDICATE)))
+              << (4 * k);
+    }
+    storeFlags32(out + i, mask & notNull32(nulls + i));
+  }
+  scalarFloats<Op>(values + i, nulls + i, count - i, literal, out + i);
+}
+
+template <CompareOp Op>
+__attribute__((target("avx2"))) void
+avx2Codes(const uint32_t *codes, const uint8_t *nulls, size_t count,
+          uint32_t code, uint8_t *out) {
+  const __m256i target = _mm256_set1_epi32(static_cast<int>(code));
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    uint32_t mask = 0;
+    for (int k = 0; k < 4; k++) {
+      __m256i v = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(codes + i + 8 * k));
+      __m256i eq = _mm256_cmpeq_epi32(v, target);
+      mask |= static_cast<uint32_t>(
+                  _mm256_movemask_ps(_mm256_castsi256_ps(eq)))
+              << (8 * k);
+    }
+    if (Op == CompareOp::NE)
+      mask = ~mask;
+    storeFlags32(out + i, mask & notNull32(nulls + i));
+  }
+  scalarCodes<Op>(codes + i, nulls + i, count - i, code, out + i);
+}
+
+const ScanKernels AVX2_KERNELS = {"avx2", KERNELS_BY_OP(avx2Ints),
+                                  KERNELS_BY_OP(avx2Floats),
+                                  &avx2Codes<CompareOp::EQ>,
+                                  &avx2Codes<CompareOp::NE>};
+
+#endif // MINISQL_SIMD_X86
+
+#ifdef MINISQL_SIMD_NEON
+
+// ============================================================================
+// NEON KERNELS - 16 rows per step
+// ============================================================================
+template <CompareOp Op> inline uint64x2_t compareInts2(int64x2_t v,
+                                                       int64x2_t lit) {
+  switch (Op) {
+  case CompareOp::EQ:
+  case CompareOp::NE: // Inverted by the caller
+    return vceqq_s64(v, lit);
+  case CompareOp::LT:
+    return vcltq_s64(v, lit);
+  case CompareOp::LE:
+    return vcleq_s64(v, lit);
+  case CompareOp::GT:
+    return vcgtq_s64(v, lit);
+  case CompareOp::GE:
+    return vcgeq_s64(v, lit);
+  }
+  return vceqq_s64(v, lit);
+}
+
+template <CompareOp Op> inline uint64x2_t compareFloats2(float64x2_t v,
+                                                         float64x2_t lit) {
+  switch (Op) {
+  case CompareOp::EQ:
+  case CompareOp::NE: // Inverted by the caller
+    return vceqq_f64(v, lit);
+  case CompareOp::LT:
+    return vcltq_f64(v, lit);
+  case CompareOp::LE:
+    return vcleq_f64(v, lit);
+  case CompareOp::GT:
+    return vcgtq_f64(v, lit);
+  case CompareOp::GE:
+    return vcgeq_f64(v, lit);
+  }
+  return vceqq_f64(v, lit);
+}
+
+// Narrow eight 2-lane 64-bit masks into one 16-lane byte mask
+inline uint8x16_t narrow64(const uint64x2_t (&r)[8]) {
+  uint8x8_t half[2];
+  for (int h = 0; h < 2; h++) {
+    const uint64x2_t *q = r + 4 * h;
+    uint32x4_t lo = vcombine_u32(vmovn_u64(q[0]), vmovn_u64(q[1]));
+    uint32x4_t hi = vcombine_u32(vmovn_u64(q[2]), vmovn_u64(q[3]));
+    half[h] = vmovn_u16(vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+  }
+  return vcombine_u8(half[0], half[1]);
+}
+
+template <CompareOp Op>
+inline void storeFlags16(uint8_t *out, const uint8_t *nulls,
+                         uint8x16_t mask) {
+  if (Op == CompareOp::NE)
+    mask = vmvnq_u8(mask);
+  uint8x16_t notNull = vceqq_u8(vld1q_u8(nulls), vdupq_n_u8(0));
+  vst1q_u8(out, vandq_u8(vandq_u8(mask, notNull), vdupq_n_u8(1)));
+}
+
+template <CompareOp Op>
+void neonInts(const int64_t *values, const uint8_t *nulls, size_t count,
+              int64_t literal, uint8_t *out) {
+  const int64x2_t lit = vdupq_n_s64(literal);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    uint64x2_t r[8];
+    for (int k = 0; k < 8; k++)
+      r[k] = compareInts2<Op>(vld1q_s64(values + i + 2 * k), lit);
+    storeFlags16<Op>(out + i, nulls + i, narrow64(r));
+  }
+  scalarInts<Op>(values + i, nulls + i, count - i, literal, out + i);
+}
+
+template <CompareOp Op>
+void neonFloats(const double *values, const uint8_t *nulls, size_t count,
+                double literal, uint8_t *out) {
+  const float64x2_t lit = vdupq_n_f64(literal);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    uint64x2_t r[8];
+    for (int k = 0; k < 8; k++)
+      r[k] = compareFloats2<Op>(vld1q_f64(values + i + 2 * k), lit);
+    storeFlags16<Op>(out + i, nulls + i, narrow64(r));
+  }
+  scalarFloats<Op>(values + i, nulls + i, count - i, literal, out + i);
+}
+
+template <CompareOp Op>
+void neonCodes(const uint32_t *codes, const uint8_t *nulls, size_t count,
+               uint32_t code, uint8_t *out) {
+  const uint32x4_t target = vdupq_n_u32(code);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    uint16x4_t r[4];
+    for (int k = 0; k < 4; k++)
+      r[k] = vmovn_u32(vceqq_u32(vld1q_u32(codes + i + 4 * k), target));
+    uint8x16_t mask =
+        vcombine_u8(vmovn_u16(vcombine_u16(r[0], r[1])),
+                    vmovn_u16(vcombine_u16(r[2], r[3])));
+    storeFlags16<Op>(out + i, nulls + i, mask);
+  }
+  scalarCodes<Op>(codes + i, nulls + i, count - i, code, out + i);
+}
+
+const ScanKernels NEON_KERNELS = {"neon", KERNELS_BY_OP(neonInts),
+                                  KERNELS_BY_OP(neonFloats),
+                                  &neonCodes<CompareOp::EQ>,
+                                  &neonCodes<CompareOp::NE>};
+
+#endif // MINISQL_SIMD_NEON
+
+#undef KERNELS_BY_OP
+
+// ============================================================================
+// DISPATCH
+// ============================================================================
+const ScanKernels &selectKernels() {
+  const char *env = std::getenv("MINISQL_SIMD");
+  std::string limit = env ? env : "";
+  if (limit == "scalar")
+    return SCALAR_KERNELS;
+
+#ifdef MINISQL_SIMD_X86
+  __builtin_cpu_init();
+  if (limit != "avx2" && __builtin_cpu_supports("avx512f") &&
+      __builtin_cpu_supports("avx512bw"))
+    return AVX512_KERNELS;
+  if (__builtin_cpu_supports("avx2"))
+    return AVX2_KERNELS;
+#endif
+#ifdef MINISQL_SIMD_NEON
+  return NEON_KERNELS; // Always present on AArch64
+#endif
+  return SCALAR_KERNELS;
+}
+
+} // namespace
+
+const ScanKernels &scanKernels() {
+  static const ScanKernels &kernels = selectKernels();
+  return kernels;
+}
+
+} // namespace MiniSQL
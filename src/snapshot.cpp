@@ -0,0 +1,335 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: snapshot.cpp
+ * Description: Binary Columnar Table Snapshots Implementation
+ */
+
+#include "../include/snapshot.h"
+#include "../include/binary_io.h"
+#include "../include/compression.h"
+#include "../include/mapped_file.h"
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+namespace MiniSQL {
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'M', 'S', 'Q', 'L', 'S', 'N', 'A', 'P'};
+const char SNAPSHOT_END[8] = {'M', 'S', 'Q', 'L', 'E', 'N', 'D', '!'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t FLAG_COMPRESSED = 1;
+
+enum : uint8_t { CODEC_STORED = 0, CODEC_LZ = 1 };
+
+// Raw payload of one column chunk
+void encodeChunk(const ColumnChunk &chunk, ColumnType type,
+                 std::vector<uint8_t> &out) {
+  out.clear();
+  putArray(out, chunk.nulls);
+  switch (type) {
+  case ColumnType::INT:
+    putArray(out, chunk.ints);
+    break;
+  case ColumnType::FLOAT:
+    putArray(out, chunk.floats);
+    break;
+  case ColumnType::VARCHAR:
+    putArray(out, chunk.codes);
+    putValue(out, static_cast<uint32_t>(chunk.dict.size()));
+    putArray(out, chunk.dict.getOffsets());
+    putArray(out, chunk.dict.getBytes());
+    break;
+  }
+}
+
+bool decodeChunk(const uint8_t *data, size_t size, ColumnType type,
+                 uint32_t rows, ColumnChunk &chunk) {
+  ByteReader in(data, data + size);
+  if (!in.getArray(chunk.nulls, rows))
+    return false;
+
+  switch (type) {
+  case ColumnType::INT:
+    if (!in.getArray(chunk.ints, rows))
+      return false;
+    break;
+  case ColumnType::FLOAT:
+    if (!in.getArray(chunk.floats, rows))
+      return false;
+    break;
+  case ColumnType::VARCHAR: {
+    uint32_t entries = 0;
+    std::vector<uint32_t> offsets;
+    std::vector<char> bytes;
+    if (!in.getArray(chunk.codes, rows) || !in.get(entries) ||
+        !in.getArray(offsets, size_t(entries) + 1) ||
+        !in.getArray(bytes, offsets.back()))
+      return false;
+    if (!chunk.dict.assign(std::move(bytes), std::move(offsets)))
+      return false;
+    for (uint32_t code : chunk.codes) {
+      if (code >= entries)
+        return false;
+    }
+    break;
+  }
+  }
+  return in.atEnd();
+}
+
+// Largest raw payload a chunk of `rows` values of a type can have: NULL
+// flags and values, for VARCHAR the codes and a dictionary of at most one
+// entry per row, whose uint32_t offsets bound its bytes
+uint64_t maxChunkSize(ColumnType type, uint32_t rows) {
+  uint64_t size = rows;
+  switch (type) {
+  case ColumnType::INT:
+    size += uint64_t(rows) * sizeof(int64_t);
+    break;
+  case ColumnType::FLOAT:
+    size += uint64_t(rows) * sizeof(double);
+    break;
+  case ColumnType::VARCHAR:
+    size += uint64_t(rows) * sizeof(uint32_t) + sizeof(uint32_t) +
+            (uint64_t(rows) + 1) * sizeof(uint32_t) +
+            std::numeric_limits<uint32_t>::max();
+    break;
+  }
+  return size;
+}
+
+struct FileCloser {
+  void operator()(FILE *f) const { std::fclose(f); }
+};
+
+} // namespace
+
+// ============================================================================
+// SAVE
+// ============================================================================
+bool saveSnapshot(const std::string &path, const TableData &table,
+                  bool compress, SnapshotStats &stats, std::string &error) {
+  stats = SnapshotStats();
+  std::string tmpPath = path + ".tmp";
+  std::unique_ptr<FILE, FileCloser> file(std::fopen(tmpPath.c_str(), "wb"));
+  if (!file) {
+    error = "could not create '" + tmpPath + "'";
+    return false;
+  }
+  std::setvbuf(file.get(), nullptr, _IOFBF, size_t(1) << 20);
+
+  std::vector<uint8_t> buffer;
+  auto flushBuffer = [&]() {
+    bool ok = std::fwrite(buffer.data(), 1, buffer.size(), file.get()) ==
+              buffer.size();
+    buffer.clear();
+    return ok;
+  };
+
+  // Header
+  buffer.insert(buffer.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 8);
+  putValue(buffer, SNAPSHOT_VERSION);
+  putValue(buffer, compress ? FLAG_COMPRESSED : 0u);
+  putValue(buffer, BYTE_ORDER_MARK);
+  putValue(buffer, static_cast<uint64_t>(table.rowCount));
+  putValue(buffer, table.logSequence);
+  putValue(buffer, static_cast<uint32_t>(COLUMN_CHUNK_ROWS));
+  putValue(buffer, static_cast<uint32_t>(table.columns.size()));
+  for (size_t c = 0; c < table.columns.size(); c++) {
+    const std::string &name = table.schema.columns[c].name;
+    putValue(buffer, static_cast<uint8_t>(table.columns[c].getType()));
+    putValue(buffer, static_cast<uint16_t>(name.size()));
+    buffer.insert(buffer.end(), name.begin(), name.end());
+  }
+  bool ok = flushBuffer();
+
+  // Column blocks
+  std::vector<uint8_t> raw, packed;
+  for (const auto &column : table.columns) {
+    for (size_t k = 0; ok && k < column.chunkCount(); k++) {
+      const ColumnChunk &chunk = column.getChunk(k);
+      encodeChunk(chunk, column.getType(), raw);
+
+      uint8_t codec = CODEC_STORED;
+      const std::vector<uint8_t> *payload = &raw;
+      if (compress) {
+        lzCompress(raw.data(), raw.size(), packed);
+        if (packed.size() < raw.size()) {
+          codec = CODEC_LZ;
+          payload = &packed;
+        }
+      }
+
+      putValue(buffer, codec);
+      putValue(buffer, static_cast<uint32_t>(chunk.nulls.size()));
+      putValue(buffer, static_cast<uint64_t>(raw.size()));
+      putValue(buffer, static_cast<uint64_t>(payload->size()));
+      putValue(buffer, checksum64(raw.data(), raw.size()));
+      ok = flushBuffer() &&
+           std::fwrite(payload->data(), 1, payload->size(), file.get()) ==
+               payload->size();
+
+      stats.rawBytes += raw.size();
+      stats.storedBytes += payload->size();
+    }
+  }
+
+  // Deleted rows
+  std::vector<uint32_t> deleted;
+  for (size_t row = 0; deleted.size() < table.deleted.size(); row++) {
+    if (table.deleted.contains(row))
+      deleted.push_back(static_cast<uint32_t>(row));
+  }
+  putValue(buffer, static_cast<uint64_t>(deleted.size()));
+  putArray(buffer, deleted);
+
+  buffer.insert(buffer.end(), SNAPSHOT_END, SNAPSHOT_END + 8);
+  ok = ok && flushBuffer() && std::fflush(file.get()) == 0;
+  file.reset();
+
+  if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    error = "could not write '" + path + "'";
+    return false;
+  }
+  stats.rows = table.liveRows();
+  return true;
+}
+
+// ============================================================================
+// LOAD
+// ============================================================================
+bool loadSnapshot(const std::string &path, TableData &table,
+                  SnapshotStats &stats, std::string &error) {
+  stats = SnapshotStats();
+  MappedFile file(path);
+  if (!file.isOpen()) {
+    error = "could not open '" + path + "'";
+    return false;
+  }
+
+  const uint8_t *base = reinterpret_cast<const uint8_t *>(file.data());
+  ByteReader in(base, base + file.size());
+
+  // Header
+  const uint8_t *magic = in.take(8);
+  uint32_t version = 0, flags = 0, byteOrder = 0, chunkRows = 0;
+  uint32_t columnCount = 0;
+  uint64_t rowCount = 0, logSequence = 0;
+  if (!magic || std::memcmp(magic, SNAPSHOT_MAGIC, 8) != 0) {
+    error = "'" + path + "' is not a snapshot";
+    return false;
+  }
+  if (!in.get(version) || version == 0 || version > SNAPSHOT_VERSION ||
+      !in.get(flags) ||
+      !in.get(byteOrder) || byteOrder != BYTE_ORDER_MARK) {
+    error = "'" + path + "' has an unsupported snapshot version";
+    return false;
+  }
+  // Version 1 snapshots predate the write-ahead log
+  if (!in.get(rowCount) || (version >= 2 && !in.get(logSequence)) ||
+      !in.get(chunkRows) || !in.get(columnCount) ||
+      chunkRows != COLUMN_CHUNK_ROWS ||
+      columnCount != table.columns.size()) {
+    error = "'" + path + "' does not match the table layout";
+    return false;
+  }
+  for (uint32_t c = 0; c < columnCount; c++) {
+    uint8_t type = 0;
+    uint16_t nameLength = 0;
+    const uint8_t *name = nullptr;
+    if (!in.get(type) || !in.get(nameLength) ||
+        !(name = in.take(nameLength)) ||
+        type != static_cast<uint8_t>(table.columns[c].getType()) ||
+        std::string(reinterpret_cast<const char *>(name), nameLength) !=
+            table.schema.columns[c].name) {
+      error = "'" + path + "' does not match the schema of table '" +
+              table.schema.name + "'";
+      return false;
+    }
+  }
+
+  // Column blocks, decoded into fresh columns
+  std::vector<Column> columns;
+  std::vector<uint8_t> scratch;
+  for (uint32_t c = 0; c < columnCount; c++) {
+    ColumnType type = table.columns[c].getType();
+    columns.emplace_back(type);
+    Column &column = columns.back();
+
+    while (column.size() < rowCount) {
+      uint8_t codec = 0;
+      uint32_t rows = 0;
+      uint64_t rawSize = 0, storedSize = 0, checksum = 0;
+      const uint8_t *payload = nullptr;
+      if (!in.get(codec) || !in.get(rows) || !in.get(rawSize) ||
+          !in.get(storedSize) || !in.get(checksum) ||
+          !(payload = in.take(storedSize)) || rows == 0 ||
+          rows > COLUMN_CHUNK_ROWS || column.size() + rows > rowCount ||
+          rawSize > maxChunkSize(type, rows)) {
+        error = "'" + path + "' is truncated or corrupt";
+        return false;
+      }
+
+      const uint8_t *data = payload;
+      if (codec == CODEC_LZ) {
+        scratch.resize(rawSize);
+        if (!lzDecompress(payload, storedSize, scratch.data(), rawSize)) {
+          error = "'" + path + "' has a corrupt compressed block";
+          return false;
+        }
+        data = scratch.data();
+      } else if (codec != CODEC_STORED || storedSize != rawSize) {
+        error = "'" + path + "' has an unknown block format";
+        return false;
+      }
+
+      ColumnChunk chunk;
+      if (checksum64(data, rawSize) != checksum ||
+          !decodeChunk(data, rawSize, type, rows, chunk)) {
+        error = "checksum mismatch in column '" +
+                table.schema.columns[c].name + "' of '" + path + "'";
+        return false;
+      }
+      column.appendChunk(std::move(chunk));
+      stats.rawBytes += rawSize;
+      stats.storedBytes += storedSize;
+    }
+  }
+
+  // Version 3+: deleted rows
+  uint64_t deletedCount = 0;
+  std::vector<uint32_t> deleted;
+  if (version >= 3 &&
+      (!in.get(deletedCount) || deletedCount > rowCount ||
+       !in.getArray(deleted, static_cast<size_t>(deletedCount)))) {
+    error = "'" + path + "' is truncated or corrupt";
+    return false;
+  }
+  DeleteBitmap deletedRows;
+  for (uint32_t row : deleted) {
+    if (row >= rowCount || !deletedRows.insert(row)) {
+      error = "'" + path + "' is truncated or corrupt";
+      return false;
+    }
+  }
+
+  const uint8_t *trailer = in.take(8);
+  if (!trailer || std::memcmp(trailer, SNAPSHOT_END, 8) != 0 || !in.atEnd()) {
+    error = "'" + path + "' is truncated or corrupt";
+    return false;
+  }
+
+  table.columns = std::move(columns);
+  table.rowCount = static_cast<size_t>(rowCount);
+  table.deleted = std::move(deletedRows);
+  table.logSequence = logSequence;
+  stats.rows = table.liveRows();
+  return true;
+}
+
+} // namespace MiniSQL
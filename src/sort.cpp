@@ -0,0 +1,493 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: sort.cpp
+ * Description: Top-K, Parallel and External Merge Sort Implementation
+ */
+
+#include "../include/sort.h"
+#include "../include/memory_tracker.h"
+#include "../include/metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace MiniSQL {
+
+namespace {
+
+// Fewest entries sorted in parallel ranges; smaller inputs sort faster on
+// one thread
+const size_t PARALLEL_SORT_MIN_ROWS = 65536;
+
+// Fewest entries in a spilled run, whatever the memory budget
+const size_t MIN_RUN_ROWS = COLUMN_CHUNK_ROWS;
+
+// Entries read from a run file at a time while merging
+const size_t MERGE_BUFFER_ROWS = 4096;
+
+// Entries of a run reserved from the memory limits at a time
+const size_t RESERVE_STEP_ROWS = COLUMN_CHUNK_ROWS;
+
+// One row to sort: its position and the prefix of its first key
+struct SortEntry {
+  uint64_t prefix;
+  RowId position;
+};
+
+// Order-preserving 64-bit prefix of a row's first key: a smaller prefix
+// means a smaller key, equal prefixes need the full comparison
+uint64_t keyPrefix(const SortKey &key, RowId position) {
+  size_t row = key.rows ? key.rows[position] : position;
+  const Column &column = *key.column;
+  uint64_t bits = UINT64_MAX; // NULL: after every value
+  if (!column.isNull(row)) {
+    switch (column.getType()) {
+    case ColumnType::INT:
+      bits = static_cast<uint64_t>(column.getInt(row)) ^ (1ULL << 63);
+      break;
+    case ColumnType::FLOAT: {
+      double value = column.getFloat(row);
+      std::memcpy(&bits, &value, sizeof(bits));
+      // Negative values: all bits flipped; others: the sign bit set
+      bits = (bits >> 63) ? ~bits : bits | (1ULL << 63);
+      break;
+    }
+    case ColumnType::VARCHAR: {
+      std::string_view text = column.getString(row);
+      bits = 0;
+      for (size_t i = 0; i < sizeof(bits); i++) {
+        bits = (bits << 8) |
+               (i < text.size() ? static_cast<unsigned char>(text[i]) : 0);
+      }
+      break;
+    }
+    }
+  }
+  return key.descending ? ~bits : bits;
+}
+
+// Compare one key of two rows (< 0, 0, > 0), ascending
+int compareKey(const SortKey &key, RowId a, RowId b) {
+  size_t rowA = key.rows ? key.rows[a] : a;
+  size_t rowB = key.rows ? key.rows[b] : b;
+  const Column &column = *key.column;
+  bool nullA = column.isNull(rowA);
+  bool nullB = column.isNull(rowB);
+  if (nullA || nullB)
+    return nullA - nullB;
+
+  switch (column.getType()) {
+  case ColumnType::INT: {
+    int64_t x = column.getInt(rowA);
+    int64_t y = column.getInt(rowB);
+    return (x > y) - (x < y);
+  }
+  case ColumnType::FLOAT: {
+    double x = column.getFloat(rowA);
+    double y = column.getFloat(rowB);
+    return (x > y) - (x < y);
+  }
+  case ColumnType::VARCHAR: {
+    int c = column.getString(rowA).compare(column.getString(rowB));
+    return (c > 0) - (c < 0);
+  }
+  }
+  return 0;
+}
+
+// Strict order of entries: by key prefix, then by every key, then by
+// position
+class EntryOrder {
+private:
+  const std::vector<SortKey> *keys;
+
+public:
+  explicit EntryOrder(const std::vector<SortKey> &k) : keys(&k) {}
+
+  bool operator()(const SortEntry &a, const SortEntry &b) const {
+    if (a.prefix != b.prefix)
+      return a.prefix < b.prefix;
+    for (const SortKey &key : *keys) {
+      int order = compareKey(key, a.position, b.position);
+      if (order != 0)
+        return key.descending ? order > 0 : order < 0;
+    }
+    return a.position < b.position;
+  }
+};
+
+// Sort entries: one range per thread of the pool, then the sorted ranges
+// are merged pairwise, every merge of a round in parallel
+void sortEntries(std::vector<SortEntry> &entries, const EntryOrder &order,
+                 ThreadPool *pool) {
+  size_t parts = pool ? pool->size() : 1;
+  if (parts < 2 || entries.size() < PARALLEL_SORT_MIN_ROWS) {
+    std::sort(entries.begin(), entries.end(), order);
+    return;
+  }
+
+  std::vector<size_t> bounds(parts + 1);
+  for (size_t i = 0; i <= parts; i++)
+    bounds[i] = entries.size() * i / parts;
+  pool->run(parts, [&](size_t i) {
+    std::sort(entries.begin() + bounds[i], entries.begin() + bounds[i + 1],
+              order);
+  });
+
+  std::vector<SortEntry> merged(entries.size());
+  recordBytes(merged.capacity() * sizeof(SortEntry));
+  while (bounds.size() > 2) {
+    size_t ranges = bounds.size() - 1;
+    size_t pairs = (ranges + 1) / 2;
+    pool->run(pairs, [&](size_t i) {
+      size_t begin = bounds[2 * i];
+      size_t middle = bounds[std::min(2 * i + 1, ranges)];
+      size_t end = bounds[std::min(2 * i + 2, ranges)];
+      std::merge(entries.begin() + begin, entries.begin() + middle,
+                 entries.begin() + middle, entries.begin() + end,
+                 merged.begin() + begin, order);
+    });
+    std::vector<size_t> next;
+    for (size_t i = 0; i <= pairs; i++)
+      next.push_back(bounds[std::min(2 * i, ranges)]);
+    bounds.swap(next);
+    entries.swap(merged);
+  }
+}
+
+// ============================================================================
+// RUN FILES - Sorted entries spilled to temporary files
+// ============================================================================
+struct CloseFile {
+  void operator()(FILE *file) const { std::fclose(file); }
+};
+
+// A sorted run in a temporary file, removed when it is closed
+struct Run {
+  std::unique_ptr<FILE, CloseFile> file;
+  size_t entries;
+};
+
+// Reads a run back, one buffer of entries at a time
+class RunReader {
+private:
+  Run run;
+  std::vector<SortEntry> buffer;
+  size_t position;
+  size_t unread; // Entries of the run not yet in the buffer
+
+public:
+  explicit RunReader(Run r)
+      : run(std::move(r)), position(0), unread(run.entries) {
+    std::rewind(run.file.get());
+    refill();
+  }
+
+  bool empty() const { return position >= buffer.size(); }
+
+  const SortEntry &current() const { return buffer[position]; }
+
+  void advance() {
+    if (++position >= buffer.size())
+      refill();
+  }
+
+private:
+  void refill() {
+    size_t count = std::min(unread, MERGE_BUFFER_ROWS);
+    buffer.resize(count);
+    size_t read =
+        count ? std::fread(buffer.data(), sizeof(SortEntry), count,
+                           run.file.get())
+              : 0;
+    buffer.resize(read); // A short read ends the run
+    unread = read < count ? 0 : unread - read;
+    position = 0;
+  }
+};
+
+// Merges runs with a min-heap of their current entries
+class RunMerger {
+private:
+  std::vector<RunReader> readers;
+  EntryOrder order;
+  std::vector<size_t> heap; // Readers that are not empty
+
+  // Heap order: the reader with the smallest current entry on top
+  bool later(size_t a, size_t b) const {
+    return order(readers[b].current(), readers[a].current());
+  }
+
+public:
+  RunMerger(std::vector<Run> runs, const EntryOrder &o) : order(o) {
+    for (auto &run : runs)
+      readers.emplace_back(std::move(run));
+    for (size_t i = 0; i < readers.size(); i++) {
+      if (!readers[i].empty())
+        heap.push_back(i);
+    }
+    auto cmp = [this](size_t a, size_t b) { return later(a, b); };
+    std::make_heap(heap.begin(), heap.end(), cmp);
+  }
+
+  /**
+   * Take the smallest entry of all runs
+   * @return false once every run is merged
+   */
+  bool next(SortEntry &entry) {
+    if (heap.empty())
+      return false;
+    auto cmp = [this](size_t a, size_t b) { return later(a, b); };
+    std::pop_heap(heap.begin(), heap.end(), cmp);
+    RunReader &reader = readers[heap.back()];
+    entry = reader.current();
+    reader.advance();
+    if (reader.empty())
+      heap.pop_back();
+    else
+      std::push_heap(heap.begin(), heap.end(), cmp);
+    return true;
+  }
+};
+
+// Write sorted entries to a new run
+bool spillRun(const SortEntry *entries, size_t count, std::vector<Run> &runs,
+              SortStats &stats, std::string &error) {
+  Run run{std::unique_ptr<FILE, CloseFile>(std::tmpfile()), count};
+  if (!run.file) {
+    error = "could not create a temporary file for the sort";
+    return false;
+  }
+  if (std::fwrite(entries, sizeof(SortEntry), count, run.file.get()) !=
+      count) {
+    error = "could not write a sorted run to a temporary file";
+    return false;
+  }
+  runs.push_back(std::move(run));
+  stats.runs++;
+  stats.spilledBytes += count * sizeof(SortEntry);
+  return true;
+}
+
+// Merge the first `count` runs into one longer run, at the end of runs
+bool mergeRuns(std::vector<Run> &runs, size_t count, const EntryOrder &order,
+               SortStats &stats, std::string &error) {
+  std::vector<Run> group(std::make_move_iterator(runs.begin()),
+                         std::make_move_iterator(runs.begin() + count));
+  runs.erase(runs.begin(), runs.begin() + count);
+  RunMerger merger(std::move(group), order);
+
+  Run run{std::unique_ptr<FILE, CloseFile>(std::tmpfile()), 0};
+  if (!run.file) {
+    error = "could not create a temporary file for the sort";
+    return false;
+  }
+  std::vector<SortEntry> buffer;
+  buffer.reserve(MERGE_BUFFER_ROWS);
+  SortEntry entry;
+  bool more = true;
+  while (more) {
+    more = merger.next(entry);
+    if (more)
+      buffer.push_back(entry);
+    if (buffer.size() == MERGE_BUFFER_ROWS || (!more && !buffer.empty())) {
+      if (std::fwrite(buffer.data(), sizeof(SortEntry), buffer.size(),
+                      run.file.get()) != buffer.size()) {
+        error = "could not write a merged run to a temporary file";
+        return false;
+      }
+      run.entries += buffer.size();
+      stats.spilledBytes += buffer.size() * sizeof(SortEntry);
+      buffer.clear();
+    }
+  }
+  runs.push_back(std::move(run));
+  return true;
+}
+
+// ============================================================================
+// SORTED ROW SOURCES
+// ============================================================================
+
+// Positions sorted in memory
+class SortedRows : public RowSource {
+private:
+  SelectionVector rows;
+  size_t position;
+
+public:
+  explicit SortedRows(SelectionVector sorted)
+      : rows(std::move(sorted)), position(0) {}
+
+  bool read(SelectionVector &out, size_t max) override {
+    size_t end = std::min(rows.size(), position + max);
+    out.insert(out.end(), rows.begin() + position, rows.begin() + end);
+    position = end;
+    return position < rows.size();
+  }
+};
+
+// Positions merged from spilled runs as they are read; the keys are kept
+// for the comparisons of the merge
+class MergedRows : public RowSource {
+private:
+  std::vector<SortKey> keys;
+  RunMerger merger;
+
+public:
+  MergedRows(std::vector<Run> runs, std::vector<SortKey> k)
+      : keys(std::move(k)), merger(std::move(runs), EntryOrder(keys)) {}
+
+  MergedRows(const MergedRows &) = delete;
+  MergedRows &operator=(const MergedRows &) = delete;
+
+  bool read(SelectionVector &out, size_t max) override {
+    SortEntry entry;
+    for (size_t i = 0; i < max; i++) {
+      if (!merger.next(entry))
+        return false;
+      out.push_back(entry.position);
+    }
+    return true;
+  }
+};
+
+SelectionVector positionsOf(const std::vector<SortEntry> &entries,
+                            size_t limit) {
+  SelectionVector rows;
+  rows.reserve(std::min(entries.size(), limit));
+  for (size_t i = 0; i < entries.size() && i < limit; i++)
+    rows.push_back(entries[i].position);
+  return rows;
+}
+
+} // namespace
+
+std::string sortMethodToString(SortMethod method) {
+  switch (method) {
+  case SortMethod::TOP_K:
+    return "top-K heap";
+  case SortMethod::PARALLEL:
+    return "parallel in-memory sort";
+  case SortMethod::EXTERNAL:
+    return "external merge sort";
+  }
+  return "unknown";
+}
+
+SortMethod chooseSortMethod(size_t limit) {
+  return limit <= TOP_K_MAX_ROWS ? SortMethod::TOP_K : SortMethod::PARALLEL;
+}
+
+bool sortRows(RowCursor &input, const std::vector<SortKey> &keys,
+              size_t limit, size_t memory, ThreadPool *pool,
+              std::shared_ptr<RowCursor> &out, SortStats &stats,
+              std::string &error) {
+  EntryOrder order(keys);
+  stats = SortStats();
+  stats.method = chooseSortMethod(limit);
+  SelectionVector batch;
+
+  // Keep the best `limit` entries: the heap's top is the worst of them
+  if (stats.method == SortMethod::TOP_K) {
+    if (!reserveMemory(limit * (sizeof(SortEntry) + sizeof(RowId)),
+                       "the top-K heap", error))
+      return false;
+    std::vector<SortEntry> heap;
+    heap.reserve(limit);
+    recordBytes(heap.capacity() * sizeof(SortEntry));
+    while (limit > 0 && input.readNext(batch)) {
+      stats.rows += batch.size();
+      for (RowId position : batch) {
+        SortEntry entry{keyPrefix(keys[0], position), position};
+        if (heap.size() < limit) {
+          heap.push_back(entry);
+          std::push_heap(heap.begin(), heap.end(), order);
+        } else if (order(entry, heap.front())) {
+          std::pop_heap(heap.begin(), heap.end(), order);
+          heap.back() = entry;
+          std::push_heap(heap.begin(), heap.end(), order);
+        }
+      }
+    }
+    std::sort_heap(heap.begin(), heap.end(), order);
+    out = std::make_shared<RowCursor>(
+        input.getTable(),
+        std::make_unique<SortedRows>(positionsOf(heap, limit)));
+    return true;
+  }
+
+  // Collect entries up to a run's worth; sorting needs as much again.
+  // The run is reserved from the memory limits a step at a time, and
+  // spilled early when they leave no more.
+  size_t runRows = std::max(MIN_RUN_ROWS, memory / (2 * sizeof(SortEntry)));
+  MemoryReservation working;
+  size_t reservedRows = 0;
+  std::vector<SortEntry> entries;
+  std::vector<Run> runs;
+  size_t allocated = 0;
+  while (input.readNext(batch)) {
+    stats.rows += batch.size();
+    for (RowId position : batch) {
+      entries.push_back({keyPrefix(keys[0], position), position});
+      if (entries.size() < std::min(reservedRows, runRows))
+        continue;
+      if (entries.size() < runRows) {
+        size_t more = std::min(runRows, reservedRows + RESERVE_STEP_ROWS);
+        if (working.resize(2 * more * sizeof(SortEntry))) {
+          reservedRows = more;
+          continue;
+        }
+        if (reservedRows == 0) { // Not even one step: no run to spill
+          error = memoryLimitError("the sort",
+                                   2 * more * sizeof(SortEntry));
+          return false;
+        }
+        stats.memoryLimited = true;
+      }
+      allocated = std::max(allocated, entries.capacity());
+      sortEntries(entries, order, pool);
+      if (!spillRun(entries.data(), entries.size(), runs, stats, error))
+        return false;
+      entries.clear();
+    }
+  }
+  allocated = std::max(allocated, entries.capacity());
+  recordBytes(allocated * sizeof(SortEntry));
+  sortEntries(entries, order, pool);
+
+  if (runs.empty()) {
+    // The sorted positions are kept until the statement ends
+    if (!reserveMemory(std::min(entries.size(), limit) * sizeof(RowId),
+                       "the sorted rows", error))
+      return false;
+    out = std::make_shared<RowCursor>(
+        input.getTable(),
+        std::make_unique<SortedRows>(positionsOf(entries, limit)));
+    return true;
+  }
+
+  stats.method = SortMethod::EXTERNAL;
+  if (!entries.empty() &&
+      !spillRun(entries.data(), entries.size(), runs, stats, error))
+    return false;
+  std::vector<SortEntry>().swap(entries);
+
+  // Each run being merged holds one buffer; merge groups of runs first
+  // while there are more than the budget has buffers for
+  size_t fanIn = std::max<size_t>(
+      2, std::min(memory, working.size() + availableMemory()) /
+             (MERGE_BUFFER_ROWS * sizeof(SortEntry)));
+  while (runs.size() > fanIn) {
+    if (!mergeRuns(runs, fanIn, order, stats, error))
+      return false;
+  }
+
+  out = std::make_shared<RowCursor>(
+      input.getTable(), std::make_unique<MergedRows>(std::move(runs), keys));
+  out->setLimit(limit);
+  return true;
+}
+
+} // namespace MiniSQL
@@ -0,0 +1,382 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: statistics.cpp
+ * Description: Table Statistics and Selectivity Estimation
+ */
+
+#include "../include/statistics.h"
+#include "../include/data_store.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+namespace MiniSQL {
+
+namespace {
+
+uint64_t floatHash(double value) {
+  if (value == 0.0)
+    value = 0.0; // -0.0 and 0.0 are one value
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return mixHash(bits);
+}
+
+// What one morsel found in one column. VARCHAR extremes are views into
+// the morsel's chunk, valid while the table is held.
+struct ColumnPartial {
+  uint64_t nulls = 0;
+  bool any = false; // A non-NULL value was seen
+  int64_t minInt = 0, maxInt = 0;
+  double minFloat = 0.0, maxFloat = 0.0;
+  std::string_view minText, maxText;
+  HyperLogLog distinct;
+  SelectionVector sample; // Positions of sampled non-NULL rows
+
+  template <typename T> static void widen(T value, T &lo, T &hi, bool any) {
+    if (!any || value < lo)
+      lo = value;
+    if (!any || value > hi)
+      hi = value;
+  }
+
+  void mergeInto(ColumnPartial &total) const {
+    if (any) {
+      widen(minInt, total.minInt, total.maxInt, total.any);
+      widen(maxInt, total.minInt, total.maxInt, true);
+      widen(minFloat, total.minFloat, total.maxFloat, total.any);
+      widen(maxFloat, total.minFloat, total.maxFloat, true);
+      widen(minText, total.minText, total.maxText, total.any);
+      widen(maxText, total.minText, total.maxText, true);
+      total.any = true;
+    }
+    total.nulls += nulls;
+    total.distinct.merge(distinct);
+    total.sample.insert(total.sample.end(), sample.begin(), sample.end());
+  }
+};
+
+// Analyze `count` rows of one chunk; flags mark the live rows, and every
+// step-th row position is sampled
+void analyzeChunk(const Column &column, size_t chunkIndex, size_t count,
+                  const uint8_t *live, size_t step, ColumnPartial &out) {
+  const ColumnChunk &chunk = column.getChunk(chunkIndex);
+  size_t base = chunkIndex * COLUMN_CHUNK_ROWS;
+  ColumnType type = column.getType();
+
+  // A VARCHAR chunk's dictionary holds each of its strings once: they are
+  // hashed and compared once, if some live row still uses them
+  std::vector<uint8_t> used;
+  if (type == ColumnType::VARCHAR)
+    used.assign(chunk.dict.size(), 0);
+
+  for (size_t i = 0; i < count; i++) {
+    if (!live[i])
+      continue;
+    if (chunk.nulls[i]) {
+      out.nulls++;
+      continue;
+    }
+    switch (type) {
+    case ColumnType::INT:
+      out.distinct.add(mixHash(static_cast<uint64_t>(chunk.ints[i])));
+      ColumnPartial::widen(chunk.ints[i], out.minInt, out.maxInt, out.any);
+      break;
+    case ColumnType::FLOAT:
+      out.distinct.add(floatHash(chunk.floats[i]));
+      ColumnPartial::widen(chunk.floats[i], out.minFloat, out.maxFloat,
+                           out.any);
+      break;
+    case ColumnType::VARCHAR:
+      used[chunk.codes[i]] = 1;
+      break;
+    }
+    if (type != ColumnType::VARCHAR)
+      out.any = true;
+    if ((base + i) % step == 0)
+      out.sample.push_back(static_cast<RowId>(base + i));
+  }
+
+  for (size_t code = 0; code < used.size(); code++) {
+    if (!used[code])
+      continue;
+    std::string_view text = chunk.dict.get(static_cast<uint32_t>(code));
+    out.distinct.add(mixHash(std::hash<std::string_view>()(text)));
+    ColumnPartial::widen(text, out.minText, out.maxText, out.any);
+    out.any = true;
+  }
+}
+
+// Three-way comparison of two non-NULL values of a column
+int compareRows(const Column &column, RowId a, RowId b) {
+  switch (column.getType()) {
+  case ColumnType::INT: {
+    int64_t x = column.getInt(a), y = column.getInt(b);
+    return x < y ? -1 : x > y;
+  }
+  case ColumnType::FLOAT: {
+    double x = column.getFloat(a), y = column.getFloat(b);
+    return x < y ? -1 : x > y;
+  }
+  case ColumnType::VARCHAR:
+    return column.getString(a).compare(column.getString(b));
+  }
+  return 0;
+}
+
+// Histogram bounds and frequent values from the sorted sample
+void summarizeSample(const Column &column, const SelectionVector &sample,
+                     ColumnStats &stats) {
+  // No more buckets than sampled values; without a sample (a handful of
+  // values), one bucket spans the range
+  size_t n = sample.size();
+  size_t buckets = std::max<size_t>(1, std::min(HISTOGRAM_BUCKETS, n));
+  stats.bounds.push_back(stats.min);
+  for (size_t b = 1; b < buckets; b++) {
+    size_t rank = (b * n + buckets - 1) / buckets;
+    stats.bounds.push_back(column.getCell(sample[rank - 1]));
+  }
+  stats.bounds.push_back(stats.max);
+
+  // A value is frequent if it fills more than half a bucket of the sample
+  std::vector<std::pair<size_t, RowId>> runs; // (length, first row)
+  for (size_t i = 0; i < n;) {
+    size_t j = i + 1;
+    while (j < n && compareRows(column, sample[i], sample[j]) == 0)
+      j++;
+    if (j - i > 1 && (j - i) * 2 * HISTOGRAM_BUCKETS > n)
+      runs.emplace_back(j - i, sample[i]);
+    i = j;
+  }
+  std::stable_sort(runs.begin(), runs.end(),
+                   [](const std::pair<size_t, RowId> &a,
+                      const std::pair<size_t, RowId> &b) {
+                     return a.first > b.first;
+                   });
+  if (runs.size() > FREQUENT_VALUES)
+    runs.resize(FREQUENT_VALUES);
+  for (const auto &run : runs) {
+    FrequentValue value;
+    value.value = column.getCell(run.second);
+    value.fraction = static_cast<double>(run.first) / n;
+    stats.frequent.push_back(std::move(value));
+  }
+}
+
+// Three-way comparison of a predicate's literal with a non-NULL statistic
+// value of its column
+int compareLiteral(const BoundPredicate &pred, ColumnType type,
+                   const CellValue &value) {
+  if (pred.mode == CompareMode::VARCHAR)
+    return pred.literal.stringValue.compare(value.stringValue);
+  if (pred.mode == CompareMode::INT && type == ColumnType::INT) {
+    int64_t x = pred.literal.intValue;
+    return x < value.intValue ? -1 : x > value.intValue;
+  }
+  double x = pred.mode == CompareMode::INT
+                 ? static_cast<double>(pred.literal.intValue)
+                 : pred.literal.floatValue;
+  double y = type == ColumnType::INT ? static_cast<double>(value.intValue)
+                                     : value.floatValue;
+  return x < y ? -1 : x > y;
+}
+
+double numericOf(const CellValue &value, ColumnType type) {
+  return type == ColumnType::INT ? static_cast<double>(value.intValue)
+                                 : value.floatValue;
+}
+
+// Share of the non-NULL values equal to the literal
+double equalFraction(const ColumnStats &stats, const BoundPredicate &pred) {
+  if (compareLiteral(pred, stats.type, stats.min) < 0 ||
+      compareLiteral(pred, stats.type, stats.max) > 0)
+    return 0.0;
+  double rest = 1.0;
+  for (const auto &value : stats.frequent) {
+    if (compareLiteral(pred, stats.type, value.value) == 0)
+      return value.fraction;
+    rest -= value.fraction;
+  }
+  double others = std::max<double>(
+      1.0, static_cast<double>(stats.distinct) - stats.frequent.size());
+  return std::max(0.0, rest) / others;
+}
+
+// Share of the non-NULL values at most the literal, from the histogram:
+// bound i has about i / HISTOGRAM_BUCKETS of the values at or below it
+double cumulativeFraction(const ColumnStats &stats,
+                          const BoundPredicate &pred) {
+  const auto &bounds = stats.bounds;
+  if (compareLiteral(pred, stats.type, bounds.front()) < 0)
+    return 0.0;
+  if (compareLiteral(pred, stats.type, bounds.back()) >= 0)
+    return 1.0;
+
+  // Last bound at or below the literal
+  size_t lo = 0, hi = bounds.size() - 1;
+  while (hi - lo > 1) {
+    size_t mid = (lo + hi) / 2;
+    if (compareLiteral(pred, stats.type, bounds[mid]) >= 0)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  double within = 0.0;
+  if (compareLiteral(pred, stats.type, bounds[lo]) > 0) {
+    if (pred.mode == CompareMode::VARCHAR) {
+      within = 0.5;
+    } else {
+      double low = numericOf(bounds[lo], stats.type);
+      double high = numericOf(bounds[hi], stats.type);
+      double x = pred.mode == CompareMode::INT
+                     ? static_cast<double>(pred.literal.intValue)
+                     : pred.literal.floatValue;
+      within = high > low ? (x - low) / (high - low) : 0.5;
+    }
+  }
+  return (static_cast<double>(lo) + within) / (bounds.size() - 1);
+}
+
+} // namespace
+
+// ============================================================================
+// HYPERLOGLOG
+// ============================================================================
+void HyperLogLog::merge(const HyperLogLog &other) {
+  for (size_t i = 0; i < registers.size(); i++)
+    registers[i] = std::max(registers[i], other.registers[i]);
+}
+
+uint64_t HyperLogLog::estimate() const {
+  double m = static_cast<double>(registers.size());
+  double sum = 0.0;
+  size_t zeros = 0;
+  for (uint8_t reg : registers) {
+    sum += std::ldexp(1.0, -static_cast<int>(reg));
+    zeros += reg == 0;
+  }
+  double alpha = 0.7213 / (1.0 + 1.079 / m);
+  double estimate = alpha * m * m / sum;
+
+  // Few values: linear counting of the empty registers is more accurate
+  if (estimate <= 2.5 * m && zeros > 0)
+    estimate = m * std::log(m / static_cast<double>(zeros));
+  return static_cast<uint64_t>(estimate + 0.5);
+}
+
+// ============================================================================
+// ANALYZE
+// ============================================================================
+TableStats analyzeTable(const TableData &table, ThreadPool *pool) {
+  TableStats stats;
+  stats.rows = table.liveRows();
+  size_t columns = table.columns.size();
+  size_t morsels = (table.rowCount + COLUMN_CHUNK_ROWS - 1) / COLUMN_CHUNK_ROWS;
+  size_t step = std::max<size_t>(
+      1, (table.rowCount + HISTOGRAM_SAMPLE - 1) / HISTOGRAM_SAMPLE);
+
+  // One partial per morsel and column, merged in morsel order so the
+  // sample (and so the histogram) does not depend on the threads
+  std::vector<std::vector<ColumnPartial>> partials(morsels);
+  auto runMorsel = [&](size_t morsel) {
+    size_t count =
+        std::min(COLUMN_CHUNK_ROWS, table.rowCount - morsel * COLUMN_CHUNK_ROWS);
+    std::vector<uint8_t> live(count, 1);
+    table.deleted.mask(morsel, count, live.data());
+    partials[morsel].resize(columns);
+    for (size_t c = 0; c < columns; c++)
+      analyzeChunk(table.columns[c], morsel, count, live.data(), step,
+                   partials[morsel][c]);
+  };
+  if (pool) {
+    pool->run(morsels, runMorsel);
+  } else {
+    for (size_t morsel = 0; morsel < morsels; morsel++)
+      runMorsel(morsel);
+  }
+
+  for (size_t c = 0; c < columns; c++) {
+    const Column &column = table.columns[c];
+    ColumnPartial total;
+    for (auto &morsel : partials) {
+      morsel[c].mergeInto(total);
+      morsel[c] = ColumnPartial(); // Free the sketch early
+    }
+
+    ColumnStats col;
+    col.type = column.getType();
+    col.nulls = total.nulls;
+    if (total.any) {
+      col.distinct = std::max<uint64_t>(1, total.distinct.estimate());
+      col.distinct = std::min<uint64_t>(col.distinct, stats.rows - col.nulls);
+      col.min.isNull = col.max.isNull = false;
+      col.min.intValue = total.minInt;
+      col.max.intValue = total.maxInt;
+      col.min.floatValue = total.minFloat;
+      col.max.floatValue = total.maxFloat;
+      col.min.stringValue = std::string(total.minText);
+      col.max.stringValue = std::string(total.maxText);
+
+      std::stable_sort(total.sample.begin(), total.sample.end(),
+                       [&column](RowId a, RowId b) {
+                         return compareRows(column, a, b) < 0;
+                       });
+      summarizeSample(column, total.sample, col);
+    }
+    stats.columns.push_back(std::move(col));
+  }
+  return stats;
+}
+
+// ============================================================================
+// SELECTIVITY ESTIMATION
+// ============================================================================
+bool estimateSelectivity(const TableStats &stats, const BoundPredicate &pred,
+                         double &fraction) {
+  if (pred.mode == CompareMode::TEXT || pred.columnIndex < 0 ||
+      pred.columnIndex >= static_cast<int>(stats.columns.size()) ||
+      stats.rows == 0)
+    return false;
+  const ColumnStats &col = stats.columns[pred.columnIndex];
+  if (col.bounds.empty()) {
+    fraction = 0.0; // Only NULLs: no comparison matches
+    return true;
+  }
+
+  // NULL never satisfies a comparison
+  double nonNull = 1.0 - static_cast<double>(col.nulls) / stats.rows;
+  double equal = equalFraction(col, pred);
+  double below = 0.0; // Share of values less than the literal
+  if (pred.op != CompareOp::EQ && pred.op != CompareOp::NE)
+    below = std::max(0.0, cumulativeFraction(col, pred) - equal);
+
+  double share = 0.0;
+  switch (pred.op) {
+  case CompareOp::EQ:
+    share = equal;
+    break;
+  case CompareOp::NE:
+    share = 1.0 - equal;
+    break;
+  case CompareOp::LT:
+    share = below;
+    break;
+  case CompareOp::LE:
+    share = below + equal;
+    break;
+  case CompareOp::GT:
+    share = 1.0 - below - equal;
+    break;
+  case CompareOp::GE:
+    share = 1.0 - below;
+    break;
+  }
+  fraction = std::min(1.0, std::max(0.0, share)) * nonNull;
+  return true;
+}
+
+} // namespace MiniSQL
@@ -16,7 +16,7 @@
 namespace MiniSQL {
 
 // Constructor - Initialize with sample schema
-SymbolTable::SymbolTable() {
+SymbolTable::SymbolTable() : version(0) {
   // Create sample tables for demonstration
 
   // Table: employees
@@ -55,6 +55,7 @@ SymbolTable::SymbolTable() {
 
 void SymbolTable::addTable(const TableInfo &table) {
   tables[table.name] = table;
+  version++;
 }
 
 bool SymbolTable::tableExists(const std::string &tableName) const {
@@ -0,0 +1,124 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: thread_pool.cpp
+ * Description: Work-Stealing Thread Pool Implementation
+ */
+
+#include "../include/thread_pool.h"
+#include <algorithm>
+
+namespace MiniSQL {
+
+ThreadPool::ThreadPool(size_t threads)
+    : task(nullptr), generation(0), busy(0), pending(0), stopping(false) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (size_t t = 0; t < threads; t++)
+    queues.push_back(std::make_unique<WorkQueue>());
+  for (size_t t = 1; t < threads; t++)
+    workers.emplace_back(&ThreadPool::workerLoop, this, t);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers)
+    worker.join();
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)> &fn) {
+  std::unique_lock<std::mutex> owner(runMutex, std::defer_lock);
+  if (queues.size() == 1 || count <= 1 || !owner.try_lock()) {
+    for (size_t i = 0; i < count; i++)
+      fn(i);
+    return;
+  }
+
+  // Deal out contiguous blocks, so neighbouring morsels share a thread
+  size_t threads = queues.size();
+  for (size_t t = 0; t < threads; t++) {
+    std::lock_guard<std::mutex> lock(queues[t]->mutex);
+    queues[t]->begin = count * t / threads;
+    queues[t]->end = count * (t + 1) / threads;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    task = &fn;
+    pending = count;
+    generation++;
+  }
+  wake.notify_all();
+
+  drain(0, fn);
+
+  // Workers may still be finishing morsels they took
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [this]() { return pending == 0 && busy == 0; });
+  task = nullptr;
+}
+
+void ThreadPool::workerLoop(size_t self) {
+  uint64_t seen = 0;
+  for (;;) {
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait(lock, [&]() { return stopping || generation != seen; });
+    if (stopping)
+      return;
+    seen = generation;
+    if (!task)
+      continue; // That run has already completed
+    const std::function<void(size_t)> &fn = *task;
+    busy++;
+    lock.unlock();
+
+    drain(self, fn);
+
+    lock.lock();
+    busy--;
+    if (busy == 0 && pending == 0)
+      finished.notify_all();
+  }
+}
+
+void ThreadPool::drain(size_t self, const std::function<void(size_t)> &fn) {
+  size_t morsel;
+  while (take(self, morsel)) {
+    fn(morsel);
+    if (--pending == 0) {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished.notify_all();
+    }
+  }
+}
+
+bool ThreadPool::take(size_t self, size_t &morsel) {
+  // Own block first, from the front
+  {
+    WorkQueue &own = *queues[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.begin < own.end) {
+      morsel = own.begin++;
+      return true;
+    }
+  }
+
+  // Then steal from the back of the other blocks
+  size_t threads = queues.size();
+  for (size_t step = 1; step < threads; step++) {
+    WorkQueue &victim = *queues[(self + step) % threads];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.begin < victim.end) {
+      morsel = --victim.end;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace MiniSQL
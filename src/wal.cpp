@@ -0,0 +1,506 @@
+/**
+ * Mini SQL Compiler for Query Validation & Execution
+ * ====================================================
+ * File: wal.cpp
+ * Description: Write-Ahead Log Implementation
+ */
+
+#include "../include/wal.h"
+#include "../include/binary_io.h"
+#include "../include/compression.h"
+#include "../include/data_store.h"
+#include "../include/mapped_file.h"
+#include "../include/output.h"
+#include "../include/snapshot.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace MiniSQL {
+
+namespace {
+
+const char SEGMENT_MAGIC[8] = {'M', 'S', 'Q', 'L', 'W', 'A', 'L', '1'};
+
+// Record layout: u32 body size, u64 checksum of the body, then the body:
+// u64 LSN, u8 type, type-specific fields
+constexpr size_t RECORD_HEADER = sizeof(uint32_t) + sizeof(uint64_t);
+constexpr uint32_t MAX_RECORD_BYTES = 1u << 30;
+
+void encodeRecord(const LogRecord &record, std::vector<uint8_t> &out) {
+  out.assign(RECORD_HEADER, 0);
+  putValue(out, record.lsn);
+  putValue(out, static_cast<uint8_t>(record.type));
+  putString(out, record.table);
+
+  switch (record.type) {
+  case LogRecordType::INSERT:
+    putValue(out, static_cast<uint32_t>(record.columns.size()));
+    for (size_t i = 0; i < record.columns.size(); i++) {
+      putString(out, record.columns[i]);
+      putString(out, record.values[i]);
+    }
+    break;
+  case LogRecordType::UPDATE:
+    putString(out, record.columns[0]);
+    putString(out, record.values[0]);
+    // fall through
+  case LogRecordType::DELETE:
+  case LogRecordType::DELETE_MARK:
+    putValue(out, static_cast<uint32_t>(record.rows.size()));
+    putArray(out, record.rows);
+    break;
+  case LogRecordType::UPDATE_SET:
+    putValue(out, static_cast<uint32_t>(record.columns.size()));
+    for (size_t i = 0; i < record.columns.size(); i++) {
+      putString(out, record.columns[i]);
+      putString(out, record.values[i]);
+    }
+    putValue(out, static_cast<uint32_t>(record.rows.size()));
+    putArray(out, record.rows);
+    break;
+  case LogRecordType::TRUNCATE:
+  case LogRecordType::COMPACT:
+    break;
+  case LogRecordType::INSERT_ROWS:
+    putValue(out, static_cast<uint32_t>(record.columns.size()));
+    for (const auto &column : record.columns)
+      putString(out, column);
+    putValue(out, static_cast<uint32_t>(record.values.size()));
+    for (const auto &value : record.values)
+      putString(out, value);
+    putValue(out, static_cast<uint8_t>(record.nulls.empty() ? 0 : 1));
+    putArray(out, record.nulls);
+    break;
+  }
+
+  uint32_t bodySize = static_cast<uint32_t>(out.size() - RECORD_HEADER);
+  uint64_t checksum = checksum64(out.data() + RECORD_HEADER, bodySize);
+  std::memcpy(out.data(), &bodySize, sizeof(bodySize));
+  std::memcpy(out.data() + sizeof(bodySize), &checksum, sizeof(checksum));
+}
+
+bool decodeRecord(const uint8_t *body, size_t size, LogRecord &record) {
+  ByteReader in(body, body + size);
+  uint8_t type = 0;
+  uint32_t count = 0;
+  if (!in.get(record.lsn) || !in.get(type) || !in.getString(record.table))
+    return false;
+  record.type = static_cast<LogRecordType>(type);
+  record.columns.clear();
+  record.values.clear();
+  record.rows.clear();
+  record.nulls.clear();
+
+  switch (record.type) {
+  case LogRecordType::INSERT:
+    if (!in.get(count))
+      return false;
+    for (uint32_t i = 0; i < count; i++) {
+      std::string column, value;
+      if (!in.getString(column) || !in.getString(value))
+        return false;
+      record.columns.push_back(std::move(column));
+      record.values.push_back(std::move(value));
+    }
+    break;
+  case LogRecordType::UPDATE:
+    record.columns.resize(1);
+    record.values.resize(1);
+    if (!in.getString(record.columns[0]) || !in.getString(record.values[0]))
+      return false;
+    // fall through
+  case LogRecordType::DELETE:
+  case LogRecordType::DELETE_MARK:
+    if (!in.get(count) || !in.getArray(record.rows, count))
+      return false;
+    break;
+  case LogRecordType::UPDATE_SET:
+    // Every string takes at least its u32 length
+    if (!in.get(count) || count > in.remaining() / (2 * sizeof(uint32_t)))
+      return false;
+    record.columns.resize(count);
+    record.values.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+      if (!in.getString(record.columns[i]) ||
+          !in.getString(record.values[i]))
+        return false;
+    }
+    if (!in.get(count) || !in.getArray(record.rows, count))
+      return false;
+    break;
+  case LogRecordType::TRUNCATE:
+  case LogRecordType::COMPACT:
+    break;
+  case LogRecordType::INSERT_ROWS: {
+    // Every string takes at least its u32 length
+    uint8_t hasNulls = 0;
+    if (!in.get(count) || count > in.remaining() / sizeof(uint32_t))
+      return false;
+    record.columns.resize(count);
+    for (auto &column : record.columns) {
+      if (!in.getString(column))
+        return false;
+    }
+    if (!in.get(count) || count > in.remaining() / sizeof(uint32_t))
+      return false;
+    record.values.resize(count);
+    for (auto &value : record.values) {
+      if (!in.getString(value))
+        return false;
+    }
+    if (!in.get(hasNulls) || (hasNulls && !in.getArray(record.nulls, count)))
+      return false;
+    break;
+  }
+  default:
+    return false;
+  }
+  return in.atEnd();
+}
+
+bool writeAll(int fd, const uint8_t *data, size_t size) {
+  while (size > 0) {
+    ssize_t n = ::write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Make directory entries (new segments, renamed snapshots) durable
+void syncDirectory(const std::string &dir) {
+  int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd >= 0) {
+    ::fsync(fd);
+    ::close(fd);
+  }
+}
+
+} // namespace
+
+// ============================================================================
+// CONSTRUCTION
+// ============================================================================
+WriteAheadLog::WriteAheadLog(const std::string &dir, size_t checkpointBytes)
+    : dir(dir), checkpointBytes(checkpointBytes), attached(nullptr), fd(-1),
+      segment(0),
+      nextLsn(1), writtenLsn(0), durableLsn(0), bytesSinceCheckpoint(0),
+      stopping(false), failed(false), syncCount(0), recordCount(0),
+      checkpointRunning(false), checkpointCount(0) {}
+
+WriteAheadLog::~WriteAheadLog() {
+  // The store's background compactor may outlive the log
+  if (attached)
+    attached->attachLog(nullptr);
+  if (checkpointer.joinable())
+    checkpointer.join();
+  if (flusher.joinable()) {
+    commit(true);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    syncRequested.notify_all();
+    flusher.join();
+  }
+  if (fd >= 0)
+    ::close(fd);
+}
+
+std::string WriteAheadLog::segmentPath(uint64_t number) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "wal-%06llu.log",
+                static_cast<unsigned long long>(number));
+  return dir + "/" + name;
+}
+
+std::vector<uint64_t> WriteAheadLog::listSegments() const {
+  std::vector<uint64_t> numbers;
+  DIR *handle = ::opendir(dir.c_str());
+  if (!handle)
+    return numbers;
+  while (dirent *entry = ::readdir(handle)) {
+    unsigned long long number = 0;
+    char tail = 0;
+    if (std::sscanf(entry->d_name, "wal-%llu.lo%c", &number, &tail) == 2 &&
+        tail == 'g' && number > 0)
+      numbers.push_back(number);
+  }
+  ::closedir(handle);
+  std::sort(numbers.begin(), numbers.end());
+  return numbers;
+}
+
+bool WriteAheadLog::openSegment(uint64_t number, std::string &error) {
+  std::string path = segmentPath(number);
+  int newFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND,
+                     0644);
+  if (newFd < 0) {
+    error = "could not create '" + path + "'";
+    return false;
+  }
+  if (!writeAll(newFd, reinterpret_cast<const uint8_t *>(SEGMENT_MAGIC),
+                sizeof(SEGMENT_MAGIC)) ||
+      ::fdatasync(newFd) != 0) {
+    ::close(newFd);
+    error = "could not write '" + path + "'";
+    return false;
+  }
+  syncDirectory(dir);
+
+  if (fd >= 0)
+    ::close(fd);
+  fd = newFd;
+  segment = number;
+  return true;
+}
+
+// ============================================================================
+// RECOVERY
+// ============================================================================
+bool WriteAheadLog::open(DataStore &store, std::string &error) {
+  if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+    error = "could not create directory '" + dir + "'";
+    return false;
+  }
+
+  // Checkpoint first, then every newer record, segment by segment
+  store.loadSnapshots(dir);
+
+  uint64_t lastLsn = 0;
+  size_t applied = 0, rejected = 0;
+  std::vector<uint64_t> segments = listSegments();
+  for (uint64_t number : segments) {
+    std::string path = segmentPath(number);
+    MappedFile file(path);
+    if (!file.isOpen())
+      continue;
+    if (file.size() <= sizeof(SEGMENT_MAGIC)) {
+      std::remove(path.c_str()); // No records (e.g. a read-only session)
+      continue;
+    }
+    bytesSinceCheckpoint += file.size();
+
+    const uint8_t *base = reinterpret_cast<const uint8_t *>(file.data());
+    ByteReader in(base, base + file.size());
+    const uint8_t *magic = in.take(sizeof(SEGMENT_MAGIC));
+    if (!magic || std::memcmp(magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)))
+      continue;
+
+    LogRecord record;
+    while (!in.atEnd()) {
+      size_t recordStart = file.size() - in.remaining();
+      uint32_t bodySize = 0;
+      uint64_t checksum = 0;
+      const uint8_t *body = nullptr;
+      if (!in.get(bodySize) || !in.get(checksum) ||
+          bodySize > MAX_RECORD_BYTES || !(body = in.take(bodySize)) ||
+          checksum64(body, bodySize) != checksum ||
+          !decodeRecord(body, bodySize, record)) {
+        // Cut the torn record off so it is reported only once
+        std::cerr << "Warning: " << path
+                  << " ends with an incomplete record (discarded)\n";
+        if (::truncate(path.c_str(), static_cast<off_t>(recordStart)) != 0)
+          std::cerr << "Warning: could not truncate " << path << "\n";
+        break;
+      }
+
+      lastLsn = std::max(lastLsn, record.lsn);
+      // Release the snapshot before applying, or replay copies the table
+      TableSnapshot table = store.snapshot(record.table);
+      bool checkpointed = table && record.lsn <= table->logSequence;
+      table.reset();
+      if (checkpointed)
+        continue; // Already in the checkpoint
+      if (store.applyLogRecord(record))
+        applied++;
+      else
+        rejected++;
+    }
+  }
+
+  // Snapshots may be newer than the last surviving segment
+  for (const auto &table : store.captureTables())
+    lastLsn = std::max(lastLsn, table.logSequence);
+
+  if (applied > 0 || rejected > 0) {
+    diag() << "Replayed " << applied << " log records from " << dir;
+    if (rejected > 0)
+      diag() << " (" << rejected << " records did not apply)";
+    diag() << "\n";
+  }
+
+  nextLsn = lastLsn + 1;
+  writtenLsn = durableLsn = lastLsn;
+  if (!openSegment(segments.empty() ? 1 : segments.back() + 1, error))
+    return false;
+
+  store.attachLog(this);
+  attached = &store;
+  flusher = std::thread(&WriteAheadLog::flusherLoop, this);
+  return true;
+}
+
+// ============================================================================
+// APPEND & GROUP COMMIT
+// ============================================================================
+uint64_t WriteAheadLog::append(LogRecord &record) {
+  std::lock_guard<std::mutex> lock(mutex);
+  record.lsn = nextLsn++;
+  encodeRecord(record, encodeBuffer);
+  if (!writeAll(fd, encodeBuffer.data(), encodeBuffer.size()))
+    failed = true;
+  writtenLsn = record.lsn;
+  bytesSinceCheckpoint += encodeBuffer.size();
+  recordCount++;
+  return record.lsn;
+}
+
+bool WriteAheadLog::commit(bool wait) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (durableLsn >= writtenLsn)
+    return !failed;
+  uint64_t target = writtenLsn;
+  syncRequested.notify_one();
+  if (wait)
+    syncDone.wait(lock, [&] { return durableLsn >= target || failed; });
+  return !failed;
+}
+
+void WriteAheadLog::flusherLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    syncRequested.wait(lock,
+                       [&] { return stopping || durableLsn < writtenLsn; });
+    if (durableLsn >= writtenLsn && stopping)
+      break;
+
+    // Everything written so far goes into this sync; records appended
+    // while it runs wait for the next one
+    uint64_t target = writtenLsn;
+    int syncFd = fd;
+    lock.unlock();
+    bool ok = ::fdatasync(syncFd) == 0;
+    lock.lock();
+
+    if (!ok)
+      failed = true;
+    durableLsn = std::max(durableLsn, target);
+    syncCount++;
+    syncDone.notify_all();
+  }
+}
+
+// ============================================================================
+// CHECKPOINTS
+// ============================================================================
+bool WriteAheadLog::checkpoint(const DataStore &store, bool background) {
+  if (checkpointRunning)
+    return false;
+  if (checkpointer.joinable())
+    checkpointer.join();
+
+  // Later records go to a new segment that the checkpoint does not delete
+  uint64_t lastSegment = 0;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    syncRequested.notify_one();
+    syncDone.wait(lock, [&] { return durableLsn >= writtenLsn || failed; });
+
+    std::string error;
+    lastSegment = segment;
+    if (failed || !openSegment(segment + 1, error)) {
+      std::cerr << "Warning: checkpoint skipped: "
+                << (error.empty() ? "log write failed" : error) << "\n";
+      return false;
+    }
+    bytesSinceCheckpoint = 0;
+  }
+
+  // The copies reflect every record of the old segments: the DataStore
+  // applies a change before another one can be logged or its tables
+  // copied. Each copy keeps the LSN of the last record it reflects, so
+  // replay skips the records of the new segment that it already holds.
+  std::vector<TableData> tables = store.captureTables();
+
+  checkpointRunning = true;
+  if (background) {
+    checkpointer = std::thread(&WriteAheadLog::writeCheckpoint, this,
+                               std::move(tables), lastSegment);
+    return true;
+  }
+  writeCheckpoint(std::move(tables), lastSegment);
+  return true;
+}
+
+void WriteAheadLog::maybeCheckpoint(const DataStore &store) {
+  if (checkpointBytes == 0 || checkpointRunning)
+    return;
+  bool due;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    due = bytesSinceCheckpoint >= checkpointBytes;
+  }
+  if (due)
+    checkpoint(store, true);
+}
+
+void WriteAheadLog::writeCheckpoint(std::vector<TableData> tables,
+                                    uint64_t lastSegment) {
+  bool complete = true;
+  for (const auto &table : tables) {
+    SnapshotStats stats;
+    std::string error;
+    if (!saveSnapshot(dir + "/" + table.schema.name + ".snap", table, false,
+                      stats, error)) {
+      std::cerr << "Warning: checkpoint failed: " << error << "\n";
+      complete = false;
+    }
+  }
+
+  // Only a complete checkpoint replaces the segments it covers
+  if (complete) {
+    syncDirectory(dir);
+    for (uint64_t number : listSegments()) {
+      if (number <= lastSegment)
+        std::remove(segmentPath(number).c_str());
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    checkpointCount++;
+  }
+  checkpointRunning = false;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+void WriteAheadLog::printStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::cout << "\nWrite-Ahead Log (" << dir << "):\n";
+  std::cout << "  Segment:       " << segmentPath(segment) << "\n";
+  std::cout << "  Records:       " << recordCount << " appended, last LSN "
+            << writtenLsn << "\n";
+  std::cout << "  Syncs:         " << syncCount << "\n";
+  if (syncCount > 0)
+    std::cout << "  Group size:    " << static_cast<double>(recordCount) /
+                                            static_cast<double>(syncCount)
+              << " records per sync\n";
+  std::cout << "  Since checkpt: " << bytesSinceCheckpoint << " bytes\n";
+  std::cout << "  Checkpoints:   " << checkpointCount
+            << (checkpointRunning ? " (one running)" : "") << "\n";
+  if (failed)
+    std::cout << "  Status:        FAILED (a write or sync error occurred)\n";
+}
+
+} // namespace MiniSQL